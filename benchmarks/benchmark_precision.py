@@ -0,0 +1,98 @@
+# Copyright (c) 2020, RTE (https://www.rte-france.com)
+# See AUTHORS.txt
+# This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+# If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+# you can obtain one at http://mozilla.org/MPL/2.0/.
+# SPDX-License-Identifier: MPL-2.0
+# This file is part of LightSim2grid, LightSim2grid a implements a c++ backend targeting the Grid2Op platform.
+
+"""
+Compares the newton raphson with the linear systems solved in mixed precision (`NRPrecision.Mixed`: jacobian
+factorized in single precision, solutions refined in double precision) to the double precision solvers, in
+speed (time spent in the solver) and accuracy (largest difference of the complex voltages with the double
+precision KLU solver, or SparseLU if KLU is not available).
+"""
+
+import argparse
+import numpy as np
+import pandapower.networks as pn
+
+import lightsim2grid
+from lightsim2grid import SolverType, NRPrecision
+from lightsim2grid.initGridModel import init
+from lightsim2grid.syntheticGrid import make_synthetic_grid
+from utils_benchmark import str2bool
+TABULATE_AVAIL = False
+try:
+    from tabulate import tabulate
+    TABULATE_AVAIL = True
+except ImportError:
+    print("The tabluate package is not installed. Some output might not work properly")
+
+CASES = "case14,case30,case118,case300,case1888rte"
+SIZES = "10000,50000"
+MAX_IT = 10
+
+
+def time_pf(model, V0, tol, nb_run):
+    """average time (in ms) spent in the solver, and the voltages of the last powerflow"""
+    solver = 0.
+    V = None
+    for _ in range(nb_run):
+        V = model.ac_pf(V0, MAX_IT, tol)
+        solver += model.get_computation_time()
+    return 1000. * solver / nb_run, V
+
+
+def main(cases, sizes, nb_run, tol, tab_format):
+    grids = [(nm, getattr(pn, nm)()) for nm in cases]
+    grids += [(f"synthetic {size}", make_synthetic_grid(size)) for size in sizes]
+    available = lightsim2grid.GridModel().available_solvers()
+    ref_type = SolverType.KLU if SolverType.KLU in available else SolverType.SparseLU
+    configs = [(ref_type, NRPrecision.Double), (SolverType.SparseLU, NRPrecision.Double),
+               (SolverType.SparseLU, NRPrecision.Mixed)]
+    if ref_type == SolverType.SparseLU:
+        configs = configs[1:]
+
+    tab = []
+    for grid_nm, net in grids:
+        model = init(net)
+        V0 = np.ones(net.bus.shape[0], dtype=np.complex_)
+        V_ref = None
+        for solver_type, precision in configs:
+            model.change_solver(solver_type)
+            model.set_precision(precision)
+            time_solver, V = time_pf(model, V0, tol, nb_run)
+            if V.shape[0] == 0:
+                tab.append([grid_nm, f"{solver_type}".split(".")[-1], f"{precision}".split(".")[-1], "diverged", ""])
+                continue
+            if V_ref is None:
+                V_ref = V
+            tab.append([grid_nm, f"{solver_type}".split(".")[-1], f"{precision}".split(".")[-1],
+                        f"{time_solver:.2e}", f"{np.max(np.abs(V - V_ref)):.2e}"])
+
+    hds = ["grid", "solver", "precision", "solver time (ms)", "max |V - V_ref|"]
+    if TABULATE_AVAIL:
+        print(tabulate(tab, headers=hds, tablefmt=tab_format))
+    else:
+        print(tab)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='Benchmark the mixed precision newton raphson')
+    parser.add_argument('--cases', default=CASES, type=str,
+                        help='Comma separated list of pandapower grids (functions of pandapower.networks)')
+    parser.add_argument('--sizes', default=SIZES, type=str,
+                        help='Comma separated list of the (minimum) number of buses of the synthetic grids '
+                             '(empty for none)')
+    parser.add_argument('--nb_run', default=10, type=int,
+                        help='Number of powerflows run for each configuration (times are averaged)')
+    parser.add_argument('--tol', default=1e-8, type=float,
+                        help='Tolerance of the powerflows')
+    parser.add_argument('--no_markdown', type=str2bool, nargs='?', const=True, default=False,
+                        help='Do not use markdown format to print the results (use rst instead)')
+    args = parser.parse_args()
+    cases = [el for el in args.cases.split(",") if el]
+    sizes = [int(el) for el in args.sizes.split(",") if el]
+    tab_format = "rst" if args.no_markdown else "github"
+    main(cases, sizes, args.nb_run, args.tol, tab_format)
@@ -0,0 +1,158 @@
+# Copyright (c) 2020, RTE (https://www.rte-france.com)
+# See AUTHORS.txt
+# This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+# If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+# you can obtain one at http://mozilla.org/MPL/2.0/.
+# SPDX-License-Identifier: MPL-2.0
+# This file is part of LightSim2grid, LightSim2grid a implements a c++ backend targeting the Grid2Op platform.
+
+"""
+Measures how the different phases of a powerflow (grid conversion, pre processing - Ybus / Sbus -, solver)
+scale with the size of the grid, on synthetic grids made of copies of a pandapower grid.
+
+The exponent reported is the slope, in log-log scale, between two consecutive sizes: 1 means linear scaling,
+anything significantly above 1 flags a super linear phase.
+"""
+
+import os
+import time
+import argparse
+import resource
+import numpy as np
+
+import lightsim2grid
+from lightsim2grid.initGridModel import init
+from lightsim2grid.syntheticGrid import make_synthetic_grid
+from utils_benchmark import str2bool
+TABULATE_AVAIL = False
+try:
+    from tabulate import tabulate
+    TABULATE_AVAIL = True
+except ImportError:
+    print("The tabluate package is not installed. Some output might not work properly")
+
+SIZES = "1000,10000,20000,50000"
+MAX_IT = 10
+MAX_IT_GS = 10000
+TOL = 1e-8
+
+
+def get_rss_mb():
+    """resident memory (in MB) of the current process"""
+    try:
+        with open("/proc/self/statm", "r") as f:
+            nb_pages = int(f.read().split()[1])
+        return nb_pages * resource.getpagesize() / 1024. / 1024.
+    except (IOError, OSError):
+        # not on linux: fallback to the peak resident memory
+        return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss / 1024.
+
+
+def time_pf(model, fun, V0, max_it, nb_run):
+    """average (over `nb_run`) total time and solver time (in ms) of a powerflow"""
+    total = 0.
+    solver = 0.
+    converged = True
+    for _ in range(nb_run):
+        beg = time.perf_counter()
+        V = fun(V0, max_it, TOL)
+        total += time.perf_counter() - beg
+        solver += model.get_computation_time()
+        converged = converged and V.shape[0] > 0
+    return 1000. * total / nb_run, 1000. * solver / nb_run, converged
+
+
+def exponent(sizes, times):
+    res = [""]
+    for i in range(1, len(sizes)):
+        if times[i - 1] is None or times[i] is None or times[i - 1] <= 0. or times[i] <= 0.:
+            res.append("")
+            continue
+        res.append(f"{np.log(times[i] / times[i - 1]) / np.log(sizes[i] / sizes[i - 1]):.2f}")
+    return res
+
+
+def main(sizes, base_case, nb_run, max_bus_gs, tab_format):
+    print(f"OMP_NUM_THREADS: {os.environ.get('OMP_NUM_THREADS', 'not set')}")
+    solvers = [el for el in [lightsim2grid.SolverType.KLU,
+                             lightsim2grid.SolverType.SparseLU,
+                             lightsim2grid.SolverType.GaussSeidel]
+               if el in lightsim2grid.GridModel().available_solvers()]
+
+    res = {}  # name of the phase => list of times (one per size)
+    real_sizes = []
+    mem = []
+    for size in sizes:
+        beg = time.perf_counter()
+        net = make_synthetic_grid(size, base_case=base_case)
+        time_gen = time.perf_counter() - beg
+        n_bus = net.bus.shape[0]
+        real_sizes.append(n_bus)
+        mem_before = get_rss_mb()
+
+        beg = time.perf_counter()
+        model = init(net)
+        time_init = time.perf_counter() - beg
+        res.setdefault("generation", []).append(1000. * time_gen)
+        res.setdefault("conversion (init)", []).append(1000. * time_init)
+
+        V0 = np.ones(n_bus, dtype=np.complex_)
+        model.change_solver(lightsim2grid.SolverType.DC)
+        total, solver, _ = time_pf(model, model.dc_pf, V0, 1, nb_run)
+        res.setdefault("DC: pre processing", []).append(total - solver)
+        res.setdefault("DC: solver", []).append(solver)
+
+        for solver_type in solvers:
+            nm = f"{solver_type}".split(".")[-1]
+            if solver_type == lightsim2grid.SolverType.GaussSeidel and n_bus > max_bus_gs:
+                res.setdefault(f"{nm}: pre processing", []).append(None)
+                res.setdefault(f"{nm}: solver", []).append(None)
+                continue
+            model.change_solver(solver_type)
+            max_it = MAX_IT_GS if solver_type == lightsim2grid.SolverType.GaussSeidel else MAX_IT
+            total, solver, converged = time_pf(model, model.ac_pf, V0, max_it, nb_run)
+            if not converged:
+                print(f"WARNING: {nm} did not converge for {n_bus} buses")
+            res.setdefault(f"{nm}: pre processing", []).append(total - solver)
+            res.setdefault(f"{nm}: solver", []).append(solver)
+        mem.append(get_rss_mb() - mem_before)
+        del model
+        del net
+
+    hds = ["phase"]
+    for n_bus in real_sizes:
+        hds += [f"{n_bus} buses (ms)", "exponent"]
+    tab = []
+    for phase, times in res.items():
+        row = [phase]
+        for t, e in zip(times, exponent(real_sizes, times)):
+            row += ["" if t is None else f"{t:.2e}", e]
+        tab.append(row)
+    row = ["memory (MB)"]
+    for m, e in zip(mem, exponent(real_sizes, mem)):
+        row += [f"{m:.1f}", e]
+    tab.append(row)
+
+    if TABULATE_AVAIL:
+        res_tab = tabulate(tab, headers=hds, tablefmt=tab_format)
+        print(res_tab)
+    else:
+        print(tab)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='Benchmark the scaling of lightsim2grid with the size of the grid')
+    parser.add_argument('--sizes', default=SIZES, type=str,
+                        help='Comma separated list of the (minimum) number of buses of the grids to test')
+    parser.add_argument('--base_case', default="case118", type=str,
+                        help='Pandapower grid used as a "tile" to build the synthetic grids')
+    parser.add_argument('--nb_run', default=3, type=int,
+                        help='Number of powerflows run for each solver (times are averaged)')
+    parser.add_argument('--max_bus_gs', default=2000, type=int,
+                        help='Gauss Seidel is not run on grids with more buses than this (too slow)')
+    parser.add_argument('--no_markdown', type=str2bool, nargs='?', const=True, default=False,
+                        help='Do not use markdown format to print the results (use rst instead)')
+    args = parser.parse_args()
+    sizes = [int(el) for el in args.sizes.split(",")]
+    tab_format = "rst" if args.no_markdown else "github"
+    main(sizes, args.base_case, args.nb_run, args.max_bus_gs, tab_format)
@@ -0,0 +1,140 @@
+# Copyright (c) 2020, RTE (https://www.rte-france.com)
+# See AUTHORS.txt
+# This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+# If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+# you can obtain one at http://mozilla.org/MPL/2.0/.
+# SPDX-License-Identifier: MPL-2.0
+# This file is part of LightSim2grid, LightSim2grid a implements a c++ backend targeting the Grid2Op platform.
+
+"""
+Measures the wall time of a powerflow against the number of (openmp) threads, on synthetic grids.
+
+The jacobian matrix (solver) is filled in parallel for grids with more than 5000 buses, if lightsim2grid has been
+compiled with openmp, and so is Ybus (pre processing) with `--parallel_ybus` (see `GridModel.set_parallel_ybus`, off
+by default). The number of threads of openmp is read once, when the library is loaded, so each thread count is
+measured in its own process (with the environment variable OMP_NUM_THREADS).
+
+The speed up reported is the time with 1 thread divided by the time with `n` threads.
+"""
+
+import os
+import sys
+import json
+import time
+import argparse
+import subprocess
+import numpy as np
+
+from utils_benchmark import str2bool
+TABULATE_AVAIL = False
+try:
+    from tabulate import tabulate
+    TABULATE_AVAIL = True
+except ImportError:
+    print("The tabluate package is not installed. Some output might not work properly")
+
+SIZES = "1000,10000,50000"
+MAX_IT = 10
+TOL = 1e-8
+
+
+def measure(sizes, base_case, nb_run, parallel_ybus):
+    """run in the child process: returns, for each size, the number of buses and the average times (in ms)"""
+    import lightsim2grid
+    from lightsim2grid.initGridModel import init
+    from lightsim2grid.syntheticGrid import make_synthetic_grid
+
+    solver_type = lightsim2grid.SolverType.SparseLU
+    if lightsim2grid.SolverType.KLU in lightsim2grid.GridModel().available_solvers():
+        solver_type = lightsim2grid.SolverType.KLU
+    res = []
+    for size in sizes:
+        net = make_synthetic_grid(size, base_case=base_case)
+        model = init(net)
+        model.change_solver(solver_type)
+        model.set_parallel_ybus(parallel_ybus)
+        V0 = np.ones(net.bus.shape[0], dtype=np.complex_)
+        total = 0.
+        solver = 0.
+        for _ in range(nb_run):
+            beg = time.perf_counter()
+            V = model.ac_pf(V0, MAX_IT, TOL)
+            total += time.perf_counter() - beg
+            solver += model.get_computation_time()
+            if V.shape[0] == 0:
+                print(f"WARNING: the powerflow did not converge for {net.bus.shape[0]} buses", file=sys.stderr)
+        res.append({"n_bus": int(net.bus.shape[0]),
+                    "total": 1000. * total / nb_run,
+                    "pre processing": 1000. * (total - solver) / nb_run,
+                    "solver": 1000. * solver / nb_run})
+    return res
+
+
+def main(sizes, threads, base_case, nb_run, parallel_ybus, tab_format):
+    res = {}  # number of threads => results of "measure"
+    for nb_thread in threads:
+        env = dict(os.environ)
+        env["OMP_NUM_THREADS"] = f"{nb_thread}"
+        out = subprocess.run([sys.executable, __file__,
+                              "--child", "True",
+                              "--sizes", ",".join(f"{el}" for el in sizes),
+                              "--base_case", base_case,
+                              "--nb_run", f"{nb_run}",
+                              "--parallel_ybus", f"{parallel_ybus}"],
+                             env=env, check=True, stdout=subprocess.PIPE, universal_newlines=True)
+        res[nb_thread] = json.loads(out.stdout.splitlines()[-1])
+
+    hds = ["buses", "phase"]
+    for nb_thread in threads:
+        hds += [f"{nb_thread} thread(s) (ms)", "speed up"]
+    tab = []
+    for size_id in range(len(sizes)):
+        for phase in ["pre processing", "solver", "total"]:
+            ref = res[threads[0]][size_id][phase]
+            row = [res[threads[0]][size_id]["n_bus"], phase]
+            for nb_thread in threads:
+                this_time = res[nb_thread][size_id][phase]
+                row += [f"{this_time:.2e}", f"{ref / this_time:.2f}" if this_time > 0. else ""]
+            tab.append(row)
+
+    if TABULATE_AVAIL:
+        res_tab = tabulate(tab, headers=hds, tablefmt=tab_format)
+        print(res_tab)
+    else:
+        print(tab)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='Benchmark the wall time of a powerflow against the number of threads')
+    parser.add_argument('--sizes', default=SIZES, type=str,
+                        help='Comma separated list of the (minimum) number of buses of the grids to test')
+    parser.add_argument('--threads', default=None, type=str,
+                        help='Comma separated list of the number of threads to test (default: powers of 2 up to '
+                             'all the cores)')
+    parser.add_argument('--base_case', default="case118", type=str,
+                        help='Pandapower grid used as a "tile" to build the synthetic grids')
+    parser.add_argument('--nb_run', default=5, type=int,
+                        help='Number of powerflows run for each size (times are averaged)')
+    parser.add_argument('--parallel_ybus', type=str2bool, nargs='?', const=True, default=False,
+                        help='Fill Ybus in parallel too (see GridModel.set_parallel_ybus)')
+    parser.add_argument('--no_markdown', type=str2bool, nargs='?', const=True, default=False,
+                        help='Do not use markdown format to print the results (use rst instead)')
+    parser.add_argument('--child', type=str2bool, nargs='?', const=True, default=False,
+                        help=argparse.SUPPRESS)
+    args = parser.parse_args()
+    sizes = [int(el) for el in args.sizes.split(",")]
+    if args.child:
+        print(json.dumps(measure(sizes, args.base_case, args.nb_run, args.parallel_ybus)))
+        sys.exit(0)
+
+    if args.threads is None:
+        nb_cores = os.cpu_count() or 1
+        threads = [1]
+        while 2 * threads[-1] < nb_cores:
+            threads.append(2 * threads[-1])
+        if threads[-1] != nb_cores:
+            threads.append(nb_cores)
+    else:
+        threads = [int(el) for el in args.threads.split(",")]
+    tab_format = "rst" if args.no_markdown else "github"
+    main(sizes, threads, args.base_case, args.nb_run, args.parallel_ybus, tab_format)
@@ -139,6 +139,8 @@ class LightSimBackend(Backend):
         - for SolverType.GaussSeidel: 10000
         - for SolverType.DC: this has no effect
         - for SolverType.SparseKLU: 10
+        - for SolverType.BackwardForwardSweep: 30 (10 is enough for the Newton Raphson used on meshed grids)
+        - for SolverType.Auto: 10 (it is automatically scaled if the GaussSeidel solver is chosen)
 
         Parameters
         ----------
@@ -466,14 +468,10 @@ class LightSimBackend(Backend):
                     self.V = np.ones(self.nb_bus_total, dtype=np.complex_) * 1.04
 
                 if self.initdc:
-                    self._grid.deactivate_result_computation()
-                    V = self._grid.dc_pf(copy.deepcopy(self.V), self.max_it, self.tol)
-                    self._grid.reactivate_result_computation()
-
-                    if V.shape[0] == 0:
-                        raise DivergingPowerFlow("divergence of powerflow (non connected grid)")
-                    self.V[:] = V
-                V = self._grid.ac_pf(self.V, self.max_it, self.tol)
+                    # the dc initialization is performed directly in the c++ side
+                    V = self._grid.ac_pf_dc_init(self.V, self.max_it, self.tol)
+                else:
+                    V = self._grid.ac_pf(self.V, self.max_it, self.tol)
                 if V.shape[0] == 0:
                     # V = self._grid.ac_pf(self.V, self.max_it, self.tol)
                     raise DivergingPowerFlow("divergence of powerflow")
@@ -1,9 +1,9 @@
 __version__ = "0.4.0"
 
-__all__ = ["newtonpf", "SolverType"]
+__all__ = ["newtonpf", "SolverType", "StepControl", "SparseKernel", "NRPrecision", "KLUOrdering", "KLUParameters", "RecoveryStage", "ControlType"]
 
 # import directly from c++ module
-from lightsim2grid_cpp import SolverType
+from lightsim2grid_cpp import SolverType, StepControl, SparseKernel, NRPrecision, KLUOrdering, KLUParameters, RecoveryStage, ControlType
 
 try:
     from lightsim2grid.LightSimBackend import LightSimBackend
@@ -0,0 +1,48 @@
+# Copyright (c) 2020, RTE (https://www.rte-france.com)
+# See AUTHORS.txt
+# This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+# If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+# you can obtain one at http://mozilla.org/MPL/2.0/.
+# SPDX-License-Identifier: MPL-2.0
+# This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+"""
+Starts a PowerflowDaemon hosting a grid saved with `GridModel.save`, until it is interrupted (ctrl+c):
+
+    python -m lightsim2grid.powerflowDaemon --grid my_grid.txt --name /lightsim2grid --nb_worker 4
+
+Other processes of the same machine can then compute powerflows with `PowerflowClient("/lightsim2grid")`.
+"""
+
+import argparse
+import time
+
+from lightsim2grid_cpp import load_grid, PowerflowDaemon
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Local powerflow daemon (requests through shared memory)")
+    parser.add_argument("--grid", required=True, type=str, help="grid saved with GridModel.save")
+    parser.add_argument("--name", default="/lightsim2grid", type=str, help="name of the shared memory segment")
+    parser.add_argument("--nb_slot", default=64, type=int, help="number of requests processed at the same time")
+    parser.add_argument("--nb_worker", default=1, type=int, help="number of replicas of the grid (threads)")
+    parser.add_argument("--max_iter", default=10, type=int, help="maximum number of iterations of the powerflows")
+    parser.add_argument("--tol", default=1e-8, type=float, help="tolerance of the powerflows")
+    args = parser.parse_args()
+
+    daemon = PowerflowDaemon(load_grid(args.grid), args.name, args.nb_slot, args.nb_worker)
+    daemon.set_max_iter(args.max_iter)
+    daemon.set_tol(args.tol)
+    daemon.start()
+    print("powerflow daemon started on \"{}\" ({} workers)".format(args.name, args.nb_worker))
+    try:
+        while True:
+            time.sleep(1.)
+    except KeyboardInterrupt:
+        pass
+    daemon.stop()
+    print("powerflow daemon stopped after {} requests".format(daemon.get_nb_processed()))
+
+
+if __name__ == "__main__":
+    main()
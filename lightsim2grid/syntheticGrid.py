@@ -0,0 +1,150 @@
+# Copyright (c) 2020, RTE (https://www.rte-france.com)
+# See AUTHORS.txt
+# This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+# If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+# you can obtain one at http://mozilla.org/MPL/2.0/.
+# SPDX-License-Identifier: MPL-2.0
+# This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+"""
+Generate large synthetic grids (for benchmarking purpose) by tiling copies of a pandapower grid, and by
+interconnecting them with a few tie lines.
+"""
+
+import copy
+import numpy as np
+import pandas as pd
+import pandapower as pp
+import pandapower.networks as pn
+
+# columns that hold a bus id, for each table copied
+_BUS_COLUMNS = {"bus": [],
+                "line": ["from_bus", "to_bus"],
+                "trafo": ["hv_bus", "lv_bus"],
+                "load": ["bus"],
+                "gen": ["bus"],
+                "shunt": ["bus"],
+                }
+
+
+def _make_tile(net_ref):
+    """
+    Copy of the reference grid, where the ext_grid is replaced by a generator producing the same amount of power
+    (losses included) as in a powerflow of the reference grid. This way each tile is balanced, and the tie lines
+    carry (almost) no power.
+
+    Bus ids are also made contiguous (starting at 0).
+    """
+    tile = copy.deepcopy(net_ref)
+    pp.runpp(tile)
+    for eg_id in tile.ext_grid.index:
+        pp.create_gen(tile,
+                      bus=tile.ext_grid.loc[eg_id, "bus"],
+                      p_mw=tile.res_ext_grid.loc[eg_id, "p_mw"],
+                      vm_pu=tile.ext_grid.loc[eg_id, "vm_pu"],
+                      min_q_mvar=-99999.,
+                      max_q_mvar=99999.)
+    tile.ext_grid.drop(tile.ext_grid.index, inplace=True)
+
+    bus_map = pd.Series(np.arange(tile.bus.shape[0]), index=tile.bus.index)
+    for table, cols in _BUS_COLUMNS.items():
+        for col in cols:
+            tile[table][col] = bus_map.loc[tile[table][col].values].values
+    tile.bus.index = np.arange(tile.bus.shape[0])
+    return tile
+
+
+def _tie_lines(tile, nb_copies, nb_tie_lines, rng):
+    """
+    Tie lines between copy k and copy k+1 (copies are on a ring). Their parameters are the one of lines randomly
+    chosen, among the lines connecting buses of the highest voltage level of the reference grid.
+    """
+    n_bus = tile.bus.shape[0]
+    vn_max = tile.bus["vn_kv"].max()
+    buses_hv = np.where(tile.bus["vn_kv"].values == vn_max)[0]
+    lines_hv = np.where(tile.bus["vn_kv"].values[tile.line["from_bus"].values] == vn_max)[0]
+    if lines_hv.shape[0] == 0:
+        raise RuntimeError("make_synthetic_grid: there are no lines at the highest voltage level of the grid.")
+
+    nb_pairs = nb_copies if nb_copies > 2 else nb_copies - 1
+    res = []
+    for copy_id in range(nb_pairs):
+        next_id = (copy_id + 1) % nb_copies
+        from_bus = rng.choice(buses_hv, size=nb_tie_lines) + copy_id * n_bus
+        to_bus = rng.choice(buses_hv, size=nb_tie_lines) + next_id * n_bus
+        model_lines = tile.line.iloc[rng.choice(lines_hv, size=nb_tie_lines)].copy()
+        model_lines["from_bus"] = from_bus
+        model_lines["to_bus"] = to_bus
+        model_lines["name"] = [f"tie_{copy_id}_{next_id}_{el}" for el in range(nb_tie_lines)]
+        model_lines["in_service"] = True
+        res.append(model_lines)
+    return res
+
+
+def make_synthetic_grid(nb_bus, base_case="case118", nb_tie_lines=3, seed=0):
+    """
+    Build a (large) synthetic grid, by tiling copies of the grid `base_case` (from pandapower.networks) until
+    the grid counts at least `nb_bus` buses.
+
+    All the parameters (in per unit) of the elements are the ones of the base case. Copies are connected on a
+    "ring" with `nb_tie_lines` tie lines between two consecutive copies. Only the first copy keeps its ext_grid, the
+    ext_grid of the other copies being replaced by a generator producing what the ext_grid produced in a
+    powerflow of the base case.
+
+    Parameters
+    ----------
+    nb_bus: ``int``
+        Minimum number of buses of the generated grid
+
+    base_case: ``str``
+        Name of the grid (in pandapower.networks) that will be copied. It should be supported by :func:`init`.
+
+    nb_tie_lines: ``int``
+        Number of lines connecting two consecutive copies
+
+    seed: ``int``
+        Seed used to choose the buses connected by the tie lines
+
+    Returns
+    -------
+    net: :class:`pandapower.grid`
+        The synthetic grid (no powerflow has been run on it)
+
+    """
+    net_ref = getattr(pn, base_case)()
+    if net_ref.ext_grid.shape[0] != 1:
+        raise RuntimeError("make_synthetic_grid: the base case should have exactly one ext_grid.")
+    rng = np.random.RandomState(seed)
+
+    tile = _make_tile(net_ref)
+    n_bus_tile = tile.bus.shape[0]
+    nb_copies = max(int(np.ceil(nb_bus / n_bus_tile)), 1)
+
+    tables = {table: [] for table in _BUS_COLUMNS}
+    for copy_id in range(nb_copies):
+        offset = copy_id * n_bus_tile
+        for table, cols in _BUS_COLUMNS.items():
+            df = tile[table].copy()
+            for col in cols:
+                df[col] += offset
+            if table == "bus":
+                df.index += offset
+                df["name"] = [f"{copy_id}_{el}" for el in df.index]
+            tables[table].append(df)
+
+    if nb_copies > 1:
+        tables["line"] += _tie_lines(tile, nb_copies, nb_tie_lines, rng)
+
+    net = pp.create_empty_network(sn_mva=net_ref.sn_mva, f_hz=net_ref.f_hz)
+    for table, dfs in tables.items():
+        net[table] = pd.concat(dfs, ignore_index=table != "bus")
+
+    # the ext_grid (and the generator at the same bus, if any) of the first copy
+    net["ext_grid"] = net_ref.ext_grid.copy()
+    bus_map = pd.Series(np.arange(net_ref.bus.shape[0]), index=net_ref.bus.index)
+    net.ext_grid["bus"] = bus_map.loc[net.ext_grid["bus"].values].values
+    slack_bus = net.ext_grid["bus"].values[0]
+    net.gen.drop(net.gen.index[(net.gen["bus"].values == slack_bus) &
+                               (net.gen["max_q_mvar"].values == 99999.)], inplace=True)
+    net.gen.reset_index(drop=True, inplace=True)
+    return net
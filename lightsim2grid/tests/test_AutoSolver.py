@@ -0,0 +1,64 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid import SolverType
+
+
+class TestAutoSolver(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case118()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.tol_test = 1e-6
+        self.V0 = np.ones(self.net.bus.shape[0], dtype=np.complex_)
+        self.V_ref = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.V_ref.shape[0] > 0, "powerflow diverged !"
+
+    def test_auto(self):
+        assert SolverType.Auto in self.model.available_solvers()
+        self.model.change_solver(SolverType.Auto)
+        assert self.model.get_solver_type() == SolverType.Auto
+        for _ in range(10):
+            V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+            assert V.shape[0] > 0, "powerflow diverged !"
+            assert np.max(np.abs(V - self.V_ref)) <= self.tol_test
+            assert self.model.get_solver_type_used() != SolverType.Auto
+        log = self.model.get_auto_solver_log()
+        assert len(log) >= 1
+        assert log[0][0] == 1
+        assert log[0][2] == "exploration"
+        # gauss seidel is not used on this grid
+        assert np.all([el[1] != SolverType.GaussSeidel for el in log])
+
+    def test_warm_start(self):
+        """candidates explored on powerflows without any iteration are still compared"""
+        self.model.change_solver(SolverType.Auto)
+        for V_init in [self.V_ref] * 4 + [self.V0] * 6:
+            V = self.model.ac_pf(V_init, self.max_it, self.tol)
+            assert V.shape[0] > 0, "powerflow diverged !"
+            assert np.max(np.abs(V - self.V_ref)) <= self.tol_test
+        for _, _, reason in self.model.get_auto_solver_log():
+            if reason.startswith("faster"):
+                assert "iterations" in reason
+
+    def test_auto_dc(self):
+        self.model.change_solver(SolverType.Auto)
+        self.model.dc_pf(self.V0, self.max_it, self.tol)
+        assert self.model.get_solver_type() == SolverType.Auto
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert np.max(np.abs(V - self.V_ref)) <= self.tol_test
+
+    def test_change_back(self):
+        self.model.change_solver(SolverType.Auto)
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        self.model.change_solver(SolverType.SparseLU)
+        assert self.model.get_solver_type() == SolverType.SparseLU
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.model.get_solver_type_used() == SolverType.SparseLU
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,56 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid import SolverType
+
+
+class TestBackwardForwardSweep(unittest.TestCase):
+    def setUp(self):
+        self.max_it = 30
+        self.tol = 1e-8
+        self.tol_test = 1e-6
+
+    def _aux_compare(self, net):
+        model = init(net)
+        V0 = np.ones(net.bus.shape[0], dtype=np.complex_)
+        model.change_solver(SolverType.SparseLU)
+        V_ref = model.ac_pf(V0, self.max_it, self.tol)
+        assert V_ref.shape[0] > 0, "powerflow diverged !"
+
+        model.change_solver(SolverType.BackwardForwardSweep)
+        V = model.ac_pf(V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged with the BackwardForwardSweep solver"
+        assert np.max(np.abs(V - V_ref)) <= self.tol_test
+        return model
+
+    def test_radial(self):
+        # the tie lines of this grid are disconnected: it is radial
+        model = self._aux_compare(pn.case33bw())
+        # the sweeps have been used: there is no jacobian matrix
+        with self.assertRaises(RuntimeError):
+            model.get_J()
+
+    def test_meshed(self):
+        # newton raphson is used instead
+        model = self._aux_compare(pn.case118())
+        J = model.get_J()
+        assert J.shape[0] > 0
+
+    def test_radial_then_meshed(self):
+        net = pn.case33bw()
+        model = self._aux_compare(net)
+        # reconnect a tie line: the grid is now meshed
+        tie_id = np.where(~net.line["in_service"].values)[0][0]
+        model.reactivate_powerline(tie_id)
+        V0 = np.ones(net.bus.shape[0], dtype=np.complex_)
+        V = model.ac_pf(V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged with the BackwardForwardSweep solver"
+        model.change_solver(SolverType.SparseLU)
+        V_ref = model.ac_pf(V0, self.max_it, self.tol)
+        assert np.max(np.abs(V - V_ref)) <= self.tol_test
+
+
+if __name__ == "__main__":
+    unittest.main()
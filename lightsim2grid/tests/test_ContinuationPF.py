@@ -0,0 +1,116 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid import SolverType
+
+
+class TestContinuationPF(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case14()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.nb_bus = self.net.bus.shape[0]
+        self.V0 = np.ones(self.nb_bus, dtype=np.complex_)
+        self.load_p = self.net.load["p_mw"].values
+        self.load_q = self.net.load["q_mvar"].values
+        self.V_base = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.V_base.shape[0] > 0, "powerflow diverged !"
+
+    def _scale_loads(self, model, lambda_):
+        for load_id in range(self.load_p.shape[0]):
+            model.change_p_load(load_id, (1. + lambda_) * self.load_p[load_id])
+            model.change_q_load(load_id, (1. + lambda_) * self.load_q[load_id])
+
+    def test_pv_curve(self):
+        lambdas, V, nose, nb_iter = self.model.continuation_pf()
+        assert lambdas.shape[0] == V.shape[0]
+        assert lambdas[0] == 0.
+        assert np.max(np.abs(V[0] - self.V_base)) <= 1e-10
+        assert 0 < nose < lambdas.shape[0] - 1
+        assert np.all(np.diff(lambdas[:nose + 1]) > 0.)
+        assert np.all(np.diff(lambdas[nose:]) < 0.)
+        # every point is a solution of the powerflow
+        for point_id in [1, nose, lambdas.shape[0] - 1]:
+            model = self.model.copy()
+            self._scale_loads(model, lambdas[point_id])
+            V_pf = model.ac_pf(V[point_id], self.max_it, self.tol)
+            assert V_pf.shape[0] > 0, "powerflow diverged !"
+            assert np.max(np.abs(V_pf - V[point_id])) <= 1e-6
+
+    def test_max_loadability(self):
+        lambdas, V, nose, nb_iter = self.model.continuation_pf(stop_at_nose=True, min_step=1e-4)
+        assert nose >= lambdas.shape[0] - 2
+        lambda_max = lambdas[nose]
+        # there is a solution just below the maximum load factor, and none above
+        model = self.model.copy()
+        self._scale_loads(model, 0.99 * lambda_max)
+        assert model.ac_pf(V[nose], self.max_it, self.tol).shape[0] > 0
+        model = self.model.copy()
+        self._scale_loads(model, 1.01 * lambda_max)
+        assert model.ac_pf(V[nose], 30, self.tol).shape[0] == 0
+        # the results of the grid are not modified
+        lor_p, *_ = self.model.get_lineor_res()
+        model = self.model.copy()
+        model.ac_pf(self.V0, self.max_it, self.tol)
+        lor_p_ref, *_ = model.get_lineor_res()
+        assert np.max(np.abs(lor_p - lor_p_ref)) <= 1e-8
+
+    def test_direction(self):
+        # only the last load increases (10 times its consumption for lambda = 1)
+        load_id = self.load_p.shape[0] - 1
+        load_p_dir = np.zeros(self.load_p.shape[0])
+        load_q_dir = np.zeros(self.load_q.shape[0])
+        load_p_dir[load_id] = 10. * self.load_p[load_id]
+        load_q_dir[load_id] = 10. * self.load_q[load_id]
+        lambdas, V, nose, nb_iter = self.model.continuation_pf(load_p_dir, load_q_dir, stop_at_nose=True)
+        model = self.model.copy()
+        model.change_p_load(load_id, self.load_p[load_id] + 0.99 * lambdas[nose] * load_p_dir[load_id])
+        model.change_q_load(load_id, self.load_q[load_id] + 0.99 * lambdas[nose] * load_q_dir[load_id])
+        assert model.ac_pf(V[nose], self.max_it, self.tol).shape[0] > 0
+        # this load alone can increase more than when all the loads increase
+        lambdas_all, *_ = self.model.continuation_pf(stop_at_nose=True)
+        assert lambdas[nose] * 10. > np.max(lambdas_all)
+
+    def test_results_kept(self):
+        """the jacobian matrix of the last powerflow is still available after the continuation powerflow"""
+        delta_S = np.zeros((1, self.nb_bus), dtype=np.complex_)
+        delta_S[0, 4] = -0.1
+        pred_ref = self.model.predict(delta_S)[0]
+        J_ref = self.model.get_J()  # (predict computes it at the converged state)
+        self.model.continuation_pf(stop_at_nose=True)
+        J = self.model.get_J()
+        assert J.shape == J_ref.shape
+        assert np.max(np.abs((J - J_ref).data)) == 0.
+        assert np.max(np.abs(self.model.predict(delta_S)[0] - pred_ref)) <= 1e-10
+
+    def test_solvers(self):
+        lambdas_ref, V_ref, nose_ref, _ = self.model.continuation_pf(stop_at_nose=True)
+        solvers = []
+        if SolverType.KLU in self.model.available_solvers():
+            solvers.append(SolverType.KLU)
+        for solver_type in solvers:
+            self.model.change_solver(solver_type)
+            self.model.ac_pf(self.V0, self.max_it, self.tol)
+            lambdas, V, nose, _ = self.model.continuation_pf(stop_at_nose=True)
+            assert abs(lambdas[nose] - lambdas_ref[nose_ref]) <= 1e-6, f"error for {solver_type}"
+        self.model.change_solver(SolverType.GaussSeidel)
+        self.model.ac_pf(self.V0, 1000, self.tol)
+        with self.assertRaises(RuntimeError):
+            self.model.continuation_pf()
+
+    def test_errors(self):
+        with self.assertRaises(RuntimeError):
+            self.model.continuation_pf(load_p_dir=np.ones(self.load_p.shape[0] + 1))
+        with self.assertRaises(RuntimeError):
+            self.model.continuation_pf(step=1e-4, min_step=1e-3)
+        model = self.model.copy()
+        with self.assertRaises(RuntimeError):
+            # no powerflow
+            model.continuation_pf()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,60 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+
+
+class TestDCInit(unittest.TestCase):
+    """the features that re use Ybus of the last powerflow also work after "ac_pf_dc_init" (LightSimBackend default)"""
+    def setUp(self):
+        self.net = pn.case14()
+        self.net.trafo["tap_step_percent"] = 1.25
+        self.net.trafo["tap_side"] = "hv"
+        self.net.trafo["tap_pos"] = 0.
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.V0 = np.ones(self.net.bus.shape[0], dtype=np.complex_)
+        self.load_p = self.net.load["p_mw"].values
+        self.V = self.model.ac_pf_dc_init(self.V0, self.max_it, self.tol)
+        assert self.V.shape[0] > 0, "powerflow diverged !"
+
+    def test_change_tap(self):
+        Ybus_ac = self.model.get_Ybus()
+        self.model.change_tap_trafo(0, 3)
+        Ybus_patched = self.model.get_Ybus()
+        model_ref = self.model.copy()
+        V_ref = model_ref.ac_pf(self.V0, self.max_it, self.tol)
+        assert V_ref.shape[0] > 0, "powerflow diverged !"
+        # the ac admittance matrix has been patched (with the ac formula)
+        assert np.max(np.abs((Ybus_patched - model_ref.get_Ybus()).data)) <= 1e-10
+        assert np.max(np.abs((Ybus_patched - Ybus_ac).data)) > 1e-6
+        V = self.model.ac_pf_injections(self.V, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert np.max(np.abs(V - V_ref)) <= 1e-8
+
+    def test_continuation_pf(self):
+        lambdas, V, nose, nb_iter = self.model.continuation_pf(stop_at_nose=True)
+        assert lambdas.shape[0] == V.shape[0]
+        assert np.max(np.abs(V[0] - self.V)) <= 1e-10
+        model_ref = self.model.copy()
+        model_ref.ac_pf(self.V0, self.max_it, self.tol)
+        lambdas_ref, _, nose_ref, _ = model_ref.continuation_pf(stop_at_nose=True)
+        assert abs(lambdas[nose] - lambdas_ref[nose_ref]) <= 1e-6
+
+    def test_time_series(self):
+        model_ref = self.model.copy()
+        V = self.V
+        for factor in [0.9, 1.1, 1.2]:
+            for load_id, val in enumerate(self.load_p):
+                self.model.change_p_load(load_id, factor * val)
+                model_ref.change_p_load(load_id, factor * val)
+            V = self.model.ac_pf_injections(V, self.max_it, self.tol)
+            assert V.shape[0] > 0, "powerflow diverged !"
+            V_ref = model_ref.ac_pf(self.V0, self.max_it, self.tol)
+            assert np.max(np.abs(V - V_ref)) <= 1e-8
+
+
+if __name__ == "__main__":
+    unittest.main()
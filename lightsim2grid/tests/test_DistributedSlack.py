@@ -0,0 +1,98 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid import SolverType
+
+
+class TestDistributedSlack(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case14()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.nb_bus = self.net.bus.shape[0]
+        self.V0 = np.ones(self.nb_bus, dtype=np.complex_)
+        # a slack generator is added by "init" (last one), its setpoint balances the loads
+        self.nb_gen = self.net.gen.shape[0] + 1
+        self.slack_id = self.nb_gen - 1
+        self.gen_p = np.concatenate((self.net.gen["p_mw"].values,
+                                     [np.sum(self.net.load["p_mw"]) - np.sum(self.net.gen["p_mw"])]))
+
+    def test_only_slack_gen(self):
+        """same as the single slack"""
+        V_ref = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V_ref.shape[0] > 0, "powerflow diverged !"
+        weights = np.zeros(self.nb_gen)
+        weights[self.slack_id] = 2.
+        self.model.set_gen_slack_weights(weights)
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert np.max(np.abs(V - V_ref)) <= 1e-7
+        # the losses are taken by the slack generator, through the distributed slack this time
+        gen_p, *_ = self.model.get_gen_res()
+        assert abs(gen_p[self.slack_id] - self.gen_p[self.slack_id] - self.model.get_distributed_slack_p()) <= 1e-6
+
+    def test_participation(self):
+        weights = np.arange(1., self.nb_gen + 1.)
+        self.model.set_gen_slack_weights(weights)
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        p_slack = self.model.get_distributed_slack_p()
+        assert p_slack > 0.  # the losses
+        gen_p, *_ = self.model.get_gen_res()
+        # each generator (the slack one included) takes its share of the slack
+        share = weights / np.sum(weights) * p_slack
+        assert np.max(np.abs(gen_p - self.gen_p - share)) <= 1e-6
+        # the losses are compensated
+        load_p, *_ = self.model.get_loads_res()
+        lor_p, *_ = self.model.get_lineor_res()
+        lex_p, *_ = self.model.get_lineex_res()
+        thv_p, *_ = self.model.get_trafohv_res()
+        tlv_p, *_ = self.model.get_trafolv_res()
+        shunt_p, *_ = self.model.get_shunts_res()
+        losses = np.sum(lor_p) + np.sum(lex_p) + np.sum(thv_p) + np.sum(tlv_p)
+        assert abs(np.sum(gen_p) - np.sum(load_p) - np.sum(shunt_p) - losses) <= 1e-6
+
+    def test_slack_gen_not_participating(self):
+        weights = np.ones(self.nb_gen)
+        weights[self.slack_id] = 0.
+        self.model.set_gen_slack_weights(weights)
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        gen_p, *_ = self.model.get_gen_res()
+        assert abs(gen_p[self.slack_id] - self.gen_p[self.slack_id]) <= 1e-6
+
+    def test_solvers(self):
+        weights = np.ones(self.nb_gen)
+        self.model.set_gen_slack_weights(weights)
+        V_ref = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        p_ref = self.model.get_distributed_slack_p()
+        solvers = []
+        if SolverType.KLU in self.model.available_solvers():
+            solvers.append(SolverType.KLU)
+        for solver_type in solvers:
+            self.model.change_solver(solver_type)
+            V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+            assert V.shape[0] > 0, f"powerflow diverged for {solver_type}"
+            assert np.max(np.abs(V - V_ref)) <= 1e-7
+            assert abs(self.model.get_distributed_slack_p() - p_ref) <= 1e-6
+        self.model.change_solver(SolverType.GaussSeidel)
+        with self.assertRaises(RuntimeError):
+            self.model.ac_pf(self.V0, self.max_it, self.tol)
+
+    def test_wrong_weights(self):
+        with self.assertRaises(RuntimeError):
+            self.model.set_gen_slack_weights(np.ones(self.nb_gen + 1))
+        with self.assertRaises(RuntimeError):
+            self.model.set_gen_slack_weights(-np.ones(self.nb_gen))
+        # back to a single slack
+        self.model.set_gen_slack_weights(np.ones(self.nb_gen))
+        self.model.set_gen_slack_weights(np.zeros(0))
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.model.get_distributed_slack_p() == 0.
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,125 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+
+
+class TestGraphExport(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case14()
+        self.model = init(self.net)
+        self.nb_bus = self.net.bus.shape[0]
+        self.nb_line = self.net.line.shape[0]
+        self.nb_trafo = self.net.trafo.shape[0]
+        self.V0 = np.ones(self.nb_bus, dtype=np.complex_)
+        V = self.model.ac_pf(self.V0, 10, 1e-8)
+        assert V.shape[0] > 0, "powerflow diverged !"
+
+    def _check_csr(self):
+        edge_or = self.model.get_graph_edge_or()
+        edge_ex = self.model.get_graph_edge_ex()
+        indptr = self.model.get_graph_csr_indptr()
+        indices = self.model.get_graph_csr_indices()
+        edges = self.model.get_graph_csr_edges()
+        assert indptr.shape[0] == self.nb_bus + 1
+        assert indptr[-1] == 2 * np.sum(edge_or >= 0)
+        assert indptr[-1] == self.model.get_graph_csr_nnz()
+        assert indices.shape[0] == indptr[-1]
+        assert edges.shape[0] == indptr[-1]
+        for bus_id in range(self.nb_bus):
+            for pos in range(indptr[bus_id], indptr[bus_id + 1]):
+                edge_id = edges[pos]
+                neighbour = indices[pos]
+                assert {bus_id, neighbour} == {edge_or[edge_id], edge_ex[edge_id]}
+
+    def test_topology(self):
+        assert self.model.update_graph()
+        edge_or = self.model.get_graph_edge_or()
+        edge_ex = self.model.get_graph_edge_ex()
+        assert edge_or.shape[0] == self.nb_line + self.nb_trafo
+        for line_id in range(self.nb_line):
+            assert edge_or[line_id] == self.model.get_bus_powerline_or(line_id)
+            assert edge_ex[line_id] == self.model.get_bus_powerline_ex(line_id)
+        for trafo_id in range(self.nb_trafo):
+            assert edge_or[self.nb_line + trafo_id] == self.model.get_bus_trafo_hv(trafo_id)
+            assert edge_ex[self.nb_line + trafo_id] == self.model.get_bus_trafo_lv(trafo_id)
+        self._check_csr()
+
+        # nothing changed
+        assert not self.model.update_graph()
+
+        # disconnect a powerline: the views are updated
+        self.model.deactivate_powerline(3)
+        assert self.model.update_graph()
+        assert edge_or[3] == -1
+        assert edge_ex[3] == -1
+        self._check_csr()
+        assert not np.any(self.model.get_graph_csr_edges() == 3)
+
+    def test_view_kept(self):
+        """the views of the adjacency stay valid (same buffer) when the topology changes"""
+        self.model.update_graph()
+        indices = self.model.get_graph_csr_indices()
+        edges = self.model.get_graph_csr_edges()
+        nnz = self.model.get_graph_csr_nnz()
+        assert indices.shape[0] == nnz
+
+        self.model.deactivate_powerline(3)
+        assert self.model.update_graph()
+        new_nnz = self.model.get_graph_csr_nnz()
+        assert new_nnz == nnz - 2
+        new_indices = self.model.get_graph_csr_indices()
+        new_edges = self.model.get_graph_csr_edges()
+        assert new_indices.shape[0] == new_nnz
+        assert np.shares_memory(indices, new_indices)
+        assert np.shares_memory(edges, new_edges)
+        # the old view (longer) sees the new adjacency in its first entries
+        assert np.all(indices[:new_nnz] == new_indices)
+        assert np.all(edges[:new_nnz] == new_edges)
+        assert not np.any(edges[:new_nnz] == 3)
+
+        # and when the powerline is reconnected
+        self.model.reactivate_powerline(3)
+        assert self.model.update_graph()
+        assert self.model.get_graph_csr_nnz() == nnz
+        assert np.all(indices == self.model.get_graph_csr_indices())
+        self._check_csr()
+
+    def test_features(self):
+        self.model.update_graph()
+        features = self.model.get_graph_edge_features()
+        assert features.shape == (self.nb_line + self.nb_trafo, 9)
+        assert not features.flags.writeable
+        p_or, q_or, _, a_or = self.model.get_lineor_res()
+        p_ex, *_ = self.model.get_lineex_res()
+        assert np.max(np.abs(features[:self.nb_line, 0] - p_or)) <= 1e-8
+        assert np.max(np.abs(features[:self.nb_line, 1] - q_or)) <= 1e-8
+        assert np.max(np.abs(features[:self.nb_line, 2] - a_or)) <= 1e-8
+        assert np.max(np.abs(features[:self.nb_line, 3] - p_ex)) <= 1e-8
+        p_hv, *_ = self.model.get_trafohv_res()
+        assert np.max(np.abs(features[self.nb_line:, 0] - p_hv)) <= 1e-8
+        assert np.all(features[:self.nb_line, 8] == 1.)
+        # series admittance: the series conductance is positive and the susceptance negative
+        assert np.all(features[:, 6] >= 0.)
+        assert np.all(features[:, 7] < 0.)
+
+        # the flows are refreshed by update_graph (same array)
+        self.model.deactivate_powerline(3)
+        V = self.model.ac_pf(self.V0, 10, 1e-8)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        self.model.update_graph()
+        assert np.all(features[3, :6] == 0.)
+        p_or, *_ = self.model.get_lineor_res()
+        assert np.max(np.abs(features[:self.nb_line, 0] - p_or)) <= 1e-8
+
+    def test_copy(self):
+        self.model.update_graph()
+        model2 = self.model.copy()
+        assert model2.get_graph_edge_or().shape[0] == 0
+        model2.update_graph()
+        assert np.all(model2.get_graph_edge_or() == self.model.get_graph_edge_or())
+
+
+if __name__ == "__main__":
+    unittest.main()
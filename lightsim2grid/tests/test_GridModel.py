@@ -388,5 +388,16 @@ class MakeACTests(BaseTests, unittest.TestCase):
         #    self.skipTest("dev")
 
 
+class MakeACDCInitTests(BaseTests, unittest.TestCase):
+    def run_me_pf(self, V0):
+        return self.model.ac_pf_dc_init(V0, self.max_it, self.tol)
+
+    def run_ref_pf(self, net):
+        pp.runpp(net, init="dc")
+
+    def do_i_skip(self, test_nm):
+        pass
+
+
 if __name__ == "__main__":
     unittest.main()
\ No newline at end of file
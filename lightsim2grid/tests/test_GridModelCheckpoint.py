@@ -0,0 +1,125 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+
+
+class TestGridModelCheckpoint(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case14()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.V0 = np.ones(self.net.bus.shape[0], dtype=np.complex_)
+        self.V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.V.shape[0] > 0, "powerflow diverged !"
+        self.a_or = self.model.get_lineor_res()[3]
+        self.state = self.model.get_state()
+
+    def _check_initial_state(self):
+        assert np.all(self.model.get_lineor_res()[3] == self.a_or)
+        assert self.model.get_state() == self.state
+        assert np.all(self.model.get_lines_status())
+
+    def test_rollback(self):
+        self.model.begin()
+        self.model.deactivate_powerline(3)
+        self.model.change_p_load(2, 1.5 * self.net.load["p_mw"].values[2])
+        V = self.model.ac_pf(self.V, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert np.max(np.abs(self.model.get_lineor_res()[3] - self.a_or)) > 1e-3
+        self.model.rollback()
+        assert self.model.get_nb_checkpoints() == 0
+        self._check_initial_state()
+        # same results as before the "what if"
+        V = self.model.ac_pf(self.V, self.max_it, self.tol)
+        assert np.max(np.abs(V - self.V)) <= 1e-8
+
+    def test_solver_results(self):
+        # the solver gives the results of the powerflow made before the checkpoint
+        Va = self.model.get_Va()
+        J = self.model.get_J()
+        self.model.begin()
+        self.model.deactivate_powerline(3)
+        self.model.ac_pf(self.V, self.max_it, self.tol)
+        self.model.rollback()
+        assert np.all(self.model.get_Va() == Va)
+        assert (self.model.get_J() != J).nnz == 0
+
+    def test_dc_pf(self):
+        # the ac admittance matrix (and the fact that it is the ac one) is given back by the rollback
+        Ybus = self.model.get_Ybus()
+        self.model.begin()
+        V = self.model.dc_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        self.model.rollback()
+        assert np.max(np.abs((self.model.get_Ybus() - Ybus).data)) == 0.
+        self._check_initial_state()
+        # Ybus is re used as the ac one
+        V = self.model.ac_pf_injections(self.V, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert np.max(np.abs(V - self.V)) <= 1e-8
+
+        # and the other way around: a dc Ybus is not used as an ac one after the rollback
+        self.model.dc_pf(self.V0, self.max_it, self.tol)
+        self.model.begin()
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        self.model.rollback()
+        V = self.model.ac_pf_injections(self.V, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert np.max(np.abs(V - self.V)) <= 1e-8
+
+    def test_slack(self):
+        nb_gen = len(self.model.get_gen_status())
+        self.model.begin()
+        self.model.set_gen_slack_weights(np.ones(nb_gen))
+        self.model.add_gen_slackbus(1)
+        self.model.ac_pf(self.V, self.max_it, self.tol)
+        self.model.rollback()
+        assert self.model.get_gen_slack_weights().shape[0] == 0
+        self._check_initial_state()
+        V = self.model.ac_pf(self.V, self.max_it, self.tol)
+        assert np.max(np.abs(V - self.V)) <= 1e-8
+
+    def test_nested(self):
+        self.model.begin()
+        self.model.change_p_gen(1, 10.)
+        self.model.begin()
+        self.model.deactivate_powerline(0)
+        self.model.ac_pf(self.V, self.max_it, self.tol)
+        assert self.model.get_nb_checkpoints() == 2
+        self.model.commit()  # keep the modifications of the inner checkpoint
+        assert not self.model.get_lines_status()[0]
+        self.model.begin()
+        self.model.reactivate_powerline(0)
+        self.model.rollback()
+        assert not self.model.get_lines_status()[0]
+        self.model.rollback()
+        self._check_initial_state()
+
+    def test_commit(self):
+        self.model.begin()
+        self.model.deactivate_powerline(3)
+        self.model.commit()
+        assert self.model.get_nb_checkpoints() == 0
+        assert not self.model.get_lines_status()[3]
+
+    def test_errors(self):
+        with self.assertRaises(RuntimeError):
+            self.model.rollback()
+        with self.assertRaises(RuntimeError):
+            self.model.commit()
+        self.model.begin()
+        with self.assertRaises(RuntimeError):
+            self.model.set_state(self.state)
+        with self.assertRaises(RuntimeError):
+            self.model.init_loads(self.net.load["p_mw"].values, self.net.load["q_mvar"].values,
+                                  self.net.load["bus"].values)
+        self.model.rollback()
+        self.model.set_state(self.state)
+
+
+if __name__ == "__main__":
+    unittest.main()
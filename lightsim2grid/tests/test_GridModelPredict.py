@@ -0,0 +1,75 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+
+
+class TestPredict(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case118()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.tol_test = 1e-2  # this is a first order approximation
+        self.V0 = np.full(self.net.bus.shape[0], fill_value=1.0, dtype=np.complex_)
+        self.Vref = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.Vref.shape[0] > 0, "powerflow diverged !"
+
+    def _delta_load(self, load_id, delta_p):
+        delta_S = np.zeros((1, self.net.bus.shape[0]), dtype=np.complex_)
+        # more load means less injection
+        delta_S[0, self.net.load["bus"].values[load_id]] = -delta_p
+        return delta_S
+
+    def test_predict_load_change(self):
+        load_id = 0
+        delta_p = 1.0
+        p_or, a_or, p_hv, a_hv = self.model.predict(self._delta_load(load_id, delta_p))
+        assert p_or.shape == (1, self.net.line.shape[0])
+        assert p_hv.shape == (1, self.net.trafo.shape[0])
+
+        # now compute the "real" powerflow
+        self.model.change_p_load(load_id, self.net.load["p_mw"].values[load_id] + delta_p)
+        V = self.model.ac_pf(self.Vref, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        por, qor, vor, aor = self.model.get_lineor_res()
+        phv, qhv, vhv, ahv = self.model.get_trafohv_res()
+        assert np.max(np.abs(p_or[0] - por)) <= self.tol_test, "error for p_or"
+        assert np.max(np.abs(a_or[0] - aor)) <= self.tol_test, "error for a_or"
+        assert np.max(np.abs(p_hv[0] - phv)) <= self.tol_test, "error for p_hv"
+        assert np.max(np.abs(a_hv[0] - ahv)) <= self.tol_test, "error for a_hv"
+
+    def test_predict_batch(self):
+        delta_S = np.concatenate((self._delta_load(0, 1.0), self._delta_load(5, 2.0)), axis=0)
+        p_or, a_or, p_hv, a_hv = self.model.predict(delta_S)
+        assert p_or.shape[0] == 2
+        p_or_1, a_or_1, p_hv_1, a_hv_1 = self.model.predict(delta_S[[1], :])
+        assert np.max(np.abs(p_or[1] - p_or_1[0])) <= 1e-8
+        assert np.max(np.abs(a_hv[1] - a_hv_1[0])) <= 1e-8
+
+    def test_predict_converged_state(self):
+        # the jacobian is the one of the converged state, whatever the iterates of the powerflow
+        delta_S = self._delta_load(0, 1.0)
+        p_or, a_or, p_hv, a_hv = self.model.predict(delta_S)
+        model = self.model.copy()
+        V = model.ac_pf(self.Vref, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        p_or_2, a_or_2, p_hv_2, a_hv_2 = model.predict(delta_S)
+        assert np.max(np.abs(p_or - p_or_2)) <= 1e-8
+        assert np.max(np.abs(a_hv - a_hv_2)) <= 1e-8
+
+    def test_predict_no_change(self):
+        delta_S = np.zeros((1, self.net.bus.shape[0]), dtype=np.complex_)
+        p_or, a_or, p_hv, a_hv = self.model.predict(delta_S)
+        por, qor, vor, aor = self.model.get_lineor_res()
+        assert np.max(np.abs(p_or[0] - por)) <= 1e-6
+
+    def test_predict_wrong_size(self):
+        delta_S = np.zeros((1, self.net.bus.shape[0] + 1), dtype=np.complex_)
+        with self.assertRaises(RuntimeError):
+            self.model.predict(delta_S)
+
+
+if __name__ == "__main__":
+    unittest.main()
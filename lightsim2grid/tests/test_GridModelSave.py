@@ -0,0 +1,46 @@
+import os
+import tempfile
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid_cpp import load_grid
+
+
+class TestGridModelSave(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case118()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.V0 = np.ones(self.net.bus.shape[0], dtype=np.complex_)
+
+    def test_save_load(self):
+        self.model.deactivate_powerline(3)
+        V_ref = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V_ref.shape[0] > 0, "powerflow diverged !"
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = os.path.join(tmpdir, "grid.txt")
+            self.model.save(path)
+            model = load_grid(path)
+        V = model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        # no loss of precision in the file
+        assert np.max(np.abs(V - V_ref)) <= 1e-12
+        assert not model.get_lines_status()[3]
+        assert np.max(np.abs(model.get_lineor_res()[0] - self.model.get_lineor_res()[0])) <= 1e-10
+
+    def test_errors(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = os.path.join(tmpdir, "grid.txt")
+            with self.assertRaises(RuntimeError):
+                load_grid(path)  # does not exist
+            with open(path, "w") as f:
+                f.write("not a grid")
+            with self.assertRaises(RuntimeError):
+                load_grid(path)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,69 @@
+import copy
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid import SolverType, KLUOrdering, KLUParameters
+
+
+class TestKLUParameters(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case118()
+        self.model = init(self.net)
+        if SolverType.KLU not in self.model.available_solvers():
+            self.skipTest("KLU is not available")
+        self.model.change_solver(SolverType.KLU)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.nb_bus = self.net.bus.shape[0]
+        self.V0 = np.ones(self.nb_bus, dtype=np.complex_)
+
+    def test_default(self):
+        assert self.model.get_klu_parameters() == KLUParameters()
+
+    def test_invalid(self):
+        with self.assertRaises(RuntimeError):
+            KLUParameters(KLUOrdering.AMD, True, 3, 0.001)
+        with self.assertRaises(RuntimeError):
+            KLUParameters(KLUOrdering.AMD, True, 2, 0.)
+
+    def test_tune_without_jacobian(self):
+        with self.assertRaises(RuntimeError):
+            self.model.tune_klu()
+
+    def test_same_results(self):
+        V_ref = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V_ref.shape[0] > 0, "powerflow diverged !"
+        for ordering in [KLUOrdering.AMD, KLUOrdering.COLAMD, KLUOrdering.Natural]:
+            self.model.set_klu_parameters(KLUParameters(ordering, False, 1, 0.1))
+            V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+            assert V.shape[0] > 0, "powerflow diverged !"
+            assert np.max(np.abs(V - V_ref)) <= 1e-6
+
+    def test_tune(self):
+        V_ref = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        res = self.model.tune_klu(nb_repeat=1)
+        assert len(res) == 3 * 2 * 3 * 3
+        best = self.model.get_klu_parameters()
+        assert best in [el[0] for el in res]
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert np.max(np.abs(V - V_ref)) <= 1e-6
+
+    def test_tune_candidates(self):
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        candidates = [KLUParameters(KLUOrdering.COLAMD, False, 0, 0.01)]
+        res = self.model.tune_klu(candidates)
+        assert len(res) == 1
+        assert self.model.get_klu_parameters() == candidates[0]
+
+    def test_state(self):
+        params = KLUParameters(KLUOrdering.COLAMD, False, 1, 0.1)
+        self.model.set_klu_parameters(params)
+        assert self.model.copy().get_klu_parameters() == params
+        assert copy.deepcopy(self.model).get_klu_parameters() == params
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,109 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid import StepControl
+
+
+class TestMemoization(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case14()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.V0 = np.ones(self.net.bus.shape[0], dtype=np.complex_)
+        self.load_p = self.net.load["p_mw"].values
+
+    def test_disabled_by_default(self):
+        assert self.model.get_memo_size() == 0
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.model.get_memo_nb_hit() == 0
+        assert self.model.get_memo_nb_entries() == 0
+
+    def test_hit(self):
+        self.model.set_memo_size(10)
+        V_ref = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        a_or_ref = self.model.get_lineor_res()[3]
+
+        self.model.change_p_load(0, 1.1 * self.load_p[0])
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert np.max(np.abs(V - V_ref)) > 1e-6
+        self.model.change_p_load(0, self.load_p[0])
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.model.get_memo_nb_hit() == 1
+        assert self.model.get_memo_nb_miss() == 2
+        assert np.all(V == V_ref)
+        assert np.all(self.model.get_lineor_res()[3] == a_or_ref)
+
+        # other solver parameters: not the same powerflow
+        self.model.ac_pf(self.V0, self.max_it, 1e-6)
+        assert self.model.get_memo_nb_miss() == 3
+
+    def test_solver_results_after_hit(self):
+        self.model.set_memo_size(10)
+        V_ref = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        Va_ref = self.model.get_Va()
+        V_solver_ref = self.model.get_V()
+        J_ref = self.model.get_J()
+        delta_S = np.zeros((1, self.V0.shape[0]), dtype=np.complex_)
+        delta_S[0, 1] = -0.1
+        pred_ref = self.model.predict(delta_S)[0]
+
+        self.model.change_p_load(0, 1.1 * self.load_p[0])
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        self.model.change_p_load(0, self.load_p[0])
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.model.get_memo_nb_hit() == 1
+        assert np.all(self.model.get_Va() == Va_ref)
+        assert np.all(self.model.get_V() == V_solver_ref)
+        assert (self.model.get_J() != J_ref).nnz == 0
+        assert self.model.get_computation_time() == 0.
+        assert np.max(np.abs(self.model.predict(delta_S)[0] - pred_ref)) <= 1e-10
+
+    def test_dc_init(self):
+        self.model.set_memo_size(10)
+        V_ref = self.model.ac_pf_dc_init(self.V0, self.max_it, self.tol)
+        # not the same function: not the same entry
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.model.get_memo_nb_hit() == 0
+        V = self.model.ac_pf_dc_init(self.V0, self.max_it, self.tol)
+        assert self.model.get_memo_nb_hit() == 1
+        assert np.all(V == V_ref)
+
+    def test_solver_configuration(self):
+        self.model.set_memo_size(10)
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        self.model.set_step_control(StepControl.Iwamoto)
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.model.get_memo_nb_hit() == 0
+        self.model.set_step_control(StepControl.FullStep)
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.model.get_memo_nb_hit() == 1
+
+    def test_size(self):
+        self.model.set_memo_size(2)
+        for coeff in [1.0, 1.1, 1.2]:
+            self.model.change_p_load(0, coeff * self.load_p[0])
+            self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.model.get_memo_nb_entries() == 2
+        # the first one has been removed
+        self.model.change_p_load(0, self.load_p[0])
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.model.get_memo_nb_hit() == 0
+        self.model.set_memo_size(0)
+        assert self.model.get_memo_nb_entries() == 0
+        self.model.clear_memo()
+        assert self.model.get_memo_nb_miss() == 0
+
+    def test_diverged_not_stored(self):
+        self.model.set_memo_size(10)
+        self.model.change_p_load(0, 1e5)
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] == 0
+        assert self.model.get_memo_nb_entries() == 0
+
+
+if __name__ == "__main__":
+    unittest.main()
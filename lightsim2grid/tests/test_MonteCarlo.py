@@ -0,0 +1,118 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid_cpp import MonteCarlo
+
+
+class TestMonteCarlo(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case14()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.tol_test = 1e-6
+        self.nb_bus = self.net.bus.shape[0]
+        self.nb_line = self.net.line.shape[0]
+        self.nb_trafo = self.net.trafo.shape[0]
+        self.load_p = self.net.load["p_mw"].values
+        self.nb_scenario = 50
+        np.random.seed(0)
+        self.samples = self.load_p * (1. + 0.1 * np.random.randn(self.nb_scenario, self.load_p.shape[0]))
+
+    def _reference(self):
+        """the statistics computed from all the results stored (one powerflow after the other)"""
+        model = self.model.copy()
+        V0 = np.ones(self.nb_bus, dtype=np.complex_)
+        loading = []
+        vm = []
+        for row in self.samples:
+            for load_id, val in enumerate(row):
+                model.change_p_load(load_id, val)
+            V = model.ac_pf(V0, self.max_it, self.tol)
+            assert V.shape[0] > 0, "powerflow diverged !"
+            a_line = np.maximum(model.get_lineor_res()[3], model.get_lineex_res()[3])
+            a_trafo = model.get_trafohv_res()[3]  # hv side, as grid2op
+            loading.append(np.concatenate((a_line, a_trafo)))
+            vm.append(np.abs(V))
+        return np.array(loading), np.array(vm)
+
+    def test_moments(self):
+        mc = MonteCarlo(self.model)
+        mc.set_tol(self.tol)
+        nb_conv = mc.run_samples(self.samples, np.zeros((0, 0)), np.zeros((0, 0)))
+        assert nb_conv == self.nb_scenario
+        assert mc.get_nb_scenario() == self.nb_scenario
+        assert mc.get_nb_diverged() == 0
+        loading, vm = self._reference()
+        assert np.max(np.abs(mc.get_loading_mean() - loading.mean(axis=0))) <= self.tol_test
+        assert np.max(np.abs(mc.get_loading_var() - loading.var(axis=0, ddof=1))) <= self.tol_test
+        assert np.max(np.abs(mc.get_loading_max() - loading.max(axis=0))) <= self.tol_test
+        assert np.max(np.abs(mc.get_vm_mean() - vm.mean(axis=0))) <= self.tol_test
+        assert np.max(np.abs(mc.get_vm_var() - vm.var(axis=0, ddof=1))) <= self.tol_test
+
+    def test_overload_proba_and_quantiles(self):
+        mc = MonteCarlo(self.model)
+        mc.set_tol(self.tol)
+        loading, vm = self._reference()
+        # half of the scenarios overload each branch
+        th_lim = np.median(loading, axis=0)
+        th_lim[th_lim <= 0.] = 1.
+        mc.set_thermal_limits(th_lim)
+        mc.run_samples(self.samples, np.zeros((0, 0)), np.zeros((0, 0)))
+        proba_ref = (loading / th_lim > 1.).mean(axis=0)
+        assert np.max(np.abs(mc.get_overload_proba() - proba_ref)) <= 1e-12
+
+        quantiles = mc.get_vm_quantiles()
+        assert quantiles.shape == (self.nb_bus, len(mc.get_quantiles()))
+        # P2 sketches are approximate, but stay between the minimum and the maximum
+        assert np.all(quantiles >= vm.min(axis=0)[:, None] - self.tol_test)
+        assert np.all(quantiles <= vm.max(axis=0)[:, None] + self.tol_test)
+
+    def test_accumulate_and_reset(self):
+        mc = MonteCarlo(self.model)
+        mc.run_samples(self.samples[:20], np.zeros((0, 0)), np.zeros((0, 0)))
+        mc.run_samples(self.samples[20:], np.zeros((0, 0)), np.zeros((0, 0)))
+        assert mc.get_nb_scenario() == self.nb_scenario
+        mean_twice = mc.get_loading_mean()
+        mc.reset_stats()
+        assert mc.get_nb_scenario() == 0
+        mc.run_samples(self.samples, np.zeros((0, 0)), np.zeros((0, 0)))
+        assert np.max(np.abs(mc.get_loading_mean() - mean_twice)) <= 1e-12
+
+    def test_normal_seed(self):
+        std = 0.05 * self.load_p
+        empty = np.zeros(0)
+        mc1 = MonteCarlo(self.model)
+        mc1.set_nb_threads(1)
+        mc1.run_normal(100, std, empty, empty, 42)
+        mc2 = MonteCarlo(self.model)
+        mc2.run_normal(100, std, empty, empty, 42)
+        # same seed, same statistics (whatever the number of threads)
+        assert np.max(np.abs(mc1.get_loading_mean() - mc2.get_loading_mean())) <= 1e-12
+        assert np.max(np.abs(mc1.get_vm_quantiles() - mc2.get_vm_quantiles())) <= 1e-12
+        mc3 = MonteCarlo(self.model)
+        mc3.run_normal(100, std, empty, empty, 43)
+        assert np.max(np.abs(mc1.get_loading_mean() - mc3.get_loading_mean())) > 0.
+
+    def test_errors(self):
+        mc = MonteCarlo(self.model)
+        with self.assertRaises(RuntimeError):
+            # wrong number of columns
+            mc.run_samples(self.samples[:, :3], np.zeros((0, 0)), np.zeros((0, 0)))
+        with self.assertRaises(RuntimeError):
+            # not the same number of rows
+            mc.run_samples(self.samples, self.samples[:3], np.zeros((0, 0)))
+        with self.assertRaises(RuntimeError):
+            mc.set_thermal_limits(np.ones(self.nb_line))
+        mc.run_samples(self.samples[:5], np.zeros((0, 0)), np.zeros((0, 0)))
+        with self.assertRaises(RuntimeError):
+            # no thermal limits given
+            mc.get_overload_proba()
+        with self.assertRaises(RuntimeError):
+            mc.set_quantiles([0.5, 1.5])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,105 @@
+import os
+import multiprocessing
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid_cpp import PowerflowDaemon, PowerflowClient
+
+
+def _client_process(name, load_p, queue):
+    """solves the requests from another process, that does not have the grid"""
+    client = PowerflowClient(name)
+    res = []
+    for row in load_p:
+        conv = client.solve(load_p=row)
+        res.append((conv, client.get_lineor_res()[3]))
+    queue.put(res)
+
+
+@unittest.skipIf(os.name == "nt", "shared memory daemon is not available on windows")
+class TestPowerflowDaemon(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case14()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.V0 = np.ones(self.net.bus.shape[0], dtype=np.complex_)
+        self.name = "/lightsim2grid_test_{}".format(os.getpid())
+        self.daemon = PowerflowDaemon(self.model, self.name, 8, 2)
+        self.daemon.start()
+        np.random.seed(0)
+        self.load_p = self.net.load["p_mw"].values * (1. + 0.1 * np.random.randn(10, self.net.load.shape[0]))
+
+    def tearDown(self):
+        self.daemon.stop()
+        del self.daemon
+
+    def _reference(self, load_p=None, line_status=None):
+        model = self.model.copy()
+        if load_p is not None:
+            for load_id, val in enumerate(load_p):
+                model.change_p_load(load_id, val)
+        if line_status is not None:
+            for line_id, status in enumerate(line_status):
+                if not status:
+                    model.deactivate_powerline(line_id)
+        V = model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        return V, model.get_lineor_res()[3]
+
+    def test_same_process(self):
+        client = PowerflowClient(self.name)
+        assert client.nb_load() == self.net.load.shape[0]
+        # base case
+        assert client.solve()
+        V_ref, a_or_ref = self._reference()
+        assert np.max(np.abs(client.get_Vm() - np.abs(V_ref))) <= 1e-6
+        assert np.max(np.abs(client.get_lineor_res()[3] - a_or_ref)) <= 1e-6
+        # asynchronous requests, with a topology change
+        line_status = [True] * self.net.line.shape[0]
+        line_status[3] = False
+        slot_1 = client.submit(load_p=self.load_p[0], line_status=line_status)
+        slot_2 = client.submit(load_p=self.load_p[1])
+        assert client.retrieve(slot_2)
+        _, a_or_ref = self._reference(load_p=self.load_p[1])
+        assert np.max(np.abs(client.get_lineor_res()[3] - a_or_ref)) <= 1e-6
+        assert client.retrieve(slot_1)
+        _, a_or_ref = self._reference(load_p=self.load_p[0], line_status=line_status)
+        assert np.max(np.abs(client.get_lineor_res()[3] - a_or_ref)) <= 1e-6
+        assert self.daemon.get_nb_processed() == 3
+
+    def test_other_process(self):
+        queue = multiprocessing.Queue()
+        processes = [multiprocessing.Process(target=_client_process, args=(self.name, self.load_p, queue))
+                     for _ in range(3)]
+        for proc in processes:
+            proc.start()
+        results = [queue.get(timeout=60) for _ in processes]
+        for proc in processes:
+            proc.join()
+        for res in results:
+            for (conv, a_or), load_p in zip(res, self.load_p):
+                assert conv
+                _, a_or_ref = self._reference(load_p=load_p)
+                assert np.max(np.abs(a_or - a_or_ref)) <= 1e-6
+
+    def test_divergence_and_errors(self):
+        client = PowerflowClient(self.name)
+        assert not client.solve(load_p=1000. * self.net.load["p_mw"].values)
+        assert np.all(np.isnan(client.get_Vm()))
+        assert client.solve()  # the next requests are not impacted
+        with self.assertRaises(RuntimeError):
+            client.solve(load_p=np.ones(3))  # wrong size
+        with self.assertRaises(RuntimeError):
+            PowerflowDaemon(self.model, self.name, 8, 1)  # already exists
+        with self.assertRaises(RuntimeError):
+            PowerflowClient(self.name + "_does_not_exist")
+        self.daemon.stop()
+        with self.assertRaises(RuntimeError):
+            client.solve()  # daemon is stopped
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,49 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid import NRPrecision, SolverType
+
+
+class TestPrecision(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case300()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.nb_bus = self.net.bus.shape[0]
+        self.V0 = np.ones(self.nb_bus, dtype=np.complex_)
+
+    def test_default(self):
+        assert self.model.get_precision() == NRPrecision.Double
+
+    def _check_same_results(self, solver_type, tol, tol_test):
+        if solver_type not in self.model.available_solvers():
+            self.skipTest("solver not available")
+        self.model.change_solver(solver_type)
+        V_ref = self.model.ac_pf(self.V0, self.max_it, tol)
+        assert V_ref.shape[0] > 0, "powerflow diverged !"
+
+        self.model.set_precision(NRPrecision.Mixed)
+        V = self.model.ac_pf(self.V0, self.max_it, tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert np.max(np.abs(V - V_ref)) <= tol_test
+
+    def test_sparse_lu(self):
+        self._check_same_results(SolverType.SparseLU, 1e-8, 1e-6)
+
+    def test_klu(self):
+        self._check_same_results(SolverType.KLU, 1e-8, 1e-6)
+
+    def test_tight_tolerance(self):
+        # the refinement (in double precision) gives the accuracy that single precision alone does not
+        self._check_same_results(SolverType.SparseLU, 1e-11, 1e-9)
+
+    def test_copy(self):
+        self.model.set_precision(NRPrecision.Mixed)
+        model = self.model.copy()
+        assert model.get_precision() == NRPrecision.Mixed
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,85 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid_cpp import RecoveryStage, SolverType
+
+
+class TestRecoveryStages(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case118()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.tol_test = 1e-5
+        self.nb_bus = self.net.bus.shape[0]
+        # a (very) bad starting point
+        self.V_bad = np.full(self.nb_bus, fill_value=0.1, dtype=np.complex_)
+        self.V_bad[::2] *= -1.
+        # reference
+        self.V_ref = self.model.ac_pf(np.ones(self.nb_bus, dtype=np.complex_), self.max_it, self.tol)
+        assert self.V_ref.shape[0] > 0, "powerflow diverged !"
+
+    def test_default(self):
+        assert self.model.get_recovery_stages() == []
+        assert self.model.get_last_recovery_stage() == RecoveryStage.NoRecovery
+
+    def test_wrong_stage(self):
+        with self.assertRaises(RuntimeError):
+            self.model.set_recovery_stages([RecoveryStage.NoRecovery])
+
+    def _check_recovery(self, stages):
+        self.model.set_recovery_stages(stages)
+        V = self.model.ac_pf(self.V_bad, 3, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert self.model.get_last_recovery_stage() in stages
+        assert np.max(np.abs(V - self.V_ref)) <= self.tol_test
+
+    def test_dc_init(self):
+        self._check_recovery([RecoveryStage.DCInit])
+
+    def test_chain(self):
+        self._check_recovery([RecoveryStage.OtherSolver, RecoveryStage.FlatStart, RecoveryStage.DCInit])
+
+    def _check_results_after_recovery(self, V):
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert self.model.get_last_recovery_stage() == RecoveryStage.Iwamoto
+        assert np.max(np.abs(V - self.V_ref)) <= self.tol_test
+        # the results of the solver that converged can be retrieved
+        assert self.model.get_solver_type() == SolverType.GaussSeidel
+        assert self.model.get_solver_type_used() == SolverType.SparseLU
+        assert self.model.get_V().shape[0] == self.nb_bus
+        assert self.model.get_J().shape[0] > 0
+        assert self.model.get_computation_time() > 0.
+        # the next powerflow is computed with the solver chosen by the user
+        self.model.set_recovery_stages([])
+        self.model.ac_pf(V, self.max_it, self.tol)
+        assert self.model.get_solver_type_used() == SolverType.GaussSeidel
+
+    def test_results_after_recovery(self):
+        # gauss seidel needs more iterations, the iwamoto stage uses the newton raphson
+        self.model.change_solver(SolverType.GaussSeidel)
+        self.model.set_recovery_stages([RecoveryStage.Iwamoto])
+        V = self.model.ac_pf(np.ones(self.nb_bus, dtype=np.complex_), self.max_it, self.tol)
+        self._check_results_after_recovery(V)
+
+    def test_ac_pf_dc_init(self):
+        self.model.change_solver(SolverType.GaussSeidel)
+        self.model.set_recovery_stages([RecoveryStage.Iwamoto])
+        V = self.model.ac_pf_dc_init(np.ones(self.nb_bus, dtype=np.complex_), self.max_it, self.tol)
+        self._check_results_after_recovery(V)
+        # no recovery needed
+        self.model.change_solver(SolverType.SparseLU)
+        V = self.model.ac_pf_dc_init(np.ones(self.nb_bus, dtype=np.complex_), self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert self.model.get_last_recovery_stage() == RecoveryStage.NoRecovery
+
+    def test_copy(self):
+        self.model.set_recovery_stages([RecoveryStage.DCInit])
+        model = self.model.copy()
+        assert model.get_recovery_stages() == [RecoveryStage.DCInit]
+
+
+if __name__ == "__main__":
+    unittest.main()
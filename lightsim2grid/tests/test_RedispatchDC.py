@@ -0,0 +1,82 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+
+
+class TestRedispatchDC(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case14()
+        self.model = init(self.net)
+        self.nb_gen = len(self.model.get_gen_status())
+        self.nb_line = len(self.model.get_lines_status())
+        self.nb_trafo = len(self.model.get_trafo_status())
+        self.cost = np.ones(self.nb_gen)
+        self.ramp = np.full(self.nb_gen, 50.)
+        self.pmin = np.full(self.nb_gen, -500.)
+        self.pmax = np.full(self.nb_gen, 500.)
+        self.no_line_limit = np.full(self.nb_line, np.inf)
+        self.no_trafo_limit = np.full(self.nb_trafo, np.inf)
+
+    def _redispatch(self, target, line_pmax, trafo_pmax, ramp=None):
+        ramp = self.ramp if ramp is None else ramp
+        return self.model.redispatch_dc(self.cost, target, ramp, ramp, self.pmin, self.pmax, line_pmax, trafo_pmax)
+
+    def test_no_limit(self):
+        # without limits, a balanced target is reached exactly
+        target = np.zeros(self.nb_gen)
+        target[1] = 10.
+        target[2] = -10.
+        delta = self._redispatch(target, self.no_line_limit, self.no_trafo_limit)
+        assert np.max(np.abs(delta - target)) <= 1e-8
+
+        # an unbalanced one is projected on the balanced redispatchings
+        target[2] = 0.
+        delta = self._redispatch(target, self.no_line_limit, self.no_trafo_limit)
+        assert abs(np.sum(delta)) <= 1e-8
+        assert np.max(np.abs(delta - (target - 10. / self.nb_gen))) <= 1e-8
+
+    def test_overload_relieved(self):
+        zero = np.zeros(self.nb_gen)
+        self._redispatch(zero, self.no_line_limit, self.no_trafo_limit)
+        flow_init = self.model.get_redispatch_line_p()
+        line_id = np.argmax(np.abs(flow_init))
+        line_pmax = np.array(self.no_line_limit)
+        line_pmax[line_id] = 0.9 * np.abs(flow_init[line_id])
+
+        delta = self._redispatch(zero, line_pmax, self.no_trafo_limit)
+        flow = self.model.get_redispatch_line_p()
+        assert abs(np.sum(delta)) <= 1e-8
+        assert np.abs(flow[line_id]) <= line_pmax[line_id] + 1e-6
+        # the constraint is active: the redispatching is the smallest one
+        assert abs(np.abs(flow[line_id]) - line_pmax[line_id]) <= 1e-6
+        assert np.all(np.abs(delta) <= self.ramp + 1e-8)
+
+        # same flows once the redispatching is applied (the slack generator, added by "init", balances it)
+        for gen_id, p_mw in enumerate(self.net.gen["p_mw"].values):
+            self.model.change_p_gen(gen_id, p_mw + delta[gen_id])
+        self._redispatch(zero, self.no_line_limit, self.no_trafo_limit)
+        assert np.max(np.abs(self.model.get_redispatch_line_p() - flow)) <= 1e-6
+
+    def test_not_redispatchable(self):
+        target = np.zeros(self.nb_gen)
+        target[0] = 5.
+        target[1] = -5.
+        self.cost[1] = 0.
+        delta = self._redispatch(target, self.no_line_limit, self.no_trafo_limit)
+        assert delta[1] == 0.
+        assert abs(np.sum(delta)) <= 1e-8
+
+    def test_infeasible(self):
+        zero = np.zeros(self.nb_gen)
+        line_pmax = np.full(self.nb_line, 0.1)
+        with self.assertRaises(RuntimeError):
+            self._redispatch(zero, line_pmax, self.no_trafo_limit, ramp=np.ones(self.nb_gen))
+        with self.assertRaises(RuntimeError):
+            # wrong size
+            self._redispatch(zero[1:], self.no_line_limit, self.no_trafo_limit)
+
+
+if __name__ == "__main__":
+    unittest.main()
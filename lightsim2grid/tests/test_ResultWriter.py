@@ -0,0 +1,103 @@
+import os
+import tempfile
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid_cpp import ResultWriter
+
+
+class TestResultWriter(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case14()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.nb_bus = self.net.bus.shape[0]
+        self.V0 = np.ones(self.nb_bus, dtype=np.complex_)
+        self.load_p = self.net.load["p_mw"].values
+        self.nb_step = 23
+        np.random.seed(0)
+        self.samples = self.load_p * (1. + 0.1 * np.random.randn(self.nb_step, self.load_p.shape[0]))
+
+    def _reference(self):
+        model = self.model.copy()
+        a_or = []
+        vm = []
+        for row in self.samples:
+            for load_id, val in enumerate(row):
+                model.change_p_load(load_id, val)
+            V = model.ac_pf(self.V0, self.max_it, self.tol)
+            assert V.shape[0] > 0, "powerflow diverged !"
+            a_or.append(model.get_lineor_res()[3])
+            vm.append(np.abs(V))
+        return np.array(a_or), np.array(vm)
+
+    def test_run(self):
+        a_or, vm = self._reference()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            writer = ResultWriter(tmpdir, False, 5)
+            nb_conv = writer.run(self.model, self.samples, np.zeros((0, 0)), np.zeros((0, 0)),
+                                 self.V0, self.max_it, self.tol)
+            writer.close()
+            assert nb_conv == self.nb_step
+            assert writer.get_nb_step() == self.nb_step
+            for quantity in writer.get_quantities():
+                assert os.path.exists(os.path.join(tmpdir, quantity + ".npy"))
+            res_a_or = np.load(os.path.join(tmpdir, "line_or_a.npy"), mmap_mode='r')
+            assert res_a_or.dtype == np.float64
+            assert res_a_or.shape == (self.nb_step, self.net.line.shape[0])
+            assert np.max(np.abs(res_a_or - a_or)) <= 1e-6
+            res_vm = np.load(os.path.join(tmpdir, "bus_vm.npy"), mmap_mode='r')
+            assert np.max(np.abs(res_vm - vm)) <= 1e-6
+            res_load_p = np.load(os.path.join(tmpdir, "load_p.npy"))
+            assert np.max(np.abs(res_load_p - self.samples)) <= 1e-6
+            del res_a_or, res_vm
+
+    def test_float32_and_flush(self):
+        a_or, _ = self._reference()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            writer = ResultWriter(tmpdir, True, 1000)
+            writer.run(self.model, self.samples, np.zeros((0, 0)), np.zeros((0, 0)), self.V0, self.max_it, self.tol)
+            # nothing written yet (chunk not full)
+            assert np.load(os.path.join(tmpdir, "line_or_a.npy")).shape[0] == 0
+            writer.flush()
+            res_a_or = np.load(os.path.join(tmpdir, "line_or_a.npy"))
+            assert res_a_or.dtype == np.float32
+            assert res_a_or.shape == (self.nb_step, self.net.line.shape[0])
+            assert np.max(np.abs(res_a_or - a_or)) <= 1e-4
+            writer.close()
+
+    def test_append_diverged(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            writer = ResultWriter(tmpdir)
+            V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+            writer.append(self.model, V)
+            writer.append(self.model, np.zeros(0, dtype=np.complex_))  # divergence
+            writer.close()
+            res = np.load(os.path.join(tmpdir, "bus_va.npy"))
+            assert res.shape == (2, self.nb_bus)
+            assert np.all(np.isfinite(res[0]))
+            assert np.all(np.isnan(res[1]))
+            with self.assertRaises(RuntimeError):
+                writer.append(self.model, V)
+
+    def test_errors(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            with self.assertRaises(RuntimeError):
+                ResultWriter(tmpdir, False, 0)
+            writer = ResultWriter(tmpdir)
+            with self.assertRaises(RuntimeError):
+                # wrong number of columns
+                writer.run(self.model, self.samples[:, :3], np.zeros((0, 0)), np.zeros((0, 0)),
+                           self.V0, self.max_it, self.tol)
+            writer.close()
+        with self.assertRaises(RuntimeError):
+            # the directory does not exist
+            writer = ResultWriter(os.path.join("this", "does", "not", "exist"))
+            writer.append(self.model, self.model.ac_pf(self.V0, self.max_it, self.tol))
+
+
+if __name__ == "__main__":
+    unittest.main()
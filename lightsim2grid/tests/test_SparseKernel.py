@@ -0,0 +1,78 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid import SparseKernel, SolverType
+
+
+class TestSparseKernel(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case300()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.tol_test = 1e-10
+        self.nb_bus = self.net.bus.shape[0]
+        self.V0 = np.ones(self.nb_bus, dtype=np.complex_)
+
+    def test_default(self):
+        assert self.model.get_sparse_kernel() == SparseKernel.Eigen
+
+    def _check_same_results(self, solver_type):
+        if solver_type not in self.model.available_solvers():
+            self.skipTest("solver not available")
+        self.model.change_solver(solver_type)
+        self.model.set_sparse_kernel(SparseKernel.Eigen)
+        V_ref = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V_ref.shape[0] > 0, "powerflow diverged !"
+        p_ref = self.model.get_lineor_res()[0]
+
+        self.model.set_sparse_kernel(SparseKernel.Split)
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert np.max(np.abs(V - V_ref)) <= self.tol_test
+        assert np.max(np.abs(self.model.get_lineor_res()[0] - p_ref)) <= 1e-6
+
+    def test_sparse_lu(self):
+        self._check_same_results(SolverType.SparseLU)
+
+    def test_klu(self):
+        self._check_same_results(SolverType.KLU)
+
+    def test_copy(self):
+        self.model.set_sparse_kernel(SparseKernel.Split)
+        model = self.model.copy()
+        assert model.get_sparse_kernel() == SparseKernel.Split
+
+    def test_cached_copy(self):
+        """the split copy of Ybus is kept between the powerflows: its values and its pattern must follow Ybus"""
+        model_ref = self.model.copy()
+        self.model.set_sparse_kernel(SparseKernel.Split)
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        # same pattern, other values
+        for model in [self.model, model_ref]:
+            model.change_p_load(0, 2. * self.net.load["p_mw"].values[0])
+            model.change_q_shunt(0, 2. * self.net.shunt["q_mvar"].values[0])
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        V_ref = model_ref.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert np.max(np.abs(V - V_ref)) <= self.tol_test
+        # other pattern
+        for model in [self.model, model_ref]:
+            model.deactivate_powerline(3)
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        V_ref = model_ref.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert np.max(np.abs(V - V_ref)) <= self.tol_test
+        # back to the Eigen kernel and to the split one
+        self.model.set_sparse_kernel(SparseKernel.Eigen)
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        self.model.set_sparse_kernel(SparseKernel.Split)
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert np.max(np.abs(V - V_ref)) <= self.tol_test
+
+
+if __name__ == "__main__":
+    unittest.main()
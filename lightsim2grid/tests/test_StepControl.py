@@ -0,0 +1,49 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid import StepControl
+
+
+class TestStepControl(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case118()
+        self.model = init(self.net)
+        self.max_it = 30
+        self.tol = 1e-8
+        self.tol_test = 1e-5
+        self.nb_bus = self.net.bus.shape[0]
+        self.V0 = np.ones(self.nb_bus, dtype=np.complex_)
+        self.V_ref = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.V_ref.shape[0] > 0, "powerflow diverged !"
+
+    def test_default(self):
+        assert self.model.get_step_control() == StepControl.FullStep
+        step_lengths = self.model.get_step_lengths()
+        assert len(step_lengths) > 0
+        assert np.all(np.array(step_lengths) == 1.)
+
+    def _check_same_results(self, step_control):
+        self.model.set_step_control(step_control)
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert np.max(np.abs(V - self.V_ref)) <= self.tol_test
+        step_lengths = np.array(self.model.get_step_lengths())
+        assert np.all(step_lengths > 0.)
+        assert np.all(step_lengths <= 1.)
+
+    def test_iwamoto(self):
+        self._check_same_results(StepControl.Iwamoto)
+
+    def test_line_search(self):
+        self._check_same_results(StepControl.LineSearch)
+
+    def test_copy(self):
+        self.model.set_step_control(StepControl.LineSearch)
+        model = self.model.copy()
+        assert model.get_step_control() == StepControl.LineSearch
+
+
+if __name__ == "__main__":
+    unittest.main()
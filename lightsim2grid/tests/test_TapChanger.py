@@ -0,0 +1,96 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+
+
+class TestTapChanger(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case14()
+        self.net.trafo["tap_step_percent"] = 1.25
+        self.net.trafo["tap_side"] = "hv"
+        self.net.trafo["tap_pos"] = 0.
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.V0 = np.ones(self.net.bus.shape[0], dtype=np.complex_)
+        self.V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.V.shape[0] > 0, "powerflow diverged !"
+
+    def test_change_tap(self):
+        self.model.change_tap_trafo(0, 3)
+        Ybus_patched = self.model.get_Ybus()
+        V = self.model.ac_pf(self.V, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        # Ybus updated in place is the same as the one recomputed
+        assert np.max(np.abs((Ybus_patched - self.model.get_Ybus()).data)) <= 1e-10
+        assert self.model.get_trafo_tap_pos()[0] == 3
+        assert abs(self.model.get_trafo_ratio()[0] - 1.0375) <= 1e-10
+
+        # same as a grid initialized with this tap position
+        self.net.trafo.loc[0, "tap_pos"] = 3.
+        model_ref = init(self.net)
+        V_ref = model_ref.ac_pf(self.V0, self.max_it, self.tol)
+        assert np.max(np.abs(V - V_ref)) <= 1e-8
+
+    def test_rollback(self):
+        self.model.begin()
+        self.model.change_ratio_trafo(1, 0.95)
+        self.model.rollback()
+        assert self.model.get_trafo_ratio()[1] == 1.
+        V = self.model.ac_pf(self.V, self.max_it, self.tol)
+        assert np.max(np.abs(V - self.V)) <= 1e-8
+
+    def test_predict(self):
+        delta_S = np.zeros((1, self.net.bus.shape[0]), dtype=np.complex_)
+        delta_S[0, 4] = -0.1
+        self.model.predict(delta_S)
+        # the jacobian kept by the solver is not the one of the patched Ybus
+        self.model.change_tap_trafo(0, 3)
+        with self.assertRaises(RuntimeError):
+            self.model.predict(delta_S)
+        V = self.model.ac_pf_injections(self.V, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        pred = self.model.predict(delta_S)[0]
+        model_ref = self.model.copy()
+        model_ref.ac_pf(self.V0, self.max_it, self.tol)
+        assert np.max(np.abs(pred - model_ref.predict(delta_S)[0])) <= 1e-8
+
+    def test_shunt_after_dc(self):
+        # the shunts are not in the dc admittance matrix: it is not patched
+        self.model.dc_pf(self.V0, self.max_it, self.tol)
+        Ybus_dc = self.model.get_Ybus()
+        self.model.change_q_shunt(0, 2. * self.net.shunt["q_mvar"].values[0])
+        assert np.max(np.abs((self.model.get_Ybus() - Ybus_dc).data)) == 0.
+        V = self.model.ac_pf_injections(self.V, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        model_ref = self.model.copy()
+        V_ref = model_ref.ac_pf(self.V0, self.max_it, self.tol)
+        assert np.max(np.abs(V - V_ref)) <= 1e-8
+
+    def test_oltc(self):
+        trafo_id = 0
+        bus_lv = self.net.trafo["lv_bus"].values[trafo_id]
+        target = np.abs(self.V[bus_lv]) + 0.02
+        self.model.add_oltc(trafo_id, bus_lv, target, 0.005, -10, 10)
+        V = self.model.ac_pf_oltc(self.V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        assert self.model.get_oltc_nb_iter() >= 1
+        assert self.model.get_trafo_tap_pos()[trafo_id] != 0
+        assert abs(np.abs(V[bus_lv]) - target) <= 0.005
+        # the taps are kept in the grid
+        V2 = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert np.max(np.abs(V - V2)) <= 1e-6
+
+    def test_errors(self):
+        with self.assertRaises(IndexError):
+            self.model.change_tap_trafo(self.net.trafo.shape[0], 1)
+        with self.assertRaises(RuntimeError):
+            self.model.change_ratio_trafo(0, -1.)
+        with self.assertRaises(RuntimeError):
+            self.model.add_oltc(0, 0, 1., 0.01, 5, -5)
+
+
+if __name__ == "__main__":
+    unittest.main()
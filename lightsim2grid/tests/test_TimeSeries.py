@@ -0,0 +1,111 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid_cpp import TimeSeries
+from lightsim2grid import ControlType
+
+
+class TestTimeSeries(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case14()
+        self.net.trafo["tap_step_percent"] = 1.25
+        self.net.trafo["tap_side"] = "hv"
+        self.net.trafo["tap_pos"] = 0.
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-8
+        self.nb_bus = self.net.bus.shape[0]
+        self.V0 = np.ones(self.nb_bus, dtype=np.complex_)
+        self.load_p = self.net.load["p_mw"].values
+        self.load_q = self.net.load["q_mvar"].values
+        self.nb_step = 24
+        self.profile = 1. + 0.3 * np.sin(np.arange(self.nb_step) * 2. * np.pi / self.nb_step)
+        self.series_p = self.load_p * self.profile.reshape(-1, 1)
+        self.series_q = self.load_q * self.profile.reshape(-1, 1)
+
+    def test_no_control(self):
+        """same as one powerflow after the other"""
+        ts = TimeSeries(self.model)
+        nb_conv = ts.run(self.series_p, self.series_q)
+        assert nb_conv == self.nb_step
+        assert np.all(ts.get_converged())
+        assert len(ts.get_actions()) == 0
+        model = self.model.copy()
+        for step in range(self.nb_step):
+            for load_id in range(self.load_p.shape[0]):
+                model.change_p_load(load_id, self.series_p[step, load_id])
+                model.change_q_load(load_id, self.series_q[step, load_id])
+            V = model.ac_pf(self.V0, self.max_it, self.tol)
+            assert V.shape[0] > 0, "powerflow diverged !"
+            assert np.max(np.abs(ts.get_vm()[step] - np.abs(V))) <= 1e-6
+            assert np.max(np.abs(ts.get_va()[step] - np.angle(V))) <= 1e-6
+
+    def test_oltc(self):
+        trafo_id = 0
+        bus_lv = self.net.trafo["lv_bus"].values[trafo_id]
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        target = np.abs(V[bus_lv]) + 0.02
+        ts = TimeSeries(self.model)
+        ts.add_oltc(trafo_id, bus_lv, target, 0.005, -10, 10, delay=2, max_step=1)
+        ts.run(self.series_p, self.series_q)
+        actions = ts.get_actions()
+        assert len(actions) > 0
+        # it waits for 2 time steps, then moves by one step per time step
+        assert actions[0][0] == 2
+        assert actions[0][1] == ControlType.OLTC
+        steps = [el[0] for el in actions]
+        assert len(set(steps)) == len(steps)
+        for el in actions:
+            assert abs(el[4] - el[3]) == 1
+            assert ts.get_tap_pos()[el[0], 0] == el[4]
+        vm = ts.get_vm()[-1, bus_lv]
+        assert abs(vm - target) <= 0.02
+
+    def test_switched_shunt(self):
+        shunt_id = 0
+        bus = self.net.shunt["bus"].values[shunt_id]
+        V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        target = np.abs(V[bus]) + 0.01
+        ts = TimeSeries(self.model)
+        ts.add_switched_shunt(shunt_id, bus, target, 0.002, -5., -10, 10, delay=0, max_step=3)
+        ts.run(self.series_p, self.series_q)
+        actions = ts.get_actions()
+        assert len(actions) > 0
+        assert actions[0][1] == ControlType.SwitchedShunt
+        # capacitive steps (q decreasing) to raise the voltage
+        assert actions[0][4] == actions[0][3] + 1
+        assert np.max(ts.get_nb_solve()) <= 4
+
+        # same results as a grid with the final reactive value of the shunt
+        model = self.model.copy()
+        q_final = self.net.shunt["q_mvar"].values[shunt_id] - 5. * ts.get_shunt_step()[-1, 0]
+        model.change_q_shunt(shunt_id, q_final)
+        for load_id in range(self.load_p.shape[0]):
+            model.change_p_load(load_id, self.series_p[-1, load_id])
+            model.change_q_load(load_id, self.series_q[-1, load_id])
+        V_ref = model.ac_pf(self.V0, self.max_it, self.tol)
+        assert np.max(np.abs(ts.get_vm()[-1] - np.abs(V_ref))) <= 1e-6
+
+    def test_change_q_shunt_patch(self):
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        self.model.change_q_shunt(0, 10.)
+        Ybus_patched = self.model.get_Ybus()
+        self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert np.max(np.abs((Ybus_patched - self.model.get_Ybus()).data)) <= 1e-10
+
+    def test_errors(self):
+        ts = TimeSeries(self.model)
+        with self.assertRaises(RuntimeError):
+            ts.run(self.series_p[:, :2])
+        with self.assertRaises(RuntimeError):
+            ts.run(self.series_p, self.series_q[:3])
+        with self.assertRaises(RuntimeError):
+            ts.add_switched_shunt(0, 0, 1., 0.01, 0., -1, 1)
+        with self.assertRaises(RuntimeError):
+            ts.add_oltc(0, 0, 1., 0.01, 1, 10)  # current tap (0) outside the limits
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,65 @@
+import unittest
+import numpy as np
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+
+
+class TestReduce(unittest.TestCase):
+    def setUp(self):
+        self.net = pn.case118()
+        self.model = init(self.net)
+        self.max_it = 10
+        self.tol = 1e-10
+        self.tol_test = 1e-7
+        self.V0 = np.ones(self.net.bus.shape[0], dtype=np.complex_)
+        self.V = self.model.ac_pf(self.V0, self.max_it, self.tol)
+        assert self.V.shape[0] > 0, "powerflow diverged !"
+        slack_bus = self.net.ext_grid["bus"].values
+        self.keep = np.unique(np.concatenate((np.arange(60), slack_bus))).astype(np.int32)
+
+    def test_same_operating_point(self):
+        red = self.model.reduce(self.keep, self.V)
+        assert red.nb_bus() == self.keep.shape[0]
+        V_red = red.ac_pf(np.ones(self.keep.shape[0], dtype=np.complex_), self.max_it, self.tol)
+        assert V_red.shape[0] > 0, "powerflow diverged on the reduced grid"
+        assert np.max(np.abs(V_red - self.V[self.keep])) <= self.tol_test
+
+    def test_kept_elements(self):
+        red = self.model.reduce(self.keep, self.V)
+        V_red = red.ac_pf(np.ones(self.keep.shape[0], dtype=np.complex_), self.max_it, self.tol)
+        assert V_red.shape[0] > 0, "powerflow diverged on the reduced grid"
+        # powerlines with both ends kept come first, in the same order
+        kept_lines = np.where(np.isin(self.net.line["from_bus"].values, self.keep) &
+                              np.isin(self.net.line["to_bus"].values, self.keep))[0]
+        p_or_full = self.model.get_lineor_res()[0]
+        p_or_red = red.get_lineor_res()[0]
+        assert np.max(np.abs(p_or_red[:kept_lines.shape[0]] - p_or_full[kept_lines])) <= 1e-5
+
+    def test_drop_tol(self):
+        red = self.model.reduce(self.keep, self.V, drop_tol=0.)
+        red_drop = self.model.reduce(self.keep, self.V, drop_tol=1e-4)
+        assert len(red_drop.get_lines_status()) <= len(red.get_lines_status())
+        V_red = red_drop.ac_pf(np.ones(self.keep.shape[0], dtype=np.complex_), self.max_it, self.tol)
+        assert V_red.shape[0] > 0, "powerflow diverged on the reduced grid"
+        # the equivalent powerlines dropped are neglected
+        assert np.max(np.abs(V_red - self.V[self.keep])) <= 1e-2
+
+    def test_errors(self):
+        with self.assertRaises(RuntimeError):
+            # slack bus is not kept
+            keep = np.array([el for el in range(self.net.bus.shape[0])
+                             if el not in self.net.ext_grid["bus"].values], dtype=np.int32)
+            self.model.reduce(keep, self.V)
+        with self.assertRaises(RuntimeError):
+            # wrong size for V
+            self.model.reduce(self.keep, self.V[:10])
+        with self.assertRaises(RuntimeError):
+            # bus given twice
+            self.model.reduce(np.concatenate((self.keep, self.keep[:1])), self.V)
+        with self.assertRaises(RuntimeError):
+            self.model.reduce(self.keep, self.V, drop_tol=-1.)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,58 @@
+import unittest
+import numpy as np
+import pandapower as pp
+import pandapower.networks as pn
+
+from lightsim2grid.initGridModel import init
+from lightsim2grid.syntheticGrid import make_synthetic_grid
+
+
+class TestSyntheticGrid(unittest.TestCase):
+    def setUp(self):
+        self.max_it = 10
+        self.tol = 1e-8
+        self.tol_test = 1e-6
+
+    def test_size(self):
+        net_ref = pn.case118()
+        net = make_synthetic_grid(300, base_case="case118", nb_tie_lines=2)
+        assert net.bus.shape[0] == 3 * net_ref.bus.shape[0]
+        assert net.ext_grid.shape[0] == 1
+        assert net.line.shape[0] == 3 * net_ref.line.shape[0] + 3 * 2  # 3 copies + 3 pairs of tie lines
+        assert net.trafo.shape[0] == 3 * net_ref.trafo.shape[0]
+        assert np.all(net.bus.index.values == np.arange(net.bus.shape[0]))
+
+    def test_seed(self):
+        net1 = make_synthetic_grid(250, seed=1)
+        net2 = make_synthetic_grid(250, seed=1)
+        assert np.all(net1.line["from_bus"].values == net2.line["from_bus"].values)
+        assert np.all(net1.line["to_bus"].values == net2.line["to_bus"].values)
+
+    def test_powerflow(self):
+        net = make_synthetic_grid(300)
+        model = init(net)
+        V0 = np.ones(net.bus.shape[0], dtype=np.complex_)
+        V = model.ac_pf(V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+
+        pp.runpp(net, init="flat")
+        assert np.max(np.abs(np.abs(V) - net.res_bus["vm_pu"].values)) <= self.tol_test
+
+    def test_parallel_ybus(self):
+        # above 5000 buses, Ybus can be filled in parallel (off by default): same matrix
+        net = make_synthetic_grid(5100)
+        model = init(net)
+        assert not model.get_parallel_ybus()
+        V0 = np.ones(net.bus.shape[0], dtype=np.complex_)
+        V = model.ac_pf(V0, self.max_it, self.tol)
+        assert V.shape[0] > 0, "powerflow diverged !"
+        Ybus = model.get_Ybus()
+        model.set_parallel_ybus(True)
+        assert model.copy().get_parallel_ybus()
+        V_par = model.ac_pf(V0, self.max_it, self.tol)
+        assert np.max(np.abs((model.get_Ybus() - Ybus).data)) == 0.
+        assert np.max(np.abs(V_par - V)) <= 1e-10
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -1,8 +1,10 @@
 from setuptools import setup, Extension
 from setuptools.command.build_ext import build_ext
+from setuptools.command.build_clib import build_clib
 import sys
 import setuptools
 import os
+import glob
 import warnings
 
 __version__ = "0.4.0"
@@ -60,36 +62,56 @@ def cpp_flag(compiler):
                        'is needed!')
 
 
-class BuildExt(build_ext):
-    """
-    A custom build extension for adding compiler-specific options.
+def compile_opts(compiler, version):
+    """Return the compiler specific options, used both for the core library and for the extension.
     @author: Sylvain Corlay
     """
     c_opts = {
         'msvc': ['/EHsc'],
         'unix': [],
     }
+    if sys.platform == 'darwin':
+        c_opts['unix'] += ['-stdlib=libc++', '-mmacosx-version-min=10.7']
+    ct = compiler.compiler_type
+    opts = list(c_opts.get(ct, []))
+    if ct == 'unix':
+        opts.append('-DVERSION_INFO="%s"' % version)
+        opts.append(cpp_flag(compiler))
+        if has_flag(compiler, '-fvisibility=hidden'):
+            opts.append('-fvisibility=hidden')
+    elif ct == 'msvc':
+        opts.append('/DVERSION_INFO=\\"%s\\"' % version)
+    return opts
+
+
+class BuildClib(build_clib):
+    """
+    Compiles the core library (everything but the python bindings) with the same options as the extension.
+    """
+    def build_libraries(self, libraries):
+        opts = compile_opts(self.compiler, self.distribution.get_version())
+        for lib_name, build_info in libraries:
+            build_info["cflags"] = build_info.get("cflags", []) + opts
+        build_clib.build_libraries(self, libraries)
+
+
+class BuildExt(build_ext):
+    """
+    A custom build extension for adding compiler-specific options.
+    @author: Sylvain Corlay
+    """
     l_opts = {
         'msvc': [],
         'unix': [],
     }
 
     if sys.platform == 'darwin':
-        darwin_opts = ['-stdlib=libc++', '-mmacosx-version-min=10.7']
-        c_opts['unix'] += darwin_opts
-        l_opts['unix'] += darwin_opts
+        l_opts['unix'] += ['-stdlib=libc++', '-mmacosx-version-min=10.7']
 
     def build_extensions(self):
         ct = self.compiler.compiler_type
-        opts = self.c_opts.get(ct, [])
+        opts = compile_opts(self.compiler, self.distribution.get_version())
         link_opts = self.l_opts.get(ct, [])
-        if ct == 'unix':
-            opts.append('-DVERSION_INFO="%s"' % self.distribution.get_version())
-            opts.append(cpp_flag(self.compiler))
-            if has_flag(self.compiler, '-fvisibility=hidden'):
-                opts.append('-fvisibility=hidden')
-        elif ct == 'msvc':
-            opts.append('/DVERSION_INFO=\\"%s\\"' % self.distribution.get_version())
         for ext in self.extensions:
             ext.extra_compile_args += opts
             ext.extra_link_args += link_opts
@@ -161,6 +183,19 @@ elif sys.platform.startswith("win32"):
     # otherwise windows compiler does not import "M_PI" from the math header
 
 
+# the assembly of the Ybus and jacobian matrices of large grids is performed with multiple threads if openmp is available
+extra_link_args = []
+if sys.platform.startswith('linux'):
+    extra_compile_args_tmp += ["-fopenmp"]
+    extra_link_args += ["-fopenmp"]
+# on macos (with libomp installed) or windows (/openmp with msvc) you can also activate it with the flags:
+# extra_compile_args_tmp += ["-Xpreprocessor", "-fopenmp"]
+# extra_link_args += ["-lomp"]
+
+# shared memory (shm_open) used by the PowerflowDaemon is in librt on older linux systems
+if sys.platform.startswith('linux'):
+    extra_link_args += ["-lrt"]
+
 # for even greater speed, you can add the "-march=native" flag. It does not work on all platform, that is
 # why we deactivated it by default
 # extra_compile_args_tmp += ["-march=native"]
@@ -170,23 +205,32 @@ elif sys.platform.startswith("win32"):
 # extra_compile_args_tmp += ["-DEIGEN_USE_BLAS", "-DEIGEN_USE_LAPACKE"]
 
 extra_compile_args = extra_compile_args_tmp
-src_files = ['src/main.cpp', "src/SparseLUSolver.cpp", "src/GridModel.cpp", "src/DataConverter.cpp",
-             "src/DataLine.cpp", "src/DataGeneric.cpp", "src/DataShunt.cpp", "src/DataTrafo.cpp",
-             "src/DataLoad.cpp", "src/DataGen.cpp", "src/BaseNRSolver.cpp", "src/ChooseSolver.cpp",
-             "src/GaussSeidelSolver.cpp", "src/BaseSolver.cpp", "src/DCSolver.cpp"]
+# the core (solvers, grid model...) is compiled once, in a static library, with the same sources as the standalone
+# c++ library of the Makefile ("make liblightsim2grid"), and the python bindings (src/main.cpp) are linked against it
+core_files = sorted(el.replace(os.sep, "/") for el in glob.glob("src/*.cpp"))
+core_files = [el for el in core_files if el not in ("src/main.cpp", "src/KLUSolver.cpp")]
 
 if KLU_SOLVER_AVAILABLE:
-    src_files.append("src/KLUSolver.cpp")
+    core_files.append("src/KLUSolver.cpp")
     extra_compile_args_tmp.append("-DKLU_SOLVER_AVAILABLE")
 
+libraries = [
+    ("lightsim2grid_core", {
+        "sources": core_files,
+        "include_dirs": INCLUDE,
+        "cflags": list(extra_compile_args),
+    })
+]
+
 ext_modules = [
     Extension(
         'lightsim2grid_cpp',
-        src_files,
+        ['src/main.cpp'],
         include_dirs=include_dirs,
         language='c++',
-        extra_objects=LIBS,
-        extra_compile_args=extra_compile_args
+        extra_compile_args=extra_compile_args,
+        # after the core library, that uses them (the order of the static libraries matters)
+        extra_link_args=LIBS + extra_link_args
     )
 ]
 
@@ -220,11 +264,12 @@ setup(name='LightSim2Grid',
       long_description='LightSim2Grid implements a backend for the Grid2Op platform written in c++ using state of the '
                        'art libraries, mainly "c++ Eigen" and "Suitesparse". See "DISCLAIMER.md" for disclaimers about '
                        'its usage.',
+      libraries=libraries,
       ext_modules=ext_modules,
       install_requires=pkgs["required"],
       extras_require=pkgs["extras"],
       setup_requires=['pybind11>=2.4'],
-      cmdclass={'build_ext': BuildExt},
+      cmdclass={'build_clib': BuildClib, 'build_ext': BuildExt},
       zip_safe=False,
       packages=['lightsim2grid'],
       keywords='pandapower powergrid simulator KLU Eigen c++',
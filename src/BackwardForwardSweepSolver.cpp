@@ -0,0 +1,196 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#include "BackwardForwardSweepSolver.h"
+
+void BackwardForwardSweepSolver::reset(){
+    BaseSolver::reset();
+    nr_solver_.reset();
+    is_radial_ = false;
+    used_nr_ = false;
+    order_.clear();
+    parent_.clear();
+    child_begin_.clear();
+    y_up_ = Eigen::VectorXcd();
+    w_down_ = Eigen::VectorXcd();
+    inv_diag_ = Eigen::VectorXcd();
+    I_ = Eigen::VectorXcd();
+}
+
+bool BackwardForwardSweepSolver::compute_pf(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                            Eigen::VectorXcd & V,
+                                            const Eigen::VectorXcd & Sbus,
+                                            const Eigen::VectorXi & pv,
+                                            const Eigen::VectorXi & pq,
+                                            int max_iter,
+                                            double tol
+                                            )
+{
+    /**
+    pv: id of the pv buses
+    pq: id of the pq buses
+
+    The sweeps can only be used if there are no pv buses (their voltage magnitude is not handled) and if the
+    grid is radial, otherwise the newton raphson is used.
+    **/
+    reset_timer();
+    if(err_ > 0) return false; // i don't do anything if there were a problem at the initialization
+    auto timer = CustTimer();
+
+    n_ = static_cast<int>(Ybus.cols());
+    int slack_bus_id = extract_slack_bus_id(pv, pq, n_);
+    is_radial_ = build_tree(Ybus, slack_bus_id);
+    used_nr_ = (!is_radial_) || (pv.size() > 0);
+    if(used_nr_){
+        bool res = compute_pf_nr(Ybus, V, Sbus, pv, pq, max_iter, tol);
+        timer_total_nr_ += timer.duration();
+        return res;
+    }
+    err_ = 0;
+
+    V_ = V;
+    Vm_ = V_.array().abs();  // update Vm and Va again in case
+    Va_ = V_.array().arg();  // we wrapped around with a negative Vm
+
+    // first check, if the problem is already solved, i stop there
+    Eigen::VectorXd F = _evaluate_Fx(Ybus, V, Sbus, pv, pq);
+    bool converged = _check_for_convergence(F, tol);
+    nr_iter_ = 0; //current step
+    bool res = true;  // have i converged or not
+    while ((!converged) & (nr_iter_ < max_iter)){
+        nr_iter_++;
+
+        auto timer2 = CustTimer();
+        one_iter(Sbus);
+        timer_solve_ += timer2.duration();
+
+        // #####################
+        // stopping criteria
+        // #####################
+        F = _evaluate_Fx(Ybus, V_, Sbus, pv, pq);
+        bool tmp = F.allFinite();
+        if(!tmp) break; // divergence due to Nans
+        converged = _check_for_convergence(F, tol);
+    }
+    if(!converged){
+        err_ = 4;
+        res = false;
+    }
+    Vm_ = V_.array().abs();  // update Vm and Va again in case
+    Va_ = V_.array().arg();  // we wrapped around with a negative Vm
+    timer_total_nr_ += timer.duration();
+    return res;
+}
+
+bool BackwardForwardSweepSolver::build_tree(const Eigen::SparseMatrix<cdouble> & Ybus, int slack_bus_id)
+{
+    /**
+    Breadth first search from the slack bus. The grid is radial if all the buses are reached and if there
+    are exactly n - 1 branches (each branch being 2 off diagonal coefficients of Ybus).
+    **/
+    const int n = n_;
+    order_.clear();
+    order_.reserve(n);
+    parent_.assign(n, -1);
+    child_begin_.assign(n + 1, n);
+    y_up_ = Eigen::VectorXcd::Zero(n);
+    Eigen::VectorXcd y_down = Eigen::VectorXcd::Zero(n);
+    Eigen::VectorXcd diag = Eigen::VectorXcd::Zero(n);
+    std::vector<int> position(n, -1);
+    const cdouble zero = 0.;
+
+    int nb_off_diag = 0;
+    order_.push_back(slack_bus_id);
+    position[slack_bus_id] = 0;
+    for(int pos = 0; pos < static_cast<int>(order_.size()); ++pos){
+        const int bus_id = order_[pos];
+        child_begin_[pos] = static_cast<int>(order_.size());
+        for (Eigen::SparseMatrix<cdouble>::InnerIterator it(Ybus, bus_id); it; ++it){
+            const int other_id = static_cast<int>(it.row());
+            if(it.value() == zero) continue;  // disconnected branch (coefficient still in the sparsity pattern)
+            if(other_id == bus_id){
+                diag(pos) = it.value();
+                continue;
+            }
+            ++nb_off_diag;
+            if(position[other_id] != -1) continue;  // the parent (or a loop, detected by the number of branches)
+            const int child_pos = static_cast<int>(order_.size());
+            position[other_id] = child_pos;
+            order_.push_back(other_id);
+            parent_[child_pos] = pos;
+            y_up_(child_pos) = it.value();  // Ybus(child, bus)
+            y_down(child_pos) = Ybus.coeff(bus_id, other_id);
+        }
+    }
+    if(static_cast<int>(order_.size()) != n) return false;  // multiple islands
+    if(nb_off_diag != 2 * (n - 1)) return false;  // meshed grid
+
+    // eliminate the children (from the leaves to the slack bus), this can be done once and for all as
+    // it only depends on Ybus
+    w_down_ = Eigen::VectorXcd::Zero(n);
+    inv_diag_ = Eigen::VectorXcd::Zero(n);
+    I_ = Eigen::VectorXcd::Zero(n);
+    for(int pos = n - 1; pos > 0; --pos){
+        cdouble diag_pos = diag(pos);
+        for(int child_pos = child_begin_[pos]; child_pos < child_begin_[pos + 1]; ++child_pos){
+            diag_pos -= w_down_(child_pos) * y_up_(child_pos);
+        }
+        if(diag_pos == zero || !std::isfinite(std::abs(diag_pos))) return false;  // sweeps cannot be used
+        inv_diag_(pos) = 1. / diag_pos;
+        w_down_(pos) = y_down(pos) * inv_diag_(pos);
+    }
+    return true;
+}
+
+void BackwardForwardSweepSolver::one_iter(const Eigen::VectorXcd & Sbus)
+{
+    /**
+    With the currents I injected at each bus, for bus k (parent p, children c) the kirchhoff's law is:
+    Ybus(k,k).V_k + Ybus(k,p).V_p + sum_c Ybus(k,c).V_c = I_k
+
+    The backward sweep replaces the V_c (children are processed first) to get diag_k.V_k + Ybus(k,p).V_p = I'_k
+    and the forward sweep computes V_k from V_p.
+    **/
+    const int n = n_;
+    // backward sweep
+    for(int pos = n - 1; pos > 0; --pos){
+        const int bus_id = order_[pos];
+        cdouble tmp = std::conj(Sbus(bus_id) / V_(bus_id));
+        for(int child_pos = child_begin_[pos]; child_pos < child_begin_[pos + 1]; ++child_pos){
+            tmp -= w_down_(child_pos) * I_(child_pos);
+        }
+        I_(pos) = tmp;
+    }
+    // forward sweep (the voltage of the slack bus is not modified)
+    for(int pos = 1; pos < n; ++pos){
+        V_(order_[pos]) = (I_(pos) - y_up_(pos) * V_(order_[parent_[pos]])) * inv_diag_(pos);
+    }
+}
+
+bool BackwardForwardSweepSolver::compute_pf_nr(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                               Eigen::VectorXcd & V,
+                                               const Eigen::VectorXcd & Sbus,
+                                               const Eigen::VectorXi & pv,
+                                               const Eigen::VectorXi & pq,
+                                               int max_iter,
+                                               double tol
+                                               )
+{
+    // the newton raphson solver is reset by "reset" only, so its symbolic factorization is kept between calls
+    bool res = nr_solver_.compute_pf(Ybus, V, Sbus, pv, pq, max_iter, tol);
+    V_ = nr_solver_.get_V();
+    Vm_ = nr_solver_.get_Vm();
+    Va_ = nr_solver_.get_Va();
+    nr_iter_ = nr_solver_.get_nb_iter();
+    err_ = nr_solver_.get_error();
+    const auto timers = nr_solver_.get_timers();
+    timer_Fx_ = std::get<0>(timers);
+    timer_solve_ = std::get<1>(timers);
+    timer_check_ = std::get<2>(timers);
+    return res;
+}
@@ -0,0 +1,112 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#ifndef BACKWARDFORWARDSWEEPSOLVER_H
+#define BACKWARDFORWARDSWEEPSOLVER_H
+
+#include "BaseSolver.h"
+#include "SparseLUSolver.h"
+
+/**
+Backward / forward sweep powerflow, for radial grids (typically distribution feeders).
+
+The buses are sorted in breadth first order, starting from the slack bus. This gives a tree where each bus
+(except the slack) has a single parent, and where the children of a bus are stored contiguously. Each iteration:
+
+- computes the current injected at each bus, with the voltages of the previous iteration: I = conj(S / V)
+- backward sweep (from the leaves to the slack): the currents of the children are accumulated into their parent
+- forward sweep (from the slack to the leaves): the voltage of each bus is computed from the one of its parent
+
+The coefficients of the branches are read directly from the Ybus matrix (so transformers, with or without
+ratio, and shunts are handled as in the other solvers). Nothing is factorized: one iteration is O(nb_bus).
+
+If the grid is not radial (meshed, or made of multiple islands), or if it counts some pv buses, the powerflow
+is computed with the newton raphson method instead (see "used_nr").
+**/
+class BackwardForwardSweepSolver : public BaseSolver
+{
+    public:
+        BackwardForwardSweepSolver():BaseSolver(),is_radial_(false),used_nr_(false) {};
+
+        ~BackwardForwardSweepSolver(){}
+
+        // the jacobian matrix (and the newton steps) only exist if the newton raphson has been used (see "used_nr")
+        Eigen::SparseMatrix<double> get_J(){
+            if(!used_nr_) throw std::runtime_error("get_J: There is no jacobian in the backward forward sweep method");
+            return nr_solver_.get_J();
+        }
+        std::vector<double> get_step_lengths(){
+            if(!used_nr_) throw std::runtime_error("get_step_lengths: There is no newton step in the backward forward sweep method");
+            return nr_solver_.get_step_lengths();
+        }
+        Eigen::MatrixXcd predict_V(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                   const Eigen::MatrixXcd & delta_Sbus,
+                                   const Eigen::VectorXi & pv,
+                                   const Eigen::VectorXi & pq){
+            if(!used_nr_) throw std::runtime_error("predict_V: There is no jacobian in the backward forward sweep method");
+            return nr_solver_.predict_V(Ybus, delta_Sbus, pv, pq);
+        }
+
+        // was the last grid radial
+        bool is_radial() const {return is_radial_;}
+        // has the newton raphson been used (instead of the sweeps) for the last powerflow
+        bool used_nr() const {return used_nr_;}
+
+        virtual
+        void reset();
+
+        bool compute_pf(const Eigen::SparseMatrix<cdouble> & Ybus,
+                        Eigen::VectorXcd & V,
+                        const Eigen::VectorXcd & Sbus,
+                        const Eigen::VectorXi & pv,
+                        const Eigen::VectorXi & pq,
+                        int max_iter,
+                        double tol
+                        ) ;
+
+    protected:
+        // computes the tree (and the coefficients of the sweeps), returns false if the grid is not radial
+        bool build_tree(const Eigen::SparseMatrix<cdouble> & Ybus, int slack_bus_id);
+
+        void one_iter(const Eigen::VectorXcd & Sbus);
+
+        bool compute_pf_nr(const Eigen::SparseMatrix<cdouble> & Ybus,
+                           Eigen::VectorXcd & V,
+                           const Eigen::VectorXcd & Sbus,
+                           const Eigen::VectorXi & pv,
+                           const Eigen::VectorXi & pq,
+                           int max_iter,
+                           double tol
+                           ) ;
+
+    protected:
+        bool is_radial_;
+        bool used_nr_;
+
+        // the tree, everything is indexed by the position of the bus in the breadth first order
+        std::vector<int> order_;  // id of the bus (in Ybus) at each position
+        std::vector<int> parent_;  // position of the parent (-1 for the slack bus)
+        std::vector<int> child_begin_;  // children of position k are at positions child_begin_[k] ... child_begin_[k+1] - 1
+
+        // coefficients of the sweeps
+        Eigen::VectorXcd y_up_;  // Ybus(bus, parent)
+        Eigen::VectorXcd w_down_;  // Ybus(parent, bus) / diag_(bus)
+        Eigen::VectorXcd inv_diag_;  // 1 / diag_, diag_ being Ybus(bus, bus) once all the children are eliminated
+        Eigen::VectorXcd I_;  // current (injected at each bus then accumulated from the children)
+
+        // used when the grid is not radial
+        SparseLUSolver nr_solver_;
+
+    private:
+        // no copy allowed
+        BackwardForwardSweepSolver( const BackwardForwardSweepSolver & ) ;
+        BackwardForwardSweepSolver & operator=( const BackwardForwardSweepSolver & ) ;
+
+};
+
+#endif // BACKWARDFORWARDSWEEPSOLVER_H
@@ -37,22 +37,31 @@ bool BaseNRSolver::compute_pf(const Eigen::SparseMatrix<cdouble> & Ybus,
     for(int inv_id=0; inv_id < n_pvpq; ++inv_id) pvpq_inv[pvpq(inv_id)] = inv_id;
     std::vector<int> pq_inv(V.size(), -1);
     for(int inv_id=0; inv_id < n_pq; ++inv_id) pq_inv[pq(inv_id)] = inv_id;
+    _init_distributed_slack(Ybus, pv, pq, pvpq_inv);
+    slack_p_ = 0.;
+    factorized_at_V_ = false;
+    ybus_modified_ = false;
 
     V_ = V;
     Vm_ = V_.array().abs();  // update Vm and Va again in case
     Va_ = V_.array().arg();  // we wrapped around with a negative Vm
+    _init_split_kernel(Ybus);
+    tol_ = tol;
+    nb_refinement_ = 0;
 
     // first check, if the problem is already solved, i stop there
     Eigen::VectorXd F = _evaluate_Fx(Ybus, V, Sbus, pv, pq);
     bool converged = _check_for_convergence(F, tol);
     nr_iter_ = 0; //current step
+    step_lengths_.clear();
+    Eigen::VectorXd F_prev;  // only used when the step is controlled
     bool res = true;  // have i converged or not
     bool has_just_been_inialized = false;  // to avoid a call to klu_refactor follow a call to klu_factor in the same loop
     while ((!converged) & (nr_iter_ < max_iter)){
         nr_iter_++;
         fill_jacobian_matrix(Ybus, V_, pq, pvpq, pq_inv, pvpq_inv);
         if(need_factorize_){
-            initialize();
+            _initialize_linear();
             if(err_ != 0){
                 // I got an error during the initialization of the linear system, i need to stop here
                 res = false;
@@ -61,30 +70,37 @@ bool BaseNRSolver::compute_pf(const Eigen::SparseMatrix<cdouble> & Ybus,
             has_just_been_inialized = true;
         }
         //TODO refactorize is called uselessly at the first iteration
-        solve(F, has_just_been_inialized);
+        if(step_control_ != StepControl::FullStep) F_prev = F;
+        _solve_linear(F, has_just_been_inialized);
         has_just_been_inialized = false;
         if(err_ != 0){
             // I got an error during the solving of the linear system, i need to stop here
             res = false;
             break;
         }
-        auto dx = -1.0*F;
+        if(step_control_ != StepControl::FullStep){
+            F = _controlled_step(Ybus, Sbus, pv, pq, F_prev, -1.0 * F);
+        }else{
+            auto dx = -1.0*F;
 
+            Vm_ = V_.array().abs();  // update Vm and Va again in case
+            Va_ = V_.array().arg();  // we wrapped around with a negative Vm
 
-        Vm_ = V_.array().abs();  // update Vm and Va again in case
-        Va_ = V_.array().arg();  // we wrapped around with a negative Vm
+            // update voltage (this should be done consistently with "klu_solver._evaluate_Fx")
+            if (n_pv > 0) Va_(pv) += dx.segment(0,n_pv);
+            if (n_pq > 0){
+                Va_(pq) += dx.segment(n_pv,n_pq);
+                Vm_(pq) += dx.segment(n_pv+n_pq, n_pq);
+            }
 
-        // update voltage (this should be done consistently with "klu_solver._evaluate_Fx")
-        if (n_pv > 0) Va_(pv) += dx.segment(0,n_pv);
-        if (n_pq > 0){
-            Va_(pq) += dx.segment(n_pv,n_pq);
-            Vm_(pq) += dx.segment(n_pv+n_pq, n_pq);
-        }
+            if(slack_bus_ds_ >= 0) slack_p_ += dx(n_pv + 2 * n_pq);
 
-        // TODO change here for not having to cast all the time ... maybe
-        V_ = Vm_.array() * (Va_.array().cos().cast<cdouble>() + my_i * Va_.array().sin().cast<cdouble>() );
+            // TODO change here for not having to cast all the time ... maybe
+            V_ = Vm_.array() * (Va_.array().cos().cast<cdouble>() + my_i * Va_.array().sin().cast<cdouble>() );
 
-        F = _evaluate_Fx(Ybus, V_, Sbus, pv, pq);
+            F = _evaluate_Fx(Ybus, V_, Sbus, pv, pq);
+            step_lengths_.push_back(1.0);
+        }
         bool tmp = F.allFinite();
         if(!tmp) break; // divergence due to Nans
         converged = _check_for_convergence(F, tol);
@@ -92,19 +108,394 @@ bool BaseNRSolver::compute_pf(const Eigen::SparseMatrix<cdouble> & Ybus,
     if(!converged){
         err_ = 4;
         res = false;
+    }else{
+        err_ = 0;  // also when the initial state was already a solution (no linear system solved)
     }
     timer_total_nr_ += timer.duration();
     return res;
 }
 
 
+void BaseNRSolver::_update_V(const Eigen::VectorXd & Va0,
+                             const Eigen::VectorXd & Vm0,
+                             double slack_p0,
+                             const Eigen::VectorXd & dx,
+                             double step_length,
+                             const Eigen::VectorXi & pv,
+                             const Eigen::VectorXi & pq)
+{
+    int n_pv = pv.size();
+    int n_pq = pq.size();
+    Va_ = Va0;
+    Vm_ = Vm0;
+    if (n_pv > 0) Va_(pv) += step_length * dx.segment(0,n_pv);
+    if (n_pq > 0){
+        Va_(pq) += step_length * dx.segment(n_pv,n_pq);
+        Vm_(pq) += step_length * dx.segment(n_pv+n_pq, n_pq);
+    }
+    if(slack_bus_ds_ >= 0) slack_p_ = slack_p0 + step_length * dx(n_pv + 2 * n_pq);
+    V_ = Vm_.array() * (Va_.array().cos().cast<cdouble>() + my_i * Va_.array().sin().cast<cdouble>() );
+}
+
+Eigen::VectorXd BaseNRSolver::_controlled_step(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                               const Eigen::VectorXcd & Sbus,
+                                               const Eigen::VectorXi & pv,
+                                               const Eigen::VectorXi & pq,
+                                               const Eigen::VectorXd & F,
+                                               const Eigen::VectorXd & dx)
+{
+    Eigen::VectorXd Vm0 = V_.array().abs();
+    Eigen::VectorXd Va0 = V_.array().arg();
+    const double slack_p0 = slack_p_;
+
+    // first try the full step
+    double step_length = 1.0;
+    _update_V(Va0, Vm0, slack_p0, dx, step_length, pv, pq);
+    Eigen::VectorXd F1 = _evaluate_Fx(Ybus, V_, Sbus, pv, pq);
+
+    double norm_F = F.squaredNorm();
+    if(step_control_ == StepControl::Iwamoto){
+        if(F1.allFinite()){
+            // as J.dx = -F, the quadratic expansion of the mismatch along dx is
+            // F(x + mu.dx) = (1 - mu).F + mu^2.F1
+            // and mu is the first minimum of its squared norm, ie the first root of (derivative / 2):
+            // g(mu) = -F.F + mu (F.F + 2 F.F1) - 3 mu^2 F.F1 + 2 mu^3 F1.F1
+            double F_F1 = F.dot(F1);
+            double norm_F1 = F1.squaredNorm();
+            auto g = [&](double mu){return -norm_F + mu * (norm_F + 2. * F_F1) - 3. * mu * mu * F_F1 + 2. * mu * mu * mu * norm_F1;};
+            if(g(1.0) > 0.){
+                // g(0) < 0, there is a root in [0, 1]: bisection
+                double mu_min = 0.;
+                double mu_max = 1.;
+                for(int i = 0; i < 30; ++i){
+                    double mu = 0.5 * (mu_min + mu_max);
+                    if(g(mu) > 0.) mu_max = mu;
+                    else mu_min = mu;
+                }
+                step_length = std::max(0.5 * (mu_min + mu_max), min_step_length_);
+            }
+        }else{
+            // full step leads to Nan, quadratic expansion is meaningless
+            step_length = 0.5;
+        }
+        if(step_length < 1.0){
+            _update_V(Va0, Vm0, slack_p0, dx, step_length, pv, pq);
+            F1 = _evaluate_Fx(Ybus, V_, Sbus, pv, pq);
+        }
+    }else if(step_control_ == StepControl::LineSearch){
+        // backtracking (armijo condition on the squared norm of the mismatch)
+        const double alpha = 1e-4;
+        while((!F1.allFinite() || F1.squaredNorm() > (1. - 2. * alpha * step_length) * norm_F) &&
+              (step_length > min_step_length_)){
+            step_length *= 0.5;
+            _update_V(Va0, Vm0, slack_p0, dx, step_length, pv, pq);
+            F1 = _evaluate_Fx(Ybus, V_, Sbus, pv, pq);
+        }
+    }
+    step_lengths_.push_back(step_length);
+    return F1;
+}
+
+Eigen::MatrixXcd BaseNRSolver::predict_V(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                         const Eigen::MatrixXcd & delta_Sbus,
+                                         const Eigen::VectorXi & pv,
+                                         const Eigen::VectorXi & pq)
+{
+    /**
+    The last converged state x verifies F(x) = 0. If Sbus is modified by dS, the mismatch becomes
+    F(x) - [real(dS)(pv), real(dS)(pq), imag(dS)(pq)] and the first order update is then
+    dx = -J^-1 . dF = J^-1 . [real(dS)(pv), real(dS)(pq), imag(dS)(pq)]
+    (with real(dS)(slack bus) at the end if the slack is distributed)
+    **/
+    if(V_.size() == 0) throw std::runtime_error("predict_V: no powerflow has been computed with this solver.");
+    if(err_ != 0) throw std::runtime_error("predict_V: the last powerflow did not converge.");
+    if(ybus_modified_) throw std::runtime_error("predict_V: Ybus has been modified since the last powerflow, compute a powerflow first.");
+    int nb_bus = V_.size();
+    if(delta_Sbus.cols() != nb_bus) throw std::runtime_error("predict_V: delta_Sbus should have as many columns as the number of bus in the solver.");
+
+    int n_pv = pv.size();
+    int n_pq = pq.size();
+    const bool distributed = slack_bus_ds_ >= 0;
+    int size_j = n_pv + 2 * n_pq + (distributed ? 1 : 0);
+    if(!factorized_at_V_ || need_factorize_ || J_.cols() != size_j){
+        // the jacobian at the converged state (the powerflow factorized the one of the previous iterate, if any)
+        _init_split_kernel(Ybus);
+        Eigen::VectorXi pvpq(n_pv + n_pq);
+        pvpq << pv, pq;
+        std::vector<int> pvpq_inv(nb_bus, -1);
+        for(int inv_id=0; inv_id < n_pv + n_pq; ++inv_id) pvpq_inv[pvpq(inv_id)] = inv_id;
+        std::vector<int> pq_inv(nb_bus, -1);
+        for(int inv_id=0; inv_id < n_pq; ++inv_id) pq_inv[pq(inv_id)] = inv_id;
+        if(distributed) pvpq_inv[slack_bus_ds_] = n_pv + 2 * n_pq;
+        fill_jacobian_matrix(Ybus, V_, pq, pvpq, pq_inv, pvpq_inv);
+        _initialize_linear();
+        if(err_ != 0) throw std::runtime_error("predict_V: impossible to factorize the jacobian matrix.");
+        factorized_at_V_ = true;
+    }
+
+    Eigen::VectorXd Vm = V_.array().abs();
+    Eigen::VectorXd Va = V_.array().arg();
+    int nb_delta = delta_Sbus.rows();
+    Eigen::MatrixXcd res(nb_delta, nb_bus);
+    Eigen::VectorXd dx(size_j);
+    for(int delta_id = 0; delta_id < nb_delta; ++delta_id){
+        Eigen::VectorXd dP = delta_Sbus.row(delta_id).real().transpose();
+        Eigen::VectorXd dQ = delta_Sbus.row(delta_id).imag().transpose();
+        dx.segment(0, n_pv) = dP(pv);
+        dx.segment(n_pv, n_pq) = dP(pq);
+        dx.segment(n_pv + n_pq, n_pq) = dQ(pq);
+        if(distributed) dx(n_pv + 2 * n_pq) = dP(slack_bus_ds_);
+
+        // the matrix is already factorized, only the triangular solves are performed
+        _solve_linear(dx, true);
+        if(err_ != 0){
+            err_ = 0;  // the last powerflow is still valid
+            throw std::runtime_error("predict_V: impossible to solve the linear system.");
+        }
+
+        Eigen::VectorXd Vm_pred = Vm;
+        Eigen::VectorXd Va_pred = Va;
+        if (n_pv > 0) Va_pred(pv) += dx.segment(0, n_pv);
+        if (n_pq > 0){
+            Va_pred(pq) += dx.segment(n_pv, n_pq);
+            Vm_pred(pq) += dx.segment(n_pv + n_pq, n_pq);
+        }
+        res.row(delta_id) = (Vm_pred.array() * (Va_pred.array().cos().cast<cdouble>() + my_i * Va_pred.array().sin().cast<cdouble>())).matrix().transpose();
+    }
+    return res;
+}
+
+void BaseNRSolver::_initialize_linear()
+{
+    factorized_at_V_ = false;
+    if(precision_ == NRPrecision::Mixed) _initialize_mixed();
+    else initialize();
+}
+
+void BaseNRSolver::_solve_linear(Eigen::VectorXd & b, bool has_just_been_inialized)
+{
+    if(!has_just_been_inialized) factorized_at_V_ = false;  // refactorized
+    if(precision_ == NRPrecision::Mixed) _solve_mixed(b, has_just_been_inialized);
+    else solve(b, has_just_been_inialized);
+}
+
+void BaseNRSolver::_initialize_mixed()
+{
+    auto timer = CustTimer();
+    n_ = J_.cols();
+    err_ = 0;
+    J_.makeCompressed();
+    J_float_ = J_.cast<float>();
+    J_float_.makeCompressed();
+    solver_float_.analyzePattern(J_float_);
+    solver_float_.factorize(J_float_);
+    if(solver_float_.info() != Eigen::Success) err_ = 1;
+    need_factorize_ = false;
+    timer_solve_ += timer.duration();
+}
+
+void BaseNRSolver::_solve_mixed(Eigen::VectorXd & b, bool has_just_been_inialized)
+{
+    /**
+    x is first computed with the single precision factors, then refined: r = b - J.x (in double precision) and
+    x += J^-1.r (single precision factors) until r is small enough.
+    "small enough" does not slow down the newton raphson: |r| <= |b|^2 (as the error of the next mismatch is in
+    |b|^2 anyway), but not below tol / 10 (the powerflow converges when the mismatch is below tol).
+    **/
+    auto timer = CustTimer();
+    if(!has_just_been_inialized){
+        // same sparsity pattern as J_, only the values are copied
+        const int nnz = J_.nonZeros();
+        const double * J_values = J_.valuePtr();
+        float * J_float_values = J_float_.valuePtr();
+        for(int k = 0; k < nnz; ++k) J_float_values[k] = static_cast<float>(J_values[k]);
+        solver_float_.factorize(J_float_);
+        if(solver_float_.info() != Eigen::Success){
+            err_ = 2;
+            timer_solve_ += timer.duration();
+            return;
+        }
+    }
+    const double norm_b = b.lpNorm<Eigen::Infinity>();
+    const double target = std::max(0.1 * tol_, std::min(0.1, norm_b) * norm_b);
+    Eigen::VectorXf tmp = solver_float_.solve(b.cast<float>());
+    if(solver_float_.info() != Eigen::Success){
+        err_ = 3;
+        timer_solve_ += timer.duration();
+        return;
+    }
+    Eigen::VectorXd x = tmp.cast<double>();
+    Eigen::VectorXd r = b - J_ * x;
+    double norm_r = r.lpNorm<Eigen::Infinity>();
+    for(int refine = 0; refine < _max_refinement && norm_r > target; ++refine){
+        tmp = solver_float_.solve(r.cast<float>());
+        Eigen::VectorXd x_new = x + tmp.cast<double>();
+        Eigen::VectorXd r_new = b - J_ * x_new;
+        const double norm_r_new = r_new.lpNorm<Eigen::Infinity>();
+        ++nb_refinement_;
+        if(!(norm_r_new < norm_r)) break;  // no more progress (or nan)
+        x.swap(x_new);
+        r.swap(r_new);
+        norm_r = norm_r_new;
+    }
+    b = x;
+    timer_solve_ += timer.duration();
+}
+
 void BaseNRSolver::reset(){
     BaseSolver::reset();
     // reset specific attributes
     J_ = Eigen::SparseMatrix<double>();  // the jacobian matrix
     dS_dVm_ = Eigen::SparseMatrix<cdouble>();
     dS_dVa_ = Eigen::SparseMatrix<cdouble>();
+    // dS_dVa_r_, dS_dVa_i_, dS_dVm_r_ and dS_dVm_i_ are kept for the split kernel (see _init_split_kernel)
     need_factorize_ = true;
+    factorized_at_V_ = false;
+    ybus_modified_ = false;
+    step_lengths_.clear();
+    J_float_ = Eigen::SparseMatrix<float>();
+    nb_refinement_ = 0;
+    slack_bus_ds_ = -1;
+    slack_p_ = 0.;
+}
+
+void BaseNRSolver::set_results(const Eigen::SparseMatrix<cdouble> & Ybus,
+                               const Eigen::VectorXcd & V,
+                               const Eigen::VectorXd & Vm,
+                               const Eigen::VectorXd & Va,
+                               const Eigen::VectorXi & pv,
+                               const Eigen::VectorXi & pq,
+                               const Eigen::SparseMatrix<double> & J,
+                               double slack_p)
+{
+    reset();  // the factorization is not the one of J
+    BaseSolver::set_results(V, Vm, Va);
+    std::vector<int> pvpq_inv(V.size(), -1);
+    _init_distributed_slack(Ybus, pv, pq, pvpq_inv);
+    J_ = J;
+    slack_p_ = slack_p;
+}
+
+void BaseNRSolver::set_slack_weights(const Eigen::VectorXd & weights)
+{
+    if(weights.size() > 0){
+        if(!weights.allFinite() || (weights.array() < 0.).any()){
+            throw std::runtime_error("set_slack_weights: the weights should be finite and >= 0.");
+        }
+        if(weights.sum() <= 0.){
+            throw std::runtime_error("set_slack_weights: at least one weight should be > 0.");
+        }
+    }
+    // the sparsity pattern of the jacobian matrix changes with the buses that participate
+    bool same_pattern = weights.size() == slack_weights_.size();
+    for(int bus_id = 0; same_pattern && bus_id < weights.size(); ++bus_id){
+        same_pattern = (weights(bus_id) != 0.) == (slack_weights_(bus_id) != 0.);
+    }
+    if(!same_pattern){
+        J_ = Eigen::SparseMatrix<double>();
+        need_factorize_ = true;
+    }
+    slack_weights_ = weights;
+}
+
+void BaseNRSolver::_init_distributed_slack(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                           const Eigen::VectorXi & pv,
+                                           const Eigen::VectorXi & pq,
+                                           std::vector<int> & pvpq_inv)
+{
+    /**
+    The unknowns are [Va(pv), Va(pq), Vm(pq), p_slack] and the equations [P(pv), P(pq), Q(pq), P(slack bus)]: the
+    active power of the slack bus is the last row of the jacobian matrix, which is filled as the other "P" rows
+    once pvpq_inv(slack bus) points to it.
+    **/
+    ybus_slack_cols_.clear();
+    ybus_slack_values_.clear();
+    if(slack_weights_.size() == 0){
+        slack_bus_ds_ = -1;
+        return;
+    }
+    const int nb_bus = Ybus.cols();
+    if(slack_weights_.size() != nb_bus){
+        throw std::runtime_error("compute_pf: the slack weights should have as many components as the number of bus in the solver.");
+    }
+    slack_bus_ds_ = extract_slack_bus_id(pv, pq, nb_bus);
+    pvpq_inv[slack_bus_ds_] = pv.size() + 2 * pq.size();
+    for (int col_id = 0; col_id < nb_bus; ++col_id){
+        for (Eigen::SparseMatrix<cdouble>::InnerIterator it(Ybus, col_id); it; ++it){
+            if(it.row() != slack_bus_ds_) continue;
+            ybus_slack_cols_.push_back(col_id);
+            ybus_slack_values_.push_back(it.value());
+        }
+    }
+}
+
+void BaseNRSolver::_fill_slack_column(const std::vector<int> & pvpq_inv, int col_id, bool need_insert)
+{
+    // dF(P(k)) / dp_slack = -weights(k)
+    const int nb_bus = slack_weights_.size();
+    for(int bus_id = 0; bus_id < nb_bus; ++bus_id){
+        const double weight = slack_weights_(bus_id);
+        const int row_id = pvpq_inv[bus_id];
+        if(weight == 0. || row_id < 0) continue;
+        if(need_insert) J_.insert(row_id, col_id) = -weight;
+        else J_.coeffRef(row_id, col_id) = -weight;
+    }
+}
+
+bool BaseNRSolver::_fill_jacobian_values_parallel(const Eigen::SparseMatrix<double> & dS_dVa_r,
+                                                  const Eigen::SparseMatrix<double> & dS_dVa_i,
+                                                  const Eigen::SparseMatrix<double> & dS_dVm_r,
+                                                  const Eigen::SparseMatrix<double> & dS_dVm_i,
+                                                  const Eigen::VectorXi & pq,
+                                                  const Eigen::VectorXi & pvpq,
+                                                  const std::vector<int> & pq_inv,
+                                                  const std::vector<int> & pvpq_inv)
+{
+    /**
+    Same as the loops of "fill_jacobian_matrix" when J_ is already initialized, but the values are directly written in
+    the value array of J_ (no insertion can happen), each thread taking care of different columns.
+    It returns false if a coefficient is not in the sparsity pattern of J_ (nothing can be done in parallel then).
+    **/
+    const int n_pvpq = pvpq.size();
+    const int size_j = n_pvpq + pq.size();  // the column of the distributed slack (if any) is not filled here
+    const int * J_outer = J_.outerIndexPtr();
+    const int * J_inner = J_.innerIndexPtr();
+    double * J_values = J_.valuePtr();
+    bool all_found = true;
+
+    #pragma omp parallel reduction(&&:all_found)
+    {
+        // buffers are "per thread"
+        int nb_obj_this_col = 0;
+        std::vector<int> inner_index;
+        std::vector<double> values;
+
+        #pragma omp for schedule(static)
+        for(int col_id = 0; col_id < size_j; ++col_id){
+            nb_obj_this_col = 0;
+            inner_index.clear();
+            values.clear();
+            if(col_id < n_pvpq){
+                _get_values_J(nb_obj_this_col, inner_index, values, dS_dVa_r, pvpq_inv, pvpq, col_id, 0);
+                _get_values_J(nb_obj_this_col, inner_index, values, dS_dVa_i, pq_inv, pvpq, col_id, n_pvpq);
+            }else{
+                _get_values_J(nb_obj_this_col, inner_index, values, dS_dVm_r, pvpq_inv, pq, col_id - n_pvpq, 0);
+                _get_values_J(nb_obj_this_col, inner_index, values, dS_dVm_i, pq_inv, pq, col_id - n_pvpq, n_pvpq);
+            }
+            // J_ is compressed, rows are sorted in each column
+            const int * col_begin = J_inner + J_outer[col_id];
+            const int * col_end = J_inner + J_outer[col_id + 1];
+            for(int in_ind=0; in_ind < nb_obj_this_col; ++in_ind){
+                const int * pos = std::lower_bound(col_begin, col_end, inner_index[in_ind]);
+                if((pos == col_end) || (*pos != inner_index[in_ind])){
+                    all_found = false;
+                    continue;
+                }
+                J_values[pos - J_inner] = values[in_ind];
+            }
+        }
+    }
+    return all_found;
 }
 
 void BaseNRSolver::_dSbus_dV(const Eigen::Ref<const Eigen::SparseMatrix<cdouble> > & Ybus,
@@ -118,7 +509,8 @@ void BaseNRSolver::_dSbus_dV(const Eigen::Ref<const Eigen::SparseMatrix<cdouble>
     dS_dVm_ = Ybus;
     dS_dVa_ = Ybus;
 
-    // i fill the buffer columns per columns
+    // i fill the buffer columns per columns (columns are independant)
+    #pragma omp parallel for schedule(static) if(size_dS >= _parallel_min_size)
     for (int k=0; k < size_dS; ++k){
         for (Eigen::SparseMatrix<cdouble>::InnerIterator it(dS_dVm_,k); it; ++it)
         {
@@ -131,6 +523,7 @@ void BaseNRSolver::_dSbus_dV(const Eigen::Ref<const Eigen::SparseMatrix<cdouble>
         }
     }
 
+    #pragma omp parallel for schedule(static) if(size_dS >= _parallel_min_size)
     for (int k=0; k < size_dS; ++k){
         for (Eigen::SparseMatrix<cdouble>::InnerIterator it(dS_dVa_,k); it; ++it)
         {
@@ -148,6 +541,98 @@ void BaseNRSolver::_dSbus_dV(const Eigen::Ref<const Eigen::SparseMatrix<cdouble>
     timer_dSbus_ += timer.duration();
 }
 
+Eigen::VectorXd BaseNRSolver::_evaluate_Fx(const Eigen::SparseMatrix<cdouble> &  Ybus,
+                                           const Eigen::VectorXcd & V,
+                                           const Eigen::VectorXcd & Sbus,
+                                           const Eigen::VectorXi & pv,
+                                           const Eigen::VectorXi & pq)
+{
+    if(slack_bus_ds_ < 0) return _evaluate_Fx_single_slack(Ybus, V, Sbus, pv, pq);
+
+    // the slack is shared between the buses
+    Eigen::VectorXcd Sbus_ds = Sbus;
+    Sbus_ds.real() += slack_p_ * slack_weights_;
+    Eigen::VectorXd F = _evaluate_Fx_single_slack(Ybus, V, Sbus_ds, pv, pq);
+
+    auto timer = CustTimer();
+    cdouble I_slack = 0.;
+    const int nb_coeff = ybus_slack_cols_.size();
+    for(int coeff_id = 0; coeff_id < nb_coeff; ++coeff_id){
+        I_slack += ybus_slack_values_[coeff_id] * V(ybus_slack_cols_[coeff_id]);
+    }
+    const int size_f = F.size();
+    Eigen::VectorXd res(size_f + 1);
+    res.segment(0, size_f) = F;
+    res(size_f) = std::real(V(slack_bus_ds_) * std::conj(I_slack)) - Sbus_ds(slack_bus_ds_).real();
+    timer_Fx_ += timer.duration();
+    return res;
+}
+
+Eigen::VectorXd BaseNRSolver::_evaluate_Fx_single_slack(const Eigen::SparseMatrix<cdouble> &  Ybus,
+                                                        const Eigen::VectorXcd & V,
+                                                        const Eigen::VectorXcd & Sbus,
+                                                        const Eigen::VectorXi & pv,
+                                                        const Eigen::VectorXi & pq)
+{
+    if(!_use_split_kernel(Ybus)) return BaseSolver::_evaluate_Fx(Ybus, V, Sbus, pv, pq);
+    auto timer = CustTimer();
+    const int nb_bus = V.size();
+    V_re_ = V.real();
+    V_im_ = V.imag();
+    I_re_.resize(nb_bus);
+    I_im_.resize(nb_bus);
+    ybus_split_.multiply(V_re_.data(), V_im_.data(), I_re_.data(), I_im_.data());
+
+    // mismatch: V * conj(I) - Sbus
+    const int npv = pv.size();
+    const int npq = pq.size();
+    Eigen::VectorXd res(npv + 2*npq);
+    for(int i = 0; i < npv; ++i){
+        const int bus = pv(i);
+        res(i) = V_re_(bus) * I_re_(bus) + V_im_(bus) * I_im_(bus) - Sbus(bus).real();
+    }
+    for(int i = 0; i < npq; ++i){
+        const int bus = pq(i);
+        res(npv + i) = V_re_(bus) * I_re_(bus) + V_im_(bus) * I_im_(bus) - Sbus(bus).real();
+        res(npv + npq + i) = V_im_(bus) * I_re_(bus) - V_re_(bus) * I_im_(bus) - Sbus(bus).imag();
+    }
+    timer_Fx_ += timer.duration();
+    return res;
+}
+
+void BaseNRSolver::_init_split_kernel(const Eigen::SparseMatrix<cdouble> & Ybus)
+{
+    if(sparse_kernel_ != SparseKernel::Split) return;
+    if(split_buffers_ok_ && ybus_split_.has_pattern_of(Ybus)){
+        // same topology: the copy of Ybus and the buffers are re used
+        ybus_split_.update_values(Ybus);
+        return;
+    }
+    ybus_split_.init(Ybus);
+    // dS_dVa and dS_dVm have the sparsity pattern of Ybus (and their values are in the same order)
+    split_buffers_ok_ = true;
+    dS_dVa_r_ = Ybus.real();
+    dS_dVa_r_.makeCompressed();
+    dS_dVa_i_ = dS_dVa_r_;
+    dS_dVm_r_ = dS_dVa_r_;
+    dS_dVm_i_ = dS_dVa_r_;
+}
+
+void BaseNRSolver::_dSbus_dV_split(const Eigen::VectorXcd & V)
+{
+    auto timer = CustTimer();
+    const int nb_bus = V.size();
+    V_re_ = V.real();
+    V_im_ = V.imag();
+    I_re_.resize(nb_bus);
+    I_im_.resize(nb_bus);
+    ybus_split_.multiply(V_re_.data(), V_im_.data(), I_re_.data(), I_im_.data());
+    ybus_split_.dS_dV(V_re_.data(), V_im_.data(), I_re_.data(), I_im_.data(),
+                      dS_dVm_r_.valuePtr(), dS_dVm_i_.valuePtr(),
+                      dS_dVa_r_.valuePtr(), dS_dVa_i_.valuePtr());
+    timer_dSbus_ += timer.duration();
+}
+
 void BaseNRSolver::_get_values_J(int & nb_obj_this_col,
                               std::vector<int> & inner_index,
                               std::vector<double> & values,
@@ -204,19 +689,32 @@ void BaseNRSolver::fill_jacobian_matrix(const Eigen::SparseMatrix<cdouble> & Ybu
     J12 = dS_dVm[array([pvpq]).T, pq].real
     J21 = dS_dVa[array([pq]).T, pvpq].imag
     J22 = dS_dVm[array([pq]).T, pq].imag
+    With a distributed slack, the "P" row of the slack bus (see _init_distributed_slack) and the column of
+    the slack (see _fill_slack_column) are added at the end, and then the ones of the continuation
+    powerflow (see _fill_cpf_border).
     **/
 
     auto timer = CustTimer();
-    _dSbus_dV(Ybus, V);
-    Eigen::SparseMatrix<double> dS_dVa_r = dS_dVa_.real();
-    Eigen::SparseMatrix<double> dS_dVa_i = dS_dVa_.imag();
-    Eigen::SparseMatrix<double> dS_dVm_r = dS_dVm_.real();
-    Eigen::SparseMatrix<double> dS_dVm_i = dS_dVm_.imag();
+    if(_use_split_kernel(Ybus)){
+        _dSbus_dV_split(V);
+    }else{
+        _dSbus_dV(Ybus, V);
+        split_buffers_ok_ = false;  // they do not have the pattern of ybus_split_ anymore
+        dS_dVa_r_ = dS_dVa_.real();
+        dS_dVa_i_ = dS_dVa_.imag();
+        dS_dVm_r_ = dS_dVm_.real();
+        dS_dVm_i_ = dS_dVm_.imag();
+    }
+    const Eigen::SparseMatrix<double> & dS_dVa_r = dS_dVa_r_;
+    const Eigen::SparseMatrix<double> & dS_dVa_i = dS_dVa_i_;
+    const Eigen::SparseMatrix<double> & dS_dVm_r = dS_dVm_r_;
+    const Eigen::SparseMatrix<double> & dS_dVm_i = dS_dVm_i_;
 
     const int n_pvpq = pvpq.size();
     const int n_pq = pq.size();
 
-    const int size_j = n_pvpq + n_pq;
+    const bool distributed = slack_bus_ds_ >= 0;
+    const int size_j = n_pvpq + n_pq + (distributed ? 1 : 0) + (cpf_active_ ? 1 : 0);
 
     bool need_insert = false;  // i optimization: i don't need to insert the coefficient in the matrix
     if(J_.cols() != size_j)
@@ -227,11 +725,21 @@ void BaseNRSolver::fill_jacobian_matrix(const Eigen::SparseMatrix<cdouble> & Ybu
         need_insert = true;
         J_ = Eigen::SparseMatrix<double>(size_j,size_j);
         // pre allocate a large enough matrix
-        J_.reserve(2*(dS_dVa_.nonZeros()+dS_dVm_.nonZeros()));
+        J_.reserve(4*Ybus.nonZeros());
         // from an experiment, outerIndexPtr is inialized, with the number of columns
         // innerIndexPtr and valuePtr are not.
     }
 
+    // large grids, J already initialized: columns are filled in parallel (if openmp is available)
+    if(!need_insert && (size_j >= _parallel_min_size) && _fill_jacobian_values_parallel(dS_dVa_r, dS_dVa_i, dS_dVm_r, dS_dVm_i,
+                                                                                         pq, pvpq, pq_inv, pvpq_inv))
+    {
+        if(distributed) _fill_slack_column(pvpq_inv, n_pvpq + n_pq, false);
+        if(cpf_active_) _fill_cpf_border(pq, pq_inv, pvpq_inv, false);
+        timer_fillJ_ += timer.duration();
+        return;
+    }
+
     // i fill the buffer columns per columns
     int nb_obj_this_col = 0;
     std::vector<int> inner_index;
@@ -323,6 +831,244 @@ void BaseNRSolver::fill_jacobian_matrix(const Eigen::SparseMatrix<cdouble> & Ybu
 //                    }
 //                }
     }
+    if(distributed) _fill_slack_column(pvpq_inv, n_pvpq + n_pq, need_insert);
+    if(cpf_active_) _fill_cpf_border(pq, pq_inv, pvpq_inv, need_insert);
     J_.makeCompressed();
     timer_fillJ_ += timer.duration();
 }
+
+void BaseNRSolver::_fill_cpf_border(const Eigen::VectorXi & pq,
+                                    const std::vector<int> & pq_inv,
+                                    const std::vector<int> & pvpq_inv,
+                                    bool need_insert)
+{
+    /**
+    Column of lambda: derivative of the mismatch, ie -[real(Sdir)(pvpq), imag(Sdir)(pq)] (and real(Sdir) of the
+    slack bus for a distributed slack).
+    Last row: 1 for the continuation parameter, 0 for the others. Every candidate (lambda and the voltage
+    magnitudes of the pq buses) is in the sparsity pattern, so that it does not change when the parameter does.
+    **/
+    const int size_j = J_.cols();
+    const int lambda_col = size_j - 1;
+    const int n_pq = pq.size();
+    const int first_vm_col = size_j - 1 - n_pq - (slack_bus_ds_ >= 0 ? 1 : 0);
+    const int nb_bus = cpf_Sdir_.size();
+    const int n_pvpq = first_vm_col;
+    auto set_coeff = [&](int row_id, int col_id, double value){
+        if(need_insert) J_.insert(row_id, col_id) = value;
+        else J_.coeffRef(row_id, col_id) = value;
+    };
+    for(int bus_id = 0; bus_id < nb_bus; ++bus_id){
+        const cdouble s_dir = cpf_Sdir_(bus_id);
+        if((pvpq_inv[bus_id] >= 0) && (s_dir.real() != 0.)) set_coeff(pvpq_inv[bus_id], lambda_col, -s_dir.real());
+        if((pq_inv[bus_id] >= 0) && (s_dir.imag() != 0.)) set_coeff(n_pvpq + pq_inv[bus_id], lambda_col, -s_dir.imag());
+    }
+    for(int pq_id = 0; pq_id < n_pq; ++pq_id){
+        const int col_id = first_vm_col + pq_id;
+        set_coeff(lambda_col, col_id, col_id == cpf_param_ ? 1. : 0.);
+    }
+    set_coeff(lambda_col, lambda_col, lambda_col == cpf_param_ ? 1. : 0.);
+}
+
+bool BaseNRSolver::_cpf_tangent(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                const Eigen::VectorXi & pq,
+                                const Eigen::VectorXi & pvpq,
+                                const std::vector<int> & pq_inv,
+                                const std::vector<int> & pvpq_inv,
+                                const Eigen::VectorXd & previous,
+                                Eigen::VectorXd & tangent)
+{
+    // the tangent t verifies [J, dF/dlambda].t = 0, and t(parameter) = 1 (then it is normalized)
+    fill_jacobian_matrix(Ybus, V_, pq, pvpq, pq_inv, pvpq_inv);
+    bool has_just_been_inialized = false;
+    if(need_factorize_){
+        _initialize_linear();
+        if(err_ != 0) return false;
+        has_just_been_inialized = true;
+    }
+    const int size_j = J_.cols();
+    tangent = Eigen::VectorXd::Zero(size_j);
+    tangent(size_j - 1) = 1.;
+    _solve_linear(tangent, has_just_been_inialized);
+    if(err_ != 0 || !tangent.allFinite()) return false;
+    tangent.normalize();
+    const bool flip = previous.size() > 0 ? tangent.dot(previous) < 0. : tangent(size_j - 1) < 0.;
+    if(flip) tangent *= -1.;
+    return true;
+}
+
+bool BaseNRSolver::_cpf_correct(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                const Eigen::VectorXcd & Sbus,
+                                const Eigen::VectorXi & pv,
+                                const Eigen::VectorXi & pq,
+                                const Eigen::VectorXi & pvpq,
+                                const std::vector<int> & pq_inv,
+                                const std::vector<int> & pvpq_inv,
+                                double & lambda,
+                                double target,
+                                int max_iter,
+                                double tol,
+                                int & nb_iter)
+{
+    const int n_pv = pv.size();
+    const int n_pq = pq.size();
+    const int lambda_col = J_.cols() - 1;
+    const int first_vm_col = n_pv + n_pq;
+    nb_iter = 0;
+    while(true){
+        Eigen::VectorXd F = _evaluate_Fx(Ybus, V_, Sbus + lambda * cpf_Sdir_, pv, pq);
+        const int size_f = F.size();
+        Eigen::VectorXd dx(size_f + 1);
+        dx.segment(0, size_f) = F;
+        dx(size_f) = (cpf_param_ == lambda_col ? lambda : Vm_(pq(cpf_param_ - first_vm_col))) - target;
+        if(!dx.allFinite()) return false;
+        if(_check_for_convergence(dx, tol)) return true;
+        if(nb_iter >= max_iter) return false;
+        ++nb_iter;
+
+        fill_jacobian_matrix(Ybus, V_, pq, pvpq, pq_inv, pvpq_inv);
+        bool has_just_been_inialized = false;
+        if(need_factorize_){
+            _initialize_linear();
+            if(err_ != 0) return false;
+            has_just_been_inialized = true;
+        }
+        _solve_linear(dx, has_just_been_inialized);
+        if(err_ != 0) return false;
+        dx *= -1.;
+        Eigen::VectorXd Vm0 = V_.array().abs();
+        Eigen::VectorXd Va0 = V_.array().arg();
+        _update_V(Va0, Vm0, slack_p_, dx, 1.0, pv, pq);
+        lambda += dx(size_f);
+    }
+}
+
+BaseNRSolver::CPFRes BaseNRSolver::compute_cpf(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                               const Eigen::VectorXcd & Sbus,
+                                               const Eigen::VectorXcd & Sdir,
+                                               const Eigen::VectorXi & pv,
+                                               const Eigen::VectorXi & pq,
+                                               double step,
+                                               double min_step,
+                                               double max_step,
+                                               int max_nb_point,
+                                               bool stop_at_nose,
+                                               int max_iter,
+                                               double tol)
+{
+    if(V_.size() == 0) throw std::runtime_error("compute_cpf: no powerflow has been computed with this solver.");
+    if(err_ != 0) throw std::runtime_error("compute_cpf: the last powerflow did not converge.");
+    const int nb_bus = V_.size();
+    if(Sdir.size() != nb_bus) throw std::runtime_error("compute_cpf: Sdir should have as many components as the number of bus in the solver.");
+    if(!(min_step > 0.) || !(step >= min_step) || !(max_step >= step)){
+        throw std::runtime_error("compute_cpf: the step lengths should verify 0 < min_step <= step <= max_step.");
+    }
+    if(max_nb_point < 1) throw std::runtime_error("compute_cpf: max_nb_point should be >= 1.");
+
+    auto timer = CustTimer();
+    int n_pv = pv.size();
+    int n_pq = pq.size();
+    Eigen::VectorXi pvpq(n_pv + n_pq);
+    pvpq << pv, pq;
+    std::vector<int> pvpq_inv(nb_bus, -1);
+    for(int inv_id=0; inv_id < n_pv + n_pq; ++inv_id) pvpq_inv[pvpq(inv_id)] = inv_id;
+    std::vector<int> pq_inv(nb_bus, -1);
+    for(int inv_id=0; inv_id < n_pq; ++inv_id) pq_inv[pq(inv_id)] = inv_id;
+    if(slack_bus_ds_ >= 0) pvpq_inv[slack_bus_ds_] = n_pv + 2 * n_pq;
+    const int lambda_col = n_pv + 2 * n_pq + (slack_bus_ds_ >= 0 ? 1 : 0);
+    const int first_vm_col = n_pv + n_pq;
+
+    // starting point, restored at the end
+    const Eigen::VectorXcd V_start = V_;
+    const double slack_p_start = slack_p_;
+    std::vector<double> lambdas(1, 0.);
+    std::vector<Eigen::VectorXcd> voltages(1, V_start);
+    int nb_iter_total = 0;
+
+    // augmented jacobian matrix
+    cpf_active_ = true;
+    cpf_Sdir_ = Sdir;
+    cpf_param_ = lambda_col;
+    Eigen::SparseMatrix<double> J_start = std::move(J_);  // jacobian matrix of the powerflow (see get_J)
+    J_ = Eigen::SparseMatrix<double>();
+    need_factorize_ = true;
+
+    double lambda = 0.;
+    Eigen::VectorXd tangent;
+    bool ok = _cpf_tangent(Ybus, pq, pvpq, pq_inv, pvpq_inv, Eigen::VectorXd(), tangent);
+    double step_length = step;
+    bool nose_found = false;
+    while(ok && static_cast<int>(lambdas.size()) < max_nb_point){
+        // continuation parameter: largest component of the tangent (pivots of the last row change with it)
+        int param = lambda_col;
+        for(int pq_id = 0; pq_id < n_pq; ++pq_id){
+            if(std::abs(tangent(first_vm_col + pq_id)) > std::abs(tangent(param))) param = first_vm_col + pq_id;
+        }
+        if(param != cpf_param_){
+            cpf_param_ = param;
+            need_factorize_ = true;
+        }
+
+        // predictor
+        const Eigen::VectorXd Vm0 = V_.array().abs();
+        const Eigen::VectorXd Va0 = V_.array().arg();
+        const double slack_p0 = slack_p_;
+        const double lambda0 = lambda;
+        _update_V(Va0, Vm0, slack_p0, tangent, step_length, pv, pq);
+        lambda = lambda0 + step_length * tangent(lambda_col);
+        const double target = param == lambda_col ? lambda : Vm_(pq(param - first_vm_col));
+
+        // corrector
+        int nb_iter = 0;
+        bool conv = _cpf_correct(Ybus, Sbus, pv, pq, pvpq, pq_inv, pvpq_inv, lambda, target, max_iter, tol, nb_iter);
+        nb_iter_total += nb_iter;
+        Eigen::VectorXd new_tangent;
+        if(conv) conv = _cpf_tangent(Ybus, pq, pvpq, pq_inv, pvpq_inv, tangent, new_tangent);
+        // the nose is between the last point and this one: it is located more precisely first
+        bool refine_nose = conv && !nose_found && (tangent(lambda_col) > 0.) && (new_tangent(lambda_col) <= 0.) &&
+                           (step_length > min_step);
+        if(!conv || refine_nose){
+            // back to the last point, with a smaller step
+            _update_V(Va0, Vm0, slack_p0, tangent, 0., pv, pq);
+            lambda = lambda0;
+            if(err_ != 0){
+                err_ = 0;
+                need_factorize_ = true;  // the factorization might not be valid anymore
+            }
+            if(step_length <= min_step) break;
+            step_length = std::max(0.5 * step_length, min_step);
+            continue;
+        }
+        if(!nose_found && (tangent(lambda_col) > 0.) && (new_tangent(lambda_col) <= 0.)) nose_found = true;
+        if(lambda < 0.) break;  // back to the starting load factor
+        lambdas.push_back(lambda);
+        voltages.push_back(V_);
+        tangent = new_tangent;
+        if(nose_found && stop_at_nose) break;
+        if(nb_iter <= 2) step_length = std::min(2. * step_length, max_step);
+        else if(nb_iter >= 5) step_length = std::max(0.5 * step_length, min_step);
+    }
+
+    // back to the starting point (and to the jacobian matrix of the powerflow, that will be factorized again if needed)
+    cpf_active_ = false;
+    J_ = std::move(J_start);
+    need_factorize_ = true;
+    factorized_at_V_ = false;
+    err_ = 0;
+    V_ = V_start;
+    Vm_ = V_.array().abs();
+    Va_ = V_.array().arg();
+    slack_p_ = slack_p_start;
+
+    const int nb_point = lambdas.size();
+    Eigen::VectorXd res_lambda(nb_point);
+    Eigen::MatrixXcd res_V(nb_point, nb_bus);
+    int nose = 0;
+    for(int point_id = 0; point_id < nb_point; ++point_id){
+        res_lambda(point_id) = lambdas[point_id];
+        res_V.row(point_id) = voltages[point_id].transpose();
+        if(lambdas[point_id] > lambdas[nose]) nose = point_id;
+    }
+    timer_total_nr_ += timer.duration();
+    return CPFRes(res_lambda, res_V, nose, nb_iter_total);
+}
@@ -9,7 +9,28 @@
 #ifndef BASENRSOLVER_H
 #define BASENRSOLVER_H
 
+#include <algorithm>  // for std::max
+
 #include "BaseSolver.h"
+#include "SplitComplexSparseMatrix.h"
+
+// how the newton step is applied at each iteration
+// - FullStep: the full newton step is applied (default)
+// - Iwamoto: the step is multiplied by the "optimal multiplier" minimizing the quadratic expansion of the mismatch
+// - LineSearch: the step is halved until the mismatch decreases enough (backtracking)
+enum class StepControl { FullStep, Iwamoto, LineSearch};
+
+// how the products with Ybus (mismatch and dS_dV) are computed at each iteration
+// - Eigen: with the complex sparse matrix of Eigen (default)
+// - Split: with a copy of Ybus where the real and imaginary parts are split, with simd kernels (see SplitComplexSparseMatrix),
+//   kept (only its values are copied) as long as the sparsity pattern of Ybus does not change
+enum class SparseKernel { Eigen, Split};
+
+// precision of the linear systems of the newton raphson
+// - Double: the jacobian is factorized in double precision by the linear solver of the solver (default)
+// - Mixed: the jacobian is factorized in single precision (SparseLU of Eigen, whatever the solver) and each solution is
+//   refined with the residuals computed in double precision. The mismatch is always computed in double precision.
+enum class NRPrecision { Double, Mixed};
 
 /**
 Base class for Newton Raphson based solver
@@ -17,7 +38,9 @@ Base class for Newton Raphson based solver
 class BaseNRSolver : public BaseSolver
 {
     public:
-        BaseNRSolver():need_factorize_(true){
+        BaseNRSolver():need_factorize_(true),factorized_at_V_(false),ybus_modified_(false),step_control_(StepControl::FullStep),sparse_kernel_(SparseKernel::Eigen),split_buffers_ok_(false),
+                       precision_(NRPrecision::Double),tol_(1e-8),nb_refinement_(0),slack_bus_ds_(-1),slack_p_(0.),
+                       cpf_active_(false),cpf_param_(-1){
             timer_dSbus_ = 0.;
             timer_fillJ_ = 0.;
         }
@@ -51,6 +74,102 @@ class BaseNRSolver : public BaseSolver
         virtual
         void reset();
 
+        // step control is not modified by "reset"
+        void set_step_control(const StepControl & step_control) {step_control_ = step_control;}
+        StepControl get_step_control() const {return step_control_;}
+        // length of the step applied at each iteration of the last powerflow (always 1. for FullStep)
+        const std::vector<double> & get_step_lengths() const {return step_lengths_;}
+
+        // sparse kernel is not modified by "reset" either
+        void set_sparse_kernel(const SparseKernel & sparse_kernel) {sparse_kernel_ = sparse_kernel;}
+        SparseKernel get_sparse_kernel() const {return sparse_kernel_;}
+
+        // precision is not modified by "reset" either
+        void set_precision(const NRPrecision & precision) {precision_ = precision; need_factorize_ = true;}
+        NRPrecision get_precision() const {return precision_;}
+        // total number of refinement steps during the last powerflow (always 0 with NRPrecision::Double)
+        int get_nb_refinement() const {return nb_refinement_;}
+
+        /**
+        Distributed slack: the active power imbalance (losses included) is shared between the buses with a weight
+        (participation factor, one per bus of the solver, summing to 1) instead of being taken by the slack bus only.
+        The injection at bus k is Sbus(k) + p_slack * weights(k), where p_slack is an additional unknown of the
+        newton raphson, and the active power balance of the slack bus is an additional equation (one more row and
+        column in the jacobian matrix). Sbus(slack bus) should then be the real injection at the slack bus.
+        An empty vector means a single slack bus (default). It is not modified by "reset".
+        **/
+        void set_slack_weights(const Eigen::VectorXd & weights);
+        const Eigen::VectorXd & get_slack_weights() const {return slack_weights_;}
+        // active power shared by the buses (p_slack above) at the end of the last powerflow, in the unit of Sbus
+        double get_slack_p() const {return slack_p_;}
+
+        /**
+        Results of a previous powerflow computed with this Ybus, pv and pq, given back without any computation (see
+        GridModel::set_memo_size): the voltages, the jacobian matrix (factorized again only if needed, by predict_V
+        for example) and the distributed slack.
+        **/
+        void set_results(const Eigen::SparseMatrix<cdouble> & Ybus,
+                         const Eigen::VectorXcd & V,
+                         const Eigen::VectorXd & Vm,
+                         const Eigen::VectorXd & Va,
+                         const Eigen::VectorXi & pv,
+                         const Eigen::VectorXi & pq,
+                         const Eigen::SparseMatrix<double> & J,
+                         double slack_p);
+
+        /**
+        First order prediction of the complex voltages around the last state computed by this solver, for a batch
+        of injection deltas (one per row of delta_Sbus, columns being the solver bus ids).
+        It solves J.dx = dS with J the jacobian at the last converged state: it is filled and factorized by the
+        first call after a powerflow (the last factorization of the newton raphson is the one of the previous
+        iterate), and this factorization is re used by the next calls.
+        **/
+        Eigen::MatrixXcd predict_V(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                   const Eigen::MatrixXcd & delta_Sbus,
+                                   const Eigen::VectorXi & pv,
+                                   const Eigen::VectorXi & pq);
+
+        /**
+        Ybus has been modified in place (same sparsity pattern, see GridModel::change_tap_trafo for example) since the
+        last powerflow: the jacobian factorized for predict_V is not the one of this Ybus, and the last voltages are
+        no more a solution, so predict_V raises an error until the next powerflow.
+        **/
+        void ybus_modified() {factorized_at_V_ = false; ybus_modified_ = true;}
+
+        // points of a continuation powerflow: load factors, voltages (one row per point), index of the maximum
+        // load factor and total number of newton raphson iterations
+        typedef std::tuple<Eigen::VectorXd, Eigen::MatrixXcd, int, int> CPFRes;
+
+        /**
+        Continuation powerflow from the last state computed by this solver (that should have converged for Sbus)
+        along the injections Sbus + lambda * Sdir (solver bus ids), lambda starting at 0.
+
+        The unknowns are the ones of the newton raphson and lambda, the additional equation fixing the
+        "continuation parameter": lambda first, then the component (among lambda and the voltage magnitudes of
+        the pq buses) with the largest variation along the tangent of the curve, which switches to a voltage
+        magnitude near the maximum load factor (the "nose") where the jacobian matrix is singular.
+        Each point is predicted along the (normalized) tangent with a step length "step", corrected with the
+        newton raphson (at most max_iter iterations), and the step length adapted: doubled (up to max_step) after a
+        fast correction, halved (down to min_step) after a slow or diverging one. The nose is located up to min_step.
+
+        It stops after max_nb_point points (the starting one included), at the nose if stop_at_nose, or when
+        lambda is negative again (lower part of the curve). The augmented jacobian matrix keeps the same sparsity
+        pattern during the whole continuation: it is analyzed again only when the continuation parameter changes.
+        The state of the solver is the starting one at the end.
+        **/
+        CPFRes compute_cpf(const Eigen::SparseMatrix<cdouble> & Ybus,
+                           const Eigen::VectorXcd & Sbus,
+                           const Eigen::VectorXcd & Sdir,
+                           const Eigen::VectorXi & pv,
+                           const Eigen::VectorXi & pq,
+                           double step,
+                           double min_step,
+                           double max_step,
+                           int max_nb_point,
+                           bool stop_at_nose,
+                           int max_iter,
+                           double tol);
+
     protected:
         virtual
         void initialize()=0;
@@ -61,6 +180,73 @@ class BaseNRSolver : public BaseSolver
         void _dSbus_dV(const Eigen::Ref<const Eigen::SparseMatrix<cdouble> > & Ybus,
                        const Eigen::Ref<const Eigen::VectorXcd > & V);
 
+        /**
+        Same as BaseSolver::_evaluate_Fx, with the split copy of Ybus if the "Split" kernel is used (and it is a copy
+        of this Ybus). With a distributed slack, the mismatch of the active power at the slack bus is added at the
+        end (and Sbus is modified by the slack, see set_slack_weights).
+        **/
+        Eigen::VectorXd _evaluate_Fx(const Eigen::SparseMatrix<cdouble> &  Ybus,
+                                     const Eigen::VectorXcd & V,
+                                     const Eigen::VectorXcd & Sbus,
+                                     const Eigen::VectorXi & pv,
+                                     const Eigen::VectorXi & pq);
+
+        Eigen::VectorXd _evaluate_Fx_single_slack(const Eigen::SparseMatrix<cdouble> &  Ybus,
+                                                  const Eigen::VectorXcd & V,
+                                                  const Eigen::VectorXcd & Sbus,
+                                                  const Eigen::VectorXi & pv,
+                                                  const Eigen::VectorXi & pq);
+        // row of the slack bus in Ybus, and the row of its active power in pvpq_inv (distributed slack only)
+        void _init_distributed_slack(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                     const Eigen::VectorXi & pv,
+                                     const Eigen::VectorXi & pq,
+                                     std::vector<int> & pvpq_inv);
+        // column col_id of the jacobian matrix (derivative of the mismatch with respect to the slack)
+        void _fill_slack_column(const std::vector<int> & pvpq_inv, int col_id, bool need_insert);
+
+        // continuation powerflow: last row and column of the augmented jacobian matrix (see compute_cpf)
+        void _fill_cpf_border(const Eigen::VectorXi & pq,
+                              const std::vector<int> & pq_inv,
+                              const std::vector<int> & pvpq_inv,
+                              bool need_insert);
+        // tangent of the curve at the current state (normalized, oriented as "previous" or with lambda increasing)
+        bool _cpf_tangent(const Eigen::SparseMatrix<cdouble> & Ybus,
+                          const Eigen::VectorXi & pq,
+                          const Eigen::VectorXi & pvpq,
+                          const std::vector<int> & pq_inv,
+                          const std::vector<int> & pvpq_inv,
+                          const Eigen::VectorXd & previous,
+                          Eigen::VectorXd & tangent);
+        // newton raphson on the augmented system (the continuation parameter being equal to "target")
+        bool _cpf_correct(const Eigen::SparseMatrix<cdouble> & Ybus,
+                          const Eigen::VectorXcd & Sbus,
+                          const Eigen::VectorXi & pv,
+                          const Eigen::VectorXi & pq,
+                          const Eigen::VectorXi & pvpq,
+                          const std::vector<int> & pq_inv,
+                          const std::vector<int> & pvpq_inv,
+                          double & lambda,
+                          double target,
+                          int max_iter,
+                          double tol,
+                          int & nb_iter);
+
+        // copy Ybus in ybus_split_ (if the "Split" kernel is used), to be called when Ybus is given to the solver
+        // (only the values are copied if the sparsity pattern did not change)
+        void _init_split_kernel(const Eigen::SparseMatrix<cdouble> & Ybus);
+        bool _use_split_kernel(const Eigen::SparseMatrix<cdouble> & Ybus) const
+        {
+            return (sparse_kernel_ == SparseKernel::Split) && ybus_split_.is_copy_of(Ybus);
+        }
+        // fill dS_dVa_r_, dS_dVa_i_, dS_dVm_r_ and dS_dVm_i_ with the split kernel
+        void _dSbus_dV_split(const Eigen::VectorXcd & V);
+
+        // factorize J_ / solve J_.x = b with the linear solver of the solver or in mixed precision (see NRPrecision)
+        void _initialize_linear();
+        void _solve_linear(Eigen::VectorXd & b, bool has_just_been_inialized);
+        void _initialize_mixed();
+        void _solve_mixed(Eigen::VectorXd & b, bool has_just_been_inialized);
+
         void _get_values_J(int & nb_obj_this_col,
                            std::vector<int> & inner_index,
                            std::vector<double> & values,
@@ -79,13 +265,86 @@ class BaseNRSolver : public BaseSolver
                                   const std::vector<int> & pvpq_inv
                                   );
 
+        bool _fill_jacobian_values_parallel(const Eigen::SparseMatrix<double> & dS_dVa_r,
+                                            const Eigen::SparseMatrix<double> & dS_dVa_i,
+                                            const Eigen::SparseMatrix<double> & dS_dVm_r,
+                                            const Eigen::SparseMatrix<double> & dS_dVm_i,
+                                            const Eigen::VectorXi & pq,
+                                            const Eigen::VectorXi & pvpq,
+                                            const std::vector<int> & pq_inv,
+                                            const std::vector<int> & pvpq_inv);
+
+        /**
+        Update V_ (and Va_, Vm_) from Va0, Vm0 with the step "step_length * dx". dx is ordered as the mismatch vector.
+        The distributed slack (if any) is updated from slack_p0 the same way.
+        **/
+        void _update_V(const Eigen::VectorXd & Va0,
+                       const Eigen::VectorXd & Vm0,
+                       double slack_p0,
+                       const Eigen::VectorXd & dx,
+                       double step_length,
+                       const Eigen::VectorXi & pv,
+                       const Eigen::VectorXi & pq);
+
+        /**
+        Apply the newton direction dx (computed at V_ where the mismatch is F) with a step length chosen
+        according to step_control_. It returns the mismatch at the new V_.
+        **/
+        Eigen::VectorXd _controlled_step(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                         const Eigen::VectorXcd & Sbus,
+                                         const Eigen::VectorXi & pv,
+                                         const Eigen::VectorXi & pq,
+                                         const Eigen::VectorXd & F,
+                                         const Eigen::VectorXd & dx);
+
     protected:
 
         // solution of the problem
         Eigen::SparseMatrix<double> J_;  // the jacobian matrix
         Eigen::SparseMatrix<cdouble> dS_dVm_;
         Eigen::SparseMatrix<cdouble> dS_dVa_;
+        // real and imaginary parts of dS_dVa_ and dS_dVm_, used to fill the jacobian
+        Eigen::SparseMatrix<double> dS_dVa_r_;
+        Eigen::SparseMatrix<double> dS_dVa_i_;
+        Eigen::SparseMatrix<double> dS_dVm_r_;
+        Eigen::SparseMatrix<double> dS_dVm_i_;
         bool need_factorize_;
+        bool factorized_at_V_;  // the factorization is the one of the jacobian at V_ (see predict_V)
+        bool ybus_modified_;  // Ybus changed since the last powerflow (see ybus_modified)
+
+        // step control
+        StepControl step_control_;
+        std::vector<double> step_lengths_;
+        const double min_step_length_ = 1. / 64.;
+
+        // split copy of Ybus (and buffers for the voltages and currents)
+        SparseKernel sparse_kernel_;
+        SplitComplexSparseMatrix ybus_split_;
+        bool split_buffers_ok_;  // dS_dVa_r_... have the sparsity pattern of ybus_split_ (they are not modified by "reset")
+        Eigen::VectorXd V_re_, V_im_, I_re_, I_im_;
+
+        // mixed precision
+        NRPrecision precision_;
+        double tol_;  // tolerance of the last powerflow (the linear systems are solved a bit more accurately)
+        int nb_refinement_;
+        Eigen::SparseMatrix<float> J_float_;
+        Eigen::SparseLU<Eigen::SparseMatrix<float>, Eigen::COLAMDOrdering<int> > solver_float_;
+        static const int _max_refinement = 10;
+
+        // distributed slack
+        Eigen::VectorXd slack_weights_;  // empty for a single slack bus
+        int slack_bus_ds_;  // slack bus of the last powerflow if the slack is distributed, -1 otherwise
+        double slack_p_;
+        std::vector<int> ybus_slack_cols_;  // row of the slack bus in Ybus
+        std::vector<cdouble> ybus_slack_values_;
+
+        // continuation powerflow (see compute_cpf)
+        bool cpf_active_;  // the jacobian matrix is the augmented one
+        Eigen::VectorXcd cpf_Sdir_;
+        int cpf_param_;  // column of the continuation parameter in the augmented jacobian matrix
+
+        // the jacobian matrix (and dS_dV) are filled in parallel (if compiled with openmp) above this size
+        static const int _parallel_min_size = 5000;
 
         // timers
          double timer_initialize_;
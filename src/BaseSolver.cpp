@@ -23,6 +23,15 @@ void BaseSolver::reset(){
     err_ = -1; //error message:
 }
 
+void BaseSolver::set_results(const Eigen::VectorXcd & V, const Eigen::VectorXd & Vm, const Eigen::VectorXd & Va){
+    reset_timer();
+    V_ = V;
+    Vm_ = Vm;
+    Va_ = Va;
+    nr_iter_ = 0;
+    err_ = 0;
+}
+
 Eigen::VectorXd BaseSolver::_evaluate_Fx(const Eigen::SparseMatrix<cdouble> &  Ybus,
                                          const Eigen::VectorXcd & V,
                                          const Eigen::VectorXcd & Sbus,
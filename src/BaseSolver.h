@@ -79,6 +79,9 @@ class BaseSolver
         virtual
         void reset();
 
+        // results of a previous powerflow, given back without any computation (see GridModel::set_memo_size)
+        void set_results(const Eigen::VectorXcd & V, const Eigen::VectorXd & Vm, const Eigen::VectorXd & Va);
+
         bool converged(){
             return err_ == 0;
         }
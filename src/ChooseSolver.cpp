@@ -8,6 +8,8 @@
 
 #include "ChooseSolver.h"
 #include <iostream>
+#include <limits>
+#include <algorithm>
 // template specialization
 template<SolverType ST>
 Eigen::Ref<Eigen::VectorXcd> ChooseSolver::get_V_tmp()
@@ -39,6 +41,11 @@ Eigen::Ref<Eigen::VectorXcd> ChooseSolver::get_V_tmp<SolverType::DC>()
 {
     return _solver_dc.get_V();
 }
+template<>
+Eigen::Ref<Eigen::VectorXcd> ChooseSolver::get_V_tmp<SolverType::BackwardForwardSweep>()
+{
+    return _solver_bfs.get_V();
+}
 
 
 template<SolverType ST>
@@ -90,6 +97,18 @@ bool ChooseSolver::compute_pf_tmp<SolverType::DC>(const Eigen::SparseMatrix<cdou
     return _solver_dc.compute_pf(Ybus, V, Sbus, pv, pq, max_iter, tol);
 }
 template<>
+bool ChooseSolver::compute_pf_tmp<SolverType::BackwardForwardSweep>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                       Eigen::VectorXcd & V,
+                       const Eigen::VectorXcd & Sbus,
+                       const Eigen::VectorXi & pv,
+                       const Eigen::VectorXi & pq,
+                       int max_iter,
+                       double tol
+                       )
+{
+    return _solver_bfs.compute_pf(Ybus, V, Sbus, pv, pq, max_iter, tol);
+}
+template<>
 bool ChooseSolver::compute_pf_tmp<SolverType::KLU>(const Eigen::SparseMatrix<cdouble> & Ybus,
                        Eigen::VectorXcd & V,
                        const Eigen::VectorXcd & Sbus,
@@ -123,6 +142,11 @@ Eigen::SparseMatrix<double> ChooseSolver::get_J_tmp<SolverType::DC>()
     throw std::runtime_error("get_J: There is not Jacobian matrix for a DC powerflow.");
 }
 template<>
+Eigen::SparseMatrix<double> ChooseSolver::get_J_tmp<SolverType::BackwardForwardSweep>()
+{
+    return _solver_bfs.get_J();
+}
+template<>
 Eigen::SparseMatrix<double> ChooseSolver::get_J_tmp<SolverType::GaussSeidel>()
 {
     throw std::runtime_error("get_J: There is not Jacobian matrix for the GaussSeidel powerflow.");
@@ -159,6 +183,11 @@ Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Va_tmp<SolverType::DC>()
     return _solver_dc.get_Va();
 }
 template<>
+Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Va_tmp<SolverType::BackwardForwardSweep>()
+{
+    return _solver_bfs.get_Va();
+}
+template<>
 Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Va_tmp<SolverType::KLU>()
 {
     #ifndef KLU_SOLVER_AVAILABLE
@@ -184,6 +213,11 @@ Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Vm_tmp<SolverType::DC>()
     return _solver_dc.get_Vm();
 }
 template<>
+Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Vm_tmp<SolverType::BackwardForwardSweep>()
+{
+    return _solver_bfs.get_Vm();
+}
+template<>
 Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Vm_tmp<SolverType::GaussSeidel>()
 {
     return _solver_gaussseidel.get_Vm();
@@ -233,6 +267,103 @@ double ChooseSolver::get_computation_time_tmp<SolverType::DC>()
    const auto & res =  _solver_dc.get_timers();
    return std::get<3>(res);
 }
+template<>
+double ChooseSolver::get_computation_time_tmp<SolverType::BackwardForwardSweep>()
+{
+    const auto & res =  _solver_bfs.get_timers();
+    return std::get<3>(res);
+}
+
+template<SolverType ST>
+Eigen::MatrixXcd ChooseSolver::predict_V_tmp(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                             const Eigen::MatrixXcd & delta_Sbus,
+                                             const Eigen::VectorXi & pv,
+                                             const Eigen::VectorXi & pq)
+{
+    throw std::runtime_error("Unknown solver type.");
+}
+template<>
+Eigen::MatrixXcd ChooseSolver::predict_V_tmp<SolverType::SparseLU>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                                                   const Eigen::MatrixXcd & delta_Sbus,
+                                                                   const Eigen::VectorXi & pv,
+                                                                   const Eigen::VectorXi & pq)
+{
+    return _solver_lu.predict_V(Ybus, delta_Sbus, pv, pq);
+}
+template<>
+Eigen::MatrixXcd ChooseSolver::predict_V_tmp<SolverType::KLU>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                                              const Eigen::MatrixXcd & delta_Sbus,
+                                                              const Eigen::VectorXi & pv,
+                                                              const Eigen::VectorXi & pq)
+{
+    #ifndef KLU_SOLVER_AVAILABLE
+        // I asked result of KLU solver without the required libraries
+        throw std::runtime_error("predict_V: Impossible to use the KLU solver, that is not available on your plaform.");
+    #else
+        return _solver_klu.predict_V(Ybus, delta_Sbus, pv, pq);
+    #endif
+}
+template<>
+Eigen::MatrixXcd ChooseSolver::predict_V_tmp<SolverType::GaussSeidel>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                                                      const Eigen::MatrixXcd & delta_Sbus,
+                                                                      const Eigen::VectorXi & pv,
+                                                                      const Eigen::VectorXi & pq)
+{
+    throw std::runtime_error("predict_V: There is not Jacobian matrix for the GaussSeidel powerflow.");
+}
+template<>
+Eigen::MatrixXcd ChooseSolver::predict_V_tmp<SolverType::DC>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                                             const Eigen::MatrixXcd & delta_Sbus,
+                                                             const Eigen::VectorXi & pv,
+                                                             const Eigen::VectorXi & pq)
+{
+    throw std::runtime_error("predict_V: There is not Jacobian matrix for a DC powerflow.");
+}
+template<>
+Eigen::MatrixXcd ChooseSolver::predict_V_tmp<SolverType::BackwardForwardSweep>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                                                            const Eigen::MatrixXcd & delta_Sbus,
+                                                                            const Eigen::VectorXi & pv,
+                                                                            const Eigen::VectorXi & pq)
+{
+    // only possible if the newton raphson has been used (meshed grid)
+    return _solver_bfs.predict_V(Ybus, delta_Sbus, pv, pq);
+}
+template<SolverType ST>
+std::vector<double> ChooseSolver::get_step_lengths_tmp()
+{
+    throw std::runtime_error("Unknown solver type.");
+}
+template<>
+std::vector<double> ChooseSolver::get_step_lengths_tmp<SolverType::SparseLU>()
+{
+    return _solver_lu.get_step_lengths();
+}
+template<>
+std::vector<double> ChooseSolver::get_step_lengths_tmp<SolverType::KLU>()
+{
+    #ifndef KLU_SOLVER_AVAILABLE
+        // I asked result of KLU solver without the required libraries
+        throw std::runtime_error("get_step_lengths: Impossible to use the KLU solver, that is not available on your plaform.");
+    #else
+        return _solver_klu.get_step_lengths();
+    #endif
+}
+template<>
+std::vector<double> ChooseSolver::get_step_lengths_tmp<SolverType::GaussSeidel>()
+{
+    throw std::runtime_error("get_step_lengths: There is no newton step for the GaussSeidel powerflow.");
+}
+template<>
+std::vector<double> ChooseSolver::get_step_lengths_tmp<SolverType::DC>()
+{
+    throw std::runtime_error("get_step_lengths: There is no newton step for a DC powerflow.");
+}
+template<>
+std::vector<double> ChooseSolver::get_step_lengths_tmp<SolverType::BackwardForwardSweep>()
+{
+    return _solver_bfs.get_step_lengths();
+}
+
 //TODO refactor all the functions above by making a template function "get_solver"
 
 // function definition
@@ -247,6 +378,8 @@ Eigen::Ref<Eigen::VectorXcd> ChooseSolver::get_V(){
          return get_V_tmp<SolverType::GaussSeidel>();
     }else if(_solver_type == SolverType::DC){
          return get_V_tmp<SolverType::DC>();
+    }else if(_solver_type == SolverType::BackwardForwardSweep){
+         return get_V_tmp<SolverType::BackwardForwardSweep>();
     }else{
         throw std::runtime_error("Unknown solver type.");
     }
@@ -263,6 +396,8 @@ Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Va(){
          return get_Va_tmp<SolverType::GaussSeidel>();
     }else if(_solver_type == SolverType::DC){
          return get_Va_tmp<SolverType::DC>();
+    }else if(_solver_type == SolverType::BackwardForwardSweep){
+         return get_Va_tmp<SolverType::BackwardForwardSweep>();
     }else{
         throw std::runtime_error("Unknown solver type.");
     }
@@ -278,6 +413,8 @@ Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Vm(){
          return get_Vm_tmp<SolverType::GaussSeidel>();
     }else if(_solver_type == SolverType::DC){
          return get_Vm_tmp<SolverType::DC>();
+    }else if(_solver_type == SolverType::BackwardForwardSweep){
+         return get_Vm_tmp<SolverType::BackwardForwardSweep>();
     }else{
         throw std::runtime_error("Unknown solver type.");
     }
@@ -292,19 +429,222 @@ bool ChooseSolver::compute_pf(const Eigen::SparseMatrix<cdouble> & Ybus,
                               double tol
                               )
 {
+    if(_has_type_to_restore) change_solver(_type_to_restore);
+    if(_auto_mode){
+        _solver_type = auto_choose(Ybus.cols());
+        if(_solver_type == SolverType::GaussSeidel) max_iter *= _auto_gs_iter_factor;
+    }
     _type_used_for_nr = _solver_type;
+    if(is_slack_distributed() &&
+       ((_solver_type == SolverType::GaussSeidel) || (_solver_type == SolverType::BackwardForwardSweep))){
+        throw std::runtime_error("compute_pf: the distributed slack is only available for the newton raphson solvers (and the DC one).");
+    }
+    bool conv = false;
     if(_solver_type == SolverType::SparseLU)
     {
-        return compute_pf_tmp<SolverType::SparseLU>(Ybus, V, Sbus, pv, pq, max_iter, tol);
+        conv = compute_pf_tmp<SolverType::SparseLU>(Ybus, V, Sbus, pv, pq, max_iter, tol);
     }else if(_solver_type == SolverType::KLU){
-        return compute_pf_tmp<SolverType::KLU>(Ybus, V, Sbus, pv, pq, max_iter, tol);
+        conv = compute_pf_tmp<SolverType::KLU>(Ybus, V, Sbus, pv, pq, max_iter, tol);
     }else if(_solver_type == SolverType::GaussSeidel){
-        return compute_pf_tmp<SolverType::GaussSeidel>(Ybus, V, Sbus, pv, pq, max_iter, tol);
+        conv = compute_pf_tmp<SolverType::GaussSeidel>(Ybus, V, Sbus, pv, pq, max_iter, tol);
     }else if(_solver_type == SolverType::DC){
-        return compute_pf_tmp<SolverType::DC>(Ybus, V, Sbus, pv, pq, max_iter, tol);
+        conv = compute_pf_tmp<SolverType::DC>(Ybus, V, Sbus, pv, pq, max_iter, tol);
+    }else if(_solver_type == SolverType::BackwardForwardSweep){
+        conv = compute_pf_tmp<SolverType::BackwardForwardSweep>(Ybus, V, Sbus, pv, pq, max_iter, tol);
     }else{
         throw std::runtime_error("Unknown solver type.");
     }
+    if(_auto_mode){
+        auto_update(_solver_type, conv);
+        if(!conv && (_solver_type == SolverType::GaussSeidel)){
+            // gauss seidel is not used anymore, and i don't want the powerflow to fail because of this test
+            max_iter /= _auto_gs_iter_factor;
+            return compute_pf(Ybus, V, Sbus, pv, pq, max_iter, tol);
+        }
+    }
+    return conv;
+}
+
+void ChooseSolver::reset_auto()
+{
+    int nb_type = static_cast<int>(SolverType::Auto);
+    _auto_nb_call = 0;
+    _auto_nb_sample = std::vector<int>(nb_type, 0);
+    _auto_mean_time = std::vector<double>(nb_type, 0.);
+    _auto_mean_iter = std::vector<double>(nb_type, 0.);
+    _auto_log.clear();
+}
+
+std::vector<SolverType> ChooseSolver::auto_candidates(int nb_bus) const
+{
+    std::vector<SolverType> res;
+    #ifdef KLU_SOLVER_AVAILABLE
+        res.push_back(SolverType::KLU);
+    #endif
+    res.push_back(SolverType::SparseLU);
+    if((nb_bus <= _auto_gs_max_bus) && !is_slack_distributed()) res.push_back(SolverType::GaussSeidel);
+    return res;
+}
+
+double ChooseSolver::get_slack_p() const
+{
+    if(_type_used_for_nr == SolverType::SparseLU) return _solver_lu.get_slack_p();
+    #ifdef KLU_SOLVER_AVAILABLE
+        if(_type_used_for_nr == SolverType::KLU) return _solver_klu.get_slack_p();
+    #endif  // KLU_SOLVER_AVAILABLE
+    return 0.;
+}
+
+SolverType ChooseSolver::auto_choose(int nb_bus)
+{
+    /**
+    Candidates are first used "_auto_nb_explore" times each. Then the fastest one (on average) is used.
+    A diverging candidate is never used again (its average time is infinite).
+
+    The inputs are the size of the grid (see "auto_candidates"), the time spent in each solver and its number of
+    iterations (see "auto_expected_time"). The frequency of the topology changes is not one of them: every ac powerflow builds
+    Ybus and the jacobian matrix (and its symbolic analysis) again, so the times measured already include this cost.
+    **/
+    ++_auto_nb_call;
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<SolverType> candidates = auto_candidates(nb_bus);
+    SolverType current = _solver_type;
+    if(std::find(candidates.begin(), candidates.end(), current) == candidates.end()) current = candidates[0];
+
+    SolverType res = current;
+    std::string reason = "";
+    SolverType least_used = current;
+    SolverType fastest = current;
+    for(const auto & type : candidates){
+        int type_id = static_cast<int>(type);
+        if(_auto_mean_time[type_id] == inf) continue;
+        if(_auto_nb_sample[type_id] < _auto_nb_sample[static_cast<int>(least_used)]) least_used = type;
+        if(auto_expected_time(type, current) < auto_expected_time(fastest, current)) fastest = type;
+    }
+    double time_fastest = auto_expected_time(fastest, current);
+    double time_current = auto_expected_time(current, current);
+    int least_used_id = static_cast<int>(least_used);
+    if(_auto_nb_sample[least_used_id] < _auto_nb_explore){
+        res = least_used;
+        reason = "exploration";
+    }else if((_auto_nb_call % _auto_refresh == 0) && (least_used != current)){
+        res = least_used;
+        reason = "refresh";
+    }else if(time_fastest < (1. - _auto_min_gain) * time_current){
+        res = fastest;
+        reason = "faster: " + std::to_string(time_fastest) + "s vs " + std::to_string(time_current) + "s expected (" +
+                 std::to_string(_auto_mean_iter[static_cast<int>(fastest)]) + " vs " +
+                 std::to_string(_auto_mean_iter[static_cast<int>(current)]) + " iterations on average)";
+    }else if(time_current == inf){
+        res = fastest;
+        reason = "divergence";
+    }
+    // only the changes are logged
+    if(_auto_log.empty() || (std::get<1>(_auto_log.back()) != res)){
+        if(reason.empty()) reason = "initial choice";
+        _auto_log.push_back(std::make_tuple(_auto_nb_call, res, reason));
+    }
+    return res;
+}
+
+void ChooseSolver::auto_update(SolverType type, bool conv)
+{
+    int type_id = static_cast<int>(type);
+    BaseSolver & solver = get_solver(type);
+    if(!conv){
+        // this solver will not be chosen anymore (unless it is the only one)
+        _auto_mean_time[type_id] = std::numeric_limits<double>::infinity();
+        ++_auto_nb_sample[type_id];
+        return;
+    }
+    double time = std::get<3>(solver.get_timers());
+    double nb_iter = solver.get_nb_iter();
+    if(_auto_nb_sample[type_id] == 0){
+        _auto_mean_time[type_id] = time;
+        _auto_mean_iter[type_id] = nb_iter;
+    }else{
+        _auto_mean_time[type_id] = (1. - _auto_alpha) * _auto_mean_time[type_id] + _auto_alpha * time;
+        _auto_mean_iter[type_id] = (1. - _auto_alpha) * _auto_mean_iter[type_id] + _auto_alpha * nb_iter;
+    }
+    ++_auto_nb_sample[type_id];
+}
+
+double ChooseSolver::auto_expected_time(SolverType type, SolverType current)
+{
+    /**
+    Time the next powerflow should take with "type".
+
+    The newton raphson solvers (KLU and SparseLU) perform the same iterations from the same starting point, they only
+    differ by the time of each one. They are then compared with their average time per iteration, multiplied by the
+    average number of iterations of the solver currently used (which reflects the last powerflows). This way, a
+    candidate explored on powerflows that needed more (or less) iterations than the current ones is not penalized
+    (or favored). Gauss Seidel iterations are not comparable: its average time is used as is.
+    **/
+    int type_id = static_cast<int>(type);
+    double mean_time = _auto_mean_time[type_id];
+    if(type == current) return mean_time;
+    if((mean_time == std::numeric_limits<double>::infinity()) ||
+       (get_nr_solver(type) == nullptr) ||
+       (get_nr_solver(current) == nullptr)) return mean_time;
+    // a powerflow can converge without any iteration (nothing changed since the last one)
+    double time_per_iter = mean_time / std::max(_auto_mean_iter[type_id], 1.);
+    return time_per_iter * std::max(_auto_mean_iter[static_cast<int>(current)], 1.);
+}
+
+BaseSolver & ChooseSolver::get_solver(SolverType type)
+{
+    if(type == SolverType::SparseLU) return _solver_lu;
+    if(type == SolverType::GaussSeidel) return _solver_gaussseidel;
+    if(type == SolverType::DC) return _solver_dc;
+    if(type == SolverType::BackwardForwardSweep) return _solver_bfs;
+    #ifdef KLU_SOLVER_AVAILABLE
+        if(type == SolverType::KLU) return _solver_klu;
+    #endif
+    throw std::runtime_error("get_solver: Unknown or unavailable solver type.");
+}
+
+BaseNRSolver * ChooseSolver::get_nr_solver(SolverType type)
+{
+    if(type == SolverType::SparseLU) return &_solver_lu;
+    #ifdef KLU_SOLVER_AVAILABLE
+        if(type == SolverType::KLU) return &_solver_klu;
+    #endif
+    return nullptr;
+}
+
+SolverResults ChooseSolver::get_results()
+{
+    check_right_solver();
+    SolverResults res;
+    res.type = _type_used_for_nr;
+    res.V = get_V();
+    res.Vm = get_Vm();
+    res.Va = get_Va();
+    BaseNRSolver * nr_solver = get_nr_solver(_type_used_for_nr);
+    if(nr_solver != nullptr) res.J = nr_solver->get_J();
+    res.slack_weights = _solver_lu.get_slack_weights();
+    res.slack_p = get_slack_p();
+    return res;
+}
+
+void ChooseSolver::restore_results(const SolverResults & results,
+                                   const Eigen::SparseMatrix<cdouble> & Ybus,
+                                   const Eigen::VectorXi & pv,
+                                   const Eigen::VectorXi & pq)
+{
+    SolverType type = get_type();
+    change_solver(results.type);
+    _type_used_for_nr = results.type;
+    set_slack_weights(results.slack_weights);
+    BaseNRSolver * nr_solver = get_nr_solver(results.type);
+    if(nr_solver != nullptr){
+        nr_solver->set_results(Ybus, results.V, results.Vm, results.Va, pv, pq, results.J, results.slack_p);
+    }else{
+        BaseSolver & solver = get_solver(results.type);
+        solver.reset();
+        solver.set_results(results.V, results.Vm, results.Va);
+    }
+    restore_solver_at_next_pf(type);
 }
 
 Eigen::SparseMatrix<double> ChooseSolver::get_J(){
@@ -318,6 +658,8 @@ Eigen::SparseMatrix<double> ChooseSolver::get_J(){
          return get_J_tmp<SolverType::GaussSeidel>();
     }else if(_solver_type == SolverType::DC){
          return get_J_tmp<SolverType::DC>();
+    }else if(_solver_type == SolverType::BackwardForwardSweep){
+         return get_J_tmp<SolverType::BackwardForwardSweep>();
     }else{
         throw std::runtime_error("Unknown solver type.");
     }
@@ -335,7 +677,76 @@ double ChooseSolver::get_computation_time()
          return get_computation_time_tmp<SolverType::GaussSeidel>();
     }else if(_solver_type == SolverType::DC){
          return get_computation_time_tmp<SolverType::DC>();
+    }else if(_solver_type == SolverType::BackwardForwardSweep){
+         return get_computation_time_tmp<SolverType::BackwardForwardSweep>();
+    }else{
+        throw std::runtime_error("Unknown solver type.");
+    }
+}
+
+Eigen::MatrixXcd ChooseSolver::predict_V(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                         const Eigen::MatrixXcd & delta_Sbus,
+                                         const Eigen::VectorXi & pv,
+                                         const Eigen::VectorXi & pq)
+{
+    check_right_solver();
+    if(_solver_type == SolverType::SparseLU)
+    {
+         return predict_V_tmp<SolverType::SparseLU>(Ybus, delta_Sbus, pv, pq);
+    }else if(_solver_type == SolverType::KLU){
+         return predict_V_tmp<SolverType::KLU>(Ybus, delta_Sbus, pv, pq);
+    }else if(_solver_type == SolverType::GaussSeidel){
+         return predict_V_tmp<SolverType::GaussSeidel>(Ybus, delta_Sbus, pv, pq);
+    }else if(_solver_type == SolverType::DC){
+         return predict_V_tmp<SolverType::DC>(Ybus, delta_Sbus, pv, pq);
+    }else if(_solver_type == SolverType::BackwardForwardSweep){
+         return predict_V_tmp<SolverType::BackwardForwardSweep>(Ybus, delta_Sbus, pv, pq);
     }else{
         throw std::runtime_error("Unknown solver type.");
     }
 }
+
+std::vector<double> ChooseSolver::get_step_lengths()
+{
+    check_right_solver();
+    if(_solver_type == SolverType::SparseLU)
+    {
+         return get_step_lengths_tmp<SolverType::SparseLU>();
+    }else if(_solver_type == SolverType::KLU){
+         return get_step_lengths_tmp<SolverType::KLU>();
+    }else if(_solver_type == SolverType::GaussSeidel){
+         return get_step_lengths_tmp<SolverType::GaussSeidel>();
+    }else if(_solver_type == SolverType::DC){
+         return get_step_lengths_tmp<SolverType::DC>();
+    }else if(_solver_type == SolverType::BackwardForwardSweep){
+         return get_step_lengths_tmp<SolverType::BackwardForwardSweep>();
+    }else{
+        throw std::runtime_error("Unknown solver type.");
+    }
+}
+
+BaseNRSolver::CPFRes ChooseSolver::compute_cpf(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                               const Eigen::VectorXcd & Sbus,
+                                               const Eigen::VectorXcd & Sdir,
+                                               const Eigen::VectorXi & pv,
+                                               const Eigen::VectorXi & pq,
+                                               double step,
+                                               double min_step,
+                                               double max_step,
+                                               int max_nb_point,
+                                               bool stop_at_nose,
+                                               int max_iter,
+                                               double tol)
+{
+    check_right_solver();
+    if(_solver_type == SolverType::SparseLU){
+        return _solver_lu.compute_cpf(Ybus, Sbus, Sdir, pv, pq, step, min_step, max_step, max_nb_point, stop_at_nose, max_iter, tol);
+    }else if(_solver_type == SolverType::KLU){
+        #ifndef KLU_SOLVER_AVAILABLE
+            throw std::runtime_error("compute_cpf: Impossible to use the KLU solver, that is not available on your plaform.");
+        #else
+            return _solver_klu.compute_cpf(Ybus, Sbus, Sdir, pv, pq, step, min_step, max_step, max_nb_point, stop_at_nose, max_iter, tol);
+        #endif
+    }
+    throw std::runtime_error("compute_cpf: the continuation powerflow is only available for the newton raphson solvers (SparseLU and KLU).");
+}
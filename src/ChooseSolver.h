@@ -10,16 +10,32 @@
 #define CHOOSESOLVER_H
 
 #include<vector>
+#include<tuple>
+#include<string>
 
 // import newton raphson solvers using different linear algebra solvers
 #include "KLUSolver.h"
 #include "SparseLUSolver.h"
 #include "GaussSeidelSolver.h"
 #include "DCSolver.h"
+#include "BackwardForwardSweepSolver.h"
+#include "KLUParameters.h"
 
-enum class SolverType { SparseLU, KLU, GaussSeidel, DC};
+// "Auto" is not a solver by itself: the (ac) solver is chosen automatically among the others, see "ChooseSolver::auto_choose"
+enum class SolverType { SparseLU, KLU, GaussSeidel, DC, BackwardForwardSweep, Auto};
 
 
+// results of a powerflow, in the solver bus ids (see ChooseSolver::get_results)
+struct SolverResults
+{
+    SolverType type;  // solver that computed them
+    Eigen::VectorXcd V;
+    Eigen::VectorXd Vm, Va;
+    Eigen::SparseMatrix<double> J;  // empty if this solver has no jacobian matrix
+    Eigen::VectorXd slack_weights;  // of the buses (distributed slack)
+    double slack_p;
+};
+
 // NB: when adding a new solver, you need to specialize the *tmp method (eg get_Va_tmp)
 // and also to "forward" the specialisation (adding the if(solvertype==XXX)) in the compute_pf, get_V, get_J, get_Va, get_Vm
 // and the "available_solvers" (add it to the list)
@@ -27,7 +43,9 @@ enum class SolverType { SparseLU, KLU, GaussSeidel, DC};
 class ChooseSolver
 {
     public:
-         ChooseSolver():_solver_type(SolverType::SparseLU),_type_used_for_nr(SolverType::SparseLU){};
+         ChooseSolver():_solver_type(SolverType::SparseLU),_type_used_for_nr(SolverType::SparseLU),_has_type_to_restore(false),_type_to_restore(SolverType::SparseLU),_auto_mode(false){
+            reset_auto();
+         };
 
         std::vector<SolverType> available_solvers()
         {
@@ -35,14 +53,28 @@ class ChooseSolver
             res.push_back(SolverType::SparseLU);
             res.push_back(SolverType::GaussSeidel);
             res.push_back(SolverType::DC);
+            res.push_back(SolverType::BackwardForwardSweep);
             #ifdef KLU_SOLVER_AVAILABLE
                 res.push_back(SolverType::KLU);
             #endif
+            res.push_back(SolverType::Auto);
             return res;
         }
-        SolverType get_type() const {return _solver_type;}
+        SolverType get_type() const
+        {
+            if(_has_type_to_restore) return _type_to_restore;
+            return _auto_mode ? SolverType::Auto : _solver_type;
+        }
         void change_solver(const SolverType & type)
         {
+            _has_type_to_restore = false;
+            if(type == SolverType::Auto){
+                // the solver actually used will be chosen at the next powerflow
+                // (statistics of the previous calls are kept: "dc_pf" for example changes the solver temporarily)
+                _auto_mode = true;
+                return;
+            }
+            _auto_mode = false;
             if(type == _solver_type) return;
             #ifndef KLU_SOLVER_AVAILABLE
                 // TODO better handling of that :-/
@@ -50,17 +82,114 @@ class ChooseSolver
             #endif
             _solver_type = type;
         }
+        // solver really used to perform the last powerflow (never "Auto")
+        SolverType get_type_used() const {return _type_used_for_nr;}
+        // the solver currently used (eg by a recovery stage) is kept, so that its results can still be retrieved
+        // (get_V, get_J...), and "type" is used again from the next powerflow on (unless change_solver is called
+        // in between)
+        void restore_solver_at_next_pf(const SolverType & type)
+        {
+            if(type == get_type()) return;
+            _type_to_restore = type;
+            _has_type_to_restore = true;
+        }
+
+        // results of the last (converged) powerflow, that can be given back later by "restore_results" for the same
+        // Ybus, pv and pq (see GridModel::set_memo_size). The solver that computed them is used until the next powerflow.
+        bool has_results() {return _solver_type == _type_used_for_nr && get_solver(_type_used_for_nr).converged();}
+        SolverResults get_results();
+        void restore_results(const SolverResults & results,
+                             const Eigen::SparseMatrix<cdouble> & Ybus,
+                             const Eigen::VectorXi & pv,
+                             const Eigen::VectorXi & pq);
+
+        // decisions taken in "Auto" mode: (powerflow number, solver chosen, reason)
+        const std::vector<std::tuple<int, SolverType, std::string> > & get_auto_log() const {return _auto_log;}
+        // step control of the newton raphson solvers (not used by the other solvers)
+        void set_step_control(const StepControl & step_control)
+        {
+            _solver_lu.set_step_control(step_control);
+            #ifdef KLU_SOLVER_AVAILABLE
+                _solver_klu.set_step_control(step_control);
+            #endif  // KLU_SOLVER_AVAILABLE
+        }
+        StepControl get_step_control() const {return _solver_lu.get_step_control();}
+        // sparse kernel of the newton raphson solvers (not used by the other solvers)
+        void set_sparse_kernel(const SparseKernel & sparse_kernel)
+        {
+            _solver_lu.set_sparse_kernel(sparse_kernel);
+            #ifdef KLU_SOLVER_AVAILABLE
+                _solver_klu.set_sparse_kernel(sparse_kernel);
+            #endif  // KLU_SOLVER_AVAILABLE
+        }
+        SparseKernel get_sparse_kernel() const {return _solver_lu.get_sparse_kernel();}
+        // precision of the linear systems of the newton raphson solvers (not used by the other solvers)
+        void set_precision(const NRPrecision & precision)
+        {
+            _solver_lu.set_precision(precision);
+            #ifdef KLU_SOLVER_AVAILABLE
+                _solver_klu.set_precision(precision);
+            #endif  // KLU_SOLVER_AVAILABLE
+        }
+        NRPrecision get_precision() const {return _solver_lu.get_precision();}
+        // parameters of the factorizations made by the "KLU" solver (kept even if KLU is not available)
+        void set_klu_parameters(const KLUParameters & parameters)
+        {
+            parameters.check();
+            _klu_parameters = parameters;
+            #ifdef KLU_SOLVER_AVAILABLE
+                _solver_klu.set_parameters(parameters);
+            #endif  // KLU_SOLVER_AVAILABLE
+        }
+        const KLUParameters & get_klu_parameters() const {return _klu_parameters;}
+        // see KLUSolver::benchmark_parameters and KLUSolver::default_candidates (an error is raised if KLU is not available)
+        std::vector<std::tuple<KLUParameters, double, double> >
+            benchmark_klu_parameters(const Eigen::SparseMatrix<double> & J,
+                                     const std::vector<KLUParameters> & candidates,
+                                     int nb_refactor,
+                                     int nb_repeat) const
+        {
+            #ifdef KLU_SOLVER_AVAILABLE
+                return KLUSolver::benchmark_parameters(J, candidates.empty() ? KLUSolver::default_candidates() : candidates,
+                                                       nb_refactor, nb_repeat);
+            #else
+                throw std::runtime_error("Impossible to tune the KLU solver, that is not available on your platform.");
+            #endif  // KLU_SOLVER_AVAILABLE
+        }
+        // distributed slack of the newton raphson solvers, see BaseNRSolver::set_slack_weights (the other ac solvers
+        // do not support it)
+        void set_slack_weights(const Eigen::VectorXd & weights)
+        {
+            _solver_lu.set_slack_weights(weights);
+            #ifdef KLU_SOLVER_AVAILABLE
+                _solver_klu.set_slack_weights(weights);
+            #endif  // KLU_SOLVER_AVAILABLE
+        }
+        bool is_slack_distributed() const {return _solver_lu.get_slack_weights().size() > 0;}
+        // active power shared by the buses during the last powerflow (0. if the slack is not distributed)
+        double get_slack_p() const;
+
         void reset()
         {
             // reset all the solvers available
             _solver_lu.reset();
             _solver_gaussseidel.reset();
             _solver_dc.reset();
+            _solver_bfs.reset();
             #ifdef KLU_SOLVER_AVAILABLE
                 _solver_klu.reset();
             #endif  // KLU_SOLVER_AVAILABLE
         }
 
+        // Ybus has been modified in place since the last powerflow (see BaseNRSolver::ybus_modified)
+        void ybus_modified()
+        {
+            _solver_lu.ybus_modified();
+            #ifdef KLU_SOLVER_AVAILABLE
+                _solver_klu.ybus_modified();
+            #endif  // KLU_SOLVER_AVAILABLE
+        }
+
         // forward to the right solver used
         //TODO inline all of that
         bool compute_pf(const Eigen::SparseMatrix<cdouble> & Ybus,
@@ -76,8 +205,35 @@ class ChooseSolver
         Eigen::Ref<Eigen::VectorXd> get_Va();
         Eigen::Ref<Eigen::VectorXd> get_Vm();
         double get_computation_time();
+        std::vector<double> get_step_lengths();
+        Eigen::MatrixXcd predict_V(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                   const Eigen::MatrixXcd & delta_Sbus,
+                                   const Eigen::VectorXi & pv,
+                                   const Eigen::VectorXi & pq);
+        // see BaseNRSolver::compute_cpf (only for the newton raphson solvers)
+        BaseNRSolver::CPFRes compute_cpf(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                         const Eigen::VectorXcd & Sbus,
+                                         const Eigen::VectorXcd & Sdir,
+                                         const Eigen::VectorXi & pv,
+                                         const Eigen::VectorXi & pq,
+                                         double step,
+                                         double min_step,
+                                         double max_step,
+                                         int max_nb_point,
+                                         bool stop_at_nose,
+                                         int max_iter,
+                                         double tol);
 
     private:
+        // automatic choice of the solver
+        void reset_auto();
+        std::vector<SolverType> auto_candidates(int nb_bus) const;
+        SolverType auto_choose(int nb_bus);
+        void auto_update(SolverType type, bool conv);
+        double auto_expected_time(SolverType type, SolverType current);
+        BaseSolver & get_solver(SolverType type);
+        BaseNRSolver * get_nr_solver(SolverType type);  // nullptr if it is not a newton raphson solver
+
         void check_right_solver()
         {
             if(_solver_type != _type_used_for_nr) throw std::runtime_error("Solver mismatch between the performing of the newton raphson and the retrieval of the result.");
@@ -98,6 +254,15 @@ class ChooseSolver
         template<SolverType ST>
         double get_computation_time_tmp();
 
+        template<SolverType ST>
+        std::vector<double> get_step_lengths_tmp();
+
+        template<SolverType ST>
+        Eigen::MatrixXcd predict_V_tmp(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                       const Eigen::MatrixXcd & delta_Sbus,
+                                       const Eigen::VectorXi & pv,
+                                       const Eigen::VectorXi & pq);
+
         template<SolverType ST>
         bool compute_pf_tmp(const Eigen::SparseMatrix<cdouble> & Ybus,
                             Eigen::VectorXcd & V,
@@ -111,15 +276,33 @@ class ChooseSolver
     protected:
         SolverType _solver_type;
         SolverType _type_used_for_nr;
+        bool _has_type_to_restore;  // see restore_solver_at_next_pf
+        SolverType _type_to_restore;
 
         // all types
         SparseLUSolver _solver_lu;
         GaussSeidelSolver _solver_gaussseidel;
         DCSolver _solver_dc;
+        BackwardForwardSweepSolver _solver_bfs;
         #ifdef KLU_SOLVER_AVAILABLE
             KLUSolver _solver_klu;
         #endif  // KLU_SOLVER_AVAILABLE
+        KLUParameters _klu_parameters;
 
+        // "Auto" mode
+        bool _auto_mode;
+        int _auto_nb_call;
+        std::vector<int> _auto_nb_sample;  // indexed by the solver type
+        std::vector<double> _auto_mean_time;  // exponential moving average of the time spent in the solver (s)
+        std::vector<double> _auto_mean_iter;  // exponential moving average of the number of iterations
+        std::vector<std::tuple<int, SolverType, std::string> > _auto_log;
+
+        static const int _auto_nb_explore = 2;  // each candidate is used this number of times before being compared
+        static const int _auto_refresh = 100;  // every "_auto_refresh" powerflow, the least used candidate is tried again
+        static const int _auto_gs_max_bus = 30;  // gauss seidel is considered only for grids smaller than this
+        static const int _auto_gs_iter_factor = 1000;  // max_iter is given for newton raphson, gauss seidel needs much more
+        static constexpr double _auto_alpha = 0.2;  // weight of the last powerflow in the moving averages
+        static constexpr double _auto_min_gain = 0.1;  // a solver is changed only if the other one is 10% faster
 };
 
 
@@ -133,6 +316,8 @@ template<>
 Eigen::Ref<Eigen::VectorXcd> ChooseSolver::get_V_tmp<SolverType::GaussSeidel>();
 template<>
 Eigen::Ref<Eigen::VectorXcd> ChooseSolver::get_V_tmp<SolverType::DC>();
+template<>
+Eigen::Ref<Eigen::VectorXcd> ChooseSolver::get_V_tmp<SolverType::BackwardForwardSweep>();
 
 template<>
 bool ChooseSolver::compute_pf_tmp<SolverType::SparseLU>(const Eigen::SparseMatrix<cdouble> & Ybus,
@@ -170,6 +355,15 @@ bool ChooseSolver::compute_pf_tmp<SolverType::DC>(const Eigen::SparseMatrix<cdou
                        int max_iter,
                        double tol
                        );
+template<>
+bool ChooseSolver::compute_pf_tmp<SolverType::BackwardForwardSweep>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                      Eigen::VectorXcd & V,
+                                      const Eigen::VectorXcd & Sbus,
+                                      const Eigen::VectorXi & pv,
+                                      const Eigen::VectorXi & pq,
+                                      int max_iter,
+                                      double tol
+                                      );
 
 template<>
 Eigen::SparseMatrix<double> ChooseSolver::get_J_tmp<SolverType::SparseLU>();
@@ -179,6 +373,8 @@ template<>
 Eigen::SparseMatrix<double> ChooseSolver::get_J_tmp<SolverType::GaussSeidel>();
 template<>
 Eigen::SparseMatrix<double> ChooseSolver::get_J_tmp<SolverType::DC>();
+template<>
+Eigen::SparseMatrix<double> ChooseSolver::get_J_tmp<SolverType::BackwardForwardSweep>();
 
 template<>
 Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Va_tmp<SolverType::SparseLU>();
@@ -189,6 +385,8 @@ Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Va_tmp<SolverType::GaussSeidel>();
 template<>
 Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Va_tmp<SolverType::DC>();
 template<>
+Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Va_tmp<SolverType::BackwardForwardSweep>();
+template<>
 Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Vm_tmp<SolverType::SparseLU>();
 template<>
 Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Vm_tmp<SolverType::KLU>();
@@ -197,10 +395,51 @@ Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Vm_tmp<SolverType::GaussSeidel>();
 template<>
 Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Vm_tmp<SolverType::DC>();
 template<>
+Eigen::Ref<Eigen::VectorXd> ChooseSolver::get_Vm_tmp<SolverType::BackwardForwardSweep>();
+template<>
 double ChooseSolver::get_computation_time_tmp<SolverType::KLU>();
 template<>
 double ChooseSolver::get_computation_time_tmp<SolverType::GaussSeidel>();
 template<>
 double ChooseSolver::get_computation_time_tmp<SolverType::DC>();
+template<>
+double ChooseSolver::get_computation_time_tmp<SolverType::BackwardForwardSweep>();
+
+template<>
+std::vector<double> ChooseSolver::get_step_lengths_tmp<SolverType::SparseLU>();
+template<>
+std::vector<double> ChooseSolver::get_step_lengths_tmp<SolverType::KLU>();
+template<>
+std::vector<double> ChooseSolver::get_step_lengths_tmp<SolverType::GaussSeidel>();
+template<>
+std::vector<double> ChooseSolver::get_step_lengths_tmp<SolverType::DC>();
+template<>
+std::vector<double> ChooseSolver::get_step_lengths_tmp<SolverType::BackwardForwardSweep>();
+
+template<>
+Eigen::MatrixXcd ChooseSolver::predict_V_tmp<SolverType::SparseLU>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                                                   const Eigen::MatrixXcd & delta_Sbus,
+                                                                   const Eigen::VectorXi & pv,
+                                                                   const Eigen::VectorXi & pq);
+template<>
+Eigen::MatrixXcd ChooseSolver::predict_V_tmp<SolverType::KLU>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                                              const Eigen::MatrixXcd & delta_Sbus,
+                                                              const Eigen::VectorXi & pv,
+                                                              const Eigen::VectorXi & pq);
+template<>
+Eigen::MatrixXcd ChooseSolver::predict_V_tmp<SolverType::GaussSeidel>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                                                      const Eigen::MatrixXcd & delta_Sbus,
+                                                                      const Eigen::VectorXi & pv,
+                                                                      const Eigen::VectorXi & pq);
+template<>
+Eigen::MatrixXcd ChooseSolver::predict_V_tmp<SolverType::DC>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                                             const Eigen::MatrixXcd & delta_Sbus,
+                                                             const Eigen::VectorXi & pv,
+                                                             const Eigen::VectorXi & pq);
+template<>
+Eigen::MatrixXcd ChooseSolver::predict_V_tmp<SolverType::BackwardForwardSweep>(const Eigen::SparseMatrix<cdouble> & Ybus,
+                                                                            const Eigen::MatrixXcd & delta_Sbus,
+                                                                            const Eigen::VectorXi & pv,
+                                                                            const Eigen::VectorXi & pq);
 
 #endif  //CHOOSESOLVER_H
@@ -139,6 +139,7 @@ void DataGen::change_p(int gen_id, double new_p, bool & need_reset)
 {
     bool my_status = status_.at(gen_id); // and this check that load_id is not out of bound
     if(!my_status) throw std::runtime_error("Impossible to change the active value of a disconnected generator");
+    if(undo_log_) undo_log_->save(p_mw_, gen_id);
     p_mw_(gen_id) = new_p;
 }
 
@@ -146,6 +147,7 @@ void DataGen::change_v(int gen_id, double new_v_pu, bool & need_reset)
 {
     bool my_status = status_.at(gen_id); // and this check that load_id is not out of bound
     if(!my_status) throw std::runtime_error("Impossible to change the voltage setpoint of a disconnected generator");
+    if(undo_log_) undo_log_->save(vm_pu_, gen_id);
     vm_pu_(gen_id) = new_v_pu;
 }
 
@@ -191,6 +193,16 @@ void DataGen::set_p_slack(int slack_bus_id, double p_slack){
     res_p_(slack_bus_id) = p_slack;
 }
 
+void DataGen::add_p_distributed_slack(const Eigen::VectorXd & weights, double p_slack, int gen_slackbus){
+    // the slack generator gets its share with set_p_slack (active power balance of the slack bus)
+    int nb_gen = nb();
+    for(int gen_id = 0; gen_id < nb_gen; ++gen_id){
+        if(!status_[gen_id]) continue;
+        if(gen_id == gen_slackbus) continue;
+        res_p_(gen_id) += weights(gen_id) * p_slack;
+    }
+}
+
 void DataGen::init_q_vector(int nb_bus)
 {
     int nb_gen = nb();
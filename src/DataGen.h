@@ -69,6 +69,8 @@ class DataGen: public DataGeneric
     void set_q(const std::vector<double> & q_by_bus);
     int get_slack_bus_id(int gen_id);
     virtual void set_p_slack(int slack_bus_id, double p_slack);
+    // adds weights(gen) * p_slack to the active power of the generators (but the slack one) for a distributed slack
+    void add_p_distributed_slack(const Eigen::VectorXd & weights, double p_slack, int gen_slackbus);
 
     void get_vm_for_dc(Eigen::VectorXd & Vm);
     /**
@@ -78,7 +80,11 @@ class DataGen: public DataGeneric
     void set_vm(Eigen::VectorXcd & V, const std::vector<int> & id_grid_to_solver);
 
     tuple3d get_res() const {return tuple3d(res_p_, res_q_, res_v_);}
+    void set_res(const tuple3d & res) {std::tie(res_p_, res_q_, res_v_) = res;}  // restore results given by get_res
     const std::vector<bool>& get_status() const {return status_;}
+    const Eigen::VectorXd & get_p() const {return p_mw_;}
+    const Eigen::VectorXi & get_bus_id() const {return bus_id_;}
+    const Eigen::VectorXd & get_vm() const {return vm_pu_;}
 
     void cout_v(){
         for(const auto & el : vm_pu_){
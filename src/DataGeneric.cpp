@@ -26,14 +26,33 @@ void DataGeneric::_get_amps(Eigen::VectorXd & a, const Eigen::VectorXd & p, cons
     }
     a = p2q2.array() * _1_sqrt_3 / v_tmp.array();
 }
+void UndoLog::rollback(const Mark & mark)
+{
+    while(bool_entries_.size() > std::get<0>(mark)){
+        const auto & entry = bool_entries_.back();
+        (*std::get<0>(entry))[std::get<1>(entry)] = std::get<2>(entry);
+        bool_entries_.pop_back();
+    }
+    while(int_entries_.size() > std::get<1>(mark)){
+        *std::get<0>(int_entries_.back()) = std::get<1>(int_entries_.back());
+        int_entries_.pop_back();
+    }
+    while(double_entries_.size() > std::get<2>(mark)){
+        *std::get<0>(double_entries_.back()) = std::get<1>(double_entries_.back());
+        double_entries_.pop_back();
+    }
+}
+
 void DataGeneric::_reactivate(int el_id, std::vector<bool> & status, bool & need_reset){
     bool val = status.at(el_id);
     if(!val) need_reset = true;  // I need to recompute the grid, if a status has changed
+    if(!val && undo_log_) undo_log_->save(status, el_id);
     status.at(el_id) = true;  //TODO why it's needed to do that again
 }
 void DataGeneric::_deactivate(int el_id, std::vector<bool> & status, bool & need_reset){
     bool val = status.at(el_id);
     if(val) need_reset = true;  // I need to recompute the grid, if a status has changed
+    if(val && undo_log_) undo_log_->save(status, el_id);
     status.at(el_id) = false;  //TODO why it's needed to do that again
 }
 void DataGeneric::_change_bus(int el_id, int new_bus_me_id, Eigen::VectorXi & el_bus_ids, bool & need_reset, int nb_bus){
@@ -46,6 +65,7 @@ void DataGeneric::_change_bus(int el_id, int new_bus_me_id, Eigen::VectorXi & el
     if(new_bus_me_id < 0) throw std::out_of_range("change_bus: negative bus id");
     int & bus_me_id = el_bus_ids(el_id);
     if(bus_me_id != new_bus_me_id) need_reset = true;  // in this case i changed the bus, i need to recompute the jacobian and reset the solver
+    if((bus_me_id != new_bus_me_id) && undo_log_) undo_log_->save(el_bus_ids, el_id);
     bus_me_id = new_bus_me_id;
 }
 
@@ -9,6 +9,9 @@
 #ifndef DATAGENERIC_H
 #define DATAGENERIC_H
 
+#include <vector>
+#include <tuple>
+
 #include "Eigen/Core"
 #include "Eigen/Dense"
 #include "Eigen/SparseCore"
@@ -16,12 +19,48 @@
 
 #include "Utils.h"
 
+/**
+Previous values of the data of the elements modified since a checkpoint (see GridModel::begin), so that they can be
+restored. Entries point directly to the modified values: the data must not be reallocated (resized) while the log
+is in use.
+**/
+class UndoLog
+{
+    public:
+        // position in the log (number of entries of each type)
+        typedef std::tuple<size_t, size_t, size_t> Mark;
+
+        // save the current value, before it is modified
+        void save(std::vector<bool> & values, int el_id) {bool_entries_.push_back(std::make_tuple(&values, el_id, static_cast<bool>(values[el_id])));}
+        void save(Eigen::VectorXi & values, int el_id) {int_entries_.push_back(std::make_tuple(&values(el_id), values(el_id)));}
+        void save(Eigen::VectorXd & values, int el_id) {double_entries_.push_back(std::make_tuple(&values(el_id), values(el_id)));}
+
+        Mark mark() const {return Mark(bool_entries_.size(), int_entries_.size(), double_entries_.size());}
+        size_t size() const {return bool_entries_.size() + int_entries_.size() + double_entries_.size();}
+
+        // restore the values saved after "mark" (most recent first) and remove them from the log
+        void rollback(const Mark & mark);
+        void clear() {bool_entries_.clear(); int_entries_.clear(); double_entries_.clear();}
+
+    protected:
+        std::vector<std::tuple<std::vector<bool> *, int, bool> > bool_entries_;
+        std::vector<std::tuple<int *, int> > int_entries_;
+        std::vector<std::tuple<double *, double> > double_entries_;
+};
+
 /**
 Base class for every object that can be manipulated
 **/
 class DataGeneric
 {
     public:
+        DataGeneric():undo_log_(nullptr){}
+        // the undo log is specific to each grid: it is not copied
+        DataGeneric(const DataGeneric &):undo_log_(nullptr){}
+        DataGeneric & operator=(const DataGeneric &) {return *this;}
+
+        // the modifications are saved in undo_log (if not nullptr) before being made
+        void set_undo_log(UndoLog * undo_log) {undo_log_ = undo_log;}
 
         virtual void fillYbus(std::vector<Eigen::Triplet<cdouble> > & res, bool ac, const std::vector<int> & id_grid_to_solver) {};
         virtual void fillYbus(Eigen::SparseMatrix<cdouble> & res, bool ac, const std::vector<int> & id_grid_to_solver) {};
@@ -37,6 +76,7 @@ class DataGeneric
     protected:
         static const int _deactivated_bus_id;
         static const cdouble my_i;
+        UndoLog * undo_log_;
 
         /**
         activation / deactivation of elements
@@ -169,6 +169,43 @@ void DataLine::fillYbus_spmat(Eigen::SparseMatrix<cdouble> & res, bool ac, const
     }
 }
 
+void DataLine::compute_flows_or(const Eigen::Ref<const Eigen::VectorXcd> & V,
+                                const std::vector<int> & id_grid_to_solver,
+                                const Eigen::VectorXd & bus_vn_kv,
+                                Eigen::VectorXd & p_or,
+                                Eigen::VectorXd & a_or)
+{
+    int nb_element = nb();
+    p_or = Eigen::VectorXd::Constant(nb_element, 0.0);  // in MW
+    Eigen::VectorXd q_or = Eigen::VectorXd::Constant(nb_element, 0.0);  // in MVar
+    Eigen::VectorXd v_or = Eigen::VectorXd::Constant(nb_element, 0.0);  // in kV
+    for(int line_id = 0; line_id < nb_element; ++line_id){
+        // don't do anything if the element is disconnected
+        if(!status_[line_id]) continue;
+
+        double r = powerlines_r_(line_id);
+        double x = powerlines_x_(line_id);
+        cdouble h = my_i * 0.5 * powerlines_h_(line_id);
+        cdouble y = 1.0 / (r + my_i * x);
+
+        int bus_or_id_me = bus_or_id_(line_id);
+        int bus_or_solver_id = id_grid_to_solver[bus_or_id_me];
+        int bus_ex_solver_id = id_grid_to_solver[bus_ex_id_(line_id)];
+        if((bus_or_solver_id == _deactivated_bus_id) || (bus_ex_solver_id == _deactivated_bus_id)){
+            throw std::runtime_error("DataLine::compute_flows_or: A powerline is connected to a disconnected bus.");
+        }
+
+        cdouble Eor = V(bus_or_solver_id);
+        cdouble Eex = V(bus_ex_solver_id);
+        cdouble s_orex = Eor * std::conj((y + h) * Eor - y * Eex);
+
+        p_or(line_id) = std::real(s_orex);
+        q_or(line_id) = std::imag(s_orex);
+        v_or(line_id) = std::abs(Eor) * bus_vn_kv(bus_or_id_me);
+    }
+    _get_amps(a_or, p_or, q_or, v_or);
+}
+
 void DataLine::reset_results()
 {
     res_powerline_por_ = Eigen::VectorXd();  // in MW
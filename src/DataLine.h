@@ -72,13 +72,32 @@ class DataLine : public DataGeneric
                          const Eigen::Ref<Eigen::VectorXcd> & V,
                          const std::vector<int> & id_grid_to_solver,
                          const Eigen::VectorXd & bus_vn_kv);
+    /**
+    Computes the active power (MW) and current (kA) at the origin side of each powerline for the complex voltages V
+    (given in the solver bus ids). Contrary to "compute_results" the internal results are not modified.
+    **/
+    void compute_flows_or(const Eigen::Ref<const Eigen::VectorXcd> & V,
+                          const std::vector<int> & id_grid_to_solver,
+                          const Eigen::VectorXd & bus_vn_kv,
+                          Eigen::VectorXd & p_or,
+                          Eigen::VectorXd & a_or);
     void reset_results();
     virtual double get_p_slack(int slack_bus_id);
     virtual void get_q(std::vector<double>& q_by_bus);
 
     tuple4d get_lineor_res() const {return tuple4d(res_powerline_por_, res_powerline_qor_, res_powerline_vor_, res_powerline_aor_);}
     tuple4d get_lineex_res() const {return tuple4d(res_powerline_pex_, res_powerline_qex_, res_powerline_vex_, res_powerline_aex_);}
+    // restore results given by get_lineor_res and get_lineex_res
+    void set_res(const tuple4d & res_or, const tuple4d & res_ex){
+        std::tie(res_powerline_por_, res_powerline_qor_, res_powerline_vor_, res_powerline_aor_) = res_or;
+        std::tie(res_powerline_pex_, res_powerline_qex_, res_powerline_vex_, res_powerline_aex_) = res_ex;
+    }
     const std::vector<bool>& get_status() const {return status_;}
+    // raw data, regardless of the status of the powerlines (r and x in pu)
+    const Eigen::VectorXi & get_bus_or_id() const {return bus_or_id_;}
+    const Eigen::VectorXi & get_bus_ex_id() const {return bus_ex_id_;}
+    const Eigen::VectorXd & get_r() const {return powerlines_r_;}
+    const Eigen::VectorXd & get_x() const {return powerlines_x_;}
 
     protected:
         // physical properties
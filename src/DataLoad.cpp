@@ -87,6 +87,7 @@ void DataLoad::change_p(int load_id, double new_p, bool & need_reset)
 {
     bool my_status = status_.at(load_id); // and this check that load_id is not out of bound
     if(!my_status) throw std::runtime_error("Impossible to change the active value of a disconnected load");
+    if(undo_log_) undo_log_->save(p_mw_, load_id);
     p_mw_(load_id) = new_p;
 }
 
@@ -94,6 +95,7 @@ void DataLoad::change_q(int load_id, double new_q, bool & need_reset)
 {
     bool my_status = status_.at(load_id); // and this check that load_id is not out of bound
     if(!my_status) throw std::runtime_error("Impossible to change the reactive value of a disconnected load");
+    if(undo_log_) undo_log_->save(q_mvar_, load_id);
     q_mvar_(load_id) = new_q;
 }
 
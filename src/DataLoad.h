@@ -63,7 +63,11 @@ class DataLoad : public DataGeneric
     virtual void get_q(std::vector<double>& q_by_bus);
 
     tuple3d get_res() const {return tuple3d(res_p_, res_q_, res_v_);}
+    void set_res(const tuple3d & res) {std::tie(res_p_, res_q_, res_v_) = res;}  // restore results given by get_res
     const std::vector<bool>& get_status() const {return status_;}
+    const Eigen::VectorXd & get_p() const {return p_mw_;}
+    const Eigen::VectorXd & get_q() const {return q_mvar_;}
+    const Eigen::VectorXi & get_bus_id() const {return bus_id_;}
 
     protected:
         // physical properties
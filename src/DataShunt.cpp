@@ -82,6 +82,23 @@ void DataShunt::fillYbus_spmat(Eigen::SparseMatrix<cdouble> & res, bool ac, cons
     }
 }
 
+void DataShunt::update_Ybus(Eigen::SparseMatrix<cdouble> & Ybus,
+                            int shunt_id,
+                            double old_p,
+                            double old_q,
+                            const std::vector<int> & id_grid_to_solver)
+{
+    if(!status_.at(shunt_id)) return;  // the shunt is not in Ybus
+    int bus_id_solver = id_grid_to_solver[bus_id_(shunt_id)];
+    if(bus_id_solver == _deactivated_bus_id){
+        throw std::runtime_error("DataShunt::update_Ybus: A shunt is connected to a disconnected bus.");
+    }
+    // same coefficient as in fillYbus: the sparsity pattern is not modified
+    cdouble old_tmp = old_p + my_i * old_q;
+    cdouble new_tmp = p_mw_(shunt_id) + my_i * q_mvar_(shunt_id);
+    Ybus.coeffRef(bus_id_solver, bus_id_solver) -= new_tmp - old_tmp;
+}
+
 void DataShunt::compute_results(const Eigen::Ref<Eigen::VectorXd> & Va,
                                const Eigen::Ref<Eigen::VectorXd> & Vm,
                                const Eigen::Ref<Eigen::VectorXcd> & V,
@@ -120,6 +137,7 @@ void DataShunt::change_p(int shunt_id, double new_p, bool & need_reset)
     bool my_status = status_.at(shunt_id); // and this check that load_id is not out of bound
     if(!my_status) throw std::runtime_error("Impossible to change the active value of a disconnected shunt");
     if(p_mw_(shunt_id) != new_p) need_reset = true;
+    if(undo_log_) undo_log_->save(p_mw_, shunt_id);
     p_mw_(shunt_id) = new_p;
 
 }
@@ -129,6 +147,7 @@ void DataShunt::change_q(int shunt_id, double new_q, bool & need_reset)
     bool my_status = status_.at(shunt_id); // and this check that load_id is not out of bound
     if(!my_status) throw std::runtime_error("Impossible to change the reactive value of a disconnected shunt");
     if(q_mvar_(shunt_id) != new_q) need_reset = true;
+    if(undo_log_) undo_log_->save(q_mvar_, shunt_id);
     q_mvar_(shunt_id) = new_q;
 }
 
@@ -50,6 +50,12 @@ class DataShunt : public DataGeneric
 
     virtual void fillYbus(std::vector<Eigen::Triplet<cdouble> > & res, bool ac, const std::vector<int> & id_grid_to_solver);
     virtual void fillYbus_spmat(Eigen::SparseMatrix<cdouble> & res, bool ac, const std::vector<int> & id_grid_to_solver);
+    // updates (in place) the diagonal coefficient of the shunt in Ybus after its p or q changed, see change_p / change_q
+    void update_Ybus(Eigen::SparseMatrix<cdouble> & Ybus,
+                     int shunt_id,
+                     double old_p,
+                     double old_q,
+                     const std::vector<int> & id_grid_to_solver);
 
     void compute_results(const Eigen::Ref<Eigen::VectorXd> & Va,
                          const Eigen::Ref<Eigen::VectorXd> & Vm,
@@ -61,7 +67,11 @@ class DataShunt : public DataGeneric
     virtual void get_q(std::vector<double>& q_by_bus);
 
     tuple3d get_res() const {return tuple3d(res_p_, res_q_, res_v_);}
+    void set_res(const tuple3d & res) {std::tie(res_p_, res_q_, res_v_) = res;}  // restore results given by get_res
     const std::vector<bool>& get_status() const {return status_;}
+    const Eigen::VectorXd & get_p_mw() const {return p_mw_;}
+    const Eigen::VectorXd & get_q_mvar() const {return q_mvar_;}
+    const Eigen::VectorXi & get_bus_id() const {return bus_id_;}
 
     protected:
         // physical properties
@@ -30,6 +30,9 @@ void DataTrafo::init(const Eigen::VectorXd & trafo_r,
     x_ = trafo_x;
     h_ = trafo_b;
     ratio_ = ratio;
+    tap_step_pct_ = trafo_tap_step_pct;
+    tap_pos_ = trafo_tap_pos;
+    tap_hv_ = std::vector<bool>(trafo_tap_hv.begin(), trafo_tap_hv.end());
     bus_hv_id_ = trafo_hv_id;
     bus_lv_id_ = trafo_lv_id;
     status_ = std::vector<bool>(trafo_r.size(), true);
@@ -44,7 +47,9 @@ DataTrafo::StateRes DataTrafo::get_state() const
      std::vector<int > bus_lv_id(bus_lv_id_.begin(), bus_lv_id_.end());
      std::vector<bool> status = status_;
      std::vector<double> ratio(ratio_.begin(), ratio_.end());
-     DataTrafo::StateRes res(branch_r, branch_x, branch_h, bus_hv_id, bus_lv_id, status, ratio);
+     std::vector<double> tap_step_pct(tap_step_pct_.begin(), tap_step_pct_.end());
+     std::vector<double> tap_pos(tap_pos_.begin(), tap_pos_.end());
+     DataTrafo::StateRes res(branch_r, branch_x, branch_h, bus_hv_id, bus_lv_id, status, ratio, tap_step_pct, tap_pos, tap_hv_);
      return res;
 }
 void DataTrafo::set_state(DataTrafo::StateRes & my_state)
@@ -58,6 +63,9 @@ void DataTrafo::set_state(DataTrafo::StateRes & my_state)
     std::vector<int> & bus_lv_id = std::get<4>(my_state);
     std::vector<bool> & status = std::get<5>(my_state);
     std::vector<double> & ratio = std::get<6>(my_state);
+    std::vector<double> & tap_step_pct = std::get<7>(my_state);
+    std::vector<double> & tap_pos = std::get<8>(my_state);
+    std::vector<bool> & tap_hv = std::get<9>(my_state);
     // TODO check sizes
 
     // now assign the values
@@ -70,6 +78,9 @@ void DataTrafo::set_state(DataTrafo::StateRes & my_state)
     bus_lv_id_ = Eigen::VectorXi::Map(&bus_lv_id[0], bus_lv_id.size());
     status_ = status;
     ratio_  = Eigen::VectorXd::Map(&ratio[0], ratio.size());
+    tap_step_pct_ = Eigen::VectorXd::Map(&tap_step_pct[0], tap_step_pct.size());
+    tap_pos_ = Eigen::VectorXd::Map(&tap_pos[0], tap_pos.size());
+    tap_hv_ = tap_hv;
 }
 
 void DataTrafo::fillYbus_spmat(Eigen::SparseMatrix<cdouble> & res, bool ac, const std::vector<int> & id_grid_to_solver)
@@ -93,37 +104,12 @@ void DataTrafo::fillYbus_spmat(Eigen::SparseMatrix<cdouble> & res, bool ac, cons
             throw std::runtime_error("DataModel::fillYbusTrafo: A trafo is connected (lv) to a disconnected bus.");
         }
 
-        // get the transformers ratio
-        double r = ratio_(trafo_id);
-
-        // subsecptance
-        cdouble h = 0.;
-        if(ac){
-            h = h_(trafo_id);
-            h = my_i * 0.5 * h;
-        }
-
-        // admittance
-        cdouble y = 0.;
-        cdouble z = x_(trafo_id);
-        if(ac){
-            z *= my_i;
-            z += r_(trafo_id);
-        }
-        if(z != 0.) y = 1.0 / z;
-
-        // fill non diagonal coefficient
-        cdouble tmp = y / r;
-        res.coeffRef(bus_hv_solver_id, bus_lv_solver_id) -= tmp ;
-        res.coeffRef(bus_lv_solver_id, bus_hv_solver_id) -= tmp;
-
-        // fill diagonal coefficient
-        if(!ac){
-            r = 1.0; // in dc, r = 1.0 here (same voltage both side)
-        }
-        tmp += h;
-        res.coeffRef(bus_hv_solver_id, bus_hv_solver_id) += tmp / r ;
-        res.coeffRef(bus_lv_solver_id, bus_lv_solver_id) += tmp * r;
+        cdouble y_ft, y_hh, y_ll;
+        get_ybus_coeffs(trafo_id, ratio_(trafo_id), ac, y_ft, y_hh, y_ll);
+        res.coeffRef(bus_hv_solver_id, bus_lv_solver_id) += y_ft;
+        res.coeffRef(bus_lv_solver_id, bus_hv_solver_id) += y_ft;
+        res.coeffRef(bus_hv_solver_id, bus_hv_solver_id) += y_hh;
+        res.coeffRef(bus_lv_solver_id, bus_lv_solver_id) += y_ll;
     }
 }
 
@@ -148,38 +134,90 @@ void DataTrafo::fillYbus(std::vector<Eigen::Triplet<cdouble> > & res, bool ac, c
             throw std::runtime_error("DataModel::fillYbusTrafo: A trafo is connected (lv) to a disconnected bus.");
         }
 
-        // get the transformers ratio
-        double r = ratio_(trafo_id);
+        cdouble y_ft, y_hh, y_ll;
+        get_ybus_coeffs(trafo_id, ratio_(trafo_id), ac, y_ft, y_hh, y_ll);
+        res.push_back(Eigen::Triplet<cdouble> (bus_hv_solver_id, bus_lv_solver_id, y_ft));
+        res.push_back(Eigen::Triplet<cdouble> (bus_lv_solver_id, bus_hv_solver_id, y_ft));
+        res.push_back(Eigen::Triplet<cdouble>(bus_hv_solver_id, bus_hv_solver_id, y_hh));
+        res.push_back(Eigen::Triplet<cdouble>(bus_lv_solver_id, bus_lv_solver_id, y_ll));
+    }
+}
 
-        // subsecptance
-        cdouble h = 0.;
-        if(ac){
-            h = h_(trafo_id);
-            h = my_i * 0.5 * h;
-        }
+void DataTrafo::get_ybus_coeffs(int trafo_id, double ratio, bool ac, cdouble & y_ft, cdouble & y_hh, cdouble & y_ll) const
+{
+    // get the transformers ratio
+    double r = ratio;
+
+    // subsecptance
+    cdouble h = 0.;
+    if(ac){
+        h = h_(trafo_id);
+        h = my_i * 0.5 * h;
+    }
 
-        // admittance
-        cdouble y = 0.;
-        cdouble z = x_(trafo_id);
-        if(ac){
-            z *= my_i;
-            z += r_(trafo_id);
-        }
-        if(z != 0.) y = 1.0 / z;
+    // admittance
+    cdouble y = 0.;
+    cdouble z = x_(trafo_id);
+    if(ac){
+        z *= my_i;
+        z += r_(trafo_id);
+    }
+    if(z != 0.) y = 1.0 / z;
 
-        // fill non diagonal coefficient
-        cdouble tmp = y / r;
-        res.push_back(Eigen::Triplet<cdouble> (bus_hv_solver_id, bus_lv_solver_id, -tmp));
-        res.push_back(Eigen::Triplet<cdouble> (bus_lv_solver_id, bus_hv_solver_id, -tmp));
+    // non diagonal coefficient
+    cdouble tmp = y / r;
+    y_ft = -tmp;
 
-        // fill diagonal coefficient
-        if(!ac){
-            r = 1.0; // in dc, r = 1.0 here (same voltage both side)
-        }
-        tmp += h;
-        res.push_back(Eigen::Triplet<cdouble>(bus_hv_solver_id, bus_hv_solver_id, tmp / r));
-        res.push_back(Eigen::Triplet<cdouble>(bus_lv_solver_id, bus_lv_solver_id, tmp * r));
+    // diagonal coefficient
+    if(!ac){
+        r = 1.0; // in dc, r = 1.0 here (same voltage both side)
+    }
+    tmp += h;
+    y_hh = tmp / r;
+    y_ll = tmp * r;
+}
+
+double DataTrafo::ratio_from_tap(int trafo_id, double tap_pos) const
+{
+    return 1.0 + 0.01 * tap_step_pct_(trafo_id) * tap_pos * (tap_hv_[trafo_id] ? 1.0 : -1.0);
+}
+
+void DataTrafo::change_ratio(int trafo_id, double new_ratio, bool & need_reset)
+{
+    if((trafo_id < 0) || (trafo_id >= nb())) throw std::out_of_range("change_ratio: invalid transformer id");
+    if(new_ratio <= 0.) throw std::runtime_error("change_ratio: the ratio of a transformer should be strictly positive");
+    if(undo_log_) undo_log_->save(ratio_, trafo_id);
+    ratio_(trafo_id) = new_ratio;
+}
+
+void DataTrafo::change_tap(int trafo_id, double new_tap_pos, bool & need_reset)
+{
+    if((trafo_id < 0) || (trafo_id >= nb())) throw std::out_of_range("change_tap: invalid transformer id");
+    change_ratio(trafo_id, ratio_from_tap(trafo_id, new_tap_pos), need_reset);
+    if(undo_log_) undo_log_->save(tap_pos_, trafo_id);
+    tap_pos_(trafo_id) = new_tap_pos;
+}
+
+void DataTrafo::update_Ybus_ratio(Eigen::SparseMatrix<cdouble> & Ybus,
+                                  int trafo_id,
+                                  double old_ratio,
+                                  bool ac,
+                                  const std::vector<int> & id_grid_to_solver)
+{
+    if(!status_.at(trafo_id)) return;  // the transformer is not in Ybus
+    int bus_hv_solver_id = id_grid_to_solver[bus_hv_id_(trafo_id)];
+    int bus_lv_solver_id = id_grid_to_solver[bus_lv_id_(trafo_id)];
+    if((bus_hv_solver_id == _deactivated_bus_id) || (bus_lv_solver_id == _deactivated_bus_id)){
+        throw std::runtime_error("DataTrafo::update_Ybus_ratio: A trafo is connected to a disconnected bus.");
     }
+    cdouble old_ft, old_hh, old_ll, new_ft, new_hh, new_ll;
+    get_ybus_coeffs(trafo_id, old_ratio, ac, old_ft, old_hh, old_ll);
+    get_ybus_coeffs(trafo_id, ratio_(trafo_id), ac, new_ft, new_hh, new_ll);
+    // these coefficients are already in Ybus: its sparsity pattern is not modified
+    Ybus.coeffRef(bus_hv_solver_id, bus_lv_solver_id) += new_ft - old_ft;
+    Ybus.coeffRef(bus_lv_solver_id, bus_hv_solver_id) += new_ft - old_ft;
+    Ybus.coeffRef(bus_hv_solver_id, bus_hv_solver_id) += new_hh - old_hh;
+    Ybus.coeffRef(bus_lv_solver_id, bus_lv_solver_id) += new_ll - old_ll;
 }
 
 void DataTrafo::compute_results(const Eigen::Ref<Eigen::VectorXd> & Va,
@@ -253,6 +291,45 @@ void DataTrafo::compute_results(const Eigen::Ref<Eigen::VectorXd> & Va,
     _get_amps(res_a_lv_, res_p_lv_, res_q_lv_, res_v_lv_);
 }
 
+void DataTrafo::compute_flows_hv(const Eigen::Ref<const Eigen::VectorXcd> & V,
+                                 const std::vector<int> & id_grid_to_solver,
+                                 const Eigen::VectorXd & bus_vn_kv,
+                                 Eigen::VectorXd & p_hv,
+                                 Eigen::VectorXd & a_hv)
+{
+    int nb_element = nb();
+    p_hv = Eigen::VectorXd::Constant(nb_element, 0.0);  // in MW
+    Eigen::VectorXd q_hv = Eigen::VectorXd::Constant(nb_element, 0.0);  // in MVar
+    Eigen::VectorXd v_hv = Eigen::VectorXd::Constant(nb_element, 0.0);  // in kV
+    for(int trafo_id = 0; trafo_id < nb_element; ++trafo_id){
+        // don't do anything if the element is disconnected
+        if(!status_[trafo_id]) continue;
+
+        double r = r_(trafo_id);
+        double x = x_(trafo_id);
+        double ratio_me = ratio_(trafo_id);
+        cdouble h = my_i * 0.5 * h_(trafo_id);
+        cdouble y = 1.0 / (r + my_i * x);
+        y /= ratio_me;
+
+        int bus_hv_id_me = bus_hv_id_(trafo_id);
+        int bus_hv_solver_id = id_grid_to_solver[bus_hv_id_me];
+        int bus_lv_solver_id = id_grid_to_solver[bus_lv_id_(trafo_id)];
+        if((bus_hv_solver_id == _deactivated_bus_id) || (bus_lv_solver_id == _deactivated_bus_id)){
+            throw std::runtime_error("DataTrafo::compute_flows_hv: A trafo is connected to a disconnected bus.");
+        }
+
+        cdouble Ehv = V(bus_hv_solver_id);
+        cdouble Elv = V(bus_lv_solver_id);
+        cdouble s_hvlv = Ehv * std::conj((y + h) / ratio_me * Ehv - y * Elv);
+
+        p_hv(trafo_id) = std::real(s_hvlv);
+        q_hv(trafo_id) = std::imag(s_hvlv);
+        v_hv(trafo_id) = std::abs(Ehv) * bus_vn_kv(bus_hv_id_me);
+    }
+    _get_amps(a_hv, p_hv, q_hv, v_hv);
+}
+
 void DataTrafo::reset_results(){
     res_p_hv_ = Eigen::VectorXd();  // in MW
     res_q_hv_ = Eigen::VectorXd();  // in MVar
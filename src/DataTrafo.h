@@ -27,7 +27,10 @@ class DataTrafo : public DataGeneric
                std::vector<int>, // branch_from_id
                std::vector<int>, // branch_to_id
                std::vector<bool> , // status_
-               std::vector<double> // ratio_
+               std::vector<double>, // ratio_
+               std::vector<double>, // tap_step_pct_
+               std::vector<double>, // tap_pos_
+               std::vector<bool> // tap_hv_
            >  StateRes;
 
     DataTrafo() {};
@@ -54,21 +57,63 @@ class DataTrafo : public DataGeneric
     int get_bus_hv(int trafo_id) {return _get_bus(trafo_id, status_, bus_hv_id_);}
     int get_bus_lv(int trafo_id) {return _get_bus(trafo_id, status_, bus_lv_id_);}
 
+    /**
+    Change the ratio of a transformer (directly, or through its tap position). Ybus is not recomputed: see
+    update_Ybus_ratio.
+    **/
+    void change_ratio(int trafo_id, double new_ratio, bool & need_reset);
+    void change_tap(int trafo_id, double new_tap_pos, bool & need_reset);
+    double ratio_from_tap(int trafo_id, double tap_pos) const;
+    const Eigen::VectorXd & get_tap_pos() const {return tap_pos_;}
+    const Eigen::VectorXd & get_tap_step_pct() const {return tap_step_pct_;}
+    bool is_tap_hv(int trafo_id) const {return tap_hv_.at(trafo_id);}
+    /**
+    Update (in place) the 4 coefficients of transformer trafo_id in Ybus (computed with the ratio old_ratio) to its
+    current ratio. The sparsity pattern of Ybus is not modified.
+    **/
+    void update_Ybus_ratio(Eigen::SparseMatrix<cdouble> & Ybus,
+                           int trafo_id,
+                           double old_ratio,
+                           bool ac,
+                           const std::vector<int> & id_grid_to_solver);
+
     virtual void fillYbus_spmat(Eigen::SparseMatrix<cdouble> & res, bool ac, const std::vector<int> & id_grid_to_solver);
     virtual void fillYbus(std::vector<Eigen::Triplet<cdouble> > & res, bool ac, const std::vector<int> & id_grid_to_solver);
+    // coefficients of the transformer in Ybus (y_ft for both (hv, lv) and (lv, hv)) if its ratio were "ratio"
+    void get_ybus_coeffs(int trafo_id, double ratio, bool ac, cdouble & y_ft, cdouble & y_hh, cdouble & y_ll) const;
 
     void compute_results(const Eigen::Ref<Eigen::VectorXd> & Va,
                          const Eigen::Ref<Eigen::VectorXd> & Vm,
                          const Eigen::Ref<Eigen::VectorXcd> & V,
                          const std::vector<int> & id_grid_to_solver,
                          const Eigen::VectorXd & bus_vn_kv);
+    /**
+    Computes the active power (MW) and current (kA) at the high voltage side of each trafo for the complex voltages V
+    (given in the solver bus ids). Contrary to "compute_results" the internal results are not modified.
+    **/
+    void compute_flows_hv(const Eigen::Ref<const Eigen::VectorXcd> & V,
+                          const std::vector<int> & id_grid_to_solver,
+                          const Eigen::VectorXd & bus_vn_kv,
+                          Eigen::VectorXd & p_hv,
+                          Eigen::VectorXd & a_hv);
     void reset_results();
     virtual double get_p_slack(int slack_bus_id);
     virtual void get_q(std::vector<double>& q_by_bus);
 
     tuple4d get_res_hv() const {return tuple4d(res_p_hv_, res_q_hv_, res_v_hv_, res_a_hv_);}
     tuple4d get_res_lv() const {return tuple4d(res_p_lv_, res_q_lv_, res_v_lv_, res_a_lv_);}
+    // restore results given by get_res_hv and get_res_lv
+    void set_res(const tuple4d & res_hv, const tuple4d & res_lv){
+        std::tie(res_p_hv_, res_q_hv_, res_v_hv_, res_a_hv_) = res_hv;
+        std::tie(res_p_lv_, res_q_lv_, res_v_lv_, res_a_lv_) = res_lv;
+    }
     const std::vector<bool>& get_status() const {return status_;}
+    // raw data, regardless of the status of the transformers (r and x in pu)
+    const Eigen::VectorXi & get_bus_hv_id() const {return bus_hv_id_;}
+    const Eigen::VectorXi & get_bus_lv_id() const {return bus_lv_id_;}
+    const Eigen::VectorXd & get_r() const {return r_;}
+    const Eigen::VectorXd & get_x() const {return x_;}
+    const Eigen::VectorXd & get_ratio() const {return ratio_;}
 
     protected:
         // physical properties
@@ -81,6 +126,9 @@ class DataTrafo : public DataGeneric
         Eigen::VectorXi bus_lv_id_;
         std::vector<bool> status_;
         Eigen::VectorXd ratio_;
+        Eigen::VectorXd tap_step_pct_;
+        Eigen::VectorXd tap_pos_;
+        std::vector<bool> tap_hv_;
 
         //output data
         Eigen::VectorXd res_p_hv_;  // in MW
@@ -8,6 +8,64 @@
 
 #include "GridModel.h"
 
+#include <limits>  // for quiet_NaN
+#include <cstring>  // for memcpy
+
+namespace
+{
+    // key of the memoization of the ac powerflows: the values that define a powerflow, given one after the other
+    // to a visitor (see GridModel::memo_visit) so that the key is hashed and compared without being copied
+    std::uint64_t bits_of(double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    // FNV-1a, on the bits of the values
+    struct MemoHash
+    {
+        std::uint64_t res = 14695981039346656037ULL;
+        void operator()(double value)
+        {
+            const std::uint64_t bits = bits_of(value);
+            for(int byte = 0; byte < 8; ++byte){
+                res ^= (bits >> (8 * byte)) & 0xff;
+                res *= 1099511628211ULL;
+            }
+        }
+    };
+
+    // copy of the key, only made when an entry is stored
+    struct MemoWrite
+    {
+        std::vector<double> & key;
+        void operator()(double value) {key.push_back(value);}
+    };
+
+    // bit to bit comparison with a stored key (in case of a collision of the hashes)
+    struct MemoCompare
+    {
+        const std::vector<double> & key;
+        size_t pos = 0;
+        bool equal = true;
+        void operator()(double value)
+        {
+            if(equal) equal = pos < key.size() && bits_of(key[pos]) == bits_of(value);
+            ++pos;
+        }
+        bool is_equal() const {return equal && pos == key.size();}
+    };
+
+    // the size is part of the key, so that the split between two vectors is too
+    template<class F, class T>
+    void memo_visit_values(F & visitor, const T & values)
+    {
+        visitor(static_cast<double>(values.size()));
+        for(auto value : values) visitor(static_cast<double>(value));
+    }
+}
+
 GridModel::GridModel(const GridModel & other)
 {
     reset();
@@ -15,6 +73,20 @@ GridModel::GridModel(const GridModel & other)
     // assign the right solver
     _solver.change_solver(other._solver.get_type());
     compute_results_ = other.compute_results_;
+    _solver.set_step_control(other._solver.get_step_control());
+    _solver.set_sparse_kernel(other._solver.get_sparse_kernel());
+    _solver.set_precision(other._solver.get_precision());
+    _solver.set_klu_parameters(other._solver.get_klu_parameters());
+    parallel_ybus_ = other.parallel_ybus_;
+    recovery_stages_ = other.recovery_stages_;
+    last_recovery_stage_ = RecoveryStage::NoRecovery;
+    oltc_controls_ = other.oltc_controls_;
+    oltc_nb_iter_ = 0;
+    ybus_ac_ = true;
+    memo_size_ = other.memo_size_;
+    memo_nb_hit_ = 0;
+    memo_nb_miss_ = 0;
+    dcopf_slack_solver_ = -1;
 
     // copy the powersystem representation
     // 1. bus
@@ -41,6 +113,7 @@ GridModel::GridModel(const GridModel & other)
     // 7. slack bus
     gen_slackbus_ = other.gen_slackbus_;
     slack_bus_id_ = other.slack_bus_id_;
+    gen_slack_weights_ = other.gen_slack_weights_;
 
     // copy the attributes specific grid2op (speed optimization)
     n_sub_ = other.n_sub_;
@@ -76,13 +149,16 @@ GridModel::StateRes GridModel::get_state() const
                             res_trafo,
                             res_gen,
                             res_load,
-                            gen_slackbus_
+                            gen_slackbus_,
+                            _solver.get_klu_parameters().get_state()
                             );
     return res;
 };
 
 void GridModel::set_state(GridModel::StateRes & my_state)
 {
+    check_no_checkpoint("set_state");
+    memo_invalidate();
     // after loading back, the instance need to be reset anyway
     // TODO see if it's worth the trouble NOT to do it
     reset();
@@ -104,6 +180,8 @@ void GridModel::set_state(GridModel::StateRes & my_state)
     // loads
     DataLoad::StateRes & state_loads = std::get<6>(my_state);
     int gen_slackbus = std::get<7>(my_state);
+    KLUParameters klu_parameters;
+    klu_parameters.set_state(std::get<8>(my_state));
 
     // assign it to this instance
 
@@ -127,6 +205,7 @@ void GridModel::set_state(GridModel::StateRes & my_state)
 
     // other stuff
     gen_slackbus_ = gen_slackbus;
+    _solver.set_klu_parameters(klu_parameters);
 
 };
 
@@ -137,6 +216,8 @@ void GridModel::init_bus(const Eigen::VectorXd & bus_vn_kv, int nb_line, int nb_
     and
     initialize the Ybus_ matrix at the proper shape
     **/
+    check_no_checkpoint("init_bus");
+    memo_invalidate();
     int nb_bus = bus_vn_kv.size();
     bus_vn_kv_ = bus_vn_kv;  // base_kv
 
@@ -169,33 +250,569 @@ Eigen::VectorXcd GridModel::ac_pf(const Eigen::VectorXcd & Vinit,
     }
     bool conv = false;
     Eigen::VectorXcd res = Eigen::VectorXcd();
+    SolverType solver_type = _solver.get_type();
+
+    // same powerflow as a previous one
+    std::uint64_t memo_key_hash = 0;
+    if(memo_size_ > 0){
+        memo_key_hash = memo_hash(false, max_iter, tol);
+        if(memo_restore(memo_key_hash, false, max_iter, tol, Vinit, res)) return res;
+    }
 
     // pre process the data to define a proper jacobian matrix, the proper voltage vector etc.
     Eigen::VectorXcd V = pre_process_solver(Vinit, true);
 
     // start the solver
+    last_recovery_stage_ = RecoveryStage::NoRecovery;
     conv = _solver.compute_pf(Ybus_, V, Sbus_, bus_pv_, bus_pq_, max_iter, tol);
+    if(!conv && !recovery_stages_.empty()) conv = recover_ac_pf(V, max_iter, tol);
 
     // store results
     process_results(conv, res, Vinit);
 
+    // the solver might have been changed by the recovery: it is kept until the next powerflow (for get_V, get_J...)
+    _solver.restore_solver_at_next_pf(solver_type);
+    if(memo_size_ > 0 && conv) memo_store(memo_key_hash, false, max_iter, tol, res);
+
     // return the vector of complex voltage at each bus
     return res;
 };
 
+Eigen::VectorXcd GridModel::ac_pf_injections(const Eigen::VectorXcd & Vinit,
+                                             int max_iter,
+                                             double tol)
+{
+    // nothing to re use
+    if((Ybus_.size() == 0) || !ybus_ac_) return ac_pf(Vinit, max_iter, tol);
+
+    int nb_bus = bus_vn_kv_.size();
+    if(Vinit.size() != nb_bus){
+        throw std::runtime_error("GridModel::ac_pf_injections: Size of the Vinit should be the same as the total number of buses (both connected and disconnected).");
+    }
+    bool conv = false;
+    Eigen::VectorXcd res = Eigen::VectorXcd();
+    SolverType solver_type = _solver.get_type();
+
+    // same Ybus, pv and pq: only Sbus and the voltages of the generators are updated
+    save_compiled_grid(true);
+    Sbus_ = Eigen::VectorXcd::Constant(id_solver_to_me_.size(), 0.);
+    init_slack_weights(fillSbus_me(Sbus_, true, id_me_to_solver_, slack_bus_id_solver_));
+    int nb_bus_solver = id_solver_to_me_.size();
+    Eigen::VectorXcd V = Eigen::VectorXcd::Constant(nb_bus_solver, 1.04);
+    for(int bus_solver_id = 0; bus_solver_id < nb_bus_solver; ++bus_solver_id){
+        V(bus_solver_id) = Vinit(id_solver_to_me_[bus_solver_id]);
+    }
+    generators_.set_vm(V, id_me_to_solver_);
+
+    // the solver is not reset: it re uses its symbolic factorization
+    last_recovery_stage_ = RecoveryStage::NoRecovery;
+    conv = _solver.compute_pf(Ybus_, V, Sbus_, bus_pv_, bus_pq_, max_iter, tol);
+    if(!conv && !recovery_stages_.empty()) conv = recover_ac_pf(V, max_iter, tol);
+
+    process_results(conv, res, Vinit);
+    _solver.restore_solver_at_next_pf(solver_type);
+    return res;
+}
+
+void GridModel::set_recovery_stages(const std::vector<RecoveryStage> & stages)
+{
+    for(const auto & stage : stages){
+        if(stage == RecoveryStage::NoRecovery){
+            throw std::runtime_error("GridModel::set_recovery_stages: NoRecovery cannot be used as a recovery stage.");
+        }
+    }
+    recovery_stages_ = stages;
+}
+
+SolverType GridModel::other_solver_type(const SolverType & type)
+{
+    // the linear solver used to replace "type" in case of divergence
+    std::vector<SolverType> available = _solver.available_solvers();
+    bool klu_available = std::find(available.begin(), available.end(), SolverType::KLU) != available.end();
+    if(type == SolverType::SparseLU){
+        if(klu_available) return SolverType::KLU;
+        // gauss seidel does not support the distributed slack (no other solver can be tried)
+        return _solver.is_slack_distributed() ? SolverType::SparseLU : SolverType::GaussSeidel;
+    }
+    return SolverType::SparseLU;
+}
+
+bool GridModel::recover_ac_pf(const Eigen::VectorXcd & V, int max_iter, double tol)
+{
+    SolverType solver_type = _solver.get_type();
+    SolverType type_used = _solver.get_type_used();  // differs from solver_type in "Auto" mode
+    StepControl step_control = _solver.get_step_control();
+    int nb_bus_solver = V.size();
+    bool conv = false;
+    for(const auto & stage : recovery_stages_){
+        // the solvers stop immediately if they encountered an error before
+        _solver.reset();
+        _solver.change_solver(solver_type);
+        _solver.set_step_control(step_control);
+        Eigen::VectorXcd V_stage = V;
+        int max_iter_stage = max_iter;
+        if(stage == RecoveryStage::DCInit){
+            // same bus numbering, only the dc version of Ybus and Sbus are computed
+            Eigen::SparseMatrix<cdouble> Ybus_dc(nb_bus_solver, nb_bus_solver);
+            Eigen::VectorXcd Sbus_dc = Eigen::VectorXcd::Constant(nb_bus_solver, 0.);
+            fillYbus(Ybus_dc, false, id_me_to_solver_);
+            fillSbus_me(Sbus_dc, false, id_me_to_solver_, slack_bus_id_solver_);
+            _solver.change_solver(SolverType::DC);
+            bool conv_dc = _solver.compute_pf(Ybus_dc, V_stage, Sbus_dc, bus_pv_, bus_pq_, max_iter, tol);
+            if(!conv_dc) continue;  // non connected grid, there is no hope for this stage
+            V_stage = _solver.get_V();
+            _solver.change_solver(solver_type);
+        }else if(stage == RecoveryStage::FlatStart){
+            // magnitude of pv (and slack) buses are kept, all angles are the one of the slack bus
+            Eigen::VectorXd Vm = Eigen::VectorXd::Constant(nb_bus_solver, 1.0);
+            if(bus_pv_.size() > 0) Vm(bus_pv_) = V(bus_pv_).array().abs();
+            Vm(slack_bus_id_solver_) = std::abs(V(slack_bus_id_solver_));
+            V_stage = Vm.cast<cdouble>() * std::exp(my_i * std::arg(V(slack_bus_id_solver_)));
+            max_iter_stage = 2 * max_iter;
+        }else if(stage == RecoveryStage::OtherSolver){
+            _solver.change_solver(other_solver_type(type_used));
+        }else if(stage == RecoveryStage::Iwamoto){
+            // does not make sense for the GaussSeidel solver
+            if(type_used == SolverType::GaussSeidel) _solver.change_solver(SolverType::SparseLU);
+            _solver.set_step_control(StepControl::Iwamoto);
+        }
+        conv = _solver.compute_pf(Ybus_, V_stage, Sbus_, bus_pv_, bus_pq_, max_iter_stage, tol);
+        _solver.set_step_control(step_control);
+        if(conv){
+            last_recovery_stage_ = stage;
+            break;
+        }
+    }
+    return conv;
+}
+
+Eigen::VectorXcd GridModel::ac_pf_dc_init(const Eigen::VectorXcd & Vinit,
+                                          int max_iter,
+                                          double tol)
+{
+    int nb_bus = bus_vn_kv_.size();
+    if(Vinit.size() != nb_bus){
+        throw std::runtime_error("GridModel::ac_pf_dc_init: Size of the Vinit should be the same as the total number of buses (both connected and disconnected).");
+    }
+    bool conv = false;
+    Eigen::VectorXcd res = Eigen::VectorXcd();
+
+    // same powerflow as a previous one
+    std::uint64_t memo_key_hash = 0;
+    if(memo_size_ > 0){
+        memo_key_hash = memo_hash(true, max_iter, tol);
+        if(memo_restore(memo_key_hash, true, max_iter, tol, Vinit, res)) return res;
+    }
+    last_recovery_stage_ = RecoveryStage::NoRecovery;
+
+    // dc powerflow, to get the initial voltage angles
+    SolverType solver_type = _solver.get_type();
+    _solver.change_solver(SolverType::DC);
+    Eigen::VectorXcd V = pre_process_solver(Vinit, false);
+    conv = _solver.compute_pf(Ybus_, V, Sbus_, bus_pv_, bus_pq_, max_iter, tol);
+    if(conv) V = _solver.get_V();
+    _solver.change_solver(solver_type);
+    if(!conv){
+        // the dc powerflow diverged (non connected grid), the ac one will diverge too
+        process_results(conv, res, Vinit);
+        return res;
+    }
+
+    // the bus numbering, as well as pv and pq buses, are the same for the ac powerflow
+    // only Ybus and Sbus need to be computed again
+    fillYbus(Ybus_, true, id_me_to_solver_);
+    ybus_ac_ = true;
+    Sbus_ = Eigen::VectorXcd::Constant(Sbus_.size(), 0.);
+    init_slack_weights(fillSbus_me(Sbus_, true, id_me_to_solver_, slack_bus_id_solver_));
+
+    // start the ac solver from the dc angles
+    conv = _solver.compute_pf(Ybus_, V, Sbus_, bus_pv_, bus_pq_, max_iter, tol);
+    if(!conv && !recovery_stages_.empty()) conv = recover_ac_pf(V, max_iter, tol);
+
+    // store results
+    process_results(conv, res, Vinit);
+    _solver.restore_solver_at_next_pf(solver_type);
+    if(memo_size_ > 0 && conv) memo_store(memo_key_hash, true, max_iter, tol, res);
+
+    // return the vector of complex voltage at each bus
+    return res;
+}
+
+std::tuple<Eigen::MatrixXd, Eigen::MatrixXd, Eigen::MatrixXd, Eigen::MatrixXd>
+    GridModel::predict(const Eigen::MatrixXcd & delta_S)
+{
+    int nb_bus = bus_vn_kv_.size();
+    if(delta_S.cols() != nb_bus){
+        throw std::runtime_error("GridModel::predict: delta_S should have as many columns as the total number of buses (both connected and disconnected).");
+    }
+    if(Ybus_.size() == 0){
+        throw std::runtime_error("GridModel::predict: no ac powerflow has been computed.");
+    }
+
+    // convert the delta to the solver bus ids
+    int nb_delta = delta_S.rows();
+    int nb_bus_solver = id_solver_to_me_.size();
+    Eigen::MatrixXcd delta_Sbus(nb_delta, nb_bus_solver);
+    for(int bus_solver_id = 0; bus_solver_id < nb_bus_solver; ++bus_solver_id){
+        delta_Sbus.col(bus_solver_id) = delta_S.col(id_solver_to_me_[bus_solver_id]);
+    }
+    Eigen::MatrixXcd V_pred = _solver.predict_V(Ybus_, delta_Sbus, bus_pv_, bus_pq_);
+
+    int nb_line = powerlines_.nb();
+    int nb_trafo = trafos_.nb();
+    Eigen::MatrixXd line_p_or(nb_delta, nb_line);
+    Eigen::MatrixXd line_a_or(nb_delta, nb_line);
+    Eigen::MatrixXd trafo_p_hv(nb_delta, nb_trafo);
+    Eigen::MatrixXd trafo_a_hv(nb_delta, nb_trafo);
+    Eigen::VectorXd p_tmp, a_tmp;
+    Eigen::VectorXcd V_tmp;
+    for(int delta_id = 0; delta_id < nb_delta; ++delta_id){
+        V_tmp = V_pred.row(delta_id).transpose();
+        powerlines_.compute_flows_or(V_tmp, id_me_to_solver_, bus_vn_kv_, p_tmp, a_tmp);
+        line_p_or.row(delta_id) = p_tmp.transpose();
+        line_a_or.row(delta_id) = a_tmp.transpose();
+        trafos_.compute_flows_hv(V_tmp, id_me_to_solver_, bus_vn_kv_, p_tmp, a_tmp);
+        trafo_p_hv.row(delta_id) = p_tmp.transpose();
+        trafo_a_hv.row(delta_id) = a_tmp.transpose();
+    }
+    return std::make_tuple(line_p_or, line_a_or, trafo_p_hv, trafo_a_hv);
+}
+
+std::tuple<Eigen::VectorXd, Eigen::MatrixXcd, int, int>
+    GridModel::continuation_pf(const Eigen::VectorXd & load_p_dir,
+                               const Eigen::VectorXd & load_q_dir,
+                               const Eigen::VectorXd & gen_p_dir,
+                               double step,
+                               double min_step,
+                               double max_step,
+                               int max_nb_point,
+                               bool stop_at_nose,
+                               int max_iter,
+                               double tol)
+{
+    if((Ybus_.size() == 0) || !ybus_ac_){
+        throw std::runtime_error("GridModel::continuation_pf: no ac powerflow has been computed.");
+    }
+    const int nb_load = loads_.nb();
+    const int nb_gen = generators_.nb();
+    if((load_p_dir.size() > 0) && (load_p_dir.size() != nb_load)){
+        throw std::runtime_error("GridModel::continuation_pf: load_p_dir should have one value per load (or none).");
+    }
+    if((load_q_dir.size() > 0) && (load_q_dir.size() != nb_load)){
+        throw std::runtime_error("GridModel::continuation_pf: load_q_dir should have one value per load (or none).");
+    }
+    if((gen_p_dir.size() > 0) && (gen_p_dir.size() != nb_gen)){
+        throw std::runtime_error("GridModel::continuation_pf: gen_p_dir should have one value per generator (or none).");
+    }
+
+    // direction of the injections (solver bus ids)
+    Eigen::VectorXcd Sdir = Eigen::VectorXcd::Constant(id_solver_to_me_.size(), 0.);
+    const Eigen::VectorXd & load_p = load_p_dir.size() > 0 ? load_p_dir : loads_.get_p();
+    const Eigen::VectorXd & load_q = load_q_dir.size() > 0 ? load_q_dir : loads_.get_q();
+    const auto & load_status = loads_.get_status();
+    const auto & load_bus_id = loads_.get_bus_id();
+    for(int load_id = 0; load_id < nb_load; ++load_id){
+        if(!load_status[load_id]) continue;
+        Sdir(id_me_to_solver_[load_bus_id(load_id)]) -= cdouble(load_p(load_id), load_q(load_id));
+    }
+    const auto & gen_status = generators_.get_status();
+    const auto & gen_bus_id = generators_.get_bus_id();
+    for(int gen_id = 0; gen_id < gen_p_dir.size(); ++gen_id){
+        if(!gen_status[gen_id]) continue;
+        Sdir(id_me_to_solver_[gen_bus_id(gen_id)]) += gen_p_dir(gen_id);
+    }
+
+    auto res = _solver.compute_cpf(Ybus_, Sbus_, Sdir, bus_pv_, bus_pq_, step, min_step, max_step,
+                                   max_nb_point, stop_at_nose, max_iter, tol);
+
+    // convert back the voltages to the bus ids of the grid
+    const Eigen::MatrixXcd & V_solver = std::get<1>(res);
+    const int nb_bus = bus_vn_kv_.size();
+    Eigen::MatrixXcd V = Eigen::MatrixXcd::Zero(V_solver.rows(), nb_bus);
+    for(int bus_id_me = 0; bus_id_me < nb_bus; ++bus_id_me){
+        if(!bus_status_[bus_id_me]) continue;
+        V.col(bus_id_me) = V_solver.col(id_me_to_solver_[bus_id_me]);
+    }
+    return std::make_tuple(std::get<0>(res), V, std::get<2>(res), std::get<3>(res));
+}
+
+GridModel GridModel::reduce(const Eigen::VectorXi & keep_buses, const Eigen::VectorXcd & V, double drop_tol)
+{
+    const int nb_bus_me = bus_vn_kv_.size();
+    if(V.size() != nb_bus_me){
+        throw std::runtime_error("GridModel::reduce: V should have as many components as the total number of buses (both connected and disconnected).");
+    }
+    if(!(drop_tol >= 0.)) throw std::runtime_error("GridModel::reduce: drop_tol should be >= 0.");
+
+    // 0. buses kept
+    const int n_k = keep_buses.size();
+    std::vector<int> me_to_red(nb_bus_me, _deactivated_bus_id);
+    for(int red_id = 0; red_id < n_k; ++red_id){
+        int bus_id_me = keep_buses(red_id);
+        if(bus_id_me < 0 || bus_id_me >= nb_bus_me) throw std::runtime_error("GridModel::reduce: a bus to keep is not a bus of the grid.");
+        if(!bus_status_[bus_id_me]) throw std::runtime_error("GridModel::reduce: a bus to keep is disconnected.");
+        if(me_to_red[bus_id_me] != _deactivated_bus_id) throw std::runtime_error("GridModel::reduce: a bus to keep is given twice.");
+        me_to_red[bus_id_me] = red_id;
+    }
+    const int slack_bus_id = generators_.get_slack_bus_id(gen_slackbus_);
+    if(me_to_red[slack_bus_id] == _deactivated_bus_id) throw std::runtime_error("GridModel::reduce: the slack bus should be kept.");
+
+    // 1. admittance matrix of the whole grid, split between the kept buses (k) and the external ones (e)
+    Eigen::SparseMatrix<cdouble> Ybus;
+    Eigen::VectorXcd Sbus;
+    std::vector<int> id_me_to_solver, id_solver_to_me;
+    int slack_bus_id_solver;
+    init_Ybus(Ybus, Sbus, id_me_to_solver, id_solver_to_me, slack_bus_id, slack_bus_id_solver);
+    fillYbus(Ybus, true, id_me_to_solver);
+    const int nb_bus_solver = id_solver_to_me.size();
+    std::vector<int> solver_to_e(nb_bus_solver, _deactivated_bus_id);
+    int n_e = 0;
+    for(int bus_solver_id = 0; bus_solver_id < nb_bus_solver; ++bus_solver_id){
+        if(me_to_red[id_solver_to_me[bus_solver_id]] == _deactivated_bus_id) solver_to_e[bus_solver_id] = n_e++;
+    }
+
+    // buses at the boundary: kept buses connected to an external one
+    std::vector<int> red_to_b(n_k, _deactivated_bus_id);
+    std::vector<int> boundary;  // reduced ids
+    std::vector<Eigen::Triplet<cdouble> > t_ee, t_eb, t_be;
+    for(int col_id = 0; col_id < nb_bus_solver; ++col_id){
+        for(Eigen::SparseMatrix<cdouble>::InnerIterator it(Ybus, col_id); it; ++it){
+            int row_id = it.row();
+            int row_e = solver_to_e[row_id];
+            int col_e = solver_to_e[col_id];
+            if(row_e != _deactivated_bus_id && col_e != _deactivated_bus_id){
+                t_ee.push_back(Eigen::Triplet<cdouble>(row_e, col_e, it.value()));
+                continue;
+            }
+            if(row_e == _deactivated_bus_id && col_e == _deactivated_bus_id) continue;
+            int red_id = me_to_red[id_solver_to_me[row_e == _deactivated_bus_id ? row_id : col_id]];
+            if(red_to_b[red_id] == _deactivated_bus_id){
+                red_to_b[red_id] = boundary.size();
+                boundary.push_back(red_id);
+            }
+            if(row_e != _deactivated_bus_id) t_eb.push_back(Eigen::Triplet<cdouble>(row_e, red_to_b[red_id], it.value()));
+            else t_be.push_back(Eigen::Triplet<cdouble>(red_to_b[red_id], col_e, it.value()));
+        }
+    }
+    const int n_b = boundary.size();
+
+    // reference for the coefficients that are dropped: the largest diagonal coefficient at the boundary
+    double y_ref = 0.;
+    for(int b_i = 0; b_i < n_b; ++b_i){
+        int bus_solver_id = id_me_to_solver[keep_buses(boundary[b_i])];
+        y_ref = std::max(y_ref, std::abs(Ybus.coeff(bus_solver_id, bus_solver_id)));
+    }
+    const double y_drop = drop_tol * y_ref;
+
+    // 2. kron reduction (Y_bb - Y_be.Y_ee^-1.Y_eb) and ward equivalent injections (- Y_be.Y_ee^-1.I_e)
+    // Y_ee^-1.Y_eb is not stored: it is computed one column at a time and only the coefficients of delta_Y above
+    // y_drop are kept (and the diagonal, for the equivalent shunts)
+    Eigen::SparseMatrix<cdouble> delta_Y(n_b, n_b);
+    std::vector<cdouble> y_dropped(n_b, 0.);  // sum of the admittances of the equivalent powerlines dropped at each bus
+    Eigen::VectorXcd I_eq = Eigen::VectorXcd::Zero(n_b);
+    if(n_e > 0 && n_b > 0){
+        Eigen::SparseMatrix<cdouble> Y_ee(n_e, n_e), Y_eb(n_e, n_b), Y_be(n_b, n_e);
+        Y_ee.setFromTriplets(t_ee.begin(), t_ee.end());
+        Y_ee.makeCompressed();
+        Y_eb.setFromTriplets(t_eb.begin(), t_eb.end());
+        Y_be.setFromTriplets(t_be.begin(), t_be.end());
+        Eigen::SparseLU<Eigen::SparseMatrix<cdouble>, Eigen::COLAMDOrdering<int> > solver;
+        solver.analyzePattern(Y_ee);
+        solver.factorize(Y_ee);
+        if(solver.info() != Eigen::Success){
+            throw std::runtime_error("GridModel::reduce: the admittance matrix of the external buses is singular (is a part of the external grid isolated?).");
+        }
+        std::vector<Eigen::Triplet<cdouble> > t_delta;
+        Eigen::VectorXcd Yee_inv_Yeb(n_e);
+        Eigen::VectorXcd delta_col(n_b);
+        for(int b_j = 0; b_j < n_b; ++b_j){
+            Yee_inv_Yeb = solver.solve(Eigen::VectorXcd(Y_eb.col(b_j)));
+            delta_col = - (Y_be * Yee_inv_Yeb);
+            for(int b_i = 0; b_i < n_b; ++b_i){
+                if(b_i != b_j && std::abs(delta_col(b_i)) <= y_drop){
+                    // half of the powerline between b_i and b_j (the other half is given by the column b_i)
+                    y_dropped[b_i] -= 0.5 * delta_col(b_i);
+                    y_dropped[b_j] -= 0.5 * delta_col(b_i);
+                    continue;
+                }
+                t_delta.push_back(Eigen::Triplet<cdouble>(b_i, b_j, delta_col(b_i)));
+            }
+        }
+        delta_Y.setFromTriplets(t_delta.begin(), t_delta.end());
+
+        // current injected at the external buses at the operating point (I = Ybus.V)
+        Eigen::VectorXcd V_solver(nb_bus_solver);
+        for(int bus_solver_id = 0; bus_solver_id < nb_bus_solver; ++bus_solver_id) V_solver(bus_solver_id) = V(id_solver_to_me[bus_solver_id]);
+        Eigen::VectorXcd I = Ybus * V_solver;
+        Eigen::VectorXcd I_e(n_e);
+        for(int bus_solver_id = 0; bus_solver_id < nb_bus_solver; ++bus_solver_id){
+            if(solver_to_e[bus_solver_id] != _deactivated_bus_id) I_e(solver_to_e[bus_solver_id]) = I(bus_solver_id);
+        }
+        Eigen::VectorXcd Yee_inv_Ie = solver.solve(I_e);
+        I_eq = - (Y_be * Yee_inv_Ie);
+    }
+
+    // 3. elements connected only to kept buses
+    std::vector<double> bus_vn_kv(n_k);
+    for(int red_id = 0; red_id < n_k; ++red_id) bus_vn_kv[red_id] = bus_vn_kv_(keep_buses(red_id));
+    std::vector<bool> bus_status(n_k, true);
+
+    DataLine::StateRes state_line = powerlines_.get_state();
+    DataLine::StateRes red_line;
+    for(int line_id = 0; line_id < powerlines_.nb(); ++line_id){
+        int bus_or = me_to_red[std::get<3>(state_line)[line_id]];
+        int bus_ex = me_to_red[std::get<4>(state_line)[line_id]];
+        if(bus_or == _deactivated_bus_id || bus_ex == _deactivated_bus_id) continue;
+        std::get<0>(red_line).push_back(std::get<0>(state_line)[line_id]);
+        std::get<1>(red_line).push_back(std::get<1>(state_line)[line_id]);
+        std::get<2>(red_line).push_back(std::get<2>(state_line)[line_id]);
+        std::get<3>(red_line).push_back(bus_or);
+        std::get<4>(red_line).push_back(bus_ex);
+        std::get<5>(red_line).push_back(std::get<5>(state_line)[line_id]);
+    }
+    DataTrafo::StateRes state_trafo = trafos_.get_state();
+    DataTrafo::StateRes red_trafo;
+    for(int trafo_id = 0; trafo_id < trafos_.nb(); ++trafo_id){
+        int bus_hv = me_to_red[std::get<3>(state_trafo)[trafo_id]];
+        int bus_lv = me_to_red[std::get<4>(state_trafo)[trafo_id]];
+        if(bus_hv == _deactivated_bus_id || bus_lv == _deactivated_bus_id) continue;
+        std::get<0>(red_trafo).push_back(std::get<0>(state_trafo)[trafo_id]);
+        std::get<1>(red_trafo).push_back(std::get<1>(state_trafo)[trafo_id]);
+        std::get<2>(red_trafo).push_back(std::get<2>(state_trafo)[trafo_id]);
+        std::get<3>(red_trafo).push_back(bus_hv);
+        std::get<4>(red_trafo).push_back(bus_lv);
+        std::get<5>(red_trafo).push_back(std::get<5>(state_trafo)[trafo_id]);
+        std::get<6>(red_trafo).push_back(std::get<6>(state_trafo)[trafo_id]);
+        std::get<7>(red_trafo).push_back(std::get<7>(state_trafo)[trafo_id]);
+        std::get<8>(red_trafo).push_back(std::get<8>(state_trafo)[trafo_id]);
+        std::get<9>(red_trafo).push_back(std::get<9>(state_trafo)[trafo_id]);
+    }
+    DataShunt::StateRes state_shunt = shunts_.get_state();
+    DataShunt::StateRes red_shunt;
+    for(int shunt_id = 0; shunt_id < shunts_.nb(); ++shunt_id){
+        int bus_id = me_to_red[std::get<2>(state_shunt)[shunt_id]];
+        if(bus_id == _deactivated_bus_id) continue;
+        std::get<0>(red_shunt).push_back(std::get<0>(state_shunt)[shunt_id]);
+        std::get<1>(red_shunt).push_back(std::get<1>(state_shunt)[shunt_id]);
+        std::get<2>(red_shunt).push_back(bus_id);
+        std::get<3>(red_shunt).push_back(std::get<3>(state_shunt)[shunt_id]);
+    }
+    DataLoad::StateRes state_load = loads_.get_state();
+    DataLoad::StateRes red_load;
+    for(int load_id = 0; load_id < loads_.nb(); ++load_id){
+        int bus_id = me_to_red[std::get<2>(state_load)[load_id]];
+        if(bus_id == _deactivated_bus_id) continue;
+        std::get<0>(red_load).push_back(std::get<0>(state_load)[load_id]);
+        std::get<1>(red_load).push_back(std::get<1>(state_load)[load_id]);
+        std::get<2>(red_load).push_back(bus_id);
+        std::get<3>(red_load).push_back(std::get<3>(state_load)[load_id]);
+    }
+    DataGen::StateRes state_gen = generators_.get_state();
+    DataGen::StateRes red_gen;
+    int red_gen_slackbus = _deactivated_bus_id;
+    for(int gen_id = 0; gen_id < generators_.nb(); ++gen_id){
+        int bus_id = me_to_red[std::get<4>(state_gen)[gen_id]];
+        if(bus_id == _deactivated_bus_id) continue;
+        if(gen_id == gen_slackbus_) red_gen_slackbus = std::get<0>(red_gen).size();
+        std::get<0>(red_gen).push_back(std::get<0>(state_gen)[gen_id]);
+        std::get<1>(red_gen).push_back(std::get<1>(state_gen)[gen_id]);
+        std::get<2>(red_gen).push_back(std::get<2>(state_gen)[gen_id]);
+        std::get<3>(red_gen).push_back(std::get<3>(state_gen)[gen_id]);
+        std::get<4>(red_gen).push_back(bus_id);
+        std::get<5>(red_gen).push_back(std::get<5>(state_gen)[gen_id]);
+    }
+
+    GridModel res;
+    res.change_solver(_solver.get_type());
+    res.compute_results_ = compute_results_;
+    res.set_step_control(_solver.get_step_control());
+    res.set_sparse_kernel(_solver.get_sparse_kernel());
+    res.set_precision(_solver.get_precision());
+    res.parallel_ybus_ = parallel_ybus_;
+    res.recovery_stages_ = recovery_stages_;
+    GridModel::StateRes red_state(bus_vn_kv, bus_status, red_line, red_shunt, red_trafo, red_gen, red_load, red_gen_slackbus,
+                                  _solver.get_klu_parameters().get_state());
+    res.set_state(red_state);
+    if(n_b == 0) return res;
+
+    // 4. equivalent elements: difference (on the boundary) between the kron reduced admittance matrix and the one
+    // of the kept elements. Only the diagonal coefficients differ, except for the kron reduction
+    // (powerlines between two kept buses are kept).
+    Eigen::SparseMatrix<cdouble> Ybus_red;
+    Eigen::VectorXcd Sbus_red;
+    std::vector<int> red_to_solver, red_solver_to_red;
+    int red_slack_solver;
+    res.init_Ybus(Ybus_red, Sbus_red, red_to_solver, red_solver_to_red,
+                  res.generators_.get_slack_bus_id(res.gen_slackbus_), red_slack_solver);
+    res.fillYbus(Ybus_red, true, red_to_solver);
+    res.reset();
+
+    // the admittance matrix is symmetric (no phase shifter): one powerline per coefficient of the lower part of
+    // (delta_Y + delta_Y^T) / 2. The ones below y_drop (numerical noise, or electrically distant buses) are
+    // neglected: they are removed from the diagonal too, not replaced by shunts.
+    Eigen::SparseMatrix<cdouble> delta_Y_sym = 0.5 * (delta_Y + Eigen::SparseMatrix<cdouble>(delta_Y.transpose()));
+    std::vector<cdouble> y_lines = y_dropped;  // sum of the admittances of the equivalent powerlines at each bus
+    for(int b_j = 0; b_j < n_b; ++b_j){
+        for(Eigen::SparseMatrix<cdouble>::InnerIterator it(delta_Y_sym, b_j); it; ++it){
+            const int b_i = it.row();
+            if(b_i <= b_j) continue;
+            cdouble y = - it.value();
+            y_lines[b_i] += y;
+            y_lines[b_j] += y;
+            if(std::abs(y) <= y_drop) continue;
+            cdouble z = 1. / y;
+            std::get<0>(red_line).push_back(std::real(z));
+            std::get<1>(red_line).push_back(std::imag(z));
+            std::get<2>(red_line).push_back(0.);
+            std::get<3>(red_line).push_back(boundary[b_i]);
+            std::get<4>(red_line).push_back(boundary[b_j]);
+            std::get<5>(red_line).push_back(true);
+        }
+    }
+    for(int b_i = 0; b_i < n_b; ++b_i){
+        int red_id = boundary[b_i];
+        int bus_solver_id = id_me_to_solver[keep_buses(red_id)];
+        // what remains on the diagonal is an equivalent shunt (a shunt adds -(p + j.q) in Ybus)
+        cdouble y_shunt = Ybus.coeff(bus_solver_id, bus_solver_id) + delta_Y.coeff(b_i, b_i)
+                          - Ybus_red.coeff(red_to_solver[red_id], red_to_solver[red_id]) - y_lines[b_i];
+        if(std::abs(y_shunt) > y_drop){
+            std::get<0>(red_shunt).push_back(-std::real(y_shunt));
+            std::get<1>(red_shunt).push_back(-std::imag(y_shunt));
+            std::get<2>(red_shunt).push_back(red_id);
+            std::get<3>(red_shunt).push_back(true);
+        }
+        // ward injection, as a load (a load adds -(p + j.q) in Sbus)
+        cdouble s_eq = V(keep_buses(red_id)) * std::conj(I_eq(b_i));
+        if(std::abs(s_eq) > std::numeric_limits<double>::epsilon() * y_ref * std::norm(V(keep_buses(red_id)))){
+            std::get<0>(red_load).push_back(-std::real(s_eq));
+            std::get<1>(red_load).push_back(-std::imag(s_eq));
+            std::get<2>(red_load).push_back(red_id);
+            std::get<3>(red_load).push_back(true);
+        }
+    }
+    GridModel::StateRes red_state_eq(bus_vn_kv, bus_status, red_line, red_shunt, red_trafo, red_gen, red_load, red_gen_slackbus,
+                                     _solver.get_klu_parameters().get_state());
+    res.set_state(red_state_eq);
+    return res;
+}
+
 Eigen::VectorXcd GridModel::pre_process_solver(const Eigen::VectorXcd & Vinit, bool is_ac)
 {
     // TODO get rid of the "is_ac" argument: this info is available in the _solver already
 
     // if(need_reset_){ // TODO optimization when it's not mandatory to start from scratch
+    save_compiled_grid();
     reset();
     slack_bus_id_ = generators_.get_slack_bus_id(gen_slackbus_);
-    init_Ybus(Ybus_, Sbus_, id_me_to_solver_, id_solver_to_me_, slack_bus_id_solver_);
+    init_Ybus(Ybus_, Sbus_, id_me_to_solver_, id_solver_to_me_, slack_bus_id_, slack_bus_id_solver_);
     fillYbus(Ybus_, is_ac, id_me_to_solver_);
+    ybus_ac_ = is_ac;
     fillpv_pq(id_me_to_solver_);
     generators_.init_q_vector(bus_vn_kv_.size());
     // }
-    fillSbus_me(Sbus_, is_ac, id_me_to_solver_, slack_bus_id_solver_);
+    const double p_slack_added = fillSbus_me(Sbus_, is_ac, id_me_to_solver_, slack_bus_id_solver_);
+    if(is_ac) init_slack_weights(p_slack_added);
+    else _solver.set_slack_weights(Eigen::VectorXd());
 
     int nb_bus_solver = id_solver_to_me_.size();
     Eigen::VectorXcd V = Eigen::VectorXcd::Constant(nb_bus_solver, 1.04);
@@ -239,6 +856,7 @@ void GridModel::init_Ybus(Eigen::SparseMatrix<cdouble> & Ybus,
                           Eigen::VectorXcd & Sbus,
                           std::vector<int>& id_me_to_solver,
                           std::vector<int>& id_solver_to_me,
+                          int slack_bus_id,
                           int & slack_bus_id_solver){
     //TODO get disconnected bus !!! (and have some conversion for it)
     //1. init the conversion bus
@@ -261,7 +879,7 @@ void GridModel::init_Ybus(Eigen::SparseMatrix<cdouble> & Ybus,
     Ybus.reserve(nb_bus + 2*powerlines_.nb() + 2*trafos_.nb());
 
     Sbus = Eigen::VectorXcd::Constant(nb_bus, 0.);
-    slack_bus_id_solver = id_me_to_solver[slack_bus_id_];
+    slack_bus_id_solver = id_me_to_solver[slack_bus_id];
     if(slack_bus_id_solver == _deactivated_bus_id){
         //TODO improve error message with the gen_id
         throw std::runtime_error("The slack bus is disconnected.");
@@ -277,16 +895,55 @@ void GridModel::fillYbus(Eigen::SparseMatrix<cdouble> & res, bool ac, const std:
     // init the Ybus matrix
     std::vector<Eigen::Triplet<cdouble> > tripletList;
     tripletList.reserve(bus_vn_kv_.size() + 4*powerlines_.nb() + 4*trafos_.nb() + shunts_.nb());
-    powerlines_.fillYbus(tripletList, ac, id_me_to_solver);
-    shunts_.fillYbus(tripletList, ac, id_me_to_solver);
-    trafos_.fillYbus(tripletList, ac, id_me_to_solver);
-    loads_.fillYbus(tripletList, ac, id_me_to_solver);
-    generators_.fillYbus(tripletList, ac, id_me_to_solver);
+    if(!parallel_ybus_ || (bus_vn_kv_.size() < _parallel_min_nb_bus)){
+        powerlines_.fillYbus(tripletList, ac, id_me_to_solver);
+        shunts_.fillYbus(tripletList, ac, id_me_to_solver);
+        trafos_.fillYbus(tripletList, ac, id_me_to_solver);
+        loads_.fillYbus(tripletList, ac, id_me_to_solver);
+        generators_.fillYbus(tripletList, ac, id_me_to_solver);
+    }else{
+        // large grid: each type of element is filled in its own buffer, in parallel (if openmp is available)
+        // exceptions cannot leave a parallel region, they are forwarded after it
+        std::vector<Eigen::Triplet<cdouble> > triplets_trafo;
+        std::vector<Eigen::Triplet<cdouble> > triplets_other;
+        triplets_trafo.reserve(4*trafos_.nb());
+        triplets_other.reserve(shunts_.nb());
+        std::exception_ptr error_line = nullptr;
+        std::exception_ptr error_trafo = nullptr;
+        std::exception_ptr error_other = nullptr;
+        #pragma omp parallel sections
+        {
+            #pragma omp section
+            {
+                try{ powerlines_.fillYbus(tripletList, ac, id_me_to_solver); }
+                catch(...){ error_line = std::current_exception(); }
+            }
+            #pragma omp section
+            {
+                try{ trafos_.fillYbus(triplets_trafo, ac, id_me_to_solver); }
+                catch(...){ error_trafo = std::current_exception(); }
+            }
+            #pragma omp section
+            {
+                try{
+                    shunts_.fillYbus(triplets_other, ac, id_me_to_solver);
+                    loads_.fillYbus(triplets_other, ac, id_me_to_solver);
+                    generators_.fillYbus(triplets_other, ac, id_me_to_solver);
+                }
+                catch(...){ error_other = std::current_exception(); }
+            }
+        }
+        if(error_line) std::rethrow_exception(error_line);
+        if(error_trafo) std::rethrow_exception(error_trafo);
+        if(error_other) std::rethrow_exception(error_other);
+        tripletList.insert(tripletList.end(), triplets_trafo.begin(), triplets_trafo.end());
+        tripletList.insert(tripletList.end(), triplets_other.begin(), triplets_other.end());
+    }
     res.setFromTriplets(tripletList.begin(), tripletList.end());
     res.makeCompressed();
 }
 
-void GridModel::fillSbus_me(Eigen::VectorXcd & res, bool ac, const std::vector<int>& id_me_to_solver, int slack_bus_id_solver)
+double GridModel::fillSbus_me(Eigen::VectorXcd & res, bool ac, const std::vector<int>& id_me_to_solver, int slack_bus_id_solver)
 {
     // init the Sbus vector
     powerlines_.fillSbus(res, ac, id_me_to_solver);
@@ -298,6 +955,39 @@ void GridModel::fillSbus_me(Eigen::VectorXcd & res, bool ac, const std::vector<i
     // handle slack bus
     double sum_active = res.sum().real();
     res.coeffRef(slack_bus_id_solver) -= sum_active;
+    return -sum_active;
+}
+
+Eigen::VectorXd GridModel::gen_slack_participation() const
+{
+    if(gen_slack_weights_.size() == 0) return Eigen::VectorXd();
+    const auto & status = generators_.get_status();
+    const int nb_gen = gen_slack_weights_.size();
+    Eigen::VectorXd res = Eigen::VectorXd::Zero(nb_gen);
+    for(int gen_id = 0; gen_id < nb_gen; ++gen_id){
+        if(status[gen_id]) res(gen_id) = gen_slack_weights_(gen_id);
+    }
+    const double sum_weights = res.sum();
+    if(sum_weights <= 0.) return Eigen::VectorXd();  // no connected generator participates
+    return res / sum_weights;
+}
+
+void GridModel::init_slack_weights(double p_slack_added)
+{
+    Eigen::VectorXd gen_weights = gen_slack_participation();
+    Eigen::VectorXd bus_weights;
+    if(gen_weights.size() > 0){
+        const auto & gen_bus_id = generators_.get_bus_id();
+        const int nb_gen = gen_weights.size();
+        bus_weights = Eigen::VectorXd::Zero(id_solver_to_me_.size());
+        for(int gen_id = 0; gen_id < nb_gen; ++gen_id){
+            if(gen_weights(gen_id) == 0.) continue;
+            bus_weights(id_me_to_solver_[gen_bus_id(gen_id)]) += gen_weights(gen_id);
+        }
+        // the imbalance is shared by the solver: the slack bus keeps its own injection
+        Sbus_.coeffRef(slack_bus_id_solver_) -= p_slack_added;
+    }
+    _solver.set_slack_weights(bus_weights);
 }
 
 void GridModel::fillpv_pq(const std::vector<int>& id_me_to_solver)
@@ -350,6 +1040,8 @@ void GridModel::compute_results(){
     p_slack += loads_.get_p_slack(slack_bus_id_);
     p_slack += shunts_.get_p_slack(slack_bus_id_);
     generators_.set_p_slack(gen_slackbus_, p_slack);
+    const double p_distributed = _solver.get_slack_p();
+    if(p_distributed != 0.) generators_.add_p_distributed_slack(gen_slack_participation(), p_distributed, gen_slackbus_);
 
     // handle gen_q now
     std::vector<double> q_by_bus = std::vector<double>(bus_vn_kv_.size(), 0.);
@@ -388,7 +1080,7 @@ Eigen::VectorXcd GridModel::dc_pf_old(const Eigen::VectorXcd & Vinit,
 
     //if(need_reset_){
     slack_bus_id_ = generators_.get_slack_bus_id(gen_slackbus_);
-    init_Ybus(dcYbus_tmp, Sbus_tmp, id_me_to_solver, id_solver_to_me, slack_bus_id_solver);
+    init_Ybus(dcYbus_tmp, Sbus_tmp, id_me_to_solver, id_solver_to_me, slack_bus_id_, slack_bus_id_solver);
     fillYbus(dcYbus_tmp, false, id_me_to_solver);
     // fillpv_pq(id_me_to_solver);
     //}
@@ -528,6 +1220,778 @@ Eigen::VectorXcd GridModel::dc_pf(const Eigen::VectorXcd & Vinit,
     return res;
 }
 
+bool GridModel::update_graph()
+{
+    const Eigen::VectorXi & line_or = powerlines_.get_bus_or_id();
+    const Eigen::VectorXi & line_ex = powerlines_.get_bus_ex_id();
+    const Eigen::VectorXi & trafo_hv = trafos_.get_bus_hv_id();
+    const Eigen::VectorXi & trafo_lv = trafos_.get_bus_lv_id();
+    const std::vector<bool> & line_status = powerlines_.get_status();
+    const std::vector<bool> & trafo_status = trafos_.get_status();
+    const int nb_line = static_cast<int>(line_or.size());
+    const int nb_edge = nb_line + static_cast<int>(trafo_hv.size());
+
+    // 1. topology, only the edges that changed are updated
+    bool topo_changed = false;
+    if((graph_edge_or_.size() != nb_edge) || (graph_csr_indptr_.size() != bus_vn_kv_.size() + 1)){
+        // first call (or the grid has been modified)
+        graph_edge_or_ = Eigen::VectorXi::Constant(nb_edge, _deactivated_bus_id);
+        graph_edge_ex_ = Eigen::VectorXi::Constant(nb_edge, _deactivated_bus_id);
+        graph_features_ = RealMatRowMajor::Zero(nb_edge, graph_nb_features);
+        // fixed capacity (each edge connected is given in both directions): the views of python stay valid
+        graph_csr_indptr_ = Eigen::VectorXi::Zero(bus_vn_kv_.size() + 1);
+        graph_csr_indices_ = Eigen::VectorXi::Zero(2 * nb_edge);
+        graph_csr_edges_ = Eigen::VectorXi::Zero(2 * nb_edge);
+        graph_csr_nnz_ = 0;
+        topo_changed = true;
+    }
+    for(int edge_id = 0; edge_id < nb_edge; ++edge_id){
+        int bus_or, bus_ex;
+        if(edge_id < nb_line){
+            const bool status = line_status[edge_id];
+            bus_or = status ? line_or(edge_id) : _deactivated_bus_id;
+            bus_ex = status ? line_ex(edge_id) : _deactivated_bus_id;
+        }else{
+            const int trafo_id = edge_id - nb_line;
+            const bool status = trafo_status[trafo_id];
+            bus_or = status ? trafo_hv(trafo_id) : _deactivated_bus_id;
+            bus_ex = status ? trafo_lv(trafo_id) : _deactivated_bus_id;
+        }
+        if((graph_edge_or_(edge_id) != bus_or) || (graph_edge_ex_(edge_id) != bus_ex)){
+            graph_edge_or_(edge_id) = bus_or;
+            graph_edge_ex_(edge_id) = bus_ex;
+            topo_changed = true;
+        }
+    }
+    if(topo_changed) build_graph_csr();
+
+    // 2. features
+    const tuple4d line_or_res = powerlines_.get_lineor_res();
+    const tuple4d line_ex_res = powerlines_.get_lineex_res();
+    const tuple4d trafo_hv_res = trafos_.get_res_hv();
+    const tuple4d trafo_lv_res = trafos_.get_res_lv();
+    const bool has_res = (std::get<0>(line_or_res).size() == nb_line) &&
+                         (std::get<0>(trafo_hv_res).size() == nb_edge - nb_line);
+    const double my_nan = std::numeric_limits<double>::quiet_NaN();
+    const Eigen::VectorXd & line_r = powerlines_.get_r();
+    const Eigen::VectorXd & line_x = powerlines_.get_x();
+    const Eigen::VectorXd & trafo_r = trafos_.get_r();
+    const Eigen::VectorXd & trafo_x = trafos_.get_x();
+    const Eigen::VectorXd & trafo_ratio = trafos_.get_ratio();
+    for(int edge_id = 0; edge_id < nb_edge; ++edge_id){
+        const bool is_line = edge_id < nb_line;
+        const int el_id = is_line ? edge_id : edge_id - nb_line;
+        const tuple4d & res_or = is_line ? line_or_res : trafo_hv_res;
+        const tuple4d & res_ex = is_line ? line_ex_res : trafo_lv_res;
+        auto row = graph_features_.row(edge_id);
+        if(graph_edge_or_(edge_id) == _deactivated_bus_id){
+            row.head<6>().setZero();
+        }else if(!has_res){
+            row.head<6>().setConstant(my_nan);
+        }else{
+            row(0) = std::get<0>(res_or)(el_id);
+            row(1) = std::get<1>(res_or)(el_id);
+            row(2) = std::get<3>(res_or)(el_id);
+            row(3) = std::get<0>(res_ex)(el_id);
+            row(4) = std::get<1>(res_ex)(el_id);
+            row(5) = std::get<3>(res_ex)(el_id);
+        }
+        const cdouble y = 1. / (is_line ? cdouble(line_r(el_id), line_x(el_id)) : cdouble(trafo_r(el_id), trafo_x(el_id)));
+        row(6) = std::real(y);
+        row(7) = std::imag(y);
+        row(8) = is_line ? 1. : trafo_ratio(el_id);
+    }
+    return topo_changed;
+}
+
+void GridModel::build_graph_csr()
+{
+    const int nb_bus_me = static_cast<int>(bus_vn_kv_.size());
+    const int nb_edge = static_cast<int>(graph_edge_or_.size());
+
+    // counting sort of the (directed) edges by origin bus
+    // (the buffers are allocated by update_graph, they are filled in place)
+    graph_csr_indptr_.setZero();
+    for(int edge_id = 0; edge_id < nb_edge; ++edge_id){
+        const int bus_or = graph_edge_or_(edge_id);
+        const int bus_ex = graph_edge_ex_(edge_id);
+        if(bus_or == _deactivated_bus_id) continue;
+        if((bus_or < 0) || (bus_or >= nb_bus_me) || (bus_ex < 0) || (bus_ex >= nb_bus_me)){
+            throw std::runtime_error("GridModel::update_graph: a branch is connected to a bus that does not exist");
+        }
+        ++graph_csr_indptr_(bus_or + 1);
+        ++graph_csr_indptr_(bus_ex + 1);
+    }
+    for(int bus_id = 0; bus_id < nb_bus_me; ++bus_id) graph_csr_indptr_(bus_id + 1) += graph_csr_indptr_(bus_id);
+
+    graph_csr_nnz_ = graph_csr_indptr_(nb_bus_me);
+    Eigen::VectorXi next = graph_csr_indptr_.head(nb_bus_me);
+    for(int edge_id = 0; edge_id < nb_edge; ++edge_id){
+        const int bus_or = graph_edge_or_(edge_id);
+        const int bus_ex = graph_edge_ex_(edge_id);
+        if(bus_or == _deactivated_bus_id) continue;
+        graph_csr_indices_(next(bus_or)) = bus_ex;
+        graph_csr_edges_(next(bus_or)) = edge_id;
+        ++next(bus_or);
+        graph_csr_indices_(next(bus_ex)) = bus_or;
+        graph_csr_edges_(next(bus_ex)) = edge_id;
+        ++next(bus_ex);
+    }
+}
+
+void GridModel::change_ratio_trafo(int trafo_id, double new_ratio)
+{
+    if((trafo_id < 0) || (trafo_id >= trafos_.nb())) throw std::out_of_range("change_ratio_trafo: invalid transformer id");
+    double old_ratio = trafos_.get_ratio()(trafo_id);
+    trafos_.change_ratio(trafo_id, new_ratio, need_reset_);
+    update_Ybus_ratio(trafo_id, old_ratio);
+}
+
+void GridModel::change_tap_trafo(int trafo_id, int new_tap_pos)
+{
+    if((trafo_id < 0) || (trafo_id >= trafos_.nb())) throw std::out_of_range("change_tap_trafo: invalid transformer id");
+    double old_ratio = trafos_.get_ratio()(trafo_id);
+    trafos_.change_tap(trafo_id, new_tap_pos, need_reset_);
+    update_Ybus_ratio(trafo_id, old_ratio);
+}
+
+void GridModel::update_Ybus_ratio(int trafo_id, double old_ratio)
+{
+    if(Ybus_.size() == 0) return;  // Ybus will be computed by the next powerflow
+    // Ybus_ is modified: a checkpoint needs its current value
+    save_compiled_grid(true);
+    trafos_.update_Ybus_ratio(Ybus_, trafo_id, old_ratio, ybus_ac_, id_me_to_solver_);
+    _solver.ybus_modified();
+}
+
+void GridModel::change_p_shunt(int shunt_id, double new_p)
+{
+    if((shunt_id < 0) || (shunt_id >= shunts_.nb())) throw std::out_of_range("change_p_shunt: invalid shunt id");
+    double old_p = shunts_.get_p_mw()(shunt_id);
+    double old_q = shunts_.get_q_mvar()(shunt_id);
+    shunts_.change_p(shunt_id, new_p, need_reset_);
+    update_Ybus_shunt(shunt_id, old_p, old_q);
+}
+
+void GridModel::change_q_shunt(int shunt_id, double new_q)
+{
+    if((shunt_id < 0) || (shunt_id >= shunts_.nb())) throw std::out_of_range("change_q_shunt: invalid shunt id");
+    double old_p = shunts_.get_p_mw()(shunt_id);
+    double old_q = shunts_.get_q_mvar()(shunt_id);
+    shunts_.change_q(shunt_id, new_q, need_reset_);
+    update_Ybus_shunt(shunt_id, old_p, old_q);
+}
+
+void GridModel::update_Ybus_shunt(int shunt_id, double old_p, double old_q)
+{
+    if(Ybus_.size() == 0) return;  // Ybus will be computed by the next powerflow
+    if(!ybus_ac_){
+        // the shunts are not in the dc admittance matrix, the ac one will be computed by the next powerflow
+        need_reset_ = true;
+        return;
+    }
+    // Ybus_ is modified: a checkpoint needs its current value
+    save_compiled_grid(true);
+    shunts_.update_Ybus(Ybus_, shunt_id, old_p, old_q, id_me_to_solver_);
+    _solver.ybus_modified();
+}
+
+void GridModel::add_oltc(int trafo_id, int controlled_bus, double v_target_pu, double deadband_pu, int tap_min, int tap_max)
+{
+    if((trafo_id < 0) || (trafo_id >= trafos_.nb())) throw std::out_of_range("add_oltc: invalid transformer id");
+    if((controlled_bus < 0) || (controlled_bus >= bus_vn_kv_.size())) throw std::out_of_range("add_oltc: invalid bus id");
+    if(trafos_.get_tap_step_pct()(trafo_id) == 0.) throw std::runtime_error("add_oltc: this transformer has no tap changer (its tap_step_pct is 0)");
+    if(tap_min > tap_max) throw std::runtime_error("add_oltc: tap_min should be lower than tap_max");
+    if(deadband_pu < 0.) throw std::runtime_error("add_oltc: the deadband should be positive");
+    OltcControl control;
+    control.trafo_id = trafo_id;
+    control.controlled_bus = controlled_bus;
+    control.v_target_pu = v_target_pu;
+    control.deadband_pu = deadband_pu;
+    control.tap_min = tap_min;
+    control.tap_max = tap_max;
+    oltc_controls_.push_back(control);
+}
+
+int GridModel::estimate_tap_steps(int trafo_id, int controlled_bus, double vm_pu, double v_target_pu) const
+{
+    // sensitivity of the voltage to the tap: the voltages of the lv side are (roughly) divided by the ratio
+    const double ratio = trafos_.get_ratio()(trafo_id);
+    const bool is_hv = controlled_bus == trafos_.get_bus_hv_id()(trafo_id);
+    const double dv_dratio = is_hv ? vm_pu / ratio : -vm_pu / ratio;
+    const double dratio_dtap = 0.01 * trafos_.get_tap_step_pct()(trafo_id) * (trafos_.is_tap_hv(trafo_id) ? 1.0 : -1.0);
+    const double dv_dtap = dv_dratio * dratio_dtap;
+    int nb_step = static_cast<int>(std::round((v_target_pu - vm_pu) / dv_dtap));
+    if(nb_step == 0) nb_step = (v_target_pu - vm_pu) * dv_dtap > 0. ? 1 : -1;
+    return nb_step;
+}
+
+Eigen::VectorXcd GridModel::ac_pf_oltc(const Eigen::VectorXcd & Vinit,
+                                       int max_iter,
+                                       double tol,
+                                       int max_tap_iter)
+{
+    int nb_bus = bus_vn_kv_.size();
+    if(Vinit.size() != nb_bus){
+        throw std::runtime_error("GridModel::ac_pf_oltc: Size of the Vinit should be the same as the total number of buses (both connected and disconnected).");
+    }
+    bool conv = false;
+    Eigen::VectorXcd res = Eigen::VectorXcd();
+    SolverType solver_type = _solver.get_type();
+    oltc_nb_iter_ = 0;
+
+    Eigen::VectorXcd V = pre_process_solver(Vinit, true);
+    last_recovery_stage_ = RecoveryStage::NoRecovery;
+    conv = _solver.compute_pf(Ybus_, V, Sbus_, bus_pv_, bus_pq_, max_iter, tol);
+    if(!conv && !recovery_stages_.empty()) conv = recover_ac_pf(V, max_iter, tol);
+
+    while(conv && (oltc_nb_iter_ < max_tap_iter)){
+        Eigen::VectorXcd V_solver = _solver.get_V();
+        bool tap_changed = false;
+        for(const auto & control : oltc_controls_){
+            const int trafo_id = control.trafo_id;
+            if(!trafos_.get_status()[trafo_id]) continue;
+            const int bus_solver_id = id_me_to_solver_[control.controlled_bus];
+            if(bus_solver_id == _deactivated_bus_id) continue;
+            const double vm = std::abs(V_solver(bus_solver_id));
+            if(std::abs(vm - control.v_target_pu) <= control.deadband_pu) continue;
+
+            const int nb_step = estimate_tap_steps(trafo_id, control.controlled_bus, vm, control.v_target_pu);
+            const int tap_pos = static_cast<int>(std::round(trafos_.get_tap_pos()(trafo_id)));
+            const int new_tap_pos = std::max(control.tap_min, std::min(control.tap_max, tap_pos + nb_step));
+            if(new_tap_pos == tap_pos) continue;  // the tap is at its limit
+            change_tap_trafo(trafo_id, new_tap_pos);
+            tap_changed = true;
+        }
+        if(!tap_changed) break;
+        ++oltc_nb_iter_;
+        // same Ybus sparsity pattern, pv and pq: the solver re uses its symbolic factorization
+        V = V_solver;
+        conv = _solver.compute_pf(Ybus_, V, Sbus_, bus_pv_, bus_pq_, max_iter, tol);
+    }
+
+    process_results(conv, res, Vinit);
+    _solver.restore_solver_at_next_pf(solver_type);
+    return res;
+}
+
+Eigen::VectorXd GridModel::redispatch_dc(const Eigen::VectorXd & gen_cost,
+                                         const Eigen::VectorXd & gen_target,
+                                         const Eigen::VectorXd & gen_ramp_down,
+                                         const Eigen::VectorXd & gen_ramp_up,
+                                         const Eigen::VectorXd & gen_pmin,
+                                         const Eigen::VectorXd & gen_pmax,
+                                         const Eigen::VectorXd & line_pmax,
+                                         const Eigen::VectorXd & trafo_pmax)
+{
+    const int nb_gen = generators_.nb();
+    const int nb_line = powerlines_.nb();
+    const int nb_trafo = trafos_.nb();
+    if((gen_cost.size() != nb_gen) || (gen_target.size() != nb_gen) || (gen_ramp_down.size() != nb_gen) ||
+       (gen_ramp_up.size() != nb_gen) || (gen_pmin.size() != nb_gen) || (gen_pmax.size() != nb_gen)){
+        throw std::runtime_error("GridModel::redispatch_dc: gen_cost, gen_target, gen_ramp_down, gen_ramp_up, gen_pmin and gen_pmax should have one value per generator");
+    }
+    if(line_pmax.size() != nb_line) throw std::runtime_error("GridModel::redispatch_dc: line_pmax should have one value per powerline");
+    if(trafo_pmax.size() != nb_trafo) throw std::runtime_error("GridModel::redispatch_dc: trafo_pmax should have one value per transformer");
+    update_dcopf_ptdf();
+
+    // dc flows before the redispatching
+    const int nb_bus_solver = static_cast<int>(dcopf_B_->rows()) + 1;
+    Eigen::VectorXcd Sbus = Eigen::VectorXcd::Constant(nb_bus_solver, 0.);
+    const double p_slack = fillSbus_me(Sbus, false, dcopf_id_me_to_solver_, dcopf_slack_solver_);
+    const Eigen::VectorXd flow_init = dcopf_flows(Sbus.real());
+
+    // variables: the redispatching of the generators that can be redispatched
+    const std::vector<bool> & gen_status = generators_.get_status();
+    const Eigen::VectorXd & gen_p = generators_.get_p();
+    std::vector<int> gen_ids;
+    std::vector<int> var_of_gen(nb_gen, -1);
+    for(int gen_id = 0; gen_id < nb_gen; ++gen_id){
+        if(!gen_status[gen_id] || gen_cost(gen_id) <= 0.) continue;
+        var_of_gen[gen_id] = gen_ids.size();
+        gen_ids.push_back(gen_id);
+    }
+    const int nb_var = gen_ids.size();
+
+    // branches with a limit
+    std::vector<int> branch_ids;
+    std::vector<int> row_of_branch(nb_line + nb_trafo, -1);
+    Eigen::VectorXd branch_pmax(nb_line + nb_trafo);
+    branch_pmax << line_pmax, trafo_pmax;
+    for(int branch_id = 0; branch_id < nb_line + nb_trafo; ++branch_id){
+        if(!std::isfinite(branch_pmax(branch_id))) continue;
+        row_of_branch[branch_id] = 2 * nb_var + 2 * branch_ids.size();
+        branch_ids.push_back(branch_id);
+    }
+
+    Eigen::VectorXd delta = Eigen::VectorXd::Zero(nb_gen);
+    if(nb_var == 0){
+        // nothing can be redispatched: the limits are only checked
+        for(int branch_id : branch_ids){
+            if(std::abs(flow_init(branch_id)) > branch_pmax(branch_id)){
+                throw std::runtime_error("GridModel::redispatch_dc: no redispatching satisfies the limits of the branches and of the generators");
+            }
+        }
+        dcopf_active_.clear();
+    }else{
+        // min sum_g cost_g * (delta_g - target_g)^2  such that  sum_g delta_g = 0
+        Eigen::MatrixXd H = Eigen::MatrixXd::Zero(nb_var, nb_var);
+        Eigen::VectorXd g(nb_var);
+        for(int var_id = 0; var_id < nb_var; ++var_id){
+            const int gen_id = gen_ids[var_id];
+            H(var_id, var_id) = 2. * gen_cost(gen_id);
+            g(var_id) = -2. * gen_cost(gen_id) * gen_target(gen_id);
+        }
+        const Eigen::MatrixXd Aeq = Eigen::MatrixXd::Ones(1, nb_var);
+        const Eigen::VectorXd beq = Eigen::VectorXd::Zero(1);
+
+        // Ain.delta <= bin: upper and lower bounds of each generator, then of the flow of each limited branch
+        const int nb_row = 2 * nb_var + 2 * branch_ids.size();
+        Eigen::MatrixXd Ain = Eigen::MatrixXd::Zero(nb_row, nb_var);
+        Eigen::VectorXd bin(nb_row);
+        for(int var_id = 0; var_id < nb_var; ++var_id){
+            const int gen_id = gen_ids[var_id];
+            double p_init = gen_p(gen_id);
+            if(gen_id == gen_slackbus_) p_init += p_slack;
+            Ain(2 * var_id, var_id) = 1.;
+            bin(2 * var_id) = std::min(gen_ramp_up(gen_id), gen_pmax(gen_id) - p_init);
+            Ain(2 * var_id + 1, var_id) = -1.;
+            bin(2 * var_id + 1) = -std::max(-gen_ramp_down(gen_id), gen_pmin(gen_id) - p_init);
+        }
+        for(int branch_id : branch_ids){
+            const int row = row_of_branch[branch_id];
+            for(int var_id = 0; var_id < nb_var; ++var_id){
+                Ain(row, var_id) = dcopf_ptdf_(branch_id, gen_ids[var_id]);
+                Ain(row + 1, var_id) = -dcopf_ptdf_(branch_id, gen_ids[var_id]);
+            }
+            bin(row) = branch_pmax(branch_id) - flow_init(branch_id);
+            bin(row + 1) = branch_pmax(branch_id) + flow_init(branch_id);
+        }
+
+        // warm start: the constraints active at the previous solution (if they still exist)
+        std::vector<int> warm_start;
+        for(int code : dcopf_active_){
+            const int id = code / 2;
+            int row = -1;
+            if(id < nb_gen){
+                if(var_of_gen[id] >= 0) row = 2 * var_of_gen[id];
+            }else if(id - nb_gen < nb_line + nb_trafo){
+                row = row_of_branch[id - nb_gen];
+            }
+            if(row >= 0) warm_start.push_back(row + code % 2);
+        }
+        dcopf_qp_.set_warm_start(warm_start);
+        if(!dcopf_qp_.solve(H, g, Aeq, beq, Ain, bin)){
+            throw std::runtime_error("GridModel::redispatch_dc: no redispatching satisfies the limits of the branches and of the generators");
+        }
+
+        const Eigen::VectorXd & x = dcopf_qp_.get_x();
+        for(int var_id = 0; var_id < nb_var; ++var_id) delta(gen_ids[var_id]) = x(var_id);
+        dcopf_active_.clear();
+        for(int row : dcopf_qp_.get_active_set()){
+            const int code_id = row < 2 * nb_var ? gen_ids[row / 2] : nb_gen + branch_ids[(row - 2 * nb_var) / 2];
+            dcopf_active_.push_back(2 * code_id + row % 2);
+        }
+    }
+
+    const Eigen::VectorXd flow = flow_init + dcopf_ptdf_ * delta;
+    dcopf_line_p_ = flow.head(nb_line);
+    dcopf_trafo_p_ = flow.tail(nb_trafo);
+    return delta;
+}
+
+void GridModel::update_dcopf_ptdf()
+{
+    // everything the dc admittance matrix and the sensitivities depend on
+    const int nb_line = powerlines_.nb();
+    const int nb_trafo = trafos_.nb();
+    const int nb_gen = generators_.nb();
+    const std::vector<bool> & line_status = powerlines_.get_status();
+    const std::vector<bool> & trafo_status = trafos_.get_status();
+    const std::vector<bool> & gen_status = generators_.get_status();
+    std::vector<double> topology;
+    topology.reserve(bus_status_.size() + 4 * nb_line + 5 * nb_trafo + 2 * nb_gen + 1);
+    for(bool status : bus_status_) topology.push_back(status);
+    for(int line_id = 0; line_id < nb_line; ++line_id){
+        topology.push_back(line_status[line_id]);
+        topology.push_back(powerlines_.get_bus_or_id()(line_id));
+        topology.push_back(powerlines_.get_bus_ex_id()(line_id));
+        topology.push_back(powerlines_.get_x()(line_id));
+    }
+    for(int trafo_id = 0; trafo_id < nb_trafo; ++trafo_id){
+        topology.push_back(trafo_status[trafo_id]);
+        topology.push_back(trafos_.get_bus_hv_id()(trafo_id));
+        topology.push_back(trafos_.get_bus_lv_id()(trafo_id));
+        topology.push_back(trafos_.get_x()(trafo_id));
+        topology.push_back(trafos_.get_ratio()(trafo_id));
+    }
+    for(int gen_id = 0; gen_id < nb_gen; ++gen_id){
+        topology.push_back(gen_status[gen_id]);
+        topology.push_back(generators_.get_bus_id()(gen_id));
+    }
+    topology.push_back(gen_slackbus_);
+    if(dcopf_B_ && (topology == dcopf_topology_)) return;
+    dcopf_B_.reset();
+
+    // dc admittance matrix (Ybus_, the slack bus of the last powerflow and the solver are not modified)
+    Eigen::SparseMatrix<cdouble> Ybus;
+    Eigen::VectorXcd Sbus;
+    std::vector<int> id_solver_to_me;
+    init_Ybus(Ybus, Sbus, dcopf_id_me_to_solver_, id_solver_to_me, generators_.get_slack_bus_id(gen_slackbus_),
+              dcopf_slack_solver_);
+    fillYbus(Ybus, false, dcopf_id_me_to_solver_);
+
+    // real part, without the slack bus
+    const int nb_bus_solver = Ybus.rows();
+    const int slack = dcopf_slack_solver_;
+    std::vector<Eigen::Triplet<double> > tripletList;
+    tripletList.reserve(Ybus.nonZeros());
+    for(int col = 0; col < nb_bus_solver; ++col){
+        if(col == slack) continue;
+        for(Eigen::SparseMatrix<cdouble>::InnerIterator it(Ybus, col); it; ++it){
+            const int row = it.row();
+            if(row == slack) continue;
+            tripletList.push_back(Eigen::Triplet<double>(row > slack ? row - 1 : row, col > slack ? col - 1 : col, std::real(it.value())));
+        }
+    }
+    Eigen::SparseMatrix<double> B(nb_bus_solver - 1, nb_bus_solver - 1);
+    B.setFromTriplets(tripletList.begin(), tripletList.end());
+    B.makeCompressed();
+    std::unique_ptr<Eigen::SparseLU<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > > B_lu(new Eigen::SparseLU<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> >());
+    B_lu->analyzePattern(B);
+    B_lu->factorize(B);
+    if(B_lu->info() != Eigen::Success) throw std::runtime_error("GridModel::redispatch_dc: the dc admittance matrix is singular (the grid is probably not connected)");
+
+    // branches: powerlines then transformers
+    dcopf_branch_from_ = Eigen::VectorXi::Constant(nb_line + nb_trafo, _deactivated_bus_id);
+    dcopf_branch_to_ = Eigen::VectorXi::Constant(nb_line + nb_trafo, _deactivated_bus_id);
+    dcopf_branch_b_ = Eigen::VectorXd::Zero(nb_line + nb_trafo);
+    for(int line_id = 0; line_id < nb_line; ++line_id){
+        if(!line_status[line_id]) continue;
+        dcopf_branch_from_(line_id) = dcopf_id_me_to_solver_[powerlines_.get_bus_or_id()(line_id)];
+        dcopf_branch_to_(line_id) = dcopf_id_me_to_solver_[powerlines_.get_bus_ex_id()(line_id)];
+        const double x = powerlines_.get_x()(line_id);
+        if(x != 0.) dcopf_branch_b_(line_id) = 1. / x;
+    }
+    for(int trafo_id = 0; trafo_id < nb_trafo; ++trafo_id){
+        if(!trafo_status[trafo_id]) continue;
+        dcopf_branch_from_(nb_line + trafo_id) = dcopf_id_me_to_solver_[trafos_.get_bus_hv_id()(trafo_id)];
+        dcopf_branch_to_(nb_line + trafo_id) = dcopf_id_me_to_solver_[trafos_.get_bus_lv_id()(trafo_id)];
+        const double x = trafos_.get_x()(trafo_id);
+        if(x != 0.) dcopf_branch_b_(nb_line + trafo_id) = 1. / (x * trafos_.get_ratio()(trafo_id));
+    }
+    dcopf_B_ = std::move(B_lu);
+
+    // sensitivities: one more MW produced by a generator (and consumed at the slack bus)
+    dcopf_ptdf_ = Eigen::MatrixXd::Zero(nb_line + nb_trafo, nb_gen);
+    Eigen::VectorXd P(nb_bus_solver);
+    for(int gen_id = 0; gen_id < nb_gen; ++gen_id){
+        if(!gen_status[gen_id]) continue;
+        const int bus_solver = dcopf_id_me_to_solver_[generators_.get_bus_id()(gen_id)];
+        if(bus_solver == _deactivated_bus_id) throw std::runtime_error("GridModel::redispatch_dc: a generator is connected to a disconnected bus");
+        P.setZero();
+        P(bus_solver) = 1.;
+        dcopf_ptdf_.col(gen_id) = dcopf_flows(P);
+    }
+    dcopf_topology_ = topology;
+}
+
+Eigen::VectorXd GridModel::dcopf_flows(const Eigen::VectorXd & P) const
+{
+    const int slack = dcopf_slack_solver_;
+    const int nb_bus_solver = P.size();
+    Eigen::VectorXd P_reduced(nb_bus_solver - 1);
+    P_reduced << P.head(slack), P.tail(nb_bus_solver - slack - 1);
+    const Eigen::VectorXd theta_reduced = dcopf_B_->solve(P_reduced);
+    Eigen::VectorXd theta(nb_bus_solver);
+    theta << theta_reduced.head(slack), 0., theta_reduced.tail(nb_bus_solver - slack - 1);
+
+    const int nb_branch = dcopf_branch_b_.size();
+    Eigen::VectorXd flows = Eigen::VectorXd::Zero(nb_branch);
+    for(int branch_id = 0; branch_id < nb_branch; ++branch_id){
+        const int from = dcopf_branch_from_(branch_id);
+        if(from == _deactivated_bus_id) continue;
+        flows(branch_id) = dcopf_branch_b_(branch_id) * (theta(from) - theta(dcopf_branch_to_(branch_id)));
+    }
+    return flows;
+}
+
+void GridModel::set_memo_size(int max_nb_entries)
+{
+    if(max_nb_entries < 0) throw std::runtime_error("GridModel::set_memo_size: max_nb_entries should be >= 0");
+    memo_size_ = max_nb_entries;
+    while(static_cast<int>(memo_.size()) > memo_size_){
+        auto range = memo_index_.equal_range(memo_.back().hash);
+        for(auto it = range.first; it != range.second; ++it){
+            if(it->second == std::prev(memo_.end())){
+                memo_index_.erase(it);
+                break;
+            }
+        }
+        memo_.pop_back();
+    }
+}
+
+void GridModel::clear_memo()
+{
+    memo_.clear();
+    memo_index_.clear();
+    memo_nb_hit_ = 0;
+    memo_nb_miss_ = 0;
+}
+
+std::vector<std::tuple<KLUParameters, double, double> > GridModel::tune_klu(const std::vector<KLUParameters> & candidates,
+                                                                           int nb_repeat)
+{
+    Eigen::SparseMatrix<double> J;
+    try{
+        J = get_J();
+    }catch(const std::runtime_error &){
+        // last powerflow not made by a newton raphson solver
+    }
+    if(J.cols() == 0) throw std::runtime_error("GridModel::tune_klu: there is no jacobian matrix, an ac powerflow (with at least one iteration) should be computed first");
+    auto res = _solver.benchmark_klu_parameters(J, candidates, _klu_tune_nb_refactor, nb_repeat);
+
+    double min_error = std::numeric_limits<double>::infinity();
+    for(const auto & el : res) min_error = std::min(min_error, std::get<2>(el));
+    const double max_error = std::max(_klu_tune_max_error, 10. * min_error);
+    int best = -1;
+    for(int i = 0; i < static_cast<int>(res.size()); ++i){
+        if(std::get<2>(res[i]) > max_error) continue;
+        if(best < 0 || std::get<1>(res[i]) < std::get<1>(res[best])) best = i;
+    }
+    if(best < 0) throw std::runtime_error("GridModel::tune_klu: no candidate can factorize the jacobian matrix accurately");
+    set_klu_parameters(std::get<0>(res[best]));
+    return res;
+}
+
+template<class F>
+void GridModel::memo_visit(F & visitor, bool dc_init, int max_iter, double tol) const
+{
+    // topology and injections (the other parameters of the elements are only modified by init_* and set_state,
+    // that remove all the entries)
+    memo_visit_values(visitor, bus_status_);
+    memo_visit_values(visitor, powerlines_.get_status());
+    memo_visit_values(visitor, powerlines_.get_bus_or_id());
+    memo_visit_values(visitor, powerlines_.get_bus_ex_id());
+    memo_visit_values(visitor, trafos_.get_status());
+    memo_visit_values(visitor, trafos_.get_bus_hv_id());
+    memo_visit_values(visitor, trafos_.get_bus_lv_id());
+    memo_visit_values(visitor, trafos_.get_ratio());
+    memo_visit_values(visitor, shunts_.get_status());
+    memo_visit_values(visitor, shunts_.get_bus_id());
+    memo_visit_values(visitor, shunts_.get_p_mw());
+    memo_visit_values(visitor, shunts_.get_q_mvar());
+    memo_visit_values(visitor, generators_.get_status());
+    memo_visit_values(visitor, generators_.get_bus_id());
+    memo_visit_values(visitor, generators_.get_p());
+    memo_visit_values(visitor, generators_.get_vm());
+    memo_visit_values(visitor, loads_.get_status());
+    memo_visit_values(visitor, loads_.get_bus_id());
+    memo_visit_values(visitor, loads_.get_p());
+    memo_visit_values(visitor, loads_.get_q());
+    visitor(gen_slackbus_);
+    memo_visit_values(visitor, gen_slack_weights_);
+
+    // configuration of the solver
+    visitor(static_cast<int>(_solver.get_type()));
+    visitor(static_cast<int>(_solver.get_step_control()));
+    visitor(static_cast<int>(_solver.get_precision()));
+    visitor(static_cast<int>(_solver.get_sparse_kernel()));
+    const KLUParameters::StateRes klu_parameters = _solver.get_klu_parameters().get_state();
+    visitor(std::get<0>(klu_parameters));
+    visitor(std::get<1>(klu_parameters));
+    visitor(std::get<2>(klu_parameters));
+    visitor(std::get<3>(klu_parameters));
+    visitor(static_cast<double>(recovery_stages_.size()));
+    for(const auto & stage : recovery_stages_) visitor(static_cast<int>(stage));
+
+    // arguments of the powerflow
+    visitor(dc_init);
+    visitor(max_iter);
+    visitor(tol);
+    visitor(compute_results_);
+}
+
+std::uint64_t GridModel::memo_hash(bool dc_init, int max_iter, double tol) const
+{
+    MemoHash visitor;
+    memo_visit(visitor, dc_init, max_iter, tol);
+    return visitor.res;
+}
+
+bool GridModel::memo_restore(std::uint64_t hash, bool dc_init, int max_iter, double tol,
+                             const Eigen::VectorXcd & Vinit, Eigen::VectorXcd & V)
+{
+    auto range = memo_index_.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it){
+        const MemoEntry & entry = *it->second;
+        MemoCompare visitor{entry.key};
+        memo_visit(visitor, dc_init, max_iter, tol);
+        if(!visitor.is_equal()) continue;  // collision of the hashes
+        // the grid is compiled (Ybus, pv, pq...) and the solver given back its results, as if it computed them
+        pre_process_solver(Vinit, true);
+        _solver.restore_results(entry.solver_res, Ybus_, bus_pv_, bus_pq_);
+        need_reset_ = false;
+        last_recovery_stage_ = entry.recovery_stage;
+        loads_.set_res(entry.load_res);
+        generators_.set_res(entry.gen_res);
+        shunts_.set_res(entry.shunt_res);
+        powerlines_.set_res(entry.line_or_res, entry.line_ex_res);
+        trafos_.set_res(entry.trafo_hv_res, entry.trafo_lv_res);
+        V = entry.V;
+        memo_.splice(memo_.begin(), memo_, it->second);  // most recently used (the iterators stay valid)
+        ++memo_nb_hit_;
+        return true;
+    }
+    ++memo_nb_miss_;
+    return false;
+}
+
+void GridModel::memo_store(std::uint64_t hash, bool dc_init, int max_iter, double tol, const Eigen::VectorXcd & V)
+{
+    MemoEntry entry;
+    entry.hash = hash;
+    MemoWrite visitor{entry.key};
+    memo_visit(visitor, dc_init, max_iter, tol);
+    entry.V = V;
+    entry.solver_res = _solver.get_results();
+    entry.recovery_stage = last_recovery_stage_;
+    entry.load_res = loads_.get_res();
+    entry.gen_res = generators_.get_res();
+    entry.shunt_res = shunts_.get_res();
+    entry.line_or_res = powerlines_.get_lineor_res();
+    entry.line_ex_res = powerlines_.get_lineex_res();
+    entry.trafo_hv_res = trafos_.get_res_hv();
+    entry.trafo_lv_res = trafos_.get_res_lv();
+    memo_.push_front(std::move(entry));
+    memo_index_.insert(std::make_pair(hash, memo_.begin()));
+    set_memo_size(memo_size_);  // removes the least recently used entries
+}
+
+void GridModel::begin()
+{
+    if(checkpoints_.empty()) set_undo_log(&transaction_log_);
+    Checkpoint checkpoint;
+    checkpoint.mark = transaction_log_.mark();
+    checkpoint.need_reset = need_reset_;
+    checkpoint.slack_bus_id = slack_bus_id_;
+    checkpoint.gen_slackbus = gen_slackbus_;
+    checkpoint.gen_slack_weights = gen_slack_weights_;
+    checkpoint.has_compiled_grid = false;
+    checkpoints_.push_back(std::move(checkpoint));
+}
+
+void GridModel::rollback()
+{
+    if(checkpoints_.empty()) throw std::runtime_error("GridModel::rollback: there is no checkpoint (see GridModel::begin)");
+    Checkpoint & checkpoint = checkpoints_.back();
+    transaction_log_.rollback(checkpoint.mark);
+    need_reset_ = checkpoint.need_reset;
+    slack_bus_id_ = checkpoint.slack_bus_id;
+    gen_slackbus_ = checkpoint.gen_slackbus;
+    gen_slack_weights_ = std::move(checkpoint.gen_slack_weights);
+    if(checkpoint.has_compiled_grid){
+        Ybus_ = std::move(checkpoint.Ybus);
+        ybus_ac_ = checkpoint.ybus_ac;
+        Sbus_ = std::move(checkpoint.Sbus);
+        bus_pv_ = std::move(checkpoint.bus_pv);
+        bus_pq_ = std::move(checkpoint.bus_pq);
+        id_me_to_solver_ = std::move(checkpoint.id_me_to_solver);
+        id_solver_to_me_ = std::move(checkpoint.id_solver_to_me);
+        slack_bus_id_solver_ = checkpoint.slack_bus_id_solver;
+        loads_.set_res(checkpoint.load_res);
+        generators_.set_res(checkpoint.gen_res);
+        shunts_.set_res(checkpoint.shunt_res);
+        powerlines_.set_res(checkpoint.line_or_res, checkpoint.line_ex_res);
+        trafos_.set_res(checkpoint.trafo_hv_res, checkpoint.trafo_lv_res);
+        // the solver now holds the powerflow of the "what if"
+        if(checkpoint.has_solver_res) _solver.restore_results(checkpoint.solver_res, Ybus_, bus_pv_, bus_pq_);
+        else _solver.reset();
+    }
+    checkpoints_.pop_back();
+    if(checkpoints_.empty()) set_undo_log(nullptr);
+}
+
+void GridModel::commit()
+{
+    if(checkpoints_.empty()) throw std::runtime_error("GridModel::commit: there is no checkpoint (see GridModel::begin)");
+    if(checkpoints_.size() == 1){
+        transaction_log_.clear();
+        checkpoints_.pop_back();
+        set_undo_log(nullptr);
+        return;
+    }
+    // the enclosing checkpoint needs the compiled grid of this one if it did not save it itself
+    Checkpoint & checkpoint = checkpoints_.back();
+    Checkpoint & enclosing = checkpoints_[checkpoints_.size() - 2];
+    if(!enclosing.has_compiled_grid && checkpoint.has_compiled_grid){
+        UndoLog::Mark mark = enclosing.mark;
+        bool need_reset = enclosing.need_reset;
+        int slack_bus_id = enclosing.slack_bus_id;
+        int gen_slackbus = enclosing.gen_slackbus;
+        Eigen::VectorXd gen_slack_weights = std::move(enclosing.gen_slack_weights);
+        enclosing = std::move(checkpoint);
+        enclosing.mark = mark;
+        enclosing.need_reset = need_reset;
+        enclosing.slack_bus_id = slack_bus_id;
+        enclosing.gen_slackbus = gen_slackbus;
+        enclosing.gen_slack_weights = std::move(gen_slack_weights);
+    }
+    checkpoints_.pop_back();
+}
+
+void GridModel::set_undo_log(UndoLog * undo_log)
+{
+    undo_log_ = undo_log;  // for the buses
+    powerlines_.set_undo_log(undo_log);
+    shunts_.set_undo_log(undo_log);
+    trafos_.set_undo_log(undo_log);
+    generators_.set_undo_log(undo_log);
+    loads_.set_undo_log(undo_log);
+}
+
+void GridModel::check_no_checkpoint(const std::string & fun_name) const
+{
+    if(!checkpoints_.empty()){
+        throw std::runtime_error("GridModel::" + fun_name + ": impossible to re initialize the grid while there is a checkpoint (see GridModel::begin)");
+    }
+}
+
+void GridModel::save_compiled_grid(bool keep_current)
+{
+    if(checkpoints_.empty() || checkpoints_.back().has_compiled_grid) return;
+    Checkpoint & checkpoint = checkpoints_.back();
+    if(keep_current){
+        checkpoint.Ybus = Ybus_;
+        checkpoint.Sbus = Sbus_;
+        checkpoint.bus_pv = bus_pv_;
+        checkpoint.bus_pq = bus_pq_;
+        checkpoint.id_me_to_solver = id_me_to_solver_;
+        checkpoint.id_solver_to_me = id_solver_to_me_;
+    }else{
+        // they are reset by the powerflow anyway, so they are moved, not copied
+        checkpoint.Ybus = std::move(Ybus_);
+        checkpoint.Sbus = std::move(Sbus_);
+        checkpoint.bus_pv = std::move(bus_pv_);
+        checkpoint.bus_pq = std::move(bus_pq_);
+        checkpoint.id_me_to_solver = std::move(id_me_to_solver_);
+        checkpoint.id_solver_to_me = std::move(id_solver_to_me_);
+    }
+    checkpoint.ybus_ac = ybus_ac_;
+    checkpoint.slack_bus_id_solver = slack_bus_id_solver_;
+    checkpoint.load_res = loads_.get_res();
+    checkpoint.gen_res = generators_.get_res();
+    checkpoint.shunt_res = shunts_.get_res();
+    checkpoint.line_or_res = powerlines_.get_lineor_res();
+    checkpoint.line_ex_res = powerlines_.get_lineex_res();
+    checkpoint.trafo_hv_res = trafos_.get_res_hv();
+    checkpoint.trafo_lv_res = trafos_.get_res_lv();
+    checkpoint.has_solver_res = _solver.has_results();
+    if(checkpoint.has_solver_res) checkpoint.solver_res = _solver.get_results();
+    checkpoint.has_compiled_grid = true;
+}
+
 /**
 Retrieve the number of connected buses
 **/
@@ -547,6 +2011,18 @@ void GridModel::add_gen_slackbus(int gen_id){
     gen_slackbus_ = gen_id;
 }
 
+void GridModel::set_gen_slack_weights(const Eigen::VectorXd & weights){
+    if(weights.size() > 0){
+        if(weights.size() != generators_.nb()){
+            throw std::runtime_error("GridModel::set_gen_slack_weights: there should be one weight per generator (or none for a single slack).");
+        }
+        if(!weights.allFinite() || (weights.array() < 0.).any()){
+            throw std::runtime_error("GridModel::set_gen_slack_weights: the weights should be finite and >= 0.");
+        }
+    }
+    gen_slack_weights_ = weights;
+}
+
 /** GRID2OP SPECIFIC REPRESENTATION **/
 void GridModel::update_bus_status(int nb_bus_before,
                                   Eigen::Ref<Eigen::Array<bool, Eigen::Dynamic, 2, Eigen::RowMajor> > active_bus)
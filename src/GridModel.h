@@ -16,6 +16,11 @@
 #include <chrono>
 #include <complex>      // std::complex, std::conj
 #include <cmath>  // for PI
+#include <algorithm>  // for std::find
+#include <exception>  // for std::exception_ptr
+#include <memory>  // for std::unique_ptr
+#include <list>
+#include <unordered_map>
 
 // eigen is necessary to easily pass data from numpy to c++ without any copy.
 // and to optimize the matrix operations
@@ -36,6 +41,11 @@
 
 // import newton raphson solvers using different linear algebra solvers
 #include "ChooseSolver.h"
+#include "QPSolver.h"
+
+// the different strategies tried (in the given order) when the ac powerflow diverges, see GridModel::set_recovery_stages
+// "NoRecovery" is only used to report that the first attempt converged
+enum class RecoveryStage { NoRecovery, DCInit, FlatStart, OtherSolver, Iwamoto};
 
 //TODO implement a BFS check to make sure the Ymatrix is "connected" [one single component]
 class GridModel : public DataGeneric
@@ -55,10 +65,12 @@ class GridModel : public DataGeneric
                 // loads
                 DataLoad::StateRes,
                 // slack bus generator id
-                int
+                int,
+                // parameters of the KLU solver
+                KLUParameters::StateRes
                 >  StateRes;
 
-        GridModel():need_reset_(true),compute_results_(true){};
+        GridModel():need_reset_(true),compute_results_(true),last_recovery_stage_(RecoveryStage::NoRecovery),oltc_nb_iter_(0),ybus_ac_(true),parallel_ybus_(false),memo_size_(0),memo_nb_hit_(0),memo_nb_miss_(0),dcopf_slack_solver_(-1){};
         GridModel(const GridModel & other);
         GridModel copy(){
             GridModel res(*this);
@@ -72,6 +84,65 @@ class GridModel : public DataGeneric
         }
         std::vector<SolverType> available_solvers() {return _solver.available_solvers(); }
         SolverType get_solver_type() {return _solver.get_type(); }
+        SolverType get_solver_type_used() {return _solver.get_type_used(); }
+        std::vector<std::tuple<int, SolverType, std::string> > get_auto_solver_log() {return _solver.get_auto_log(); }
+
+        // what is done (inside "ac_pf", "ac_pf_dc_init", "ac_pf_injections" and "ac_pf_oltc") when the powerflow diverges.
+        // Stages are tried in the order given, until one converges:
+        // - DCInit: restart from the angles of a dc powerflow
+        // - FlatStart: restart from a flat start (setpoint at pv buses) with twice the number of iterations
+        // - OtherSolver: restart from the initial voltages with another linear solver (eg KLU <-> SparseLU)
+        // - Iwamoto: restart from the initial voltages with the Iwamoto step control (see StepControl)
+        // By default, no recovery is performed. The solver that converged (see get_solver_type_used) gives the results
+        // (get_V, get_J...) until the next powerflow, that uses again the solver chosen with change_solver.
+        void set_recovery_stages(const std::vector<RecoveryStage> & stages);
+        const std::vector<RecoveryStage> & get_recovery_stages() const {return recovery_stages_;}
+        // stage that made the last ac powerflow converge (NoRecovery if it converged at the first attempt)
+        RecoveryStage get_last_recovery_stage() const {return last_recovery_stage_;}
+
+        // step control of the newton raphson, see StepControl
+        void set_step_control(const StepControl & step_control) {_solver.set_step_control(step_control);}
+        StepControl get_step_control() const {return _solver.get_step_control();}
+        // how the products with Ybus are computed by the newton raphson, see SparseKernel
+        void set_sparse_kernel(const SparseKernel & sparse_kernel) {_solver.set_sparse_kernel(sparse_kernel);}
+        SparseKernel get_sparse_kernel() const {return _solver.get_sparse_kernel();}
+        // precision of the linear systems of the newton raphson, see NRPrecision
+        void set_precision(const NRPrecision & precision) {_solver.set_precision(precision);}
+        NRPrecision get_precision() const {return _solver.get_precision();}
+        // Ybus filled by 3 threads (lines, transformers, the other elements), only for the grids with more than
+        // _parallel_min_nb_bus buses and if compiled with openmp. Off by default: the triplets are still merged and
+        // compressed serially, so the gain is bounded and it could not be measured on several cores.
+        void set_parallel_ybus(bool parallel_ybus) {parallel_ybus_ = parallel_ybus;}
+        bool get_parallel_ybus() const {return parallel_ybus_;}
+
+        // parameters of the factorizations made by the KLU solver (part of the state of the grid)
+        void set_klu_parameters(const KLUParameters & parameters) {_solver.set_klu_parameters(parameters);}
+        const KLUParameters & get_klu_parameters() const {return _solver.get_klu_parameters();}
+        /**
+        Benchmarks the candidate parameters of KLU (all the combinations of orderings, btf, scalings and pivot
+        tolerances if "candidates" is empty) on the jacobian of the last ac powerflow and keeps the fastest one among
+        those that solve it accurately (error below 1e-8, or 10 times the smallest error).
+        It returns, for each candidate, the time of a factorization followed by 3 refactorizations and solves and
+        the error (see KLUSolver::benchmark_parameters).
+        An error is raised if KLU is not available or if there is no jacobian (ac_pf should be called before).
+        **/
+        std::vector<std::tuple<KLUParameters, double, double> > tune_klu(const std::vector<KLUParameters> & candidates,
+                                                                         int nb_repeat);
+        /**
+        Distributed slack: one weight (>= 0) per generator. The active power imbalance (including the losses) is
+        then shared between the connected generators proportionally to their weights, instead of being taken by
+        the slack generator only (which still gives the reference angle, and participates only if its weight is
+        > 0). The share of each generator is an unknown of the newton raphson (see BaseNRSolver::set_slack_weights),
+        so a single ac powerflow is needed.
+        An empty vector (default), or weights that are all 0 for the connected generators, means a single slack.
+        Only the SparseLU and KLU solvers support it (and "Auto" among them). It is not used by the dc
+        powerflow.
+        **/
+        void set_gen_slack_weights(const Eigen::VectorXd & weights);
+        const Eigen::VectorXd & get_gen_slack_weights() const {return gen_slack_weights_;}
+        // active power (MW) shared by the generators during the last powerflow (0. for a single slack)
+        double get_distributed_slack_p() const {return _solver.get_slack_p();}
+        std::vector<double> get_step_lengths() {return _solver.get_step_lengths();}
 
         // do i compute the results (in terms of P,Q,V or loads, generators and flows on lines
         void deactivate_result_computation(){compute_results_=false;}
@@ -86,11 +157,15 @@ class GridModel : public DataGeneric
                              const Eigen::VectorXi & branch_from_id,
                              const Eigen::VectorXi & branch_to_id
                              ){
+            check_no_checkpoint("init_powerlines");
+            memo_invalidate();
             powerlines_.init(branch_r, branch_x, branch_h, branch_from_id, branch_to_id);
         }
         void init_shunt(const Eigen::VectorXd & shunt_p_mw,
                         const Eigen::VectorXd & shunt_q_mvar,
                         const Eigen::VectorXi & shunt_bus_id){
+            check_no_checkpoint("init_shunt");
+            memo_invalidate();
             shunts_.init(shunt_p_mw, shunt_q_mvar, shunt_bus_id);
         }
         void init_trafo(const Eigen::VectorXd & trafo_r,
@@ -103,6 +178,8 @@ class GridModel : public DataGeneric
                         const Eigen::VectorXi & trafo_hv_id,
                         const Eigen::VectorXi & trafo_lv_id
                         ){
+            check_no_checkpoint("init_trafo");
+            memo_invalidate();
             trafos_.init(trafo_r, trafo_x, trafo_b, trafo_tap_step_pct, trafo_tap_pos, trafo_tap_hv, trafo_hv_id, trafo_lv_id);
         }
         void init_generators(const Eigen::VectorXd & generators_p,
@@ -110,11 +187,15 @@ class GridModel : public DataGeneric
                              const Eigen::VectorXd & generators_min_q,
                              const Eigen::VectorXd & generators_max_q,
                              const Eigen::VectorXi & generators_bus_id){
+            check_no_checkpoint("init_generators");
+            memo_invalidate();
             generators_.init(generators_p, generators_v, generators_min_q, generators_max_q, generators_bus_id);
         }
         void init_loads(const Eigen::VectorXd & loads_p,
                         const Eigen::VectorXd & loads_q,
                         const Eigen::VectorXi & loads_bus_id){
+            check_no_checkpoint("init_loads");
+            memo_invalidate();
             loads_.init(loads_p, loads_q, loads_bus_id);
         }
 
@@ -152,6 +233,127 @@ class GridModel : public DataGeneric
                                int max_iter,
                                double tol);
 
+        // ac powerflow, the voltage angles being first initialized with a dc powerflow
+        // (both are computed with the same bus numbering, without any intermediate result)
+        Eigen::VectorXcd ac_pf_dc_init(const Eigen::VectorXcd & Vinit,
+                                       int max_iter,
+                                       double tol);
+
+        /**
+        Ac powerflow that re uses the admittance matrix, the pv / pq buses and the solver (with its symbolic
+        factorization) of the last ac powerflow: only the injections (Sbus) and the voltage setpoints are updated.
+        It is only valid if the topology (buses and statuses of the elements) did not change since this last
+        powerflow. The transformers ratios and the shunts can be modified in between (Ybus is updated in place by
+        change_tap_trafo, change_ratio_trafo, change_p_shunt and change_q_shunt).
+        If there is no ac admittance matrix (no ac powerflow yet, or the last one was a dc one), it is the same
+        as ac_pf. It is used by the time series (see TimeSeries).
+        **/
+        Eigen::VectorXcd ac_pf_injections(const Eigen::VectorXcd & Vinit,
+                                          int max_iter,
+                                          double tol);
+
+        /**
+        Linear (first order) prediction of the flows for a batch of injection changes, around the last
+        converged ac powerflow. The jacobian matrix at the converged state is factorized by the first call after
+        a powerflow, and this factorization is re used by the next calls (no new powerflow is performed).
+
+        delta_S has one row per "what if" and one column per bus of the grid (in MW / MVAr, a positive
+        value meaning more power injected at the bus). Changes at the slack bus, as well as the
+        reactive part at pv buses, are ignored.
+
+        It returns the active power (MW) and current flows (kA) at the origin side of the powerlines and at the
+        high voltage side of the transformers, one row per what if.
+        **/
+        std::tuple<Eigen::MatrixXd, Eigen::MatrixXd, Eigen::MatrixXd, Eigen::MatrixXd>
+            predict(const Eigen::MatrixXcd & delta_S);
+
+        /**
+        Continuation powerflow (PV curve) from the last converged ac powerflow: the consumption of the loads is
+        p_mw + lambda * load_p_dir (MW, one value per load) and q_mvar + lambda * load_q_dir (MVAr), the production
+        of the generators p_mw + lambda * gen_p_dir (MW, one value per generator), lambda starting at 0. An empty
+        load_p_dir (resp. load_q_dir) means the current consumption of the loads (lambda = 1 doubles it), an empty
+        gen_p_dir no change of the generators (the slack, possibly distributed, compensates).
+
+        The points are computed by prediction along the tangent of the curve and correction by the newton raphson,
+        with an adaptive step length (between min_step and max_step, see BaseNRSolver::compute_cpf for the details)
+        until the maximum load factor (the "nose") if stop_at_nose, or until lambda is back to 0 (at most
+        max_nb_point points). The solver keeps the symbolic factorization of the augmented jacobian matrix.
+        Only the SparseLU and KLU solvers can be used, and the results of the grid and of the solver (get_V, get_J,
+        predict...) are not modified.
+
+        It returns the load factors, the complex voltages (one row per point, one column per bus of the grid),
+        the index of the point of maximum loadability and the total number of newton raphson iterations.
+        **/
+        std::tuple<Eigen::VectorXd, Eigen::MatrixXcd, int, int>
+            continuation_pf(const Eigen::VectorXd & load_p_dir,
+                            const Eigen::VectorXd & load_q_dir,
+                            const Eigen::VectorXd & gen_p_dir,
+                            double step,
+                            double min_step,
+                            double max_step,
+                            int max_nb_point,
+                            bool stop_at_nose,
+                            int max_iter,
+                            double tol);
+
+        /**
+        Equivalent (smaller) model of the grid, where only the buses in keep_buses remain (bus i of the returned
+        model is bus keep_buses(i) of this one).
+
+        The other ("external") buses are eliminated from the admittance matrix (Kron reduction). This creates
+        equivalent powerlines between the buses at the boundary (and equivalent shunts). The external injections are
+        replaced by equivalent loads at the boundary (Ward equivalent), computed at the operating point V (complex
+        voltages at each bus of this grid, typically the result of "ac_pf").
+
+        The reduced grid gives the same voltages as this one for the operating point V. Away from it, this is an
+        approximation: the external generators do not control their voltage anymore.
+        The equivalent admittances below drop_tol times the largest diagonal coefficient of the admittance matrix at
+        the boundary are dropped (buses electrically distant from each other), so that the number of equivalent
+        powerlines does not grow with the square of the number of buses at the boundary. They are neglected (the
+        voltages at V are then only approximately the same), and 0 keeps every one of them.
+        The slack bus must be kept, and only elements connected exclusively to kept buses are kept (with the
+        same order). The equivalent elements are added after them.
+        **/
+        GridModel reduce(const Eigen::VectorXi & keep_buses, const Eigen::VectorXcd & V, double drop_tol=1e-8);
+
+        /**
+        Checkpoints, to evaluate "what ifs" in place instead of on a copy of the grid: "begin" creates a checkpoint,
+        the grid can then be modified and powerflows computed, and "rollback" puts it back in the state it had
+        when "begin" was called (modifications of the elements, Ybus, results...). "commit" removes the last
+        checkpoint, keeping the modifications (they can still be cancelled by the rollback of an enclosing
+        checkpoint). Checkpoints can be nested.
+
+        The modifications are saved in an undo log, and the compiled grid (Ybus, Sbus, bus ids in the solver) as well
+        as the results of the elements and of the solver (get_V, get_J, predict...) are kept aside by the first
+        powerflow after the checkpoint: a rollback costs only the number of modifications. The slack (add_gen_slackbus,
+        set_gen_slack_weights) is saved by "begin".
+        The grid cannot be re initialized (set_state, init_bus, init_powerlines...) while there is a checkpoint.
+        **/
+        void begin();
+        void rollback();
+        void commit();
+        int get_nb_checkpoints() const {return static_cast<int>(checkpoints_.size());}
+
+        /**
+        Memoization of the ac powerflows (disabled by default): the results of the last max_nb_entries converged
+        powerflows computed by "ac_pf" or "ac_pf_dc_init" are kept, indexed by the topology and the injections of
+        the grid (status, buses, p, q, voltage setpoints, ratios, slack), the configuration of the solver (type,
+        step control, precision, sparse kernel, KLU parameters, recovery stages), the function, max_iter and tol.
+        When it is called again in the same conditions (for example when the same action is simulated twice from
+        the same state), the grid is compiled but no powerflow is computed: the results of the elements and of the
+        solver (get_V, get_J, predict...) are the ones of the stored powerflow, with a computation time of 0.
+        Vinit is not part of the key. All the entries are removed by init_* and set_state.
+
+        The least recently used entry is removed when there are more than max_nb_entries (0 disables the
+        memoization).
+        **/
+        void set_memo_size(int max_nb_entries);
+        int get_memo_size() const {return memo_size_;}
+        void clear_memo();
+        int get_memo_nb_entries() const {return static_cast<int>(memo_.size());}
+        long get_memo_nb_hit() const {return memo_nb_hit_;}
+        long get_memo_nb_miss() const {return memo_nb_miss_;}
+
 
         // deactivate a bus. Be careful, if a bus is deactivated, but an element is
         //still connected to it, it will throw an exception
@@ -159,6 +361,7 @@ class GridModel : public DataGeneric
         // if a bus is connected, but isolated, it will make the powerflow diverge
         void reactivate_bus(int bus_id) {_reactivate(bus_id, bus_status_, need_reset_); }
         int nb_bus() const;
+        int total_bus() const {return static_cast<int>(bus_vn_kv_.size());}  // including the disconnected ones
 
         //deactivate a powerline (disconnect it)
         void deactivate_powerline(int powerline_id) {powerlines_.deactivate(powerline_id, need_reset_); }
@@ -175,6 +378,69 @@ class GridModel : public DataGeneric
         void change_bus_trafo_lv(int trafo_id, int new_bus_id) {trafos_.change_bus_lv(trafo_id, new_bus_id, need_reset_, bus_vn_kv_.size()); }
         int get_bus_trafo_hv(int trafo_id) {return trafos_.get_bus_hv(trafo_id);}
         int get_bus_trafo_lv(int trafo_id) {return trafos_.get_bus_lv(trafo_id);}
+        /**
+        Change the ratio of a transformer, directly or through the position of its tap changer
+        (ratio = 1 + tap_pos * tap_step_pct / 100, the sign depending on the side of the tap).
+        If Ybus has already been computed, only the 4 coefficients of this transformer are updated (in place).
+        **/
+        void change_ratio_trafo(int trafo_id, double new_ratio);
+        void change_tap_trafo(int trafo_id, int new_tap_pos);
+        const Eigen::VectorXd & get_trafo_ratio() const {return trafos_.get_ratio();}
+        const Eigen::VectorXd & get_trafo_tap_pos() const {return trafos_.get_tap_pos();}
+        const Eigen::VectorXd & get_trafo_tap_step_pct() const {return trafos_.get_tap_step_pct();}
+
+        /**
+        Voltage control by the tap changers of the transformers (OLTC): the tap of transformer trafo_id is moved
+        (between tap_min and tap_max) so that the voltage magnitude of bus controlled_bus stays within
+        v_target_pu +/- deadband_pu. These controls are used by "ac_pf_oltc" only.
+        **/
+        void add_oltc(int trafo_id, int controlled_bus, double v_target_pu, double deadband_pu, int tap_min, int tap_max);
+        void clear_oltc() {oltc_controls_.clear();}
+        /**
+        Ac powerflow with the voltage control of the tap changers (see add_oltc): after each converged powerflow,
+        the taps of the transformers whose controlled voltage is outside its deadband are moved (the number of
+        steps is estimated from the sensitivity of the voltage to the ratio), their coefficients in Ybus are updated
+        in place, and the powerflow is computed again from the previous solution with the same solver (and its
+        symbolic factorization), at most max_tap_iter times. The new tap positions are kept in the grid.
+        **/
+        Eigen::VectorXcd ac_pf_oltc(const Eigen::VectorXcd & Vinit,
+                                    int max_iter,
+                                    double tol,
+                                    int max_tap_iter);
+        int get_oltc_nb_iter() const {return oltc_nb_iter_;}  // number of tap updates during the last ac_pf_oltc
+        /**
+        Number of tap steps that brings the voltage magnitude vm_pu of controlled_bus (one of the buses of
+        transformer trafo_id) to v_target_pu, estimated from the sensitivity of the voltage to the ratio (at least
+        one step in the right direction, the limits of the tap are not taken into account).
+        **/
+        int estimate_tap_steps(int trafo_id, int controlled_bus, double vm_pu, double v_target_pu) const;
+
+        /**
+        Redispatching computed with a dc optimal powerflow: the change of active production of each generator
+        (in MW, returned) is the closest to gen_target (weighted by gen_cost, in cost / MW^2) such that:
+            - the total production does not change
+            - each generator stays within its ramps (gen_ramp_down and gen_ramp_up, >= 0) and within
+              [gen_pmin, gen_pmax]
+            - the dc flows of the powerlines and transformers stay within +/- line_pmax and trafo_pmax
+              (no limit if it is not finite)
+        Generators with gen_cost <= 0 are not redispatched. The grid itself is not modified.
+
+        The sensitivities of the flows (PTDF) are computed from the dc admittance matrix, and kept until the topology
+        changes. The constraints active at the solution are tried first the next time (warm start). An error is
+        raised if no redispatching satisfies the constraints.
+        **/
+        Eigen::VectorXd redispatch_dc(const Eigen::VectorXd & gen_cost,
+                                      const Eigen::VectorXd & gen_target,
+                                      const Eigen::VectorXd & gen_ramp_down,
+                                      const Eigen::VectorXd & gen_ramp_up,
+                                      const Eigen::VectorXd & gen_pmin,
+                                      const Eigen::VectorXd & gen_pmax,
+                                      const Eigen::VectorXd & line_pmax,
+                                      const Eigen::VectorXd & trafo_pmax);
+        // dc flows (MW, origin / hv side) after the last redispatch_dc
+        const Eigen::VectorXd & get_redispatch_line_p() const {return dcopf_line_p_;}
+        const Eigen::VectorXd & get_redispatch_trafo_p() const {return dcopf_trafo_p_;}
+        int get_redispatch_nb_iter() const {return dcopf_qp_.get_nb_iter();}
 
         //load
         void deactivate_load(int load_id) {loads_.deactivate(load_id, need_reset_); }
@@ -196,8 +462,10 @@ class GridModel : public DataGeneric
         void deactivate_shunt(int shunt_id) {shunts_.deactivate(shunt_id, need_reset_); }
         void reactivate_shunt(int shunt_id) {shunts_.reactivate(shunt_id, need_reset_); }
         void change_bus_shunt(int shunt_id, int new_bus_id) {shunts_.change_bus(shunt_id, new_bus_id, need_reset_, bus_vn_kv_.size());  }
-        void change_p_shunt(int shunt_id, double new_p) {shunts_.change_p(shunt_id, new_p, need_reset_); }
-        void change_q_shunt(int shunt_id, double new_q) {shunts_.change_q(shunt_id, new_q, need_reset_); }
+        // if Ybus has already been computed, the coefficient of this shunt is updated (in place)
+        void change_p_shunt(int shunt_id, double new_p);
+        void change_q_shunt(int shunt_id, double new_q);
+        const Eigen::VectorXd & get_shunt_q_mvar() const {return shunts_.get_q_mvar();}
         int get_bus_shunt(int shunt_id) {return shunts_.get_bus(shunt_id);}
 
         // All results access
@@ -214,6 +482,36 @@ class GridModel : public DataGeneric
         tuple4d get_trafolv_res() const {return trafos_.get_res_lv();}
         const std::vector<bool>& get_trafo_status() const { return trafos_.get_status();}
 
+        /**
+        Graph of the grid (for graph neural networks for example): one edge per branch (the powerlines first, then the
+        transformers), with the bus ids of this model. A disconnected branch is kept, with -1 as its buses.
+
+        "update_graph" must be called after the modifications of the grid (and after the powerflow, for the flows).
+        Only the edges that changed since the last call are updated, and the adjacency is rebuilt only if the
+        topology changed (returns whether it did). The getters below then give read only views of these arrays
+        (they are not copied). The buffers are allocated once, at the first call (the adjacency with room for every
+        branch connected), so a view stays valid when the topology changes: only the number of entries of the
+        adjacency ("get_graph_csr_nnz") changes, so csr_indices and csr_edges must be fetched again to get the new
+        length. Only a new initialization of the grid (new elements) re allocates them.
+
+        The adjacency is in CSR format, symmetric (each connected branch is given in both directions): the neighbours
+        of bus "b" are csr_indices[csr_indptr[b]:csr_indptr[b+1]], through the edges csr_edges[...] (so it is also
+        the incidence matrix). Parallel branches are kept as distinct entries.
+
+        The features (one row per edge) are: p_or (MW), q_or (MVAr), a_or (kA), p_ex, q_ex, a_ex, g (pu), b (pu),
+        ratio, where g + j.b = 1 / (r + j.x) is the series admittance of the branch (ratio is 1 for the powerlines).
+        The flows are 0. for disconnected branches and NaN if there are no results (divergence for example).
+        **/
+        bool update_graph();
+        const Eigen::VectorXi & get_graph_edge_or() const {return graph_edge_or_;}
+        const Eigen::VectorXi & get_graph_edge_ex() const {return graph_edge_ex_;}
+        const Eigen::VectorXi & get_graph_csr_indptr() const {return graph_csr_indptr_;}
+        Eigen::Ref<const Eigen::VectorXi> get_graph_csr_indices() const {return graph_csr_indices_.head(graph_csr_nnz_);}
+        Eigen::Ref<const Eigen::VectorXi> get_graph_csr_edges() const {return graph_csr_edges_.head(graph_csr_nnz_);}
+        int get_graph_csr_nnz() const {return graph_csr_nnz_;}
+        const RealMatRowMajor & get_graph_edge_features() const {return graph_features_;}
+        static const int graph_nb_features = 9;
+
         // get some internal information, be cerafull the ID of the buses might not be the same
         // TODO convert it back to this ID, that will make copies, but who really cares ?
         Eigen::SparseMatrix<cdouble> get_Ybus(){
@@ -228,6 +526,9 @@ class GridModel : public DataGeneric
         Eigen::VectorXi get_pq(){
             return bus_pq_;
         }
+        Eigen::VectorXcd get_V(){
+            return _solver.get_V();
+        }
         Eigen::Ref<Eigen::VectorXd> get_Va(){
             return _solver.get_Va();
         }
@@ -318,10 +619,54 @@ class GridModel : public DataGeneric
         Eigen::VectorXcd pre_process_solver(const Eigen::VectorXcd & Vinit, bool is_ac);
         void init_Ybus(Eigen::SparseMatrix<cdouble> & Ybus, Eigen::VectorXcd & Sbus,
                        std::vector<int> & id_me_to_solver, std::vector<int>& id_solver_to_me,
-                       int & slack_bus_id_solver);
+                       int slack_bus_id, int & slack_bus_id_solver);
         void fillYbus(Eigen::SparseMatrix<cdouble> & res, bool ac, const std::vector<int>& id_me_to_solver);
-        void fillSbus_me(Eigen::VectorXcd & res, bool ac, const std::vector<int>& id_me_to_solver, int slack_bus_id_solver);
+        // Ybus is filled in parallel (if compiled with openmp and set_parallel_ybus) only for grids with more buses than that
+        static const int _parallel_min_nb_bus = 5000;
+        // tune_klu: number of refactorizations timed after each factorization, and error always accepted
+        static const int _klu_tune_nb_refactor = 3;
+        static constexpr double _klu_tune_max_error = 1e-8;
+        // returns the active power added at the slack bus to balance the injections
+        double fillSbus_me(Eigen::VectorXcd & res, bool ac, const std::vector<int>& id_me_to_solver, int slack_bus_id_solver);
         void fillpv_pq(const std::vector<int>& id_me_to_solver);
+        // weights of the connected generators (summing to 1), empty for a single slack
+        Eigen::VectorXd gen_slack_participation() const;
+        // gives the weights of the buses to the solver (for an ac Sbus_ that has just been filled), and removes the
+        // "p_slack_added" from the slack bus if the slack is distributed
+        void init_slack_weights(double p_slack_added);
+
+        // checkpoints
+        void set_undo_log(UndoLog * undo_log);  // for all the elements
+        void check_no_checkpoint(const std::string & fun_name) const;
+        // keep the compiled grid and the results aside, before the first powerflow of the last checkpoint
+        // (copied instead of moved if keep_current is true)
+        void save_compiled_grid(bool keep_current=false);
+        // update the coefficients of a transformer in Ybus_ after a change of its ratio
+        void update_Ybus_ratio(int trafo_id, double old_ratio);
+        // update the coefficient of a shunt in Ybus_ after a change of its p or q
+        void update_Ybus_shunt(int shunt_id, double old_p, double old_q);
+        // memoization of the ac powerflows
+        // (dc_init: "ac_pf_dc_init" instead of "ac_pf")
+        template<class F>
+        void memo_visit(F & visitor, bool dc_init, int max_iter, double tol) const;  // gives the key, value by value
+        std::uint64_t memo_hash(bool dc_init, int max_iter, double tol) const;
+        bool memo_restore(std::uint64_t hash, bool dc_init, int max_iter, double tol,
+                          const Eigen::VectorXcd & Vinit, Eigen::VectorXcd & V);  // false if the key is not found
+        void memo_store(std::uint64_t hash, bool dc_init, int max_iter, double tol, const Eigen::VectorXcd & V);
+        // the parameters of the elements changed (they are not part of the key)
+        void memo_invalidate() {memo_.clear(); memo_index_.clear();}
+
+        // dc matrix and sensitivities used by redispatch_dc, if the topology changed since they were computed
+        void update_dcopf_ptdf();
+        // dc voltage angles (0 at the slack bus) and flows of the branches for the active injections P (solver ids)
+        Eigen::VectorXd dcopf_flows(const Eigen::VectorXd & P) const;
+        // adjacency (csr format) of the edges graph_edge_or_ / graph_edge_ex_
+        void build_graph_csr();
+
+        // try the recovery stages after a divergence of the ac powerflow started from V (solver bus ids).
+        // Ybus_, Sbus_, pv and pq are not modified.
+        bool recover_ac_pf(const Eigen::VectorXcd & V, int max_iter, double tol);
+        SolverType other_solver_type(const SolverType & type);
 
         // results
         /**process the results from the solver to this instance
@@ -393,6 +738,10 @@ class GridModel : public DataGeneric
         bool need_reset_;
         bool compute_results_;
 
+        // divergence recovery
+        std::vector<RecoveryStage> recovery_stages_;
+        RecoveryStage last_recovery_stage_;
+
         // powersystem representation
         // 1. bus
         Eigen::VectorXd bus_vn_kv_;
@@ -427,6 +776,7 @@ class GridModel : public DataGeneric
         int gen_slackbus_;
         int slack_bus_id_;
         int slack_bus_id_solver_;
+        Eigen::VectorXd gen_slack_weights_;  // distributed slack (empty: single slack)
 
         // as matrix, for the solver
         Eigen::SparseMatrix<cdouble> Ybus_;
@@ -439,6 +789,87 @@ class GridModel : public DataGeneric
         // to solve the newton raphson
         ChooseSolver _solver;
 
+        // checkpoints (see begin / rollback)
+        struct Checkpoint
+        {
+            UndoLog::Mark mark;
+            bool need_reset;
+            int slack_bus_id;
+            int gen_slackbus;
+            Eigen::VectorXd gen_slack_weights;
+            // compiled grid and results, moved here by the first powerflow after the checkpoint
+            bool has_compiled_grid;
+            Eigen::SparseMatrix<cdouble> Ybus;
+            bool ybus_ac;
+            Eigen::VectorXcd Sbus;
+            Eigen::VectorXi bus_pv;
+            Eigen::VectorXi bus_pq;
+            std::vector<int> id_me_to_solver;
+            std::vector<int> id_solver_to_me;
+            int slack_bus_id_solver;
+            tuple3d load_res, gen_res, shunt_res;
+            tuple4d line_or_res, line_ex_res, trafo_hv_res, trafo_lv_res;
+            bool has_solver_res;  // false if the solver held no converged powerflow
+            SolverResults solver_res;
+        };
+        std::vector<Checkpoint> checkpoints_;
+        UndoLog transaction_log_;
+
+        // voltage control by the tap changers (see add_oltc)
+        struct OltcControl
+        {
+            int trafo_id;
+            int controlled_bus;
+            double v_target_pu;
+            double deadband_pu;
+            int tap_min;
+            int tap_max;
+        };
+        std::vector<OltcControl> oltc_controls_;
+        int oltc_nb_iter_;
+        bool ybus_ac_;  // whether Ybus_ is the ac or the dc admittance matrix
+        bool parallel_ybus_;  // see set_parallel_ybus
+
+        // memoization of the ac powerflows (see set_memo_size), only its size is copied with the grid
+        struct MemoEntry
+        {
+            std::uint64_t hash;
+            std::vector<double> key;
+            Eigen::VectorXcd V;
+            SolverResults solver_res;  // so that get_V, get_J... give the results of this powerflow after a hit
+            RecoveryStage recovery_stage;
+            tuple3d load_res, gen_res, shunt_res;
+            tuple4d line_or_res, line_ex_res, trafo_hv_res, trafo_lv_res;
+        };
+        int memo_size_;
+        std::list<MemoEntry> memo_;  // most recently used first
+        std::unordered_multimap<std::uint64_t, std::list<MemoEntry>::iterator> memo_index_;  // by hash of the key
+        long memo_nb_hit_;
+        long memo_nb_miss_;
+
+        // dc optimal powerflow (see redispatch_dc), not copied with the grid
+        std::vector<double> dcopf_topology_;  // what the matrices below depend on
+        std::vector<int> dcopf_id_me_to_solver_;
+        int dcopf_slack_solver_;
+        std::unique_ptr<Eigen::SparseLU<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > > dcopf_B_;  // without the slack bus
+        Eigen::VectorXi dcopf_branch_from_;  // solver ids (powerlines then transformers), -1 if disconnected
+        Eigen::VectorXi dcopf_branch_to_;
+        Eigen::VectorXd dcopf_branch_b_;  // flow = b * (theta_from - theta_to)
+        Eigen::MatrixXd dcopf_ptdf_;  // sensitivity of the flow of each branch to the production of each generator
+        std::vector<int> dcopf_active_;  // active constraints of the last solution (2 * gen_id (+1 for pmin) or 2 * (nb_gen + branch_id) (+1))
+        QPSolver dcopf_qp_;
+        Eigen::VectorXd dcopf_line_p_;
+        Eigen::VectorXd dcopf_trafo_p_;
+
+        // graph of the grid (see update_graph), empty until the first call to update_graph
+        Eigen::VectorXi graph_edge_or_;
+        Eigen::VectorXi graph_edge_ex_;
+        Eigen::VectorXi graph_csr_indptr_;
+        Eigen::VectorXi graph_csr_indices_;
+        Eigen::VectorXi graph_csr_edges_;
+        int graph_csr_nnz_ = 0;  // number of entries used in graph_csr_indices_ and graph_csr_edges_ (capacity: 2 per edge)
+        RealMatRowMajor graph_features_;
+
         // specific grid2op
         int n_sub_;
         Eigen::Array<int, Eigen::Dynamic, Eigen::RowMajor> load_pos_topo_vect_;
@@ -0,0 +1,78 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#ifndef KLUPARAMETERS_H
+#define KLUPARAMETERS_H
+
+#include <tuple>
+#include <string>
+#include <stdexcept>
+
+// fill reducing ordering of KLU: AMD (on J + J'), COLAMD (on J' J) or none (the order of the jacobian)
+enum class KLUOrdering { AMD, COLAMD, Natural};
+
+/**
+Parameters of the factorizations made by KLU (see the user guide of KLU). The default values are the ones set by
+"klu_defaults".
+
+They do not depend on KLU being available, so that they can be stored in the state of a GridModel (and loaded on a
+platform without KLU).
+**/
+class KLUParameters
+{
+    public:
+        // ordering, btf, scale, tol (as stored in the state of the GridModel)
+        typedef std::tuple<int, int, int, double> StateRes;
+
+        KLUParameters():ordering(KLUOrdering::AMD),btf(true),scale(2),tol(0.001){}
+        KLUParameters(KLUOrdering ordering_, bool btf_, int scale_, double tol_):
+            ordering(ordering_),btf(btf_),scale(scale_),tol(tol_)
+        {
+            check();
+        }
+
+        // raises an error if a value is not accepted by KLU
+        void check() const
+        {
+            if(scale < -1 || scale > 2) throw std::runtime_error("KLUParameters: scale should be -1 (none, not checked), 0 (none), 1 (sum) or 2 (max)");
+            if(!(tol > 0.) || tol > 1.) throw std::runtime_error("KLUParameters: the pivot tolerance should be in ]0, 1]");
+        }
+
+        StateRes get_state() const
+        {
+            return StateRes(static_cast<int>(ordering), btf ? 1 : 0, scale, tol);
+        }
+        void set_state(const StateRes & my_state)
+        {
+            int ordering_id = std::get<0>(my_state);
+            if(ordering_id < 0 || ordering_id > static_cast<int>(KLUOrdering::Natural)) throw std::runtime_error("KLUParameters: unknown ordering");
+            KLUParameters res(static_cast<KLUOrdering>(ordering_id), std::get<1>(my_state) != 0, std::get<2>(my_state), std::get<3>(my_state));
+            *this = res;
+        }
+
+        bool operator==(const KLUParameters & other) const
+        {
+            return (ordering == other.ordering) && (btf == other.btf) && (scale == other.scale) && (tol == other.tol);
+        }
+
+        std::string to_string() const
+        {
+            const char * orderings[] = {"AMD", "COLAMD", "Natural"};
+            return std::string("KLUParameters(ordering=") + orderings[static_cast<int>(ordering)] +
+                   ", btf=" + (btf ? "True" : "False") + ", scale=" + std::to_string(scale) +
+                   ", tol=" + std::to_string(tol) + ")";
+        }
+
+    public:
+        KLUOrdering ordering;
+        bool btf;  // permutation to block triangular form
+        int scale;  // row scaling: -1 none (and no check of the matrix), 0 none, 1 sum of the rows, 2 max of the rows
+        double tol;  // partial pivoting tolerance (the diagonal is kept if it is above tol * max of the column)
+};
+
+#endif // KLUPARAMETERS_H
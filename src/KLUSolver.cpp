@@ -8,12 +8,34 @@
 
 #include "KLUSolver.h"
 
+#include <limits>
+
+namespace
+{
+    // klu_defaults then the parameters
+    void set_klu_common(klu_common & common, const KLUParameters & parameters)
+    {
+        klu_defaults(&common);
+        common.ordering = parameters.ordering == KLUOrdering::COLAMD ? 1 : 0;
+        common.btf = parameters.btf ? 1 : 0;
+        common.scale = parameters.scale;
+        common.tol = parameters.tol;
+    }
+
+    klu_symbolic * analyze(int n, Eigen::SparseMatrix<double> & J, const KLUParameters & parameters, klu_common & common)
+    {
+        // the natural ordering is given as "no permutation"
+        if(parameters.ordering == KLUOrdering::Natural) return klu_analyze_given(n, J.outerIndexPtr(), J.innerIndexPtr(), nullptr, nullptr, &common);
+        return klu_analyze(n, J.outerIndexPtr(), J.innerIndexPtr(), &common);
+    }
+}
+
 void KLUSolver::reset(){
     BaseNRSolver::reset();
     klu_free_symbolic(&symbolic_, &common_);
     klu_free_numeric(&numeric_, &common_);
     n_ = -1;
-    common_ = klu_common();
+    set_klu_common(common_, parameters_);
 
     symbolic_ = nullptr;
     numeric_ = nullptr;
@@ -25,8 +47,11 @@ void KLUSolver::initialize(){
     auto timer = CustTimer();
     n_ = J_.cols(); // should be equal to J_.nrows()
     err_ = 0; // reset error message
-    common_ = klu_common();
-    symbolic_ = klu_analyze(n_, J_.outerIndexPtr(), J_.innerIndexPtr(), &common_);
+    // the parameters might have changed since the last factorization
+    klu_free_symbolic(&symbolic_, &common_);
+    klu_free_numeric(&numeric_, &common_);
+    set_klu_common(common_, parameters_);
+    symbolic_ = analyze(n_, J_, parameters_, common_);
     numeric_ = klu_factor(J_.outerIndexPtr(), J_.innerIndexPtr(), J_.valuePtr(), symbolic_, &common_);
     if (common_.status != KLU_OK) {
         err_ = 1;
@@ -60,3 +85,69 @@ void KLUSolver::solve(Eigen::VectorXd & b, bool has_just_been_inialized){
     }
     timer_solve_ += timer.duration();
 }
+
+std::vector<KLUParameters> KLUSolver::default_candidates()
+{
+    std::vector<KLUParameters> res;
+    for(KLUOrdering ordering : {KLUOrdering::AMD, KLUOrdering::COLAMD, KLUOrdering::Natural}){
+        for(bool btf : {true, false}){
+            for(int scale : {-1, 1, 2}){
+                for(double tol : {0.001, 0.01, 0.1}){
+                    res.push_back(KLUParameters(ordering, btf, scale, tol));
+                }
+            }
+        }
+    }
+    return res;
+}
+
+std::vector<std::tuple<KLUParameters, double, double> >
+    KLUSolver::benchmark_parameters(const Eigen::SparseMatrix<double> & J,
+                                    const std::vector<KLUParameters> & candidates,
+                                    int nb_refactor,
+                                    int nb_repeat)
+{
+    if(J.rows() != J.cols() || J.rows() == 0) throw std::runtime_error("KLUSolver::benchmark_parameters: J should be a non empty square matrix");
+    if(nb_refactor < 0 || nb_repeat < 1) throw std::runtime_error("KLUSolver::benchmark_parameters: nb_refactor should be >= 0 and nb_repeat >= 1");
+    Eigen::SparseMatrix<double> mat = J;
+    mat.makeCompressed();
+    const int n = mat.cols();
+    const Eigen::VectorXd ones = Eigen::VectorXd::Ones(n);
+    const Eigen::VectorXd rhs = mat * ones;
+    const double inf = std::numeric_limits<double>::infinity();
+
+    std::vector<std::tuple<KLUParameters, double, double> > res;
+    for(const auto & parameters : candidates){
+        parameters.check();
+        double best_time = inf;
+        double error = inf;
+        for(int repeat = 0; repeat < nb_repeat; ++repeat){
+            klu_common common;
+            set_klu_common(common, parameters);
+            Eigen::VectorXd x = rhs;
+            auto timer = CustTimer();
+            klu_symbolic * symbolic = analyze(n, mat, parameters, common);
+            klu_numeric * numeric = nullptr;
+            bool ok = (symbolic != nullptr);
+            if(ok){
+                numeric = klu_factor(mat.outerIndexPtr(), mat.innerIndexPtr(), mat.valuePtr(), symbolic, &common);
+                ok = (numeric != nullptr) && (common.status == KLU_OK);
+            }
+            for(int refactor = 0; ok && refactor < nb_refactor; ++refactor){
+                x = rhs;
+                ok = (klu_refactor(mat.outerIndexPtr(), mat.innerIndexPtr(), mat.valuePtr(), symbolic, numeric, &common) == 1) &&
+                     (klu_solve(symbolic, numeric, n, 1, x.data(), &common) == 1);
+            }
+            if(ok && nb_refactor == 0) ok = (klu_solve(symbolic, numeric, n, 1, x.data(), &common) == 1);
+            double duration = timer.duration();
+            klu_free_numeric(&numeric, &common);
+            klu_free_symbolic(&symbolic, &common);
+            if(!ok) break;  // this candidate does not work for this matrix
+            best_time = std::min(best_time, duration);
+            error = (x - ones).lpNorm<Eigen::Infinity>();
+            if(!std::isfinite(error)) error = inf;
+        }
+        res.push_back(std::make_tuple(parameters, best_time, error));
+    }
+    return res;
+}
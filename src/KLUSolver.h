@@ -33,6 +33,7 @@ extern "C" {
 #include "CustTimer.h"
 #include "Utils.h"
 #include "BaseNRSolver.h"
+#include "KLUParameters.h"
 /**
 class to handle the solver using newton-raphson method, using KLU algorithm and sparse matrices.
 
@@ -55,6 +56,29 @@ class KLUSolver: public BaseNRSolver
 
         virtual void reset();
 
+        // parameters of the factorizations (not modified by "reset"), used from the next factorization
+        void set_parameters(const KLUParameters & parameters)
+        {
+            parameters.check();
+            parameters_ = parameters;
+            need_factorize_ = true;
+        }
+        const KLUParameters & get_parameters() const {return parameters_;}
+
+        /**
+        Benchmark of the candidate parameters on the matrix J: for each of them the time (in s, the smallest over
+        nb_repeat) of a factorization (klu_analyze and klu_factor) followed by nb_refactor refactorizations and
+        solves (what a newton raphson does), and the error of the solution of J.x = J.1 (infinity norm of x - 1,
+        infinity if the factorization failed).
+        **/
+        static std::vector<std::tuple<KLUParameters, double, double> >
+            benchmark_parameters(const Eigen::SparseMatrix<double> & J,
+                                 const std::vector<KLUParameters> & candidates,
+                                 int nb_refactor,
+                                 int nb_repeat);
+        // ordering x btf x scale x pivot tolerance
+        static std::vector<KLUParameters> default_candidates();
+
     protected:
         virtual
         void initialize();
@@ -67,6 +91,7 @@ class KLUSolver: public BaseNRSolver
         klu_symbolic* symbolic_;
         klu_numeric* numeric_;
         klu_common common_;
+        KLUParameters parameters_;
 
         // no copy allowed
         KLUSolver( const KLUSolver & ) ;
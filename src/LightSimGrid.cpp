@@ -0,0 +1,307 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#include "LightSimGrid.h"
+
+#include <fstream>
+#include <limits>
+
+#include "GridModel.h"
+
+namespace
+{
+    /**
+    Text representation of the state of a GridModel: the elements of the (nested) tuples one after the other, each
+    vector being written as its size followed by its values. The first line gives the version of the format.
+    **/
+    const std::string _state_header = "lightsim2grid_state";
+    const int _state_version = 3;  // 2: tap positions of the transformers, 3: parameters of KLU
+
+    void write_value(std::ostream & out, double value) {out << value;}
+    void write_value(std::ostream & out, int value) {out << value;}
+    void write_value(std::ostream & out, bool value) {out << (value ? 1 : 0);}
+    void write_value(std::ostream & out, const cdouble & value) {out << value.real() << " " << value.imag();}
+
+    void read_value(std::istream & in, double & value) {in >> value;}
+    void read_value(std::istream & in, int & value) {in >> value;}
+    void read_value(std::istream & in, cdouble & value) {double re, im; in >> re >> im; value = cdouble(re, im);}
+
+    template<class T>
+    void write_value(std::ostream & out, const std::vector<T> & values)
+    {
+        out << values.size() << "\n";
+        for(const T & el : values){
+            write_value(out, el);
+            out << " ";
+        }
+        out << "\n";
+    }
+
+    template<class T>
+    void read_value(std::istream & in, std::vector<T> & values)
+    {
+        size_t size;
+        in >> size;
+        if(!in) throw std::runtime_error("load_grid: invalid file");
+        values = std::vector<T>(size);
+        for(size_t i = 0; i < size; ++i) read_value(in, values[i]);
+    }
+
+    void read_value(std::istream & in, std::vector<bool> & values)
+    {
+        // std::vector<bool> does not give references to its elements
+        std::vector<int> tmp;
+        read_value(in, tmp);
+        values = std::vector<bool>(tmp.begin(), tmp.end());
+    }
+
+    // all the elements of a tuple, recursively (the states contain nested tuples)
+    template<class... Ts>
+    void write_value(std::ostream & out, const std::tuple<Ts...> & values);
+    template<class... Ts>
+    void read_value(std::istream & in, std::tuple<Ts...> & values);
+
+    template<size_t I, class... Ts>
+    typename std::enable_if<I == sizeof...(Ts)>::type write_tuple(std::ostream &, const std::tuple<Ts...> &) {}
+
+    template<size_t I, class... Ts>
+    typename std::enable_if<I < sizeof...(Ts)>::type write_tuple(std::ostream & out, const std::tuple<Ts...> & values)
+    {
+        write_value(out, std::get<I>(values));
+        out << "\n";
+        write_tuple<I + 1>(out, values);
+    }
+
+    template<class... Ts>
+    void write_value(std::ostream & out, const std::tuple<Ts...> & values) {write_tuple<0>(out, values);}
+
+    template<size_t I, class... Ts>
+    typename std::enable_if<I == sizeof...(Ts)>::type read_tuple(std::istream &, std::tuple<Ts...> &) {}
+
+    template<size_t I, class... Ts>
+    typename std::enable_if<I < sizeof...(Ts)>::type read_tuple(std::istream & in, std::tuple<Ts...> & values)
+    {
+        read_value(in, std::get<I>(values));
+        read_tuple<I + 1>(in, values);
+    }
+
+    template<class... Ts>
+    void read_value(std::istream & in, std::tuple<Ts...> & values) {read_tuple<0>(in, values);}
+
+    // only the N first elements of a tuple (files of the previous versions have a shorter state)
+    template<size_t I, size_t N, class... Ts>
+    typename std::enable_if<I == N>::type read_tuple_first(std::istream &, std::tuple<Ts...> &) {}
+
+    template<size_t I, size_t N, class... Ts>
+    typename std::enable_if<I < N>::type read_tuple_first(std::istream & in, std::tuple<Ts...> & values)
+    {
+        read_value(in, std::get<I>(values));
+        read_tuple_first<I + 1, N>(in, values);
+    }
+
+    // copy a result in a buffer of the caller (NaN if there is no result)
+    void copy_res(const Eigen::VectorXd & res, int size, double * out)
+    {
+        if(out == nullptr) return;
+        if(res.size() != size){
+            std::fill(out, out + size, std::numeric_limits<double>::quiet_NaN());
+            return;
+        }
+        std::copy(res.data(), res.data() + size, out);
+    }
+
+    void copy_res(const tuple3d & res, int size, double * p, double * q, double * v)
+    {
+        copy_res(std::get<0>(res), size, p);
+        copy_res(std::get<1>(res), size, q);
+        copy_res(std::get<2>(res), size, v);
+    }
+
+    void copy_res(const tuple4d & res, int size, double * p, double * q, double * v, double * a)
+    {
+        copy_res(std::get<0>(res), size, p);
+        copy_res(std::get<1>(res), size, q);
+        copy_res(std::get<2>(res), size, v);
+        copy_res(std::get<3>(res), size, a);
+    }
+}
+
+void save_grid(const GridModel & grid, const std::string & path)
+{
+    std::ofstream out(path);
+    if(!out.is_open()) throw std::runtime_error("save_grid: impossible to create the file \"" + path + "\"");
+    out.precision(std::numeric_limits<double>::max_digits10);  // no loss of precision
+    out << _state_header << " " << _state_version << "\n";
+    write_value(out, grid.get_state());
+    if(!out.good()) throw std::runtime_error("save_grid: error while writing \"" + path + "\"");
+}
+
+void load_grid(GridModel & grid, const std::string & path)
+{
+    std::ifstream in(path);
+    if(!in.is_open()) throw std::runtime_error("load_grid: impossible to open the file \"" + path + "\"");
+    std::string header;
+    int version;
+    in >> header >> version;
+    if(!in || (header != _state_header)) throw std::runtime_error("load_grid: \"" + path + "\" is not a grid saved by lightsim2grid");
+    if(version != _state_version && version != 2) throw std::runtime_error("load_grid: unsupported version " + std::to_string(version));
+    GridModel::StateRes state;
+    if(version == 2){
+        // no parameters of KLU: the default ones are used
+        read_tuple_first<0, std::tuple_size<GridModel::StateRes>::value - 1>(in, state);
+        std::get<8>(state) = KLUParameters().get_state();
+    }else{
+        read_value(in, state);
+    }
+    if(!in) throw std::runtime_error("load_grid: the file \"" + path + "\" is truncated or invalid");
+    grid.set_state(state);
+}
+
+struct LightSimGrid::Solution
+{
+    Eigen::VectorXcd V;  // empty if the last powerflow diverged (or if there is none)
+};
+
+LightSimGrid::LightSimGrid():
+    grid_(new GridModel()),
+    converged_(false),
+    solution_(new Solution())
+{}
+
+LightSimGrid::LightSimGrid(const GridModel & grid):
+    grid_(new GridModel(grid)),
+    converged_(false),
+    solution_(new Solution())
+{}
+
+LightSimGrid::LightSimGrid(const LightSimGrid & other):
+    grid_(new GridModel(*other.grid_)),
+    converged_(other.converged_),
+    solution_(new Solution(*other.solution_))
+{}
+
+LightSimGrid & LightSimGrid::operator=(const LightSimGrid & other)
+{
+    if(this != &other){
+        grid_.reset(new GridModel(*other.grid_));
+        converged_ = other.converged_;
+        solution_.reset(new Solution(*other.solution_));
+    }
+    return *this;
+}
+
+LightSimGrid::~LightSimGrid() {}
+
+void LightSimGrid::reset_solution()
+{
+    converged_ = false;
+    solution_->V = Eigen::VectorXcd();
+}
+
+void LightSimGrid::load(const std::string & path)
+{
+    std::unique_ptr<GridModel> grid(new GridModel());
+    load_grid(*grid, path);
+    grid_ = std::move(grid);  // this grid is untouched if the file is invalid
+    reset_solution();
+}
+
+void LightSimGrid::save(const std::string & path) const
+{
+    save_grid(*grid_, path);
+}
+
+int LightSimGrid::nb_bus() const {return grid_->total_bus();}
+int LightSimGrid::nb_line() const {return static_cast<int>(grid_->get_lines_status().size());}
+int LightSimGrid::nb_trafo() const {return static_cast<int>(grid_->get_trafo_status().size());}
+int LightSimGrid::nb_load() const {return static_cast<int>(grid_->get_loads_status().size());}
+int LightSimGrid::nb_gen() const {return static_cast<int>(grid_->get_gen_status().size());}
+int LightSimGrid::nb_shunt() const {return static_cast<int>(grid_->get_shunts_status().size());}
+
+void LightSimGrid::set_load_p(int load_id, double p_mw) {grid_->change_p_load(load_id, p_mw);}
+void LightSimGrid::set_load_q(int load_id, double q_mvar) {grid_->change_q_load(load_id, q_mvar);}
+void LightSimGrid::set_gen_p(int gen_id, double p_mw) {grid_->change_p_gen(gen_id, p_mw);}
+void LightSimGrid::set_gen_v(int gen_id, double v_pu) {grid_->change_v_gen(gen_id, v_pu);}
+
+void LightSimGrid::set_line_status(int line_id, bool connected)
+{
+    if(connected) grid_->reactivate_powerline(line_id);
+    else grid_->deactivate_powerline(line_id);
+}
+
+void LightSimGrid::set_trafo_status(int trafo_id, bool connected)
+{
+    if(connected) grid_->reactivate_trafo(trafo_id);
+    else grid_->deactivate_trafo(trafo_id);
+}
+
+void LightSimGrid::set_load_status(int load_id, bool connected)
+{
+    if(connected) grid_->reactivate_load(load_id);
+    else grid_->deactivate_load(load_id);
+}
+
+void LightSimGrid::set_gen_status(int gen_id, bool connected)
+{
+    if(connected) grid_->reactivate_gen(gen_id);
+    else grid_->deactivate_gen(gen_id);
+}
+
+bool LightSimGrid::solve_ac(int max_iter, double tol)
+{
+    const int nb = nb_bus();
+    const Eigen::VectorXcd Vinit = solution_->V.size() == nb ? solution_->V : Eigen::VectorXcd::Constant(nb, 1.);
+    solution_->V = grid_->ac_pf(Vinit, max_iter, tol);
+    converged_ = solution_->V.size() > 0;
+    return converged_;
+}
+
+bool LightSimGrid::solve_dc()
+{
+    solution_->V = grid_->dc_pf(Eigen::VectorXcd::Constant(nb_bus(), 1.), 1, 1e-8);
+    converged_ = solution_->V.size() > 0;
+    return converged_;
+}
+
+void LightSimGrid::get_bus_v(double * vm_pu, double * va_rad) const
+{
+    const int nb = nb_bus();
+    const Eigen::VectorXcd & V = solution_->V;
+    copy_res(V.size() == nb ? Eigen::VectorXd(V.cwiseAbs()) : Eigen::VectorXd(), nb, vm_pu);
+    copy_res(V.size() == nb ? Eigen::VectorXd(V.array().arg().matrix()) : Eigen::VectorXd(), nb, va_rad);
+}
+
+void LightSimGrid::get_line_or_res(double * p_mw, double * q_mvar, double * v_kv, double * a_ka) const
+{
+    copy_res(grid_->get_lineor_res(), nb_line(), p_mw, q_mvar, v_kv, a_ka);
+}
+
+void LightSimGrid::get_line_ex_res(double * p_mw, double * q_mvar, double * v_kv, double * a_ka) const
+{
+    copy_res(grid_->get_lineex_res(), nb_line(), p_mw, q_mvar, v_kv, a_ka);
+}
+
+void LightSimGrid::get_trafo_hv_res(double * p_mw, double * q_mvar, double * v_kv, double * a_ka) const
+{
+    copy_res(grid_->get_trafohv_res(), nb_trafo(), p_mw, q_mvar, v_kv, a_ka);
+}
+
+void LightSimGrid::get_trafo_lv_res(double * p_mw, double * q_mvar, double * v_kv, double * a_ka) const
+{
+    copy_res(grid_->get_trafolv_res(), nb_trafo(), p_mw, q_mvar, v_kv, a_ka);
+}
+
+void LightSimGrid::get_load_res(double * p_mw, double * q_mvar, double * v_kv) const
+{
+    copy_res(grid_->get_loads_res(), nb_load(), p_mw, q_mvar, v_kv);
+}
+
+void LightSimGrid::get_gen_res(double * p_mw, double * q_mvar, double * v_kv) const
+{
+    copy_res(grid_->get_gen_res(), nb_gen(), p_mw, q_mvar, v_kv);
+}
@@ -0,0 +1,110 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#ifndef LIGHTSIMGRID_H
+#define LIGHTSIMGRID_H
+
+#include <string>
+#include <memory>  // for std::unique_ptr
+
+/**
+Public api of the standalone c++ library (see "make liblightsim2grid"), to use lightsim2grid from c++ without
+python. This header does not depend on Eigen nor on the other headers of lightsim2grid, so that it can stay
+stable when they change.
+
+A typical use is:
+
+    LightSimGrid grid;
+    grid.load("my_grid.txt");  // saved with `GridModel.save("my_grid.txt")` from python
+    grid.set_load_p(0, 12.);
+    if(grid.solve_ac(10, 1e-8)){
+        std::vector<double> a_or(grid.nb_line());
+        grid.get_line_or_res(nullptr, nullptr, nullptr, a_or.data());
+    }
+
+Elements are identified by their id (same order as in the python GridModel), units are MW, MVAr, kV, kA (and
+pu for the voltage setpoints / magnitudes, rad for the voltage angles). Errors are reported with
+std::runtime_error (or std::out_of_range for invalid ids).
+
+Results are copied in buffers given by the caller, that must be large enough (for example nb_bus() for
+get_bus_v), or nullptr if this result is not needed. After a diverging powerflow, the buffers are filled with NaN.
+**/
+
+class GridModel;
+
+// write / read a grid (same content as its pickle state) in a text file that does not depend on the platform
+void save_grid(const GridModel & grid, const std::string & path);
+void load_grid(GridModel & grid, const std::string & path);
+
+class LightSimGrid
+{
+    public:
+        LightSimGrid();
+        explicit LightSimGrid(const GridModel & grid);  // copy of the grid
+        LightSimGrid(const LightSimGrid & other);
+        LightSimGrid & operator=(const LightSimGrid & other);
+        ~LightSimGrid();
+
+        // load / save
+        void load(const std::string & path);
+        void save(const std::string & path) const;
+
+        // size of the grid
+        int nb_bus() const;  // including the disconnected ones
+        int nb_line() const;
+        int nb_trafo() const;
+        int nb_load() const;
+        int nb_gen() const;
+        int nb_shunt() const;
+
+        // modify the grid
+        void set_load_p(int load_id, double p_mw);
+        void set_load_q(int load_id, double q_mvar);
+        void set_gen_p(int gen_id, double p_mw);
+        void set_gen_v(int gen_id, double v_pu);
+        void set_line_status(int line_id, bool connected);
+        void set_trafo_status(int trafo_id, bool connected);
+        void set_load_status(int load_id, bool connected);
+        void set_gen_status(int gen_id, bool connected);
+
+        /**
+        Ac powerflow, starting from the last solution found (or a flat start for the first one, or after a
+        divergence). Returns whether it converged.
+        **/
+        bool solve_ac(int max_iter, double tol);
+        // dc powerflow, returns whether it converged
+        bool solve_dc();
+        bool converged() const {return converged_;}
+
+        // results (size nb_bus)
+        void get_bus_v(double * vm_pu, double * va_rad) const;
+        // results (size nb_line or nb_trafo)
+        void get_line_or_res(double * p_mw, double * q_mvar, double * v_kv, double * a_ka) const;
+        void get_line_ex_res(double * p_mw, double * q_mvar, double * v_kv, double * a_ka) const;
+        void get_trafo_hv_res(double * p_mw, double * q_mvar, double * v_kv, double * a_ka) const;
+        void get_trafo_lv_res(double * p_mw, double * q_mvar, double * v_kv, double * a_ka) const;
+        // results (size nb_load or nb_gen)
+        void get_load_res(double * p_mw, double * q_mvar, double * v_kv) const;
+        void get_gen_res(double * p_mw, double * q_mvar, double * v_kv) const;
+
+        // the underlying model, for what is not (yet) part of this api
+        GridModel & model() {return *grid_;}
+        const GridModel & model() const {return *grid_;}
+
+    private:
+        void reset_solution();
+
+    private:
+        std::unique_ptr<GridModel> grid_;
+        bool converged_;
+
+        struct Solution;  // last powerflow results (defined in the .cpp)
+        std::unique_ptr<Solution> solution_;
+};
+
+#endif // LIGHTSIMGRID_H
@@ -0,0 +1,265 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#include "MonteCarlo.h"
+
+#include <random>
+#include <string>
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+MonteCarlo::MonteCarlo(const GridModel & grid):
+    grid_(grid),
+    max_iter_(10),
+    tol_(1e-8),
+    nb_threads_(0),
+    quantiles_({0.05, 0.5, 0.95}),
+    nb_diverged_(0)
+{
+    GridModel::StateRes state = grid_.get_state();
+    nb_bus_ = static_cast<int>(std::get<0>(state).size());
+    nb_line_ = static_cast<int>(std::get<3>(std::get<2>(state)).size());
+    nb_trafo_ = static_cast<int>(std::get<3>(std::get<4>(state)).size());
+
+    const DataLoad::StateRes & loads = std::get<6>(state);
+    load_p_ = Eigen::Map<const Eigen::VectorXd>(std::get<0>(loads).data(), std::get<0>(loads).size());
+    load_q_ = Eigen::Map<const Eigen::VectorXd>(std::get<1>(loads).data(), std::get<1>(loads).size());
+    load_status_ = std::get<3>(loads);
+    const DataGen::StateRes & gens = std::get<5>(state);
+    gen_p_ = Eigen::Map<const Eigen::VectorXd>(std::get<0>(gens).data(), std::get<0>(gens).size());
+    gen_status_ = std::get<5>(gens);
+
+    reset_stats();
+}
+
+void MonteCarlo::set_max_iter(int max_iter)
+{
+    if(max_iter < 1) throw std::runtime_error("MonteCarlo::set_max_iter: the number of iterations should be >= 1");
+    max_iter_ = max_iter;
+    V_init_ = Eigen::VectorXcd();  // initial powerflow needs to be recomputed
+}
+
+void MonteCarlo::set_tol(double tol)
+{
+    if(tol <= 0.) throw std::runtime_error("MonteCarlo::set_tol: the tolerance should be > 0.");
+    tol_ = tol;
+    V_init_ = Eigen::VectorXcd();  // initial powerflow needs to be recomputed
+}
+
+void MonteCarlo::set_nb_threads(int nb_threads)
+{
+    if(nb_threads < 0) throw std::runtime_error("MonteCarlo::set_nb_threads: the number of threads should be >= 0");
+    nb_threads_ = nb_threads;
+}
+
+int MonteCarlo::get_nb_threads() const
+{
+    int res = 1;
+    #ifdef _OPENMP
+        res = nb_threads_ > 0 ? nb_threads_ : omp_get_max_threads();
+    #endif
+    return res;
+}
+
+void MonteCarlo::set_quantiles(const std::vector<double> & quantiles)
+{
+    for(const auto q : quantiles){
+        if((q < 0.) || (q > 1.)) throw std::runtime_error("MonteCarlo::set_quantiles: quantiles should be between 0. and 1.");
+    }
+    quantiles_ = quantiles;
+    reset_stats();
+}
+
+void MonteCarlo::set_thermal_limits(const Eigen::VectorXd & thermal_limits)
+{
+    if(thermal_limits.size() != nb_line_ + nb_trafo_){
+        throw std::runtime_error("MonteCarlo::set_thermal_limits: there should be one limit per powerline and per transformer (powerlines first).");
+    }
+    if((thermal_limits.array() <= 0.).any()){
+        throw std::runtime_error("MonteCarlo::set_thermal_limits: the thermal limits should be > 0.");
+    }
+    thermal_limits_ = thermal_limits;
+    reset_stats();
+}
+
+Eigen::VectorXd MonteCarlo::get_overload_proba() const
+{
+    if(thermal_limits_.size() == 0){
+        throw std::runtime_error("MonteCarlo::get_overload_proba: the thermal limits are not known, see set_thermal_limits.");
+    }
+    return branch_stats_.proba_above();
+}
+
+void MonteCarlo::reset_stats()
+{
+    nb_diverged_ = 0;
+    branch_stats_.init(nb_line_ + nb_trafo_, 1.);
+    vm_stats_.init(nb_bus_, 1.);
+    vm_quantiles_.init(nb_bus_, quantiles_);
+}
+
+void MonteCarlo::init_grids()
+{
+    // initial powerflow, used as a starting point for all the scenarios
+    if(V_init_.size() == 0){
+        Eigen::VectorXcd V = grid_.ac_pf(Eigen::VectorXcd::Constant(nb_bus_, 1.), max_iter_, tol_);
+        if(V.size() == 0) throw std::runtime_error("MonteCarlo: the powerflow of the initial grid diverges.");
+        V_init_ = V;
+    }
+    const int nb_threads = get_nb_threads();
+    while(static_cast<int>(grids_.size()) < nb_threads){
+        grids_.push_back(std::unique_ptr<GridModel>(new GridModel(grid_)));
+        grids_.back()->reactivate_result_computation();  // the flows are needed
+    }
+}
+
+void MonteCarlo::check_input(const Eigen::MatrixXd & mat, int nb_col, const std::string & name) const
+{
+    if((mat.rows() > 0) && (mat.cols() != nb_col)){
+        throw std::runtime_error("MonteCarlo: " + name + " should have " + std::to_string(nb_col) + " columns.");
+    }
+}
+
+void MonteCarlo::set_injections(GridModel & grid,
+                                const Eigen::MatrixXd & load_p,
+                                const Eigen::MatrixXd & load_q,
+                                const Eigen::MatrixXd & gen_p,
+                                int row) const
+{
+    const int nb_load = static_cast<int>(load_status_.size());
+    const int nb_gen = static_cast<int>(gen_status_.size());
+    for(int load_id = 0; load_id < nb_load; ++load_id){
+        if(!load_status_[load_id]) continue;
+        grid.change_p_load(load_id, load_p.rows() > 0 ? load_p(row, load_id) : load_p_(load_id));
+        grid.change_q_load(load_id, load_q.rows() > 0 ? load_q(row, load_id) : load_q_(load_id));
+    }
+    for(int gen_id = 0; gen_id < nb_gen; ++gen_id){
+        if(!gen_status_[gen_id]) continue;
+        grid.change_p_gen(gen_id, gen_p.rows() > 0 ? gen_p(row, gen_id) : gen_p_(gen_id));
+    }
+}
+
+int MonteCarlo::run_samples(const Eigen::MatrixXd & load_p,
+                            const Eigen::MatrixXd & load_q,
+                            const Eigen::MatrixXd & gen_p)
+{
+    check_input(load_p, static_cast<int>(load_status_.size()), "load_p");
+    check_input(load_q, static_cast<int>(load_status_.size()), "load_q");
+    check_input(gen_p, static_cast<int>(gen_status_.size()), "gen_p");
+    int nb_scenario = 0;
+    for(const auto * mat : {&load_p, &load_q, &gen_p}){
+        if(mat->rows() == 0) continue;
+        if((nb_scenario > 0) && (mat->rows() != nb_scenario)){
+            throw std::runtime_error("MonteCarlo::run_samples: all the (non empty) matrices should have the same number of rows.");
+        }
+        nb_scenario = static_cast<int>(mat->rows());
+    }
+
+    init_grids();
+    const int batch_size = _batch_per_thread * get_nb_threads();
+    const Eigen::MatrixXd empty;
+    int res = 0;
+    for(int first = 0; first < nb_scenario; first += batch_size){
+        const int nb = std::min(batch_size, nb_scenario - first);
+        // copy of the rows of this batch (only)
+        res += run_batch(load_p.rows() > 0 ? Eigen::MatrixXd(load_p.middleRows(first, nb)) : empty,
+                         load_q.rows() > 0 ? Eigen::MatrixXd(load_q.middleRows(first, nb)) : empty,
+                         gen_p.rows() > 0 ? Eigen::MatrixXd(gen_p.middleRows(first, nb)) : empty,
+                         nb);
+    }
+    return res;
+}
+
+int MonteCarlo::run_normal(int nb_scenario,
+                           const Eigen::VectorXd & load_p_std,
+                           const Eigen::VectorXd & load_q_std,
+                           const Eigen::VectorXd & gen_p_std,
+                           unsigned int seed)
+{
+    if(nb_scenario < 0) throw std::runtime_error("MonteCarlo::run_normal: the number of scenarios should be >= 0");
+    const int nb_load = static_cast<int>(load_status_.size());
+    const int nb_gen = static_cast<int>(gen_status_.size());
+    if((load_p_std.size() > 0) && (load_p_std.size() != nb_load)) throw std::runtime_error("MonteCarlo::run_normal: load_p_std should have one value per load.");
+    if((load_q_std.size() > 0) && (load_q_std.size() != nb_load)) throw std::runtime_error("MonteCarlo::run_normal: load_q_std should have one value per load.");
+    if((gen_p_std.size() > 0) && (gen_p_std.size() != nb_gen)) throw std::runtime_error("MonteCarlo::run_normal: gen_p_std should have one value per generator.");
+
+    init_grids();
+    const int batch_size = _batch_per_thread * get_nb_threads();
+    // the draws are made sequentially: the results do not depend on the number of threads
+    std::mt19937_64 gen(seed);
+    std::normal_distribution<double> normal(0., 1.);
+    Eigen::MatrixXd load_p, load_q, gen_p;
+    int res = 0;
+    for(int first = 0; first < nb_scenario; first += batch_size){
+        const int nb = std::min(batch_size, nb_scenario - first);
+        load_p = load_p_.transpose().replicate(nb, 1);
+        load_q = load_q_.transpose().replicate(nb, 1);
+        gen_p = gen_p_.transpose().replicate(nb, 1);
+        for(int row = 0; row < nb; ++row){
+            for(int el_id = 0; el_id < load_p_std.size(); ++el_id) load_p(row, el_id) += load_p_std(el_id) * normal(gen);
+            for(int el_id = 0; el_id < load_q_std.size(); ++el_id) load_q(row, el_id) += load_q_std(el_id) * normal(gen);
+            for(int el_id = 0; el_id < gen_p_std.size(); ++el_id) gen_p(row, el_id) += gen_p_std(el_id) * normal(gen);
+        }
+        res += run_batch(load_p, load_q, gen_p, nb);
+    }
+    return res;
+}
+
+int MonteCarlo::run_batch(const Eigen::MatrixXd & load_p,
+                          const Eigen::MatrixXd & load_q,
+                          const Eigen::MatrixXd & gen_p,
+                          int nb_scenario)
+{
+    const int nb_branch = nb_line_ + nb_trafo_;
+    Eigen::MatrixXd loading(nb_branch, nb_scenario);  // one column per scenario
+    Eigen::MatrixXd vm(nb_bus_, nb_scenario);
+    std::vector<int> converged(nb_scenario, 0);
+    std::string error_msg = "";
+
+    #pragma omp parallel for schedule(dynamic) num_threads(get_nb_threads())
+    for(int row = 0; row < nb_scenario; ++row){
+        int thread_id = 0;
+        #ifdef _OPENMP
+            thread_id = omp_get_thread_num();
+        #endif
+        GridModel & grid = *grids_[thread_id];
+        try{
+            set_injections(grid, load_p, load_q, gen_p, row);
+            Eigen::VectorXcd V = grid.ac_pf(V_init_, max_iter_, tol_);
+            if(V.size() == 0) continue;  // divergence
+            converged[row] = 1;
+            vm.col(row) = V.cwiseAbs();
+            const tuple4d & lor = grid.get_lineor_res();
+            const tuple4d & lex = grid.get_lineex_res();
+            const tuple4d & thv = grid.get_trafohv_res();
+            loading.col(row).head(nb_line_) = std::get<3>(lor).cwiseMax(std::get<3>(lex));
+            loading.col(row).tail(nb_trafo_) = std::get<3>(thv);
+            if(thermal_limits_.size() > 0) loading.col(row).array() /= thermal_limits_.array();
+        }catch(const std::exception & e){
+            // exceptions cannot be propagated outside of an openmp loop
+            #pragma omp critical
+            error_msg = e.what();
+        }
+    }
+    if(!error_msg.empty()) throw std::runtime_error("MonteCarlo: " + error_msg);
+
+    // statistics are updated in the order of the scenarios
+    int res = 0;
+    for(int row = 0; row < nb_scenario; ++row){
+        if(!converged[row]){
+            ++nb_diverged_;
+            continue;
+        }
+        ++res;
+        branch_stats_.add(loading.col(row));
+        vm_stats_.add(vm.col(row));
+        vm_quantiles_.add(vm.col(row));
+    }
+    return res;
+}
@@ -0,0 +1,146 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+#include <vector>
+#include <memory>  // for std::unique_ptr
+
+#include "GridModel.h"
+#include "StreamingStats.h"
+
+/**
+Probabilistic powerflow: a lot of "scenarios" (values of the loads and of the productions) are computed, and
+only statistics about the results are kept:
+
+- for each "branch" (the powerlines, then the transformers): mean, variance and maximum of its loading, and
+  probability that it is overloaded (loading > 1). The loading is the current (max of both sides for the
+  powerlines, hv side for the transformers, as grid2op) divided by the thermal limit, in kA, given by
+  "set_thermal_limits". If no limits are given, the loading is the current in kA, and the overload probability
+  cannot be retrieved.
+- for each bus: mean and variance of the voltage magnitude (pu), as well as some of its quantiles (see
+  "set_quantiles")
+
+These statistics are updated after each scenario (nothing is stored per scenario), so the memory does not depend
+on the number of scenarios. The statistics of successive calls to "run_samples" / "run_normal" are accumulated,
+until "reset_stats" is called.
+
+The scenarios are computed by batches, in parallel (one copy of the grid per thread, if lightsim2grid is compiled
+with openmp) and each powerflow starts from the solution of the grid given to the constructor ("warm start").
+The statistics are updated in the order of the scenarios, so the results do not depend on the number of threads.
+
+The scenarios for which the powerflow diverges are not taken into account (see "get_nb_diverged").
+**/
+class MonteCarlo
+{
+    public:
+        MonteCarlo(const GridModel & grid);
+
+        ~MonteCarlo(){}
+
+        // parameters of the powerflows
+        void set_max_iter(int max_iter);
+        void set_tol(double tol);
+        // 0 = as many threads as openmp would use
+        void set_nb_threads(int nb_threads);
+        int get_nb_threads() const;
+
+        // these reset the statistics
+        void set_quantiles(const std::vector<double> & quantiles);
+        const std::vector<double> & get_quantiles() const {return quantiles_;}
+        void set_thermal_limits(const Eigen::VectorXd & thermal_limits);
+        void reset_stats();
+
+        /**
+        Computes one scenario per row of the matrices, that have one column per load (load_p and load_q, in MW and
+        MVAr) or per generator (gen_p, in MW). A matrix with 0 row means that the values of the initial grid are used
+        (for all scenarios). Values of disconnected elements are ignored.
+
+        It returns the number of scenarios that converged.
+        **/
+        int run_samples(const Eigen::MatrixXd & load_p,
+                        const Eigen::MatrixXd & load_q,
+                        const Eigen::MatrixXd & gen_p);
+
+        /**
+        Computes nb_scenario scenarios where each value is drawn independently from a normal distribution, centered
+        on the value of the initial grid, with the given standard deviations (same units as above, an empty vector
+        meaning a standard deviation of 0. for all the elements). The results only depend on the seed.
+
+        It returns the number of scenarios that converged.
+        **/
+        int run_normal(int nb_scenario,
+                       const Eigen::VectorXd & load_p_std,
+                       const Eigen::VectorXd & load_q_std,
+                       const Eigen::VectorXd & gen_p_std,
+                       unsigned int seed);
+
+        // results
+        int get_nb_scenario() const {return branch_stats_.count();}
+        int get_nb_diverged() const {return nb_diverged_;}
+        Eigen::VectorXd get_loading_mean() const {return branch_stats_.mean();}
+        Eigen::VectorXd get_loading_var() const {return branch_stats_.variance();}
+        Eigen::VectorXd get_loading_max() const {return branch_stats_.max();}
+        // only if the thermal limits are given (see set_thermal_limits)
+        Eigen::VectorXd get_overload_proba() const;
+        Eigen::VectorXd get_vm_mean() const {return vm_stats_.mean();}
+        Eigen::VectorXd get_vm_var() const {return vm_stats_.variance();}
+        // one row per bus, one column per quantile
+        Eigen::MatrixXd get_vm_quantiles() const {return vm_quantiles_.values();}
+
+    protected:
+        // solves the first nb_scenario rows of the matrices, and updates the statistics
+        int run_batch(const Eigen::MatrixXd & load_p,
+                      const Eigen::MatrixXd & load_q,
+                      const Eigen::MatrixXd & gen_p,
+                      int nb_scenario);
+        void init_grids();
+        void check_input(const Eigen::MatrixXd & mat, int nb_col, const std::string & name) const;
+        void set_injections(GridModel & grid,
+                            const Eigen::MatrixXd & load_p,
+                            const Eigen::MatrixXd & load_q,
+                            const Eigen::MatrixXd & gen_p,
+                            int row) const;
+
+    protected:
+        GridModel grid_;
+        std::vector<std::unique_ptr<GridModel> > grids_;  // one per thread
+        Eigen::VectorXcd V_init_;  // solution of the initial grid (used as starting point)
+
+        int max_iter_;
+        double tol_;
+        int nb_threads_;
+
+        // initial grid
+        int nb_bus_;
+        int nb_line_;
+        int nb_trafo_;
+        std::vector<bool> load_status_;
+        std::vector<bool> gen_status_;
+        Eigen::VectorXd load_p_;
+        Eigen::VectorXd load_q_;
+        Eigen::VectorXd gen_p_;
+
+        // statistics
+        std::vector<double> quantiles_;
+        Eigen::VectorXd thermal_limits_;  // empty until set_thermal_limits
+        int nb_diverged_;
+        RunningMoments branch_stats_;
+        RunningMoments vm_stats_;
+        RunningQuantiles vm_quantiles_;
+
+        static const int _batch_per_thread = 16;  // number of scenarios per thread in each batch
+
+    private:
+        // no copy allowed
+        MonteCarlo( const MonteCarlo & ) ;
+        MonteCarlo & operator=( const MonteCarlo & ) ;
+};
+
+#endif // MONTECARLO_H
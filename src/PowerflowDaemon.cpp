@@ -0,0 +1,536 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#include "PowerflowDaemon.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>  // placement new
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    // the atomics are shared between processes: they must not rely on a lock
+    static_assert(ATOMIC_INT_LOCK_FREE == 2, "lock free std::atomic<int> is required");
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "lock free std::atomic<long long> is required");
+
+    const uint64_t _magic = 0x4c53326744616d6eULL;
+    const int _version = 1;
+
+    enum SlotState : int32_t {Free = 0, Writing = 1, Submitted = 2, Processing = 3, Done = 4};
+
+    struct SharedHeader
+    {
+        uint64_t magic;
+        int32_t version;
+        int32_t nb_bus, nb_load, nb_gen, nb_line, nb_trafo;
+        int32_t nb_slot;
+        uint64_t queue_mask;  // number of cells of the queue (power of 2) - 1
+        std::atomic<int32_t> running;
+        std::atomic<long long> nb_processed;
+        // positions of the queue, on different cache lines
+        alignas(64) std::atomic<unsigned long long> enqueue_pos;
+        alignas(64) std::atomic<unsigned long long> dequeue_pos;
+    };
+
+    struct QueueCell
+    {
+        std::atomic<unsigned long long> sequence;
+        int64_t slot_id;
+    };
+
+    struct alignas(64) SlotHeader
+    {
+        std::atomic<int32_t> state;
+        int32_t converged;
+        // which inputs are given
+        int32_t has_load_p, has_load_q, has_gen_p, has_gen_v, has_line_status, has_trafo_status;
+    };
+
+    uint64_t queue_size(int nb_slot)
+    {
+        uint64_t res = 1;
+        while(res < static_cast<uint64_t>(nb_slot)) res *= 2;
+        return res;
+    }
+
+    // offsets (in bytes) of the parts of the shared memory
+    size_t cells_offset() {return (sizeof(SharedHeader) + 63) / 64 * 64;}
+    size_t slots_offset(uint64_t nb_cell) {return (cells_offset() + nb_cell * sizeof(QueueCell) + 63) / 64 * 64;}
+    size_t slot_bytes(const PowerflowSlotLayout & layout) {return sizeof(SlotHeader) + layout.size * sizeof(double);}
+
+    SharedHeader * get_header(void * memory) {return static_cast<SharedHeader *>(memory);}
+    QueueCell * get_cells(void * memory) {return reinterpret_cast<QueueCell *>(static_cast<char *>(memory) + cells_offset());}
+    SlotHeader * get_slot(void * memory, const PowerflowSlotLayout & layout, int slot_id)
+    {
+        const SharedHeader * header = get_header(memory);
+        char * first = static_cast<char *>(memory) + slots_offset(header->queue_mask + 1);
+        return reinterpret_cast<SlotHeader *>(first + slot_id * slot_bytes(layout));
+    }
+    double * get_data(SlotHeader * slot) {return reinterpret_cast<double *>(slot + 1);}
+
+    // bounded multi producers / multi consumers queue (D. Vyukov), returns false if the queue is full / empty
+    bool enqueue(void * memory, int slot_id)
+    {
+        SharedHeader * header = get_header(memory);
+        QueueCell * cells = get_cells(memory);
+        unsigned long long pos = header->enqueue_pos.load(std::memory_order_relaxed);
+        QueueCell * cell;
+        while(true){
+            cell = &cells[pos & header->queue_mask];
+            const unsigned long long seq = cell->sequence.load(std::memory_order_acquire);
+            const long long diff = static_cast<long long>(seq) - static_cast<long long>(pos);
+            if(diff == 0){
+                if(header->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }else if(diff < 0){
+                return false;
+            }else{
+                pos = header->enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->slot_id = slot_id;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool dequeue(void * memory, int & slot_id)
+    {
+        SharedHeader * header = get_header(memory);
+        QueueCell * cells = get_cells(memory);
+        unsigned long long pos = header->dequeue_pos.load(std::memory_order_relaxed);
+        QueueCell * cell;
+        while(true){
+            cell = &cells[pos & header->queue_mask];
+            const unsigned long long seq = cell->sequence.load(std::memory_order_acquire);
+            const long long diff = static_cast<long long>(seq) - static_cast<long long>(pos + 1);
+            if(diff == 0){
+                if(header->dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }else if(diff < 0){
+                return false;
+            }else{
+                pos = header->dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        slot_id = static_cast<int>(cell->slot_id);
+        cell->sequence.store(pos + header->queue_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // waits a bit (more and more) when there is nothing to do
+    void backoff(int & nb_idle)
+    {
+        ++nb_idle;
+        if(nb_idle < 64) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(nb_idle < 1024 ? 10 : 200));
+    }
+
+    void * map_memory(const std::string & name, size_t & size, bool create)
+    {
+#ifdef _WIN32
+        throw std::runtime_error("PowerflowDaemon: shared memory is not available on windows");
+#else
+        const int fd = create ? shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600) : shm_open(name.c_str(), O_RDWR, 0600);
+        if(fd < 0){
+            throw std::runtime_error(create ? "PowerflowDaemon: impossible to create the shared memory \"" + name + "\" (does it exist already ?)"
+                                            : "PowerflowClient: impossible to open the shared memory \"" + name + "\" (is the daemon started ?)");
+        }
+        if(create){
+            if(ftruncate(fd, static_cast<off_t>(size)) != 0){
+                close(fd);
+                shm_unlink(name.c_str());
+                throw std::runtime_error("PowerflowDaemon: impossible to allocate the shared memory");
+            }
+        }else{
+            struct stat info;
+            if(fstat(fd, &info) != 0){
+                close(fd);
+                throw std::runtime_error("PowerflowClient: impossible to get the size of the shared memory");
+            }
+            size = static_cast<size_t>(info.st_size);
+        }
+        void * res = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);  // the mapping stays valid
+        if(res == MAP_FAILED){
+            if(create) shm_unlink(name.c_str());
+            throw std::runtime_error("PowerflowDaemon: impossible to map the shared memory");
+        }
+        return res;
+#endif
+    }
+
+    void unmap_memory(void * memory, size_t size)
+    {
+#ifndef _WIN32
+        if(memory != nullptr) munmap(memory, size);
+#endif
+    }
+}
+
+void PowerflowSlotLayout::init(int nb_bus_, int nb_load_, int nb_gen_, int nb_line_, int nb_trafo_)
+{
+    nb_bus = nb_bus_;
+    nb_load = nb_load_;
+    nb_gen = nb_gen_;
+    nb_line = nb_line_;
+    nb_trafo = nb_trafo_;
+    size_t pos = 0;
+    load_p = pos; pos += nb_load;
+    load_q = pos; pos += nb_load;
+    gen_p = pos; pos += nb_gen;
+    gen_v = pos; pos += nb_gen;
+    line_status = pos; pos += nb_line;
+    trafo_status = pos; pos += nb_trafo;
+    bus_vm = pos; pos += nb_bus;
+    bus_va = pos; pos += nb_bus;
+    line_or = pos; pos += 4 * nb_line;
+    line_ex = pos; pos += 4 * nb_line;
+    trafo_hv = pos; pos += 4 * nb_trafo;
+    trafo_lv = pos; pos += 4 * nb_trafo;
+    gen_res = pos; pos += 3 * nb_gen;
+    size = (pos + 7) / 8 * 8;  // slots aligned on cache lines
+}
+
+PowerflowDaemon::PowerflowDaemon(const GridModel & grid, const std::string & name, int nb_slot, int nb_worker):
+    name_(name),
+    nb_slot_(nb_slot),
+    nb_worker_(nb_worker),
+    max_iter_(10),
+    tol_(1e-8),
+    memory_(nullptr),
+    memory_size_(0),
+    stop_requested_(false)
+{
+    if(nb_slot < 1) throw std::runtime_error("PowerflowDaemon: the number of slots should be >= 1");
+    if(nb_worker < 1) throw std::runtime_error("PowerflowDaemon: the number of workers should be >= 1");
+
+    GridModel::StateRes state = grid.get_state();
+    const DataLoad::StateRes & loads = std::get<6>(state);
+    load_p_ = Eigen::Map<const Eigen::VectorXd>(std::get<0>(loads).data(), std::get<0>(loads).size());
+    load_q_ = Eigen::Map<const Eigen::VectorXd>(std::get<1>(loads).data(), std::get<1>(loads).size());
+    load_status_ = std::get<3>(loads);
+    const DataGen::StateRes & gens = std::get<5>(state);
+    gen_p_ = Eigen::Map<const Eigen::VectorXd>(std::get<0>(gens).data(), std::get<0>(gens).size());
+    gen_v_ = Eigen::Map<const Eigen::VectorXd>(std::get<1>(gens).data(), std::get<1>(gens).size());
+    gen_status_ = std::get<5>(gens);
+    line_status_ = grid.get_lines_status();
+    trafo_status_ = grid.get_trafo_status();
+    layout_.init(grid.total_bus(), static_cast<int>(load_status_.size()), static_cast<int>(gen_status_.size()),
+                 static_cast<int>(line_status_.size()), static_cast<int>(trafo_status_.size()));
+
+    for(int worker_id = 0; worker_id < nb_worker; ++worker_id){
+        grids_.push_back(std::unique_ptr<GridModel>(new GridModel(grid)));
+        grids_.back()->reactivate_result_computation();
+    }
+
+    // shared memory: header, queue then slots
+    const uint64_t nb_cell = queue_size(nb_slot);
+    memory_size_ = slots_offset(nb_cell) + nb_slot * slot_bytes(layout_);
+    memory_ = map_memory(name_, memory_size_, true);
+    std::memset(memory_, 0, memory_size_);
+    SharedHeader * header = new (memory_) SharedHeader();
+    header->nb_bus = layout_.nb_bus;
+    header->nb_load = layout_.nb_load;
+    header->nb_gen = layout_.nb_gen;
+    header->nb_line = layout_.nb_line;
+    header->nb_trafo = layout_.nb_trafo;
+    header->nb_slot = nb_slot;
+    header->queue_mask = nb_cell - 1;
+    header->running.store(0);
+    header->nb_processed.store(0);
+    header->enqueue_pos.store(0);
+    header->dequeue_pos.store(0);
+    QueueCell * cells = get_cells(memory_);
+    for(uint64_t cell_id = 0; cell_id < nb_cell; ++cell_id){
+        new (&cells[cell_id]) QueueCell();
+        cells[cell_id].sequence.store(cell_id);
+    }
+    for(int slot_id = 0; slot_id < nb_slot; ++slot_id){
+        SlotHeader * slot = new (get_slot(memory_, layout_, slot_id)) SlotHeader();
+        slot->state.store(SlotState::Free);
+    }
+    // the clients check the header last
+    header->version = _version;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = _magic;
+}
+
+PowerflowDaemon::~PowerflowDaemon()
+{
+    stop();
+    unmap_memory(memory_, memory_size_);
+#ifndef _WIN32
+    shm_unlink(name_.c_str());
+#endif
+}
+
+void PowerflowDaemon::set_max_iter(int max_iter)
+{
+    if(is_running()) throw std::runtime_error("PowerflowDaemon::set_max_iter: the daemon should be stopped first");
+    if(max_iter < 1) throw std::runtime_error("PowerflowDaemon::set_max_iter: the number of iterations should be >= 1");
+    max_iter_ = max_iter;
+}
+
+void PowerflowDaemon::set_tol(double tol)
+{
+    if(is_running()) throw std::runtime_error("PowerflowDaemon::set_tol: the daemon should be stopped first");
+    if(tol <= 0.) throw std::runtime_error("PowerflowDaemon::set_tol: the tolerance should be > 0.");
+    tol_ = tol;
+}
+
+long PowerflowDaemon::get_nb_processed() const
+{
+    return static_cast<long>(get_header(memory_)->nb_processed.load());
+}
+
+void PowerflowDaemon::start()
+{
+    if(is_running()) return;
+    stop_requested_.store(false);
+    for(int worker_id = 0; worker_id < nb_worker_; ++worker_id){
+        workers_.push_back(std::thread(&PowerflowDaemon::work, this, worker_id));
+    }
+    get_header(memory_)->running.store(1);
+}
+
+void PowerflowDaemon::stop()
+{
+    if(!is_running()) return;
+    get_header(memory_)->running.store(0);
+    stop_requested_.store(true);
+    for(auto & worker : workers_) worker.join();
+    workers_.clear();
+}
+
+void PowerflowDaemon::work(int worker_id)
+{
+    GridModel & grid = *grids_[worker_id];
+    Eigen::VectorXcd V;  // last solution of this replica (warm start)
+    int nb_idle = 0;
+    int slot_id;
+    while(!stop_requested_.load(std::memory_order_relaxed)){
+        if(!dequeue(memory_, slot_id)){
+            backoff(nb_idle);
+            continue;
+        }
+        nb_idle = 0;
+        process(slot_id, grid, V);
+    }
+}
+
+void PowerflowDaemon::process(int slot_id, GridModel & grid, Eigen::VectorXcd & V)
+{
+    SlotHeader * slot = get_slot(memory_, layout_, slot_id);
+    double * data = get_data(slot);
+    slot->state.store(SlotState::Processing, std::memory_order_relaxed);
+
+    bool conv = false;
+    try{
+        // topology
+        for(int line_id = 0; line_id < layout_.nb_line; ++line_id){
+            const bool status = slot->has_line_status ? data[layout_.line_status + line_id] > 0.5 : line_status_[line_id];
+            if(status == grid.get_lines_status()[line_id]) continue;
+            if(status) grid.reactivate_powerline(line_id);
+            else grid.deactivate_powerline(line_id);
+        }
+        for(int trafo_id = 0; trafo_id < layout_.nb_trafo; ++trafo_id){
+            const bool status = slot->has_trafo_status ? data[layout_.trafo_status + trafo_id] > 0.5 : trafo_status_[trafo_id];
+            if(status == grid.get_trafo_status()[trafo_id]) continue;
+            if(status) grid.reactivate_trafo(trafo_id);
+            else grid.deactivate_trafo(trafo_id);
+        }
+        // injections
+        for(int load_id = 0; load_id < layout_.nb_load; ++load_id){
+            if(!load_status_[load_id]) continue;
+            grid.change_p_load(load_id, slot->has_load_p ? data[layout_.load_p + load_id] : load_p_(load_id));
+            grid.change_q_load(load_id, slot->has_load_q ? data[layout_.load_q + load_id] : load_q_(load_id));
+        }
+        for(int gen_id = 0; gen_id < layout_.nb_gen; ++gen_id){
+            if(!gen_status_[gen_id]) continue;
+            grid.change_p_gen(gen_id, slot->has_gen_p ? data[layout_.gen_p + gen_id] : gen_p_(gen_id));
+            grid.change_v_gen(gen_id, slot->has_gen_v ? data[layout_.gen_v + gen_id] : gen_v_(gen_id));
+        }
+
+        const Eigen::VectorXcd Vinit = V.size() == layout_.nb_bus ? V : Eigen::VectorXcd::Constant(layout_.nb_bus, 1.);
+        Eigen::VectorXcd res = grid.ac_pf(Vinit, max_iter_, tol_);
+        conv = res.size() > 0;
+        if(conv) V = res;
+        else V = Eigen::VectorXcd();  // flat start next time
+    }catch(const std::exception &){
+        conv = false;  // invalid request (for example a bus left without any element): reported as a divergence
+        V = Eigen::VectorXcd();
+    }
+
+    // results
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::fill(data + layout_.bus_vm, data + layout_.size, nan);
+    if(conv){
+        Eigen::Map<Eigen::VectorXd>(data + layout_.bus_vm, layout_.nb_bus) = V.cwiseAbs();
+        Eigen::Map<Eigen::VectorXd>(data + layout_.bus_va, layout_.nb_bus) = V.array().arg().matrix();
+        const std::vector<std::pair<size_t, tuple4d> > branches = {{layout_.line_or, grid.get_lineor_res()},
+                                                                    {layout_.line_ex, grid.get_lineex_res()},
+                                                                    {layout_.trafo_hv, grid.get_trafohv_res()},
+                                                                    {layout_.trafo_lv, grid.get_trafolv_res()}};
+        for(const auto & branch : branches){
+            const int nb = static_cast<int>(std::get<0>(branch.second).size());
+            Eigen::Map<Eigen::VectorXd>(data + branch.first, nb) = std::get<0>(branch.second);
+            Eigen::Map<Eigen::VectorXd>(data + branch.first + nb, nb) = std::get<1>(branch.second);
+            Eigen::Map<Eigen::VectorXd>(data + branch.first + 2 * nb, nb) = std::get<2>(branch.second);
+            Eigen::Map<Eigen::VectorXd>(data + branch.first + 3 * nb, nb) = std::get<3>(branch.second);
+        }
+        const tuple3d gen_res = grid.get_gen_res();
+        Eigen::Map<Eigen::VectorXd>(data + layout_.gen_res, layout_.nb_gen) = std::get<0>(gen_res);
+        Eigen::Map<Eigen::VectorXd>(data + layout_.gen_res + layout_.nb_gen, layout_.nb_gen) = std::get<1>(gen_res);
+        Eigen::Map<Eigen::VectorXd>(data + layout_.gen_res + 2 * layout_.nb_gen, layout_.nb_gen) = std::get<2>(gen_res);
+    }
+    slot->converged = conv ? 1 : 0;
+    get_header(memory_)->nb_processed.fetch_add(1, std::memory_order_relaxed);
+    slot->state.store(SlotState::Done, std::memory_order_release);  // the client can read the results
+}
+
+PowerflowClient::PowerflowClient(const std::string & name):
+    name_(name),
+    memory_(nullptr),
+    memory_size_(0),
+    next_slot_(0)
+{
+    memory_ = map_memory(name_, memory_size_, false);
+    const SharedHeader * header = get_header(memory_);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if((memory_size_ < sizeof(SharedHeader)) || (header->magic != _magic) || (header->version != _version)){
+        unmap_memory(memory_, memory_size_);
+        throw std::runtime_error("PowerflowClient: \"" + name_ + "\" is not the shared memory of a (compatible) PowerflowDaemon");
+    }
+    layout_.init(header->nb_bus, header->nb_load, header->nb_gen, header->nb_line, header->nb_trafo);
+}
+
+PowerflowClient::~PowerflowClient()
+{
+    unmap_memory(memory_, memory_size_);
+}
+
+int PowerflowClient::submit(const Eigen::VectorXd & load_p,
+                            const Eigen::VectorXd & load_q,
+                            const Eigen::VectorXd & gen_p,
+                            const Eigen::VectorXd & gen_v,
+                            const std::vector<bool> & line_status,
+                            const std::vector<bool> & trafo_status)
+{
+    SharedHeader * header = get_header(memory_);
+    if(!header->running.load()) throw std::runtime_error("PowerflowClient::submit: the daemon is not running");
+    if(((load_p.size() > 0) && (load_p.size() != layout_.nb_load)) || ((load_q.size() > 0) && (load_q.size() != layout_.nb_load))){
+        throw std::runtime_error("PowerflowClient::submit: load_p and load_q should have one value per load (or be empty)");
+    }
+    if(((gen_p.size() > 0) && (gen_p.size() != layout_.nb_gen)) || ((gen_v.size() > 0) && (gen_v.size() != layout_.nb_gen))){
+        throw std::runtime_error("PowerflowClient::submit: gen_p and gen_v should have one value per generator (or be empty)");
+    }
+    if((!line_status.empty() && (static_cast<int>(line_status.size()) != layout_.nb_line)) ||
+       (!trafo_status.empty() && (static_cast<int>(trafo_status.size()) != layout_.nb_trafo))){
+        throw std::runtime_error("PowerflowClient::submit: line_status (resp. trafo_status) should have one value per powerline (resp. transformer), or be empty");
+    }
+
+    // take a free slot
+    const int nb_slot = header->nb_slot;
+    int slot_id = -1;
+    SlotHeader * slot = nullptr;
+    for(int i = 0; i < nb_slot; ++i){
+        const int candidate = (next_slot_ + i) % nb_slot;
+        slot = get_slot(memory_, layout_, candidate);
+        int32_t expected = SlotState::Free;
+        if(slot->state.compare_exchange_strong(expected, SlotState::Writing, std::memory_order_acquire)){
+            slot_id = candidate;
+            break;
+        }
+    }
+    if(slot_id < 0) throw std::runtime_error("PowerflowClient::submit: no free slot (too many requests at the same time)");
+    next_slot_ = (slot_id + 1) % nb_slot;
+
+    double * data = get_data(slot);
+    slot->has_load_p = load_p.size() > 0;
+    slot->has_load_q = load_q.size() > 0;
+    slot->has_gen_p = gen_p.size() > 0;
+    slot->has_gen_v = gen_v.size() > 0;
+    slot->has_line_status = !line_status.empty();
+    slot->has_trafo_status = !trafo_status.empty();
+    if(slot->has_load_p) Eigen::Map<Eigen::VectorXd>(data + layout_.load_p, layout_.nb_load) = load_p;
+    if(slot->has_load_q) Eigen::Map<Eigen::VectorXd>(data + layout_.load_q, layout_.nb_load) = load_q;
+    if(slot->has_gen_p) Eigen::Map<Eigen::VectorXd>(data + layout_.gen_p, layout_.nb_gen) = gen_p;
+    if(slot->has_gen_v) Eigen::Map<Eigen::VectorXd>(data + layout_.gen_v, layout_.nb_gen) = gen_v;
+    for(size_t i = 0; i < line_status.size(); ++i) data[layout_.line_status + i] = line_status[i] ? 1. : 0.;
+    for(size_t i = 0; i < trafo_status.size(); ++i) data[layout_.trafo_status + i] = trafo_status[i] ? 1. : 0.;
+    slot->state.store(SlotState::Submitted, std::memory_order_release);
+
+    // there are as many cells in the queue as slots (or more): it cannot be full
+    if(!enqueue(memory_, slot_id)){
+        slot->state.store(SlotState::Free, std::memory_order_release);
+        throw std::runtime_error("PowerflowClient::submit: the queue is full");
+    }
+    return slot_id;
+}
+
+bool PowerflowClient::retrieve(int slot_id, double timeout_s)
+{
+    SharedHeader * header = get_header(memory_);
+    if((slot_id < 0) || (slot_id >= header->nb_slot)) throw std::runtime_error("PowerflowClient::retrieve: invalid slot id");
+    SlotHeader * slot = get_slot(memory_, layout_, slot_id);
+    const int32_t state = slot->state.load(std::memory_order_acquire);
+    if((state == SlotState::Free) || (state == SlotState::Writing)){
+        throw std::runtime_error("PowerflowClient::retrieve: no request has been submitted in this slot");
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    int nb_idle = 0;
+    while(slot->state.load(std::memory_order_acquire) != SlotState::Done){
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if(elapsed.count() > timeout_s){
+            throw std::runtime_error("PowerflowClient::retrieve: timeout (the request is still pending, you can call retrieve again)");
+        }
+        backoff(nb_idle);
+    }
+
+    const double * data = get_data(slot);
+    vm_ = Eigen::Map<const Eigen::VectorXd>(data + layout_.bus_vm, layout_.nb_bus);
+    va_ = Eigen::Map<const Eigen::VectorXd>(data + layout_.bus_va, layout_.nb_bus);
+    const std::vector<std::tuple<size_t, int, tuple4d *> > branches = {
+        std::make_tuple(layout_.line_or, layout_.nb_line, &line_or_), std::make_tuple(layout_.line_ex, layout_.nb_line, &line_ex_),
+        std::make_tuple(layout_.trafo_hv, layout_.nb_trafo, &trafo_hv_), std::make_tuple(layout_.trafo_lv, layout_.nb_trafo, &trafo_lv_)};
+    for(const auto & branch : branches){
+        const double * first = data + std::get<0>(branch);
+        const int nb = std::get<1>(branch);
+        *std::get<2>(branch) = tuple4d(Eigen::Map<const Eigen::VectorXd>(first, nb),
+                                       Eigen::Map<const Eigen::VectorXd>(first + nb, nb),
+                                       Eigen::Map<const Eigen::VectorXd>(first + 2 * nb, nb),
+                                       Eigen::Map<const Eigen::VectorXd>(first + 3 * nb, nb));
+    }
+    const int nb_gen = layout_.nb_gen;
+    gen_ = tuple3d(Eigen::Map<const Eigen::VectorXd>(data + layout_.gen_res, nb_gen),
+                   Eigen::Map<const Eigen::VectorXd>(data + layout_.gen_res + nb_gen, nb_gen),
+                   Eigen::Map<const Eigen::VectorXd>(data + layout_.gen_res + 2 * nb_gen, nb_gen));
+    const bool res = slot->converged != 0;
+    slot->state.store(SlotState::Free, std::memory_order_release);
+    return res;
+}
+
+bool PowerflowClient::solve(const Eigen::VectorXd & load_p,
+                            const Eigen::VectorXd & load_q,
+                            const Eigen::VectorXd & gen_p,
+                            const Eigen::VectorXd & gen_v,
+                            const std::vector<bool> & line_status,
+                            const std::vector<bool> & trafo_status,
+                            double timeout_s)
+{
+    const int slot_id = submit(load_p, load_q, gen_p, gen_v, line_status, trafo_status);
+    return retrieve(slot_id, timeout_s);
+}
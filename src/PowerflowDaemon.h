@@ -0,0 +1,185 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#ifndef POWERFLOWDAEMON_H
+#define POWERFLOWDAEMON_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <memory>  // for std::unique_ptr
+
+#include "GridModel.h"
+
+/**
+Powerflows computed for other processes of the same machine, through shared memory (posix "shm_open", so not
+available on windows).
+
+The daemon (PowerflowDaemon) creates a shared memory segment, called "name", and keeps some replicas of the grid
+(one per worker thread), that are "warm": the Ybus matrix, the factorization of the jacobian and the last solution
+are kept between two requests. The processes that need powerflows (PowerflowClient) only open the shared memory
+segment: they do not need a copy of the grid.
+
+The segment is made of "slots": a client takes a free slot, writes the modifications of the grid in it (all of
+them are optional: injections of the loads and of the generators, status of the powerlines and of the
+transformers) and puts its id in a lock free queue (bounded multi producers / multi consumers ring buffer). A
+worker takes it from the queue, computes the ac powerflow and writes the results in the same slot. The client then
+reads them and frees the slot.
+
+Each request is relative to the grid given to the daemon (and not to the previous requests): what is not given in
+a request is reset to the value of this grid. So the results do not depend on the worker that computed them.
+**/
+
+// memory layout of a slot (same for the daemon and the clients), sizes and offsets in number of doubles
+class PowerflowSlotLayout
+{
+    public:
+        PowerflowSlotLayout():nb_bus(0),nb_load(0),nb_gen(0),nb_line(0),nb_trafo(0){}
+        void init(int nb_bus, int nb_load, int nb_gen, int nb_line, int nb_trafo);
+
+        int nb_bus, nb_load, nb_gen, nb_line, nb_trafo;
+
+        // inputs
+        size_t load_p, load_q, gen_p, gen_v, line_status, trafo_status;
+        // outputs
+        size_t bus_vm, bus_va, line_or, line_ex, trafo_hv, trafo_lv, gen_res;  // p, q, v (and a) one after the other
+        size_t size;
+};
+
+class PowerflowDaemon
+{
+    public:
+        /**
+        Creates the shared memory segment "name" (an error is raised if it exists), with nb_slot slots (number of
+        requests that can be processed at the same time). The grid is copied.
+        **/
+        PowerflowDaemon(const GridModel & grid, const std::string & name, int nb_slot, int nb_worker);
+
+        ~PowerflowDaemon();  // stops the workers and removes the shared memory segment
+
+        void set_max_iter(int max_iter);
+        void set_tol(double tol);
+
+        // start / stop the worker threads
+        void start();
+        void stop();
+        bool is_running() const {return !workers_.empty();}
+
+        const std::string & get_name() const {return name_;}
+        int get_nb_slot() const {return nb_slot_;}
+        int get_nb_worker() const {return nb_worker_;}
+        long get_nb_processed() const;  // number of requests computed
+
+    protected:
+        void work(int worker_id);
+        void process(int slot_id, GridModel & grid, Eigen::VectorXcd & V);
+
+    protected:
+        std::string name_;
+        int nb_slot_;
+        int nb_worker_;
+        int max_iter_;
+        double tol_;
+        PowerflowSlotLayout layout_;
+
+        // shared memory
+        void * memory_;
+        size_t memory_size_;
+
+        // initial grid
+        std::vector<std::unique_ptr<GridModel> > grids_;  // one per worker
+        std::vector<bool> load_status_;
+        std::vector<bool> gen_status_;
+        std::vector<bool> line_status_;
+        std::vector<bool> trafo_status_;
+        Eigen::VectorXd load_p_;
+        Eigen::VectorXd load_q_;
+        Eigen::VectorXd gen_p_;
+        Eigen::VectorXd gen_v_;
+
+        std::vector<std::thread> workers_;
+        std::atomic<bool> stop_requested_;
+
+    private:
+        // no copy allowed
+        PowerflowDaemon( const PowerflowDaemon & ) ;
+        PowerflowDaemon & operator=( const PowerflowDaemon & ) ;
+};
+
+class PowerflowClient
+{
+    public:
+        // opens the shared memory segment created by a PowerflowDaemon
+        PowerflowClient(const std::string & name);
+
+        ~PowerflowClient();
+
+        int nb_bus() const {return layout_.nb_bus;}
+        int nb_load() const {return layout_.nb_load;}
+        int nb_gen() const {return layout_.nb_gen;}
+        int nb_line() const {return layout_.nb_line;}
+        int nb_trafo() const {return layout_.nb_trafo;}
+
+        /**
+        Sends a request, and returns the id of its slot (to be given to "retrieve"). Empty vectors mean "value of
+        the grid of the daemon". Units are MW, MVAr and pu (for gen_v). An error is raised if there is no free slot.
+        **/
+        int submit(const Eigen::VectorXd & load_p,
+                   const Eigen::VectorXd & load_q,
+                   const Eigen::VectorXd & gen_p,
+                   const Eigen::VectorXd & gen_v,
+                   const std::vector<bool> & line_status,
+                   const std::vector<bool> & trafo_status);
+
+        /**
+        Waits (at most timeout_s seconds) for the results of a request, copies them (see the getters below) and frees
+        its slot. Returns whether the powerflow converged.
+        **/
+        bool retrieve(int slot_id, double timeout_s);
+
+        // submit then retrieve
+        bool solve(const Eigen::VectorXd & load_p,
+                   const Eigen::VectorXd & load_q,
+                   const Eigen::VectorXd & gen_p,
+                   const Eigen::VectorXd & gen_v,
+                   const std::vector<bool> & line_status,
+                   const std::vector<bool> & trafo_status,
+                   double timeout_s);
+
+        // results of the last "retrieve" (NaN if it diverged)
+        const Eigen::VectorXd & get_Vm() const {return vm_;}
+        const Eigen::VectorXd & get_Va() const {return va_;}
+        tuple4d get_lineor_res() const {return line_or_;}
+        tuple4d get_lineex_res() const {return line_ex_;}
+        tuple4d get_trafohv_res() const {return trafo_hv_;}
+        tuple4d get_trafolv_res() const {return trafo_lv_;}
+        tuple3d get_gen_res() const {return gen_;}
+
+    protected:
+        std::string name_;
+        PowerflowSlotLayout layout_;
+        void * memory_;
+        size_t memory_size_;
+        int next_slot_;  // where the search of a free slot starts
+
+        Eigen::VectorXd vm_;
+        Eigen::VectorXd va_;
+        tuple4d line_or_;
+        tuple4d line_ex_;
+        tuple4d trafo_hv_;
+        tuple4d trafo_lv_;
+        tuple3d gen_;
+
+    private:
+        // no copy allowed
+        PowerflowClient( const PowerflowClient & ) ;
+        PowerflowClient & operator=( const PowerflowClient & ) ;
+};
+
+#endif // POWERFLOWDAEMON_H
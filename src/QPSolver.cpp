@@ -0,0 +1,279 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#include "QPSolver.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+bool QPSolver::solve(const Eigen::MatrixXd & H,
+                     const Eigen::VectorXd & g,
+                     const Eigen::MatrixXd & Aeq,
+                     const Eigen::VectorXd & beq,
+                     const Eigen::MatrixXd & Ain,
+                     const Eigen::VectorXd & bin)
+{
+    const int n = H.rows();
+    const int p = Aeq.rows();
+    const int m = Ain.rows();
+    if((H.cols() != n) || (g.size() != n)) throw std::runtime_error("QPSolver::solve: H should be a square matrix, of the size of g");
+    if((p > 0 && Aeq.cols() != n) || (beq.size() != p)) throw std::runtime_error("QPSolver::solve: Aeq should have one column per variable and as many rows as beq");
+    if((m > 0 && Ain.cols() != n) || (bin.size() != m)) throw std::runtime_error("QPSolver::solve: Ain should have one column per variable and as many rows as bin");
+
+    const double inf = std::numeric_limits<double>::infinity();
+    const double eps = std::numeric_limits<double>::epsilon();
+    nb_iter_ = 0;
+    active_set_.clear();
+    multipliers_ = Eigen::VectorXd::Zero(m);
+
+    // unconstrained minimum, and J = L^-T (H = L.L')
+    Eigen::LLT<Eigen::MatrixXd> chol(H);
+    if(chol.info() != Eigen::Success) throw std::runtime_error("QPSolver::solve: H is not positive definite");
+    J_ = chol.matrixU().solve(Eigen::MatrixXd::Identity(n, n));
+    R_ = Eigen::MatrixXd::Zero(n, n);
+    R_norm_ = 1.;
+    const double cond_estimate = H.trace() * J_.trace();  // c1 * c2 in the paper, to scale the tolerance
+    x_ = -chol.solve(g);
+    objective_ = 0.5 * g.dot(x_);
+
+    std::vector<int> active(n + 1, 0);  // equalities are coded -1 - id, inequalities by their id
+    Eigen::VectorXd u = Eigen::VectorXd::Zero(n + 1);  // multipliers of the active constraints
+    Eigen::VectorXd d(n), z(n), r(n + 1), np(n);
+    int nb_active = 0;
+
+    // 1. equality constraints (always active)
+    for(int i = 0; i < p; ++i){
+        np = Aeq.row(i).transpose();
+        d = J_.transpose() * np;
+        z = J_.rightCols(n - nb_active) * d.tail(n - nb_active);
+        r.head(nb_active) = R_.topLeftCorner(nb_active, nb_active).triangularView<Eigen::Upper>().solve(d.head(nb_active));
+        double t = 0.;
+        if(std::abs(z.dot(z)) > eps) t = (beq(i) - np.dot(x_)) / z.dot(np);
+        x_ += t * z;
+        u(nb_active) = t;
+        u.head(nb_active) -= t * r.head(nb_active);
+        objective_ += 0.5 * t * t * z.dot(np);
+        active[nb_active] = -i - 1;
+        if(!add_constraint(d, nb_active)) throw std::runtime_error("QPSolver::solve: the equality constraints are linearly dependent");
+    }
+
+    // 2. inequality constraints: the most violated one (trying those of the warm start first) is added, until
+    // there is none
+    std::vector<bool> is_active(m, false);
+    std::vector<bool> is_warm(m, false);
+    for(int i : warm_start_) if(i >= 0 && i < m) is_warm[i] = true;
+    std::vector<bool> excluded(m, false);  // linearly dependent of the active ones (for the current iteration)
+    Eigen::VectorXd s(m);
+    // saved at the beginning of each iteration, in case the constraint added is degenerate
+    std::vector<int> active_old;
+    Eigen::VectorXd u_old, x_old;
+    Eigen::MatrixXd J_old, R_old;
+    int nb_active_old = 0;
+    double objective_old = 0.;
+
+    while(true){
+        ++nb_iter_;
+        if(nb_iter_ > max_iter_) return false;
+        s = bin - Ain * x_;
+        double psi = 0.;
+        for(int i = 0; i < m; ++i) psi += std::min(0., s(i));
+        std::fill(excluded.begin(), excluded.end(), false);
+        if(std::abs(psi) <= m * eps * cond_estimate * 100.) break;  // numerically feasible: this is the optimum
+
+        active_old = active;
+        u_old = u;
+        x_old = x_;
+        J_old = J_;
+        R_old = R_;
+        nb_active_old = nb_active;
+        objective_old = objective_;
+
+        bool optimum = false;
+        bool take_new_constraint = true;
+        while(take_new_constraint){
+            take_new_constraint = false;
+            // choose the constraint ip to add
+            int ip = -1;
+            double worst = 0., worst_warm = 0.;
+            int ip_warm = -1;
+            for(int i = 0; i < m; ++i){
+                if(is_active[i] || excluded[i]) continue;
+                if(s(i) < worst){
+                    worst = s(i);
+                    ip = i;
+                }
+                if(is_warm[i] && s(i) < worst_warm){
+                    worst_warm = s(i);
+                    ip_warm = i;
+                }
+            }
+            if(ip_warm >= 0) ip = ip_warm;
+            if(ip < 0){
+                optimum = true;
+                break;
+            }
+            np = -Ain.row(ip).transpose();
+            u(nb_active) = 0.;
+            active[nb_active] = ip;
+
+            // steps (in the dual space only or in both spaces) until the constraint ip is satisfied
+            while(true){
+                d = J_.transpose() * np;
+                z = J_.rightCols(n - nb_active) * d.tail(n - nb_active);
+                r.head(nb_active) = R_.topLeftCorner(nb_active, nb_active).triangularView<Eigen::Upper>().solve(d.head(nb_active));
+
+                // partial step: largest step in the dual space keeping the multipliers positive
+                int l = -1;
+                double t1 = inf;
+                for(int k = p; k < nb_active; ++k){
+                    if(r(k) > 0. && u(k) / r(k) < t1){
+                        t1 = u(k) / r(k);
+                        l = k;
+                    }
+                }
+                // full step: smallest step in the primal space satisfying the constraint ip
+                double t2 = inf;
+                if(std::abs(z.dot(z)) > eps) t2 = -s(ip) / z.dot(np);
+                double t = std::min(t1, t2);
+                if(t >= inf) return false;  // infeasible
+
+                if(t2 >= inf){
+                    // step in the dual space only, then constraint l is dropped
+                    u.head(nb_active) -= t * r.head(nb_active);
+                    u(nb_active) += t;
+                    is_active[active[l]] = false;
+                    delete_constraint(active, u, l, nb_active);
+                    continue;
+                }
+
+                // step in the primal and dual spaces
+                x_ += t * z;
+                objective_ += t * z.dot(np) * (0.5 * t + u(nb_active));
+                u.head(nb_active) -= t * r.head(nb_active);
+                u(nb_active) += t;
+
+                if(t == t2){
+                    // full step: ip becomes active
+                    if(!add_constraint(d, nb_active)){
+                        // degenerate: ip depends linearly on the active constraints, another one is tried
+                        excluded[ip] = true;
+                        active = active_old;
+                        u = u_old;
+                        x_ = x_old;
+                        J_ = J_old;
+                        R_ = R_old;
+                        nb_active = nb_active_old;
+                        objective_ = objective_old;
+                        std::fill(is_active.begin(), is_active.end(), false);
+                        for(int k = p; k < nb_active; ++k) is_active[active[k]] = true;
+                        s = bin - Ain * x_;
+                        take_new_constraint = true;
+                    }else{
+                        is_active[ip] = true;
+                    }
+                    break;
+                }
+
+                // partial step: constraint l is dropped
+                is_active[active[l]] = false;
+                delete_constraint(active, u, l, nb_active);
+                s(ip) = bin(ip) - Ain.row(ip).dot(x_);
+            }
+        }
+        if(optimum) break;
+    }
+
+    for(int k = p; k < nb_active; ++k){
+        active_set_.push_back(active[k]);
+        multipliers_(active[k]) = u(k);
+    }
+    return true;
+}
+
+bool QPSolver::add_constraint(Eigen::VectorXd & d, int & nb_active)
+{
+    const int n = J_.rows();
+    // Givens rotations of J that put d(nb_active + 1), ..., d(n - 1) to 0
+    for(int j = n - 1; j >= nb_active + 1; --j){
+        double cc = d(j - 1);
+        double ss = d(j);
+        double h = std::hypot(cc, ss);
+        if(h == 0.) continue;
+        d(j) = 0.;
+        ss /= h;
+        cc /= h;
+        if(cc < 0.){
+            cc = -cc;
+            ss = -ss;
+            d(j - 1) = -h;
+        }else{
+            d(j - 1) = h;
+        }
+        double xny = ss / (1. + cc);
+        for(int k = 0; k < n; ++k){
+            double t1 = J_(k, j - 1);
+            double t2 = J_(k, j);
+            J_(k, j - 1) = t1 * cc + t2 * ss;
+            J_(k, j) = xny * (t1 + J_(k, j - 1)) - t2;
+        }
+    }
+    ++nb_active;
+    R_.col(nb_active - 1).head(nb_active) = d.head(nb_active);
+    if(std::abs(d(nb_active - 1)) <= std::numeric_limits<double>::epsilon() * R_norm_) return false;
+    R_norm_ = std::max(R_norm_, std::abs(d(nb_active - 1)));
+    return true;
+}
+
+void QPSolver::delete_constraint(std::vector<int> & active, Eigen::VectorXd & u, int pos, int & nb_active)
+{
+    const int n = R_.rows();
+    // the constraint being added (at position nb_active) is shifted too
+    for(int i = pos; i < nb_active; ++i){
+        active[i] = active[i + 1];
+        u(i) = u(i + 1);
+        if(i < nb_active - 1) R_.col(i) = R_.col(i + 1);
+    }
+    active[nb_active] = 0;
+    u(nb_active) = 0.;
+    R_.col(nb_active - 1).setZero();
+    --nb_active;
+    if(nb_active == 0) return;
+
+    // R is now upper Hessenberg from column pos: Givens rotations to make it triangular again (J is updated too)
+    for(int j = pos; j < nb_active; ++j){
+        double cc = R_(j, j);
+        double ss = R_(j + 1, j);
+        double h = std::hypot(cc, ss);
+        if(h == 0.) continue;
+        cc /= h;
+        ss /= h;
+        R_(j + 1, j) = 0.;
+        if(cc < 0.){
+            R_(j, j) = -h;
+            cc = -cc;
+            ss = -ss;
+        }else{
+            R_(j, j) = h;
+        }
+        double xny = ss / (1. + cc);
+        for(int k = j + 1; k < nb_active; ++k){
+            double t1 = R_(j, k);
+            double t2 = R_(j + 1, k);
+            R_(j, k) = t1 * cc + t2 * ss;
+            R_(j + 1, k) = xny * (t1 + R_(j, k)) - t2;
+        }
+        for(int k = 0; k < n; ++k){
+            double t1 = J_(k, j);
+            double t2 = J_(k, j + 1);
+            J_(k, j) = t1 * cc + t2 * ss;
+            J_(k, j + 1) = xny * (J_(k, j) + t1) - t2;
+        }
+    }
+}
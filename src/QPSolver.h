@@ -0,0 +1,88 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#ifndef QPSOLVER_H
+#define QPSOLVER_H
+
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/Dense"
+
+/**
+Dense convex quadratic program:
+
+    min 0.5 * x'.H.x + g'.x    such that    Aeq.x = beq   and   Ain.x <= bin
+
+with H symmetric positive definite, solved with the dual active set method of D. Goldfarb and A. Idnani ("A
+numerically stable dual method for solving strictly convex quadratic programs", 1983): it starts from the
+unconstrained minimum and adds, one by one, the violated constraints. The factorization of the active set is
+updated with Givens rotations.
+
+It is meant for small problems (some tens of variables), the constraints can be more numerous: only the violated
+ones are ever factorized.
+
+The constraints active at the solution can be given to the next "solve" (set_warm_start): they are then added
+first (if they are violated), which saves most of the iterations when the problem changes a little.
+**/
+class QPSolver
+{
+    public:
+        QPSolver():max_iter_(1000),nb_iter_(0),objective_(0.){}
+
+        /**
+        Returns false if the problem is infeasible (or if max_iter is reached). An error is raised if the sizes are
+        not consistent or if H is not positive definite.
+        **/
+        bool solve(const Eigen::MatrixXd & H,
+                   const Eigen::VectorXd & g,
+                   const Eigen::MatrixXd & Aeq,
+                   const Eigen::VectorXd & beq,
+                   const Eigen::MatrixXd & Ain,
+                   const Eigen::VectorXd & bin);
+
+        // ids (rows of Ain) of the inequality constraints to try first at the next solve
+        void set_warm_start(const std::vector<int> & active_set) {warm_start_ = active_set;}
+        void set_max_iter(int max_iter) {max_iter_ = max_iter;}
+
+        // results of the last solve
+        const Eigen::VectorXd & get_x() const {return x_;}
+        double get_objective() const {return objective_;}
+        const std::vector<int> & get_active_set() const {return active_set_;}  // rows of Ain active at the solution
+        const Eigen::VectorXd & get_multipliers() const {return multipliers_;}  // of the rows of Ain (0 if inactive)
+        int get_nb_iter() const {return nb_iter_;}
+
+    protected:
+        // add the constraint whose direction (in the space transformed by J) is d to the factorization
+        bool add_constraint(Eigen::VectorXd & d, int & nb_active);
+        // remove the active constraint at position "pos" (and shift the following ones)
+        void delete_constraint(std::vector<int> & active, Eigen::VectorXd & u, int pos, int & nb_active);
+
+    protected:
+        int max_iter_;
+        std::vector<int> warm_start_;
+
+        // factorization of the active set: H^-1 = J.J', and N = J.[R 0]' for the normals N of the active constraints
+        Eigen::MatrixXd J_;
+        Eigen::MatrixXd R_;
+        double R_norm_;
+
+        // results
+        Eigen::VectorXd x_;
+        Eigen::VectorXd multipliers_;
+        std::vector<int> active_set_;
+        int nb_iter_;
+        double objective_;
+
+    private:
+        // no copy allowed
+        QPSolver( const QPSolver & ) ;
+        QPSolver & operator=( const QPSolver & ) ;
+};
+
+#endif // QPSOLVER_H
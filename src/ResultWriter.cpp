@@ -0,0 +1,295 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#include "ResultWriter.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+ResultWriter::ResultWriter(const std::string & directory, bool use_float32, int chunk_size):
+    directory_(directory),
+    use_float32_(use_float32),
+    chunk_size_(chunk_size),
+    is_closed_(false),
+    nb_step_(0),
+    nb_step_written_(0)
+{
+    if(chunk_size < 1) throw std::runtime_error("ResultWriter: the chunk size should be >= 1");
+}
+
+ResultWriter::~ResultWriter()
+{
+    // exceptions must not leave a destructor
+    try{
+        close();
+    }catch(const std::exception &){
+    }
+}
+
+std::vector<std::string> ResultWriter::get_quantities() const
+{
+    std::vector<std::string> res;
+    for(const auto & column : columns_) res.push_back(column.name);
+    return res;
+}
+
+void ResultWriter::init_columns(const GridModel & grid, int nb_bus)
+{
+    const int nb_load = static_cast<int>(grid.get_loads_status().size());
+    const int nb_gen = static_cast<int>(grid.get_gen_status().size());
+    const int nb_line = static_cast<int>(grid.get_lines_status().size());
+    const int nb_trafo = static_cast<int>(grid.get_trafo_status().size());
+    std::vector<std::pair<std::string, int> > quantities = {{"bus_vm", nb_bus}, {"bus_va", nb_bus}};
+    for(const auto & el : std::vector<std::pair<std::string, int> >{{"load", nb_load}, {"gen", nb_gen}}){
+        for(const auto & var : {"p", "q", "v"}) quantities.push_back({el.first + "_" + var, el.second});
+    }
+    for(const auto & el : std::vector<std::pair<std::string, int> >{{"line_or", nb_line}, {"line_ex", nb_line},
+                                                                    {"trafo_hv", nb_trafo}, {"trafo_lv", nb_trafo}}){
+        for(const auto & var : {"p", "q", "v", "a"}) quantities.push_back({el.first + "_" + var, el.second});
+    }
+
+    columns_ = std::vector<Column>(quantities.size());
+    for(size_t col_id = 0; col_id < quantities.size(); ++col_id){
+        Column & column = columns_[col_id];
+        column.name = quantities[col_id].first;
+        column.nb_col = quantities[col_id].second;
+        const std::string path = directory_ + "/" + column.name + ".npy";
+#ifdef _WIN32
+        column.file.open(path, std::ios::binary | std::ios::trunc);
+        if(!column.file.is_open()) throw std::runtime_error("ResultWriter: impossible to create the file \"" + path + "\"");
+        column.buffer.reserve(static_cast<size_t>(chunk_size_) * column.nb_col);
+#else
+        column.fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if(column.fd < 0) throw std::runtime_error("ResultWriter: impossible to create the file \"" + path + "\"");
+        map_rows(column, chunk_size_);
+#endif
+        write_header(column);
+    }
+}
+
+void ResultWriter::append(const GridModel & grid, const Eigen::VectorXcd & V)
+{
+    if(is_closed_) throw std::runtime_error("ResultWriter::append: the writer is closed");
+    const bool converged = V.size() > 0;
+    if(columns_.empty()){
+        const int nb_bus = converged ? static_cast<int>(V.size()) : static_cast<int>(std::get<0>(grid.get_state()).size());
+        init_columns(grid, nb_bus);
+    }
+
+    // same order as in "init_columns"
+    std::vector<Eigen::VectorXd> values;
+    values.reserve(columns_.size());
+    if(converged){
+        values.push_back(V.cwiseAbs());
+        values.push_back(V.array().arg().matrix());
+        for(const tuple3d & res : {grid.get_loads_res(), grid.get_gen_res()}){
+            values.push_back(std::get<0>(res));
+            values.push_back(std::get<1>(res));
+            values.push_back(std::get<2>(res));
+        }
+        for(const tuple4d & res : {grid.get_lineor_res(), grid.get_lineex_res(), grid.get_trafohv_res(), grid.get_trafolv_res()}){
+            values.push_back(std::get<0>(res));
+            values.push_back(std::get<1>(res));
+            values.push_back(std::get<2>(res));
+            values.push_back(std::get<3>(res));
+        }
+    }
+    for(size_t col_id = 0; col_id < columns_.size(); ++col_id){
+        add_row(columns_[col_id], converged ? values[col_id] : Eigen::VectorXd(), converged);
+    }
+    ++nb_step_;
+    if(nb_step_ - nb_step_written_ >= chunk_size_) flush();
+}
+
+void ResultWriter::add_row(Column & column, const Eigen::VectorXd & values, bool converged)
+{
+    if(converged && (values.size() != column.nb_col)){
+        throw std::runtime_error("ResultWriter: the number of elements for \"" + column.name + "\" changed (or the results were not computed)");
+    }
+#ifdef _WIN32
+    if(!converged){
+        column.buffer.insert(column.buffer.end(), column.nb_col, std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+    column.buffer.insert(column.buffer.end(), values.data(), values.data() + values.size());
+#else
+    // the row is written directly in the file (row "nb_step_")
+    if(nb_step_ >= column.capacity) map_rows(column, column.capacity + chunk_size_);
+    char * row = column.data + _header_size + nb_step_ * row_size(column);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    if(use_float32_){
+        float * res = reinterpret_cast<float *>(row);
+        for(int col_id = 0; col_id < column.nb_col; ++col_id) res[col_id] = static_cast<float>(converged ? values(col_id) : nan);
+    }else{
+        double * res = reinterpret_cast<double *>(row);
+        for(int col_id = 0; col_id < column.nb_col; ++col_id) res[col_id] = converged ? values(col_id) : nan;
+    }
+#endif
+}
+
+int ResultWriter::run(GridModel & grid,
+                      const Eigen::MatrixXd & load_p,
+                      const Eigen::MatrixXd & load_q,
+                      const Eigen::MatrixXd & gen_p,
+                      const Eigen::VectorXcd & Vinit,
+                      int max_iter,
+                      double tol)
+{
+    const std::vector<bool> & load_status = grid.get_loads_status();
+    const std::vector<bool> & gen_status = grid.get_gen_status();
+    const int nb_load = static_cast<int>(load_status.size());
+    const int nb_gen = static_cast<int>(gen_status.size());
+    int nb_step = -1;
+    for(const auto & mat : std::vector<std::pair<const Eigen::MatrixXd *, int> >{{&load_p, nb_load}, {&load_q, nb_load}, {&gen_p, nb_gen}}){
+        if(mat.first->rows() == 0) continue;
+        if(mat.first->cols() != mat.second){
+            throw std::runtime_error("ResultWriter::run: load_p and load_q should have one column per load and gen_p one per generator.");
+        }
+        if((nb_step >= 0) && (mat.first->rows() != nb_step)){
+            throw std::runtime_error("ResultWriter::run: all the (non empty) matrices should have the same number of rows.");
+        }
+        nb_step = static_cast<int>(mat.first->rows());
+    }
+
+    grid.reactivate_result_computation();  // the flows are written
+    Eigen::VectorXcd V_start = Vinit;
+    int res = 0;
+    for(int step = 0; step < nb_step; ++step){
+        for(int load_id = 0; load_id < nb_load; ++load_id){
+            if(!load_status[load_id]) continue;
+            if(load_p.rows() > 0) grid.change_p_load(load_id, load_p(step, load_id));
+            if(load_q.rows() > 0) grid.change_q_load(load_id, load_q(step, load_id));
+        }
+        if(gen_p.rows() > 0){
+            for(int gen_id = 0; gen_id < nb_gen; ++gen_id){
+                if(gen_status[gen_id]) grid.change_p_gen(gen_id, gen_p(step, gen_id));
+            }
+        }
+        const Eigen::VectorXcd V = grid.ac_pf(V_start, max_iter, tol);
+        append(grid, V);
+        if(V.size() > 0){
+            ++res;
+            V_start = V;  // warm start for the next step
+        }
+    }
+    return res;
+}
+
+void ResultWriter::write_header(Column & column)
+{
+    // npy format, version 1.0: magic string, version, length of the header (uint16 little endian), and a python
+    // dictionary padded with spaces (and ending with a new line) so that the data are aligned
+    const uint16_t one = 1;
+    const bool little_endian = *reinterpret_cast<const char *>(&one) == 1;  // byte order of the values written
+    std::string dict = "{'descr': '";
+    dict += little_endian ? "<" : ">";
+    dict += use_float32_ ? "f4" : "f8";
+    dict += "', 'fortran_order': False, 'shape': (" + std::to_string(nb_step_written_) + ", " + std::to_string(column.nb_col) + "), }";
+    const int header_len = _header_size - 10;
+    if(static_cast<int>(dict.size()) + 1 > header_len) throw std::runtime_error("ResultWriter: the npy header is too long");
+    dict += std::string(header_len - dict.size() - 1, ' ') + "\n";
+
+    const char magic[8] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0};
+    const char len[2] = {static_cast<char>(header_len & 0xFF), static_cast<char>((header_len >> 8) & 0xFF)};
+#ifdef _WIN32
+    column.file.seekp(0, std::ios::beg);
+    column.file.write(magic, 8);
+    column.file.write(len, 2);
+    column.file.write(dict.data(), dict.size());
+    column.file.seekp(0, std::ios::end);
+#else
+    std::memcpy(column.data, magic, 8);
+    std::memcpy(column.data + 8, len, 2);
+    std::memcpy(column.data + 10, dict.data(), dict.size());
+#endif
+}
+
+#ifdef _WIN32
+void ResultWriter::write_buffer(Column & column)
+{
+    if(use_float32_){
+        std::vector<float> tmp(column.buffer.begin(), column.buffer.end());
+        column.file.write(reinterpret_cast<const char *>(tmp.data()), tmp.size() * sizeof(float));
+    }else{
+        column.file.write(reinterpret_cast<const char *>(column.buffer.data()), column.buffer.size() * sizeof(double));
+    }
+    column.buffer.clear();
+}
+#else
+void ResultWriter::map_rows(Column & column, int nb_row)
+{
+    // the file is extended (with 0) and mapped again as a whole
+    const size_t size = _header_size + nb_row * row_size(column);
+    unmap(column);
+    if(ftruncate(column.fd, static_cast<off_t>(size)) != 0){
+        throw std::runtime_error("ResultWriter: impossible to extend the file \"" + column.name + ".npy\"");
+    }
+    void * data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, column.fd, 0);
+    if(data == MAP_FAILED) throw std::runtime_error("ResultWriter: impossible to map the file \"" + column.name + ".npy\"");
+    column.data = static_cast<char *>(data);
+    column.capacity = nb_row;
+}
+
+void ResultWriter::unmap(Column & column)
+{
+    if(column.data == nullptr) return;
+    munmap(column.data, _header_size + column.capacity * row_size(column));
+    column.data = nullptr;
+    column.capacity = 0;
+}
+#endif
+
+void ResultWriter::flush()
+{
+    if(is_closed_) return;
+    if(nb_step_ == nb_step_written_) return;
+    nb_step_written_ = nb_step_;
+    for(auto & column : columns_){
+#ifdef _WIN32
+        write_buffer(column);
+        write_header(column);  // with the new number of rows
+        column.file.flush();
+        if(!column.file.good()) throw std::runtime_error("ResultWriter: error while writing \"" + column.name + ".npy\"");
+#else
+        write_header(column);  // with the new number of rows
+        // starts writing the pages back to the disk (without waiting for it)
+        if(msync(column.data, _header_size + column.capacity * row_size(column), MS_ASYNC) != 0){
+            throw std::runtime_error("ResultWriter: error while writing \"" + column.name + ".npy\"");
+        }
+#endif
+    }
+}
+
+void ResultWriter::close()
+{
+    if(is_closed_) return;
+    flush();
+    is_closed_ = true;
+#ifdef _WIN32
+    for(auto & column : columns_) column.file.close();
+#else
+    std::string error;
+    for(auto & column : columns_){
+        if(column.fd < 0) continue;
+        // the rows reserved but not used are removed
+        unmap(column);
+        const size_t size = _header_size + nb_step_ * row_size(column);
+        if(ftruncate(column.fd, static_cast<off_t>(size)) != 0) error = column.name;
+        ::close(column.fd);
+        column.fd = -1;
+    }
+    if(!error.empty()) throw std::runtime_error("ResultWriter: error while writing \"" + error + ".npy\"");
+#endif
+}
@@ -0,0 +1,128 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+
+#include "GridModel.h"
+
+/**
+Writes the results of a lot of powerflows ("steps") directly on the hard drive, one ".npy" file per quantity,
+with one row per step and one column per element. Once the writer is closed (or flushed), each file can be read
+with numpy without any conversion, for example with `np.load(directory + "/line_or_a.npy", mmap_mode='r')`.
+
+The quantities written are (in the directory given to the constructor, which must exist):
+
+- bus_vm (pu) and bus_va (rad): one column per bus
+- load_p (MW), load_q (MVAr), load_v (kV)
+- gen_p (MW), gen_q (MVAr), gen_v (kV)
+- line_or_p (MW), line_or_q (MVAr), line_or_v (kV), line_or_a (kA), and the same for "line_ex", "trafo_hv"
+  and "trafo_lv"
+
+The files are memory mapped: each step is written directly in them (nothing is kept in memory by the writer, the
+operating system writes the pages back to the disk). They grow by "chunk_size" steps at a time, and their headers
+(number of rows) are updated each time this number of steps is reached (see "flush"). The values can be written
+in float32 (half the size on the disk) instead of float64.
+
+The steps for which the powerflow diverged are written with NaN values (so that row i is always step i).
+
+NB the values are written in the byte order of the computer, given in the header of the files.
+NB on windows, memory mapping is not used: the last "chunk_size" steps are kept in memory and written (with
+std::ofstream) when the headers are updated, the files being the same.
+**/
+class ResultWriter
+{
+    public:
+        ResultWriter(const std::string & directory, bool use_float32, int chunk_size);
+
+        ~ResultWriter();
+
+        /**
+        Adds one step: the results of the last powerflow of "grid", V being the complex voltages it returned
+        (an empty vector meaning that it diverged).
+        **/
+        void append(const GridModel & grid, const Eigen::VectorXcd & V);
+
+        /**
+        Computes one ac powerflow per row of the matrices (one column per load for load_p and load_q, in MW and
+        MVAr, or per generator for gen_p, in MW), and appends its results. A matrix with 0 row means that
+        the values of the grid are not modified. Values of disconnected elements are ignored.
+
+        The first powerflow starts from Vinit, the next ones from the last converged solution. The injections
+        of "grid" are modified, and the computation of its results is activated.
+
+        It returns the number of powerflows that converged.
+        **/
+        int run(GridModel & grid,
+                const Eigen::MatrixXd & load_p,
+                const Eigen::MatrixXd & load_q,
+                const Eigen::MatrixXd & gen_p,
+                const Eigen::VectorXcd & Vinit,
+                int max_iter,
+                double tol);
+
+        // updates the headers with the number of steps (and writes the steps kept in memory on windows): the files
+        // are valid after this call
+        void flush();
+        // flushes and closes the files (no more step can be added)
+        void close();
+
+        int get_nb_step() const {return nb_step_;}
+        const std::string & get_directory() const {return directory_;}
+        // name of the quantities (file "directory/name.npy")
+        std::vector<std::string> get_quantities() const;
+
+    protected:
+        struct Column
+        {
+            std::string name;
+            int nb_col;
+#ifdef _WIN32
+            std::ofstream file;
+            std::vector<double> buffer;  // steps not written yet, row major
+#else
+            int fd = -1;
+            char * data = nullptr;  // the whole file (header and rows), memory mapped
+            int capacity = 0;  // number of rows the file can hold
+#endif
+        };
+
+        void init_columns(const GridModel & grid, int nb_bus);
+        void add_row(Column & column, const Eigen::VectorXd & values, bool converged);
+        void write_header(Column & column);
+#ifdef _WIN32
+        void write_buffer(Column & column);
+#else
+        void map_rows(Column & column, int nb_row);
+        void unmap(Column & column);
+        size_t row_size(const Column & column) const {return static_cast<size_t>(column.nb_col) * (use_float32_ ? sizeof(float) : sizeof(double));}
+#endif
+
+    protected:
+        std::string directory_;
+        bool use_float32_;
+        int chunk_size_;
+        bool is_closed_;
+
+        int nb_step_;  // total number of steps
+        int nb_step_written_;  // number of steps already in the files
+        std::vector<Column> columns_;
+
+        static const int _header_size = 128;  // total size of the header of the npy files (multiple of 64)
+
+    private:
+        // no copy allowed
+        ResultWriter( const ResultWriter & ) ;
+        ResultWriter & operator=( const ResultWriter & ) ;
+};
+
+#endif // RESULTWRITER_H
@@ -0,0 +1,385 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#include "SplitComplexSparseMatrix.h"
+
+#include <cmath>
+#include <algorithm>
+
+// the avx2 / avx-512 kernels are compiled for these instructions (function attributes) whatever the flags of the
+// compiler, and only called if the processor supports them
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LIGHTSIM_SPLIT_SIMD
+#include <immintrin.h>
+#define LIGHTSIM_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define LIGHTSIM_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+
+namespace
+{
+    // the compressed row arrays are padded with this number of values (0.) so that the kernels can read a full
+    // vector after the last value of a row
+    const int _csr_padding = 8;
+    // dS_dV is computed with multiple threads (if compiled with openmp) above this number of rows
+    const int _parallel_min_size = 5000;
+    const int _parallel_block_size = 4096;  // number of values per thread
+}
+
+SimdLevel SplitComplexSparseMatrix::best_simd_level()
+{
+#ifdef LIGHTSIM_SPLIT_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdLevel::AVX2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+void SplitComplexSparseMatrix::set_simd_level(SimdLevel simd_level)
+{
+    if(static_cast<int>(simd_level) > static_cast<int>(best_simd_level())){
+        throw std::runtime_error("SplitComplexSparseMatrix::set_simd_level: these instructions are not supported by this processor (or this build)");
+    }
+    simd_level_ = simd_level;
+}
+
+void SplitComplexSparseMatrix::init(const Eigen::SparseMatrix<cdouble> & mat)
+{
+    if(mat.rows() != mat.cols()) throw std::runtime_error("SplitComplexSparseMatrix::init: the matrix should be square");
+    Eigen::SparseMatrix<cdouble> compressed;
+    const Eigen::SparseMatrix<cdouble> * mat_ptr = &mat;
+    if(!mat.isCompressed()){
+        compressed = mat;
+        compressed.makeCompressed();
+        mat_ptr = &compressed;
+    }
+    const Eigen::SparseMatrix<cdouble> & Y = *mat_ptr;
+    nb_row_ = Y.rows();
+    const int nnz = Y.nonZeros();
+    source_ = mat.valuePtr();
+
+    // compressed columns
+    col_ptr_.assign(Y.outerIndexPtr(), Y.outerIndexPtr() + nb_row_ + 1);
+    row_.resize(nnz);
+    col_.resize(nnz);
+    re_.resize(nnz);
+    im_.resize(nnz);
+    diag_.assign(nb_row_, -1);
+    const int * outer = Y.outerIndexPtr();
+    const int * inner = Y.innerIndexPtr();
+    const cdouble * values = Y.valuePtr();
+    for(int col = 0; col < nb_row_; ++col){
+        for(int k = outer[col]; k < outer[col + 1]; ++k){
+            row_[k] = inner[k];
+            col_[k] = col;
+            re_[k] = values[k].real();
+            im_[k] = values[k].imag();
+            if(inner[k] == col) diag_[col] = k;
+        }
+    }
+
+    // compressed rows (padded)
+    csr_ptr_.assign(nb_row_ + 1, 0);
+    for(int k = 0; k < nnz; ++k) ++csr_ptr_[row_[k] + 1];
+    for(int row = 0; row < nb_row_; ++row) csr_ptr_[row + 1] += csr_ptr_[row];
+    csr_col_.assign(nnz + _csr_padding, 0);
+    csr_re_.assign(nnz + _csr_padding, 0.);
+    csr_im_.assign(nnz + _csr_padding, 0.);
+    csr_pos_.resize(nnz);
+    std::vector<std::int32_t> next(csr_ptr_.begin(), csr_ptr_.end() - 1);
+    for(int k = 0; k < nnz; ++k){
+        const int pos = next[row_[k]]++;
+        csr_pos_[k] = pos;
+        csr_col_[pos] = col_[k];
+        csr_re_[pos] = re_[k];
+        csr_im_[pos] = im_[k];
+    }
+}
+
+bool SplitComplexSparseMatrix::has_pattern_of(const Eigen::SparseMatrix<cdouble> & mat) const
+{
+    if(!mat.isCompressed() || (mat.rows() != nb_row_) || (mat.cols() != nb_row_) || (mat.nonZeros() != nnz())) return false;
+    return std::equal(col_ptr_.begin(), col_ptr_.end(), mat.outerIndexPtr()) &&
+           std::equal(row_.begin(), row_.end(), mat.innerIndexPtr());
+}
+
+void SplitComplexSparseMatrix::update_values(const Eigen::SparseMatrix<cdouble> & mat)
+{
+    const int nnz_ = nnz();
+    const cdouble * values = mat.valuePtr();
+    source_ = values;
+    for(int k = 0; k < nnz_; ++k){
+        re_[k] = values[k].real();
+        im_[k] = values[k].imag();
+        csr_re_[csr_pos_[k]] = re_[k];
+        csr_im_[csr_pos_[k]] = im_[k];
+    }
+}
+
+void SplitComplexSparseMatrix::multiply(const double * x_re, const double * x_im, double * y_re, double * y_im) const
+{
+    switch(simd_level_){
+        case SimdLevel::AVX512: multiply_avx512(x_re, x_im, y_re, y_im); break;
+        case SimdLevel::AVX2: multiply_avx2(x_re, x_im, y_re, y_im); break;
+        default: multiply_scalar(x_re, x_im, y_re, y_im); break;
+    }
+}
+
+void SplitComplexSparseMatrix::dS_dV(const double * V_re, const double * V_im,
+                                     const double * I_re, const double * I_im,
+                                     double * dS_dVm_re, double * dS_dVm_im,
+                                     double * dS_dVa_re, double * dS_dVa_im) const
+{
+    Vn_re_.resize(nb_row_);
+    Vn_im_.resize(nb_row_);
+    for(int bus = 0; bus < nb_row_; ++bus){
+        const double vm = std::hypot(V_re[bus], V_im[bus]);
+        Vn_re_[bus] = V_re[bus] / vm;
+        Vn_im_[bus] = V_im[bus] / vm;
+    }
+    const double * Vn_re = Vn_re_.data();
+    const double * Vn_im = Vn_im_.data();
+
+    const int nnz_ = nnz();
+    const int nb_block = (nnz_ + _parallel_block_size - 1) / _parallel_block_size;
+    #pragma omp parallel for schedule(static) if(nb_row_ >= _parallel_min_size)
+    for(int block = 0; block < nb_block; ++block){
+        const int begin = block * _parallel_block_size;
+        const int end = std::min(nnz_, begin + _parallel_block_size);
+        switch(simd_level_){
+            case SimdLevel::AVX512: dS_dV_avx512(begin, end, V_re, V_im, Vn_re, Vn_im, dS_dVm_re, dS_dVm_im, dS_dVa_re, dS_dVa_im); break;
+            case SimdLevel::AVX2: dS_dV_avx2(begin, end, V_re, V_im, Vn_re, Vn_im, dS_dVm_re, dS_dVm_im, dS_dVa_re, dS_dVa_im); break;
+            default: dS_dV_scalar(begin, end, V_re, V_im, Vn_re, Vn_im, dS_dVm_re, dS_dVm_im, dS_dVa_re, dS_dVa_im); break;
+        }
+    }
+
+    // diagonal terms of the currents:
+    // dS_dVm[k] += conj(I[r]) * Vnorm[r] and dS_dVa[k] -= conj(-I[r]) * (1j * V[r])
+    for(int bus = 0; bus < nb_row_; ++bus){
+        const int k = diag_[bus];
+        if(k < 0) continue;
+        dS_dVm_re[k] += I_re[bus] * Vn_re[bus] + I_im[bus] * Vn_im[bus];
+        dS_dVm_im[k] += I_re[bus] * Vn_im[bus] - I_im[bus] * Vn_re[bus];
+        dS_dVa_re[k] -= I_re[bus] * V_im[bus] - I_im[bus] * V_re[bus];
+        dS_dVa_im[k] += I_re[bus] * V_re[bus] + I_im[bus] * V_im[bus];
+    }
+}
+
+void SplitComplexSparseMatrix::multiply_scalar(const double * x_re, const double * x_im, double * y_re, double * y_im) const
+{
+    for(int row = 0; row < nb_row_; ++row){
+        double sum_re = 0.;
+        double sum_im = 0.;
+        for(int k = csr_ptr_[row]; k < csr_ptr_[row + 1]; ++k){
+            const int col = csr_col_[k];
+            sum_re += csr_re_[k] * x_re[col] - csr_im_[k] * x_im[col];
+            sum_im += csr_re_[k] * x_im[col] + csr_im_[k] * x_re[col];
+        }
+        y_re[row] = sum_re;
+        y_im[row] = sum_im;
+    }
+}
+
+void SplitComplexSparseMatrix::dS_dV_scalar(int begin, int end,
+                                            const double * V_re, const double * V_im,
+                                            const double * Vn_re, const double * Vn_im,
+                                            double * dVm_re, double * dVm_im,
+                                            double * dVa_re, double * dVa_im) const
+{
+    // for the value y at (r, c): dS_dVm = conj(y * Vnorm[c]) * V[r] and dS_dVa = conj(-y * V[c]) * (1j * V[r])
+    for(int k = begin; k < end; ++k){
+        const int r = row_[k];
+        const int c = col_[k];
+        const double a_re = re_[k] * Vn_re[c] - im_[k] * Vn_im[c];
+        const double a_im = re_[k] * Vn_im[c] + im_[k] * Vn_re[c];
+        const double b_re = re_[k] * V_re[c] - im_[k] * V_im[c];
+        const double b_im = re_[k] * V_im[c] + im_[k] * V_re[c];
+        dVm_re[k] = a_re * V_re[r] + a_im * V_im[r];
+        dVm_im[k] = a_re * V_im[r] - a_im * V_re[r];
+        dVa_re[k] = b_re * V_im[r] - b_im * V_re[r];
+        dVa_im[k] = -b_re * V_re[r] - b_im * V_im[r];
+    }
+}
+
+#ifdef LIGHTSIM_SPLIT_SIMD
+
+namespace
+{
+    // base[idx] (the masked gathers, with all the lanes set, avoid the "uninitialized" warnings of gcc)
+    LIGHTSIM_TARGET_AVX2
+    inline __m256d _gather_avx2(const double * base, __m128i idx)
+    {
+        return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), base, idx, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+    }
+
+    LIGHTSIM_TARGET_AVX512
+    inline __m512d _gather_avx512(const double * base, __m256i idx)
+    {
+        return _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xff, idx, base, 8);
+    }
+
+    // sum of the values of x (same reason for the masked extract)
+    LIGHTSIM_TARGET_AVX512
+    inline double _sum_avx512(__m512d x)
+    {
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d half = _mm256_add_pd(_mm512_mask_extractf64x4_pd(zero, 0xf, x, 0), _mm512_mask_extractf64x4_pd(zero, 0xf, x, 1));
+        const __m128d quarter = _mm_add_pd(_mm256_castpd256_pd128(half), _mm256_extractf128_pd(half, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(quarter, _mm_unpackhi_pd(quarter, quarter)));
+    }
+}
+
+LIGHTSIM_TARGET_AVX2
+void SplitComplexSparseMatrix::multiply_avx2(const double * x_re, const double * x_im, double * y_re, double * y_im) const
+{
+    const __m256i lanes = _mm256_set_epi64x(3, 2, 1, 0);
+    const __m256d zero = _mm256_setzero_pd();
+    for(int row = 0; row < nb_row_; ++row){
+        __m256d sum_re = zero;
+        __m256d sum_im = zero;
+        const int end = csr_ptr_[row + 1];
+        for(int k = csr_ptr_[row]; k < end; k += 4){
+            // the values after the end of the row are set to 0 (the indices read there are valid, see _csr_padding)
+            const __m256d mask = _mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_set1_epi64x(end - k), lanes));
+            const __m128i cols = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&csr_col_[k]));
+            const __m256d a_re = _mm256_and_pd(_mm256_loadu_pd(&csr_re_[k]), mask);
+            const __m256d a_im = _mm256_and_pd(_mm256_loadu_pd(&csr_im_[k]), mask);
+            const __m256d v_re = _gather_avx2(x_re, cols);
+            const __m256d v_im = _gather_avx2(x_im, cols);
+            sum_re = _mm256_fmadd_pd(a_re, v_re, sum_re);
+            sum_re = _mm256_fnmadd_pd(a_im, v_im, sum_re);
+            sum_im = _mm256_fmadd_pd(a_re, v_im, sum_im);
+            sum_im = _mm256_fmadd_pd(a_im, v_re, sum_im);
+        }
+        // horizontal sums
+        __m128d re = _mm_add_pd(_mm256_castpd256_pd128(sum_re), _mm256_extractf128_pd(sum_re, 1));
+        __m128d im = _mm_add_pd(_mm256_castpd256_pd128(sum_im), _mm256_extractf128_pd(sum_im, 1));
+        y_re[row] = _mm_cvtsd_f64(_mm_add_sd(re, _mm_unpackhi_pd(re, re)));
+        y_im[row] = _mm_cvtsd_f64(_mm_add_sd(im, _mm_unpackhi_pd(im, im)));
+    }
+}
+
+LIGHTSIM_TARGET_AVX2
+void SplitComplexSparseMatrix::dS_dV_avx2(int begin, int end,
+                                          const double * V_re, const double * V_im,
+                                          const double * Vn_re, const double * Vn_im,
+                                          double * dVm_re, double * dVm_im,
+                                          double * dVa_re, double * dVa_im) const
+{
+    int k = begin;
+    for(; k + 4 <= end; k += 4){
+        const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&row_[k]));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&col_[k]));
+        const __m256d y_re = _mm256_loadu_pd(&re_[k]);
+        const __m256d y_im = _mm256_loadu_pd(&im_[k]);
+        const __m256d vn_re = _gather_avx2(Vn_re, c);
+        const __m256d vn_im = _gather_avx2(Vn_im, c);
+        const __m256d vc_re = _gather_avx2(V_re, c);
+        const __m256d vc_im = _gather_avx2(V_im, c);
+        const __m256d vr_re = _gather_avx2(V_re, r);
+        const __m256d vr_im = _gather_avx2(V_im, r);
+        const __m256d a_re = _mm256_fmsub_pd(y_re, vn_re, _mm256_mul_pd(y_im, vn_im));
+        const __m256d a_im = _mm256_fmadd_pd(y_re, vn_im, _mm256_mul_pd(y_im, vn_re));
+        const __m256d b_re = _mm256_fmsub_pd(y_re, vc_re, _mm256_mul_pd(y_im, vc_im));
+        const __m256d b_im = _mm256_fmadd_pd(y_re, vc_im, _mm256_mul_pd(y_im, vc_re));
+        _mm256_storeu_pd(&dVm_re[k], _mm256_fmadd_pd(a_re, vr_re, _mm256_mul_pd(a_im, vr_im)));
+        _mm256_storeu_pd(&dVm_im[k], _mm256_fmsub_pd(a_re, vr_im, _mm256_mul_pd(a_im, vr_re)));
+        _mm256_storeu_pd(&dVa_re[k], _mm256_fmsub_pd(b_re, vr_im, _mm256_mul_pd(b_im, vr_re)));
+        _mm256_storeu_pd(&dVa_im[k], _mm256_fnmsub_pd(b_re, vr_re, _mm256_mul_pd(b_im, vr_im)));
+    }
+    dS_dV_scalar(k, end, V_re, V_im, Vn_re, Vn_im, dVm_re, dVm_im, dVa_re, dVa_im);
+}
+
+LIGHTSIM_TARGET_AVX512
+void SplitComplexSparseMatrix::multiply_avx512(const double * x_re, const double * x_im, double * y_re, double * y_im) const
+{
+    const __m512d zero = _mm512_setzero_pd();
+    for(int row = 0; row < nb_row_; ++row){
+        __m512d sum_re = zero;
+        __m512d sum_im = zero;
+        const int end = csr_ptr_[row + 1];
+        for(int k = csr_ptr_[row]; k < end; k += 8){
+            const __mmask8 mask = end - k >= 8 ? 0xff : static_cast<__mmask8>((1 << (end - k)) - 1);
+            const __m256i cols = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&csr_col_[k]));
+            const __m512d a_re = _mm512_maskz_loadu_pd(mask, &csr_re_[k]);
+            const __m512d a_im = _mm512_maskz_loadu_pd(mask, &csr_im_[k]);
+            const __m512d v_re = _gather_avx512(x_re, cols);
+            const __m512d v_im = _gather_avx512(x_im, cols);
+            sum_re = _mm512_fmadd_pd(a_re, v_re, sum_re);
+            sum_re = _mm512_fnmadd_pd(a_im, v_im, sum_re);
+            sum_im = _mm512_fmadd_pd(a_re, v_im, sum_im);
+            sum_im = _mm512_fmadd_pd(a_im, v_re, sum_im);
+        }
+        y_re[row] = _sum_avx512(sum_re);
+        y_im[row] = _sum_avx512(sum_im);
+    }
+}
+
+LIGHTSIM_TARGET_AVX512
+void SplitComplexSparseMatrix::dS_dV_avx512(int begin, int end,
+                                            const double * V_re, const double * V_im,
+                                            const double * Vn_re, const double * Vn_im,
+                                            double * dVm_re, double * dVm_im,
+                                            double * dVa_re, double * dVa_im) const
+{
+    int k = begin;
+    for(; k + 8 <= end; k += 8){
+        const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&row_[k]));
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&col_[k]));
+        const __m512d y_re = _mm512_loadu_pd(&re_[k]);
+        const __m512d y_im = _mm512_loadu_pd(&im_[k]);
+        const __m512d vn_re = _gather_avx512(Vn_re, c);
+        const __m512d vn_im = _gather_avx512(Vn_im, c);
+        const __m512d vc_re = _gather_avx512(V_re, c);
+        const __m512d vc_im = _gather_avx512(V_im, c);
+        const __m512d vr_re = _gather_avx512(V_re, r);
+        const __m512d vr_im = _gather_avx512(V_im, r);
+        const __m512d a_re = _mm512_fmsub_pd(y_re, vn_re, _mm512_mul_pd(y_im, vn_im));
+        const __m512d a_im = _mm512_fmadd_pd(y_re, vn_im, _mm512_mul_pd(y_im, vn_re));
+        const __m512d b_re = _mm512_fmsub_pd(y_re, vc_re, _mm512_mul_pd(y_im, vc_im));
+        const __m512d b_im = _mm512_fmadd_pd(y_re, vc_im, _mm512_mul_pd(y_im, vc_re));
+        _mm512_storeu_pd(&dVm_re[k], _mm512_fmadd_pd(a_re, vr_re, _mm512_mul_pd(a_im, vr_im)));
+        _mm512_storeu_pd(&dVm_im[k], _mm512_fmsub_pd(a_re, vr_im, _mm512_mul_pd(a_im, vr_re)));
+        _mm512_storeu_pd(&dVa_re[k], _mm512_fmsub_pd(b_re, vr_im, _mm512_mul_pd(b_im, vr_re)));
+        _mm512_storeu_pd(&dVa_im[k], _mm512_fnmsub_pd(b_re, vr_re, _mm512_mul_pd(b_im, vr_im)));
+    }
+    dS_dV_scalar(k, end, V_re, V_im, Vn_re, Vn_im, dVm_re, dVm_im, dVa_re, dVa_im);
+}
+
+#else
+
+// no simd kernels for this compiler / processor (set_simd_level does not allow to use them)
+void SplitComplexSparseMatrix::multiply_avx2(const double * x_re, const double * x_im, double * y_re, double * y_im) const
+{
+    multiply_scalar(x_re, x_im, y_re, y_im);
+}
+
+void SplitComplexSparseMatrix::multiply_avx512(const double * x_re, const double * x_im, double * y_re, double * y_im) const
+{
+    multiply_scalar(x_re, x_im, y_re, y_im);
+}
+
+void SplitComplexSparseMatrix::dS_dV_avx2(int begin, int end,
+                                          const double * V_re, const double * V_im,
+                                          const double * Vn_re, const double * Vn_im,
+                                          double * dVm_re, double * dVm_im,
+                                          double * dVa_re, double * dVa_im) const
+{
+    dS_dV_scalar(begin, end, V_re, V_im, Vn_re, Vn_im, dVm_re, dVm_im, dVa_re, dVa_im);
+}
+
+void SplitComplexSparseMatrix::dS_dV_avx512(int begin, int end,
+                                            const double * V_re, const double * V_im,
+                                            const double * Vn_re, const double * Vn_im,
+                                            double * dVm_re, double * dVm_im,
+                                            double * dVa_re, double * dVa_im) const
+{
+    dS_dV_scalar(begin, end, V_re, V_im, Vn_re, Vn_im, dVm_re, dVm_im, dVa_re, dVa_im);
+}
+
+#endif  // LIGHTSIM_SPLIT_SIMD
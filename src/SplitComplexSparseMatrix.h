@@ -0,0 +1,116 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#ifndef SPLITCOMPLEXSPARSEMATRIX_H
+#define SPLITCOMPLEXSPARSEMATRIX_H
+
+#include <vector>
+#include <cstdint>
+
+#include "Eigen/Core"
+#include "Eigen/SparseCore"
+
+#include "Utils.h"
+
+// instructions used by the kernels of SplitComplexSparseMatrix (chosen at runtime, see best_simd_level)
+enum class SimdLevel { Scalar, AVX2, AVX512};
+
+/**
+Copy of a complex sparse matrix (typically Ybus) where the real and imaginary parts of the values are stored in
+separate arrays, with int32 indices, so that the operations of the newton raphson on this matrix are made with
+plain (vectorized) double operations instead of complex multiplications:
+    - the product with a complex vector (the currents Ybus.V, for the mismatch and dS_dV)
+    - the values of dS_dVm and dS_dVa (same sparsity pattern as the matrix)
+
+Complex vectors are given as their real and imaginary parts too. The matrix is kept both in compressed column
+(same order of the values as the Eigen matrix it is built from) and compressed row format (for the product).
+
+The kernels use AVX2 or AVX-512 if the processor supports them (checked at runtime, the rest of lightsim2grid
+does not need to be compiled with these instructions), and plain c++ otherwise (or with a compiler other than
+gcc and clang on x86).
+**/
+class SplitComplexSparseMatrix
+{
+    public:
+        SplitComplexSparseMatrix():nb_row_(0),simd_level_(default_simd_level()),source_(nullptr){}
+
+        // copy of mat (square)
+        void init(const Eigen::SparseMatrix<cdouble> & mat);
+        // whether mat (compressed) has the sparsity pattern of this copy: then only its values need to be copied
+        bool has_pattern_of(const Eigen::SparseMatrix<cdouble> & mat) const;
+        // copy of the values of mat, that has the same sparsity pattern (see has_pattern_of), without any allocation
+        void update_values(const Eigen::SparseMatrix<cdouble> & mat);
+        // whether this is (still) a copy of mat (same object, same size)
+        bool is_copy_of(const Eigen::SparseMatrix<cdouble> & mat) const
+        {
+            return (source_ == mat.valuePtr()) && (nb_row_ == mat.rows()) && (nnz() == mat.nonZeros());
+        }
+
+        int rows() const {return nb_row_;}
+        int nnz() const {return static_cast<int>(re_.size());}
+
+        // y = this * x
+        void multiply(const double * x_re, const double * x_im, double * y_re, double * y_im) const;
+
+        /**
+        Values (in the compressed column order of the matrix) of dS_dVm and dS_dVa, for the voltages V and the
+        currents I = this * V
+        **/
+        void dS_dV(const double * V_re, const double * V_im,
+                   const double * I_re, const double * I_im,
+                   double * dS_dVm_re, double * dS_dVm_im,
+                   double * dS_dVa_re, double * dS_dVa_im) const;
+
+        // instructions used, it cannot be above best_simd_level()
+        void set_simd_level(SimdLevel simd_level);
+        SimdLevel get_simd_level() const {return simd_level_;}
+        static SimdLevel best_simd_level();
+        // AVX2 if available: the kernels are limited by the gathers, AVX-512 is not faster (and can lower the frequency)
+        static SimdLevel default_simd_level()
+        {
+            return best_simd_level() == SimdLevel::Scalar ? SimdLevel::Scalar : SimdLevel::AVX2;
+        }
+
+    protected:
+        void multiply_scalar(const double * x_re, const double * x_im, double * y_re, double * y_im) const;
+        void multiply_avx2(const double * x_re, const double * x_im, double * y_re, double * y_im) const;
+        void multiply_avx512(const double * x_re, const double * x_im, double * y_re, double * y_im) const;
+        // values of dS_dV without the diagonal terms of the currents, for the nnz between begin and end
+        void dS_dV_scalar(int begin, int end, const double * V_re, const double * V_im, const double * Vn_re, const double * Vn_im,
+                          double * dVm_re, double * dVm_im, double * dVa_re, double * dVa_im) const;
+        void dS_dV_avx2(int begin, int end, const double * V_re, const double * V_im, const double * Vn_re, const double * Vn_im,
+                        double * dVm_re, double * dVm_im, double * dVa_re, double * dVa_im) const;
+        void dS_dV_avx512(int begin, int end, const double * V_re, const double * V_im, const double * Vn_re, const double * Vn_im,
+                          double * dVm_re, double * dVm_im, double * dVa_re, double * dVa_im) const;
+
+    protected:
+        int nb_row_;
+        SimdLevel simd_level_;
+        const cdouble * source_;  // values of the matrix copied (to check it is still the same)
+
+        // compressed column format (order of the values of the Eigen matrix)
+        std::vector<std::int32_t> col_ptr_;  // position of the first value of each column
+        std::vector<std::int32_t> row_;  // row of each value
+        std::vector<std::int32_t> col_;  // column of each value
+        std::vector<std::int32_t> diag_;  // position of the diagonal value of each column (-1 if none)
+        std::vector<double> re_;
+        std::vector<double> im_;
+
+        // compressed row format
+        std::vector<std::int32_t> csr_ptr_;
+        std::vector<std::int32_t> csr_pos_;  // position, in the compressed rows, of each value (compressed columns)
+        std::vector<std::int32_t> csr_col_;
+        std::vector<double> csr_re_;
+        std::vector<double> csr_im_;
+
+        // normalized voltages (buffers of dS_dV)
+        mutable std::vector<double> Vn_re_;
+        mutable std::vector<double> Vn_im_;
+};
+
+#endif // SPLITCOMPLEXSPARSEMATRIX_H
@@ -0,0 +1,160 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#include "StreamingStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+void RunningMoments::init(int nb_variable, double threshold)
+{
+    count_ = 0;
+    threshold_ = threshold;
+    mean_ = Eigen::VectorXd::Zero(nb_variable);
+    m2_ = Eigen::VectorXd::Zero(nb_variable);
+    max_ = Eigen::VectorXd::Constant(nb_variable, -std::numeric_limits<double>::infinity());
+    nb_above_ = Eigen::VectorXd::Zero(nb_variable);
+}
+
+void RunningMoments::add(const Eigen::Ref<const Eigen::VectorXd> & x)
+{
+    if(x.size() != mean_.size()) throw std::runtime_error("RunningMoments::add: wrong number of variables");
+    ++count_;
+    // welford's update (numerically stable, unlike the sum of the squares)
+    const Eigen::ArrayXd delta = x.array() - mean_.array();
+    mean_.array() += delta / static_cast<double>(count_);
+    m2_.array() += delta * (x.array() - mean_.array());
+    max_ = max_.cwiseMax(x);
+    nb_above_.array() += (x.array() > threshold_).cast<double>();
+}
+
+Eigen::VectorXd RunningMoments::variance() const
+{
+    if(count_ < 2) return Eigen::VectorXd::Zero(mean_.size());
+    return m2_ / static_cast<double>(count_ - 1);
+}
+
+Eigen::VectorXd RunningMoments::proba_above() const
+{
+    if(count_ == 0) return Eigen::VectorXd::Zero(mean_.size());
+    return nb_above_ / static_cast<double>(count_);
+}
+
+void P2Quantile::init(double p)
+{
+    if((p < 0.) || (p > 1.)) throw std::runtime_error("P2Quantile::init: the quantile should be between 0. and 1.");
+    p_ = p;
+    count_ = 0;
+    height_.fill(0.);
+    pos_ = {1, 2, 3, 4, 5};
+    desired_ = {1., 1. + 2. * p, 1. + 4. * p, 3. + 2. * p, 5.};
+    increment_ = {0., 0.5 * p, p, 0.5 * (1. + p), 1.};
+}
+
+void P2Quantile::add(double x)
+{
+    if(count_ < 5){
+        height_[count_] = x;
+        ++count_;
+        if(count_ == 5) std::sort(height_.begin(), height_.end());
+        return;
+    }
+    ++count_;
+
+    // cell of the new sample (extreme markers are updated if needed)
+    int cell;
+    if(x < height_[0]){
+        height_[0] = x;
+        cell = 0;
+    }else if(x >= height_[4]){
+        height_[4] = x;
+        cell = 3;
+    }else{
+        cell = 0;
+        while(x >= height_[cell + 1]) ++cell;
+    }
+    for(int i = cell + 1; i < 5; ++i) ++pos_[i];
+    for(int i = 0; i < 5; ++i) desired_[i] += increment_[i];
+
+    // move the middle markers toward their desired position if needed
+    for(int i = 1; i < 4; ++i){
+        const double d = desired_[i] - pos_[i];
+        if(((d >= 1.) && (pos_[i + 1] - pos_[i] > 1)) || ((d <= -1.) && (pos_[i - 1] - pos_[i] < -1))){
+            const int step = d > 0. ? 1 : -1;
+            double new_height = parabolic(i, step);
+            if((new_height <= height_[i - 1]) || (new_height >= height_[i + 1])) new_height = linear(i, step);
+            height_[i] = new_height;
+            pos_[i] += step;
+        }
+    }
+}
+
+double P2Quantile::parabolic(int i, double d) const
+{
+    const double n_prev = pos_[i - 1];
+    const double n_i = pos_[i];
+    const double n_next = pos_[i + 1];
+    return height_[i] + d / (n_next - n_prev) *
+           ((n_i - n_prev + d) * (height_[i + 1] - height_[i]) / (n_next - n_i) +
+            (n_next - n_i - d) * (height_[i] - height_[i - 1]) / (n_i - n_prev));
+}
+
+double P2Quantile::linear(int i, int d) const
+{
+    return height_[i] + d * (height_[i + d] - height_[i]) / (pos_[i + d] - pos_[i]);
+}
+
+double P2Quantile::value() const
+{
+    if(count_ == 0) return std::numeric_limits<double>::quiet_NaN();
+    if(count_ >= 5) return height_[2];
+    // not enough samples for the markers: exact quantile (nearest rank)
+    // insertion sort of the (at most 4) samples: std::sort triggers a false -Warray-bounds (for its branch of
+    // more than 16 values) with gcc
+    const int nb = std::min(count_, 5);
+    std::array<double, 5> tmp = height_;
+    for(int i = 1; i < nb; ++i){
+        const double val = tmp[i];
+        int j = i;
+        for(; (j > 0) && (tmp[j - 1] > val); --j) tmp[j] = tmp[j - 1];
+        tmp[j] = val;
+    }
+    const int rank = static_cast<int>(std::lround(p_ * (nb - 1)));
+    return tmp[rank];
+}
+
+void RunningQuantiles::init(int nb_variable, const std::vector<double> & quantiles)
+{
+    nb_quantile_ = static_cast<int>(quantiles.size());
+    sketches_ = std::vector<P2Quantile>(nb_variable * nb_quantile_);
+    for(int var_id = 0; var_id < nb_variable; ++var_id){
+        for(int q_id = 0; q_id < nb_quantile_; ++q_id) sketches_[var_id * nb_quantile_ + q_id].init(quantiles[q_id]);
+    }
+}
+
+void RunningQuantiles::add(const Eigen::Ref<const Eigen::VectorXd> & x)
+{
+    if(x.size() * nb_quantile_ != static_cast<int>(sketches_.size())){
+        throw std::runtime_error("RunningQuantiles::add: wrong number of variables");
+    }
+    for(int var_id = 0; var_id < x.size(); ++var_id){
+        for(int q_id = 0; q_id < nb_quantile_; ++q_id) sketches_[var_id * nb_quantile_ + q_id].add(x(var_id));
+    }
+}
+
+Eigen::MatrixXd RunningQuantiles::values() const
+{
+    const int nb_variable = nb_quantile_ > 0 ? static_cast<int>(sketches_.size()) / nb_quantile_ : 0;
+    Eigen::MatrixXd res(nb_variable, nb_quantile_);
+    for(int var_id = 0; var_id < nb_variable; ++var_id){
+        for(int q_id = 0; q_id < nb_quantile_; ++q_id) res(var_id, q_id) = sketches_[var_id * nb_quantile_ + q_id].value();
+    }
+    return res;
+}
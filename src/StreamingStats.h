@@ -0,0 +1,95 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#ifndef STREAMINGSTATS_H
+#define STREAMINGSTATS_H
+
+#include <vector>
+#include <array>
+
+#include "Eigen/Core"
+
+/**
+Statistics computed "on the fly" (each sample is seen once, and is not stored): the memory used does not depend
+on the number of samples.
+**/
+
+/**
+Mean, variance (Welford's algorithm), maximum and number of samples above a threshold, for a vector of variables.
+**/
+class RunningMoments
+{
+    public:
+        RunningMoments():count_(0),threshold_(1.){}
+
+        void init(int nb_variable, double threshold);
+        void add(const Eigen::Ref<const Eigen::VectorXd> & x);
+
+        int count() const {return count_;}
+        const Eigen::VectorXd & mean() const {return mean_;}
+        Eigen::VectorXd variance() const;  // unbiased (0 if less than 2 samples)
+        const Eigen::VectorXd & max() const {return max_;}
+        Eigen::VectorXd proba_above() const;  // fraction of the samples strictly above the threshold
+
+    private:
+        int count_;
+        double threshold_;
+        Eigen::VectorXd mean_;
+        Eigen::VectorXd m2_;  // sum of the squared differences to the mean
+        Eigen::VectorXd max_;
+        Eigen::VectorXd nb_above_;
+};
+
+/**
+Estimation of a single quantile with the P² algorithm (R. Jain and I. Chlamtac, "The P² algorithm for dynamic
+calculation of quantiles and histograms without storing observations", 1985): only 5 "markers" are stored.
+
+Exact as long as less than 5 samples have been added.
+**/
+class P2Quantile
+{
+    public:
+        P2Quantile():p_(0.5),count_(0){}
+
+        void init(double p);
+        void add(double x);
+        double value() const;
+
+    private:
+        double parabolic(int i, double d) const;
+        double linear(int i, int d) const;
+
+    private:
+        double p_;
+        int count_;
+        std::array<double, 5> height_;  // height of the markers (the 5 first samples until 5 samples are added)
+        std::array<int, 5> pos_;  // actual position of the markers
+        std::array<double, 5> desired_;  // desired position of the markers
+        std::array<double, 5> increment_;  // increment of the desired position, for each new sample
+};
+
+/**
+The quantiles "quantiles" of each variable of a vector of variables.
+**/
+class RunningQuantiles
+{
+    public:
+        RunningQuantiles():nb_quantile_(0){}
+
+        void init(int nb_variable, const std::vector<double> & quantiles);
+        void add(const Eigen::Ref<const Eigen::VectorXd> & x);
+
+        // one row per variable, one column per quantile
+        Eigen::MatrixXd values() const;
+
+    private:
+        int nb_quantile_;
+        std::vector<P2Quantile> sketches_;  // quantile q of variable i is at i * nb_quantile_ + q
+};
+
+#endif // STREAMINGSTATS_H
@@ -0,0 +1,269 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#include "TimeSeries.h"
+
+#include <limits>
+#include <string>
+
+TimeSeries::TimeSeries(const GridModel & grid):
+    grid_(grid),
+    max_iter_(10),
+    tol_(1e-8),
+    max_control_iter_(10)
+{
+    // only the voltages are needed
+    grid_.deactivate_result_computation();
+}
+
+void TimeSeries::set_max_iter(int max_iter)
+{
+    if(max_iter < 1) throw std::runtime_error("TimeSeries::set_max_iter: the number of iterations should be >= 1");
+    max_iter_ = max_iter;
+}
+
+void TimeSeries::set_tol(double tol)
+{
+    if(tol <= 0.) throw std::runtime_error("TimeSeries::set_tol: the tolerance should be > 0.");
+    tol_ = tol;
+}
+
+void TimeSeries::set_max_control_iter(int max_control_iter)
+{
+    if(max_control_iter < 0) throw std::runtime_error("TimeSeries::set_max_control_iter: the number of iterations should be >= 0");
+    max_control_iter_ = max_control_iter;
+}
+
+void TimeSeries::check_control(int controlled_bus, double deadband_pu, int pos_min, int pos_max, int delay, int max_step) const
+{
+    if((controlled_bus < 0) || (controlled_bus >= grid_.total_bus())) throw std::out_of_range("TimeSeries: invalid bus id");
+    if(deadband_pu < 0.) throw std::runtime_error("TimeSeries: the deadband should be positive");
+    if(pos_min > pos_max) throw std::runtime_error("TimeSeries: the minimum position should be lower than the maximum one");
+    if(delay < 0) throw std::runtime_error("TimeSeries: the delay should be >= 0");
+    if(max_step < 1) throw std::runtime_error("TimeSeries: the maximum number of steps should be >= 1");
+}
+
+void TimeSeries::add_oltc(int trafo_id, int controlled_bus, double v_target_pu, double deadband_pu,
+                          int tap_min, int tap_max, int delay, int max_step)
+{
+    if((trafo_id < 0) || (trafo_id >= static_cast<int>(grid_.get_trafo_status().size()))) throw std::out_of_range("TimeSeries::add_oltc: invalid transformer id");
+    if(grid_.get_trafo_tap_step_pct()(trafo_id) == 0.) throw std::runtime_error("TimeSeries::add_oltc: this transformer has no tap changer (its tap_step_pct is 0)");
+    check_control(controlled_bus, deadband_pu, tap_min, tap_max, delay, max_step);
+    const int tap_pos = static_cast<int>(std::round(grid_.get_trafo_tap_pos()(trafo_id)));
+    if((tap_pos < tap_min) || (tap_pos > tap_max)) throw std::runtime_error("TimeSeries::add_oltc: the current tap position is not within [tap_min, tap_max]");
+
+    OltcControl control;
+    control.trafo_id = trafo_id;
+    control.controlled_bus = controlled_bus;
+    control.v_target_pu = v_target_pu;
+    control.deadband_pu = deadband_pu;
+    control.pos_min = tap_min;
+    control.pos_max = tap_max;
+    control.delay = delay;
+    control.max_step = max_step;
+    control.pos = tap_pos;
+    control.nb_outside = 0;
+    control.nb_step_left = 0;
+    oltcs_.push_back(control);
+}
+
+void TimeSeries::add_switched_shunt(int shunt_id, int controlled_bus, double v_target_pu, double deadband_pu,
+                                    double q_step_mvar, int step_min, int step_max, int delay, int max_step)
+{
+    if((shunt_id < 0) || (shunt_id >= static_cast<int>(grid_.get_shunts_status().size()))) throw std::out_of_range("TimeSeries::add_switched_shunt: invalid shunt id");
+    if(!grid_.get_shunts_status()[shunt_id]) throw std::runtime_error("TimeSeries::add_switched_shunt: the shunt is disconnected");
+    if(q_step_mvar == 0.) throw std::runtime_error("TimeSeries::add_switched_shunt: q_step_mvar should not be 0.");
+    check_control(controlled_bus, deadband_pu, step_min, step_max, delay, max_step);
+    if((step_min > 0) || (step_max < 0)) throw std::runtime_error("TimeSeries::add_switched_shunt: the initial step (0) should be within [step_min, step_max]");
+
+    ShuntControl control;
+    control.shunt_id = shunt_id;
+    control.q_init_mvar = grid_.get_shunt_q_mvar()(shunt_id);
+    control.q_step_mvar = q_step_mvar;
+    control.controlled_bus = controlled_bus;
+    control.v_target_pu = v_target_pu;
+    control.deadband_pu = deadband_pu;
+    control.pos_min = step_min;
+    control.pos_max = step_max;
+    control.delay = delay;
+    control.max_step = max_step;
+    control.pos = 0;
+    control.nb_outside = 0;
+    control.nb_step_left = 0;
+    shunts_.push_back(control);
+}
+
+void TimeSeries::clear_controls()
+{
+    oltcs_.clear();
+    shunts_.clear();
+}
+
+void TimeSeries::check_input(const Eigen::MatrixXd & mat, int nb_col, const std::string & name, int & nb_step) const
+{
+    if(mat.rows() == 0) return;
+    if(mat.cols() != nb_col){
+        throw std::runtime_error("TimeSeries: " + name + " should have " + std::to_string(nb_col) + " columns.");
+    }
+    if((nb_step >= 0) && (mat.rows() != nb_step)){
+        throw std::runtime_error("TimeSeries: all the matrices (with at least one row) should have the same number of rows.");
+    }
+    nb_step = mat.rows();
+}
+
+void TimeSeries::set_injections(const Eigen::MatrixXd & load_p,
+                                const Eigen::MatrixXd & load_q,
+                                const Eigen::MatrixXd & gen_p,
+                                const Eigen::MatrixXd & gen_v,
+                                int row)
+{
+    const std::vector<bool> & load_status = grid_.get_loads_status();
+    const std::vector<bool> & gen_status = grid_.get_gen_status();
+    const int nb_load = static_cast<int>(load_status.size());
+    const int nb_gen = static_cast<int>(gen_status.size());
+    for(int load_id = 0; load_id < nb_load; ++load_id){
+        if(!load_status[load_id]) continue;
+        if(load_p.rows() > 0) grid_.change_p_load(load_id, load_p(row, load_id));
+        if(load_q.rows() > 0) grid_.change_q_load(load_id, load_q(row, load_id));
+    }
+    for(int gen_id = 0; gen_id < nb_gen; ++gen_id){
+        if(!gen_status[gen_id]) continue;
+        if(gen_p.rows() > 0) grid_.change_p_gen(gen_id, gen_p(row, gen_id));
+        if(gen_v.rows() > 0) grid_.change_v_gen(gen_id, gen_v(row, gen_id));
+    }
+}
+
+bool TimeSeries::solve(bool same_topology)
+{
+    const int nb_bus = grid_.total_bus();
+    Eigen::VectorXcd Vinit = V_.size() == nb_bus ? V_ : Eigen::VectorXcd::Constant(nb_bus, 1.);
+    // after a divergence, everything is computed again
+    Eigen::VectorXcd V = same_topology ? grid_.ac_pf_injections(Vinit, max_iter_, tol_) : grid_.ac_pf(Vinit, max_iter_, tol_);
+    if(V.size() == 0) return false;
+    V_ = V;
+    return true;
+}
+
+void TimeSeries::update_delays()
+{
+    auto update = [this](Control & control){
+        const double vm = std::abs(V_(control.controlled_bus));
+        if(std::abs(vm - control.v_target_pu) > control.deadband_pu){
+            ++control.nb_outside;
+        }else{
+            control.nb_outside = 0;
+        }
+        control.nb_step_left = control.nb_outside > control.delay ? control.max_step : 0;
+    };
+    for(auto & control : oltcs_) update(control);
+    for(auto & control : shunts_) update(control);
+}
+
+bool TimeSeries::move_controls(int step)
+{
+    bool has_moved = false;
+    const std::vector<bool> & trafo_status = grid_.get_trafo_status();
+    for(int control_id = 0; control_id < get_nb_oltc(); ++control_id){
+        OltcControl & control = oltcs_[control_id];
+        if((control.nb_step_left == 0) || !trafo_status[control.trafo_id]) continue;
+        const double vm = std::abs(V_(control.controlled_bus));
+        if(vm == 0.) continue;  // disconnected bus
+        if(std::abs(vm - control.v_target_pu) <= control.deadband_pu) continue;
+
+        int nb_step = grid_.estimate_tap_steps(control.trafo_id, control.controlled_bus, vm, control.v_target_pu);
+        nb_step = std::max(-control.nb_step_left, std::min(control.nb_step_left, nb_step));
+        const int new_pos = std::max(control.pos_min, std::min(control.pos_max, control.pos + nb_step));
+        if(new_pos == control.pos) continue;  // the tap is at its limit
+        grid_.change_tap_trafo(control.trafo_id, new_pos);
+        actions_.push_back(Action(step, ControlType::OLTC, control_id, control.pos, new_pos));
+        control.nb_step_left -= std::abs(new_pos - control.pos);
+        control.pos = new_pos;
+        control.nb_outside = 0;
+        has_moved = true;
+    }
+    for(int control_id = 0; control_id < get_nb_switched_shunt(); ++control_id){
+        ShuntControl & control = shunts_[control_id];
+        if(control.nb_step_left == 0) continue;
+        const double vm = std::abs(V_(control.controlled_bus));
+        if(vm == 0.) continue;  // disconnected bus
+        if(std::abs(vm - control.v_target_pu) <= control.deadband_pu) continue;
+
+        // the shunt is in Ybus as -(p + j.q): the voltage rises when q decreases
+        const bool q_decreases = vm < control.v_target_pu;
+        const int direction = (q_decreases == (control.q_step_mvar > 0.)) ? -1 : 1;
+        const int new_pos = std::max(control.pos_min, std::min(control.pos_max, control.pos + direction));
+        if(new_pos == control.pos) continue;  // all the steps are used
+        grid_.change_q_shunt(control.shunt_id, control.q_init_mvar + new_pos * control.q_step_mvar);
+        actions_.push_back(Action(step, ControlType::SwitchedShunt, control_id, control.pos, new_pos));
+        control.nb_step_left -= 1;
+        control.pos = new_pos;
+        control.nb_outside = 0;
+        has_moved = true;
+    }
+    return has_moved;
+}
+
+int TimeSeries::run(const Eigen::MatrixXd & load_p,
+                    const Eigen::MatrixXd & load_q,
+                    const Eigen::MatrixXd & gen_p,
+                    const Eigen::MatrixXd & gen_v,
+                    const Eigen::VectorXcd & Vinit)
+{
+    const int nb_load = static_cast<int>(grid_.get_loads_status().size());
+    const int nb_gen = static_cast<int>(grid_.get_gen_status().size());
+    const int nb_bus = grid_.total_bus();
+    int nb_step = -1;
+    check_input(load_p, nb_load, "load_p", nb_step);
+    check_input(load_q, nb_load, "load_q", nb_step);
+    check_input(gen_p, nb_gen, "gen_p", nb_step);
+    check_input(gen_v, nb_gen, "gen_v", nb_step);
+    if(nb_step < 0) nb_step = 0;
+    if((Vinit.size() > 0) && (Vinit.size() != nb_bus)){
+        throw std::runtime_error("TimeSeries::run: Vinit should have one value per bus (or be empty).");
+    }
+    if(Vinit.size() > 0) V_ = Vinit;
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    vm_ = Eigen::MatrixXd::Constant(nb_step, nb_bus, nan);
+    va_ = Eigen::MatrixXd::Constant(nb_step, nb_bus, nan);
+    converged_ = std::vector<bool>(nb_step, false);
+    nb_solve_ = Eigen::VectorXi::Zero(nb_step);
+    tap_pos_ = Eigen::MatrixXi::Zero(nb_step, get_nb_oltc());
+    shunt_step_ = Eigen::MatrixXi::Zero(nb_step, get_nb_switched_shunt());
+    actions_.clear();
+
+    // the first powerflow compiles the grid (the previous run might have diverged)
+    bool same_topology = false;
+    int nb_converged = 0;
+    for(int step = 0; step < nb_step; ++step){
+        set_injections(load_p, load_q, gen_p, gen_v, step);
+        bool conv = solve(same_topology);
+        int nb_solve = 1;
+        if(conv){
+            update_delays();
+            for(int control_iter = 0; control_iter < max_control_iter_; ++control_iter){
+                if(!move_controls(step)) break;
+                // only the coefficients of the controls changed in Ybus
+                conv = solve(true);
+                ++nb_solve;
+                if(!conv) break;
+            }
+        }
+        same_topology = conv;
+
+        nb_solve_(step) = nb_solve;
+        for(int control_id = 0; control_id < get_nb_oltc(); ++control_id) tap_pos_(step, control_id) = oltcs_[control_id].pos;
+        for(int control_id = 0; control_id < get_nb_switched_shunt(); ++control_id) shunt_step_(step, control_id) = shunts_[control_id].pos;
+        if(!conv) continue;
+        converged_[step] = true;
+        ++nb_converged;
+        vm_.row(step) = V_.array().abs().matrix().transpose();
+        va_.row(step) = V_.array().arg().matrix().transpose();
+    }
+    return nb_converged;
+}
@@ -0,0 +1,163 @@
+// Copyright (c) 2020, RTE (https://www.rte-france.com)
+// See AUTHORS.txt
+// This Source Code Form is subject to the terms of the Mozilla Public License, version 2.0.
+// If a copy of the Mozilla Public License, version 2.0 was not distributed with this file,
+// you can obtain one at http://mozilla.org/MPL/2.0/.
+// SPDX-License-Identifier: MPL-2.0
+// This file is part of LightSim2grid, LightSim2grid implements a c++ backend targeting the Grid2Op platform.
+
+#ifndef TIMESERIES_H
+#define TIMESERIES_H
+
+#include <vector>
+
+#include "GridModel.h"
+
+// type of a discrete control of the time series
+enum class ControlType { OLTC, SwitchedShunt};
+
+/**
+Quasi static time series: one ac powerflow per time step (one row of the injection matrices) with discrete
+voltage controls acting between the newton raphson solves:
+
+- tap changers of the transformers (OLTC, see "add_oltc"): the tap is moved by the number of steps estimated
+  from the sensitivity of the voltage to the ratio (see GridModel::estimate_tap_steps)
+- switched shunts (see "add_switched_shunt"): one step of q_step_mvar at a time, the reactive value of the shunt
+  being its initial value + step * q_step_mvar
+
+A control acts when the voltage magnitude of its bus has been outside v_target_pu +/- deadband_pu for more than
+"delay" consecutive time steps (0: as soon as it is outside), then it can move by at most "max_step" steps during
+this time step, and it waits for "delay" time steps again before its next move. Within a time step, the
+controls are applied and the powerflow solved again (at most "set_max_control_iter" times) until no control
+moves anymore.
+
+Between two solves, only the injections (or the coefficients in Ybus of the transformers and shunts that moved)
+are updated, the solver keeps its symbolic factorization (see GridModel::ac_pf_injections) and each powerflow
+starts from the last converged solution. The topology of the grid should not change during the time series.
+
+The positions of the controls, their delays and the last solution are kept between two calls to "run" (a
+series can be computed by chunks), the results are the ones of the last call.
+**/
+class TimeSeries
+{
+    public:
+        // a move of a control: time step, type, id of the control, positions before and after
+        typedef std::tuple<int, ControlType, int, int, int> Action;
+
+        TimeSeries(const GridModel & grid);
+
+        ~TimeSeries(){}
+
+        // parameters of the powerflows
+        void set_max_iter(int max_iter);
+        void set_tol(double tol);
+        // maximum number of powerflows solved again after the controls moved, in each time step
+        void set_max_control_iter(int max_control_iter);
+
+        /**
+        Controls (their id is their order of creation, for each type). The positions start at the current tap
+        position of the transformer (that should be within [tap_min, tap_max]) and at step 0 for the shunts
+        (step_min <= 0 <= step_max).
+        **/
+        void add_oltc(int trafo_id, int controlled_bus, double v_target_pu, double deadband_pu,
+                      int tap_min, int tap_max, int delay, int max_step);
+        void add_switched_shunt(int shunt_id, int controlled_bus, double v_target_pu, double deadband_pu,
+                                double q_step_mvar, int step_min, int step_max, int delay, int max_step);
+        // removes the controls (the grid keeps their last positions)
+        void clear_controls();
+        int get_nb_oltc() const {return static_cast<int>(oltcs_.size());}
+        int get_nb_switched_shunt() const {return static_cast<int>(shunts_.size());}
+
+        /**
+        Computes one time step per row of the matrices, that have one column per load (load_p and load_q, in MW and
+        MVAr) or per generator (gen_p in MW, gen_v in pu). A matrix with 0 row means that the values of the grid are
+        not modified. Values of disconnected elements are ignored.
+
+        The first time step starts from Vinit (an empty vector means the last solution of the previous call, or
+        a flat start).
+
+        It returns the number of time steps that converged.
+        **/
+        int run(const Eigen::MatrixXd & load_p,
+                const Eigen::MatrixXd & load_q,
+                const Eigen::MatrixXd & gen_p,
+                const Eigen::MatrixXd & gen_v,
+                const Eigen::VectorXcd & Vinit);
+
+        // results of the last "run": one row per time step (NaN for the voltages if the powerflow diverged)
+        const Eigen::MatrixXd & get_vm() const {return vm_;}  // in pu, one column per bus
+        const Eigen::MatrixXd & get_va() const {return va_;}  // in rad, one column per bus
+        const std::vector<bool> & get_converged() const {return converged_;}
+        const Eigen::VectorXi & get_nb_solve() const {return nb_solve_;}  // number of powerflows of each time step
+        const Eigen::MatrixXi & get_tap_pos() const {return tap_pos_;}  // at the end of each time step, one column per OLTC
+        const Eigen::MatrixXi & get_shunt_step() const {return shunt_step_;}  // one column per switched shunt
+        const std::vector<Action> & get_actions() const {return actions_;}  // in chronological order
+
+    protected:
+        // the parts common to both types of control
+        struct Control
+        {
+            int controlled_bus;
+            double v_target_pu;
+            double deadband_pu;
+            int pos_min;
+            int pos_max;
+            int delay;
+            int max_step;
+
+            int pos;  // current position
+            int nb_outside;  // number of consecutive time steps outside the deadband
+            int nb_step_left;  // number of steps it can still move during this time step (0 if it cannot act)
+        };
+        struct OltcControl : public Control
+        {
+            int trafo_id;
+        };
+        struct ShuntControl : public Control
+        {
+            int shunt_id;
+            double q_init_mvar;
+            double q_step_mvar;
+        };
+
+        void check_input(const Eigen::MatrixXd & mat, int nb_col, const std::string & name, int & nb_step) const;
+        void check_control(int controlled_bus, double deadband_pu, int pos_min, int pos_max, int delay, int max_step) const;
+        void set_injections(const Eigen::MatrixXd & load_p,
+                            const Eigen::MatrixXd & load_q,
+                            const Eigen::MatrixXd & gen_p,
+                            const Eigen::MatrixXd & gen_v,
+                            int row);
+        // powerflow of the current injections, from V_; returns whether it converged
+        bool solve(bool same_topology);
+        // updates the delays of the controls (after the first powerflow of a time step)
+        void update_delays();
+        // moves the controls that can act; returns whether at least one of them moved
+        bool move_controls(int step);
+
+    protected:
+        GridModel grid_;
+        Eigen::VectorXcd V_;  // last converged solution (empty if there is none)
+
+        int max_iter_;
+        double tol_;
+        int max_control_iter_;
+
+        std::vector<OltcControl> oltcs_;
+        std::vector<ShuntControl> shunts_;
+
+        // results
+        Eigen::MatrixXd vm_;
+        Eigen::MatrixXd va_;
+        std::vector<bool> converged_;
+        Eigen::VectorXi nb_solve_;
+        Eigen::MatrixXi tap_pos_;
+        Eigen::MatrixXi shunt_step_;
+        std::vector<Action> actions_;
+
+    private:
+        // no copy allowed
+        TimeSeries( const TimeSeries & ) ;
+        TimeSeries & operator=( const TimeSeries & ) ;
+};
+
+#endif // TIMESERIES_H
@@ -17,5 +17,6 @@ typedef std::complex<double> cdouble;
 typedef Eigen::VectorXd EigenPythonNumType;  // Eigen::VectorXd
 typedef std::tuple<EigenPythonNumType, EigenPythonNumType, EigenPythonNumType> tuple3d;
 typedef std::tuple<EigenPythonNumType, EigenPythonNumType, EigenPythonNumType, EigenPythonNumType> tuple4d;
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RealMatRowMajor;  // same memory layout as numpy
 
 #endif // UTILS_H
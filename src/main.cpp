@@ -13,8 +13,14 @@
 #include "KLUSolver.h"
 #include "SparseLUSolver.h"
 #include "GaussSeidelSolver.h"
+#include "BackwardForwardSweepSolver.h"
 #include "DataConverter.h"
 #include "GridModel.h"
+#include "MonteCarlo.h"
+#include "ResultWriter.h"
+#include "TimeSeries.h"
+#include "LightSimGrid.h"
+#include "PowerflowDaemon.h"
 
 namespace py = pybind11;
 
@@ -27,6 +33,47 @@ PYBIND11_MODULE(lightsim2grid_cpp, m)
         .value("KLU", SolverType::KLU)
         .value("GaussSeidel", SolverType::GaussSeidel)
         .value("DC", SolverType::DC)
+        .value("BackwardForwardSweep", SolverType::BackwardForwardSweep)
+        .value("Auto", SolverType::Auto)
+        .export_values();
+
+    // step control of the newton raphson
+    py::enum_<StepControl>(m, "StepControl")
+        .value("FullStep", StepControl::FullStep)
+        .value("Iwamoto", StepControl::Iwamoto)
+        .value("LineSearch", StepControl::LineSearch);
+
+    py::enum_<SparseKernel>(m, "SparseKernel")
+        .value("Eigen", SparseKernel::Eigen)
+        .value("Split", SparseKernel::Split);
+
+    py::enum_<NRPrecision>(m, "NRPrecision")
+        .value("Double", NRPrecision::Double)
+        .value("Mixed", NRPrecision::Mixed);
+
+    // parameters of the KLU solver (see GridModel.tune_klu)
+    py::enum_<KLUOrdering>(m, "KLUOrdering")
+        .value("AMD", KLUOrdering::AMD)
+        .value("COLAMD", KLUOrdering::COLAMD)
+        .value("Natural", KLUOrdering::Natural);
+
+    py::class_<KLUParameters>(m, "KLUParameters")
+        .def(py::init<>())  // default parameters of KLU
+        .def(py::init<KLUOrdering, bool, int, double>(), py::arg("ordering"), py::arg("btf"), py::arg("scale"), py::arg("tol"))
+        .def_readwrite("ordering", &KLUParameters::ordering)
+        .def_readwrite("btf", &KLUParameters::btf)  // permutation to block triangular form
+        .def_readwrite("scale", &KLUParameters::scale)  // -1: none (not checked), 0: none, 1: sum of the rows, 2: max of the rows
+        .def_readwrite("tol", &KLUParameters::tol)  // partial pivoting tolerance
+        .def("__eq__", &KLUParameters::operator==)
+        .def("__repr__", &KLUParameters::to_string);
+
+    // recovery of the ac powerflow in case of divergence
+    py::enum_<RecoveryStage>(m, "RecoveryStage")
+        .value("NoRecovery", RecoveryStage::NoRecovery)
+        .value("DCInit", RecoveryStage::DCInit)
+        .value("FlatStart", RecoveryStage::FlatStart)
+        .value("OtherSolver", RecoveryStage::OtherSolver)
+        .value("Iwamoto", RecoveryStage::Iwamoto)
         .export_values();
 
     #ifdef KLU_SOLVER_AVAILABLE
@@ -41,6 +88,16 @@ PYBIND11_MODULE(lightsim2grid_cpp, m)
         .def("converged", &KLUSolver::converged)  // whether the solver has converged
         .def("compute_pf", &KLUSolver::compute_pf, py::call_guard<py::gil_scoped_release>())  // perform the newton raphson optimization
         .def("get_timers", &KLUSolver::get_timers)  // returns the timers corresponding to times the solver spent in different part
+        .def("set_step_control", &KLUSolver::set_step_control)  // full newton step, Iwamoto multiplier or line search
+        .def("get_step_control", &KLUSolver::get_step_control)
+        .def("set_sparse_kernel", &KLUSolver::set_sparse_kernel)  // products with Ybus with Eigen or with the split (simd) kernels
+        .def("get_sparse_kernel", &KLUSolver::get_sparse_kernel)
+        .def("set_precision", &KLUSolver::set_precision)  // single precision factorization with refinement (Mixed) or double
+        .def("get_precision", &KLUSolver::get_precision)
+        .def("get_nb_refinement", &KLUSolver::get_nb_refinement)  // number of refinement steps of the last powerflow
+        .def("set_parameters", &KLUSolver::set_parameters)  // ordering, btf, scaling and pivot tolerance of the factorizations
+        .def("get_parameters", &KLUSolver::get_parameters)
+        .def("get_step_lengths", &KLUSolver::get_step_lengths)  // step length applied at each iteration of the last powerflow
         .def("solve", &KLUSolver::compute_pf, py::call_guard<py::gil_scoped_release>() );  // perform the newton raphson optimization
     #endif
 
@@ -55,6 +112,14 @@ PYBIND11_MODULE(lightsim2grid_cpp, m)
         .def("converged", &SparseLUSolver::converged)  // whether the solver has converged
         .def("compute_pf", &SparseLUSolver::compute_pf, py::call_guard<py::gil_scoped_release>())  // perform the newton raphson optimization
         .def("get_timers", &SparseLUSolver::get_timers)  // returns the timers corresponding to times the solver spent in different part
+        .def("set_step_control", &SparseLUSolver::set_step_control)  // full newton step, Iwamoto multiplier or line search
+        .def("get_step_control", &SparseLUSolver::get_step_control)
+        .def("set_sparse_kernel", &SparseLUSolver::set_sparse_kernel)  // products with Ybus with Eigen or with the split (simd) kernels
+        .def("get_sparse_kernel", &SparseLUSolver::get_sparse_kernel)
+        .def("set_precision", &SparseLUSolver::set_precision)  // single precision factorization with refinement (Mixed) or double
+        .def("get_precision", &SparseLUSolver::get_precision)
+        .def("get_nb_refinement", &SparseLUSolver::get_nb_refinement)  // number of refinement steps of the last powerflow
+        .def("get_step_lengths", &SparseLUSolver::get_step_lengths)  // step length applied at each iteration of the last powerflow
         .def("solve", &SparseLUSolver::compute_pf, py::call_guard<py::gil_scoped_release>() );  // perform the newton raphson optimization
 
     py::class_<GaussSeidelSolver>(m, "GaussSeidelSolver")
@@ -69,6 +134,21 @@ PYBIND11_MODULE(lightsim2grid_cpp, m)
         .def("get_timers", &GaussSeidelSolver::get_timers)  // returns the timers corresponding to times the solver spent in different part
         .def("solve", &GaussSeidelSolver::compute_pf, py::call_guard<py::gil_scoped_release>() );  // perform the newton raphson optimization
 
+    py::class_<BackwardForwardSweepSolver>(m, "BackwardForwardSweepSolver")
+        .def(py::init<>())
+        .def("get_J", &BackwardForwardSweepSolver::get_J)  // (only if the newton raphson has been used, see "used_nr")
+        .def("get_Va", &BackwardForwardSweepSolver::get_Va)  // get the voltage angle vector (vector of double)
+        .def("get_Vm", &BackwardForwardSweepSolver::get_Vm)  // get the voltage magnitude vector (vector of double)
+        .def("get_error", &BackwardForwardSweepSolver::get_error)  // get the error message, see the definition of "err_" for more information
+        .def("get_nb_iter", &BackwardForwardSweepSolver::get_nb_iter)  // return the number of iteration performed at the last optimization
+        .def("reset", &BackwardForwardSweepSolver::reset)  // reset the solver to its original state
+        .def("converged", &BackwardForwardSweepSolver::converged)  // whether the solver has converged
+        .def("is_radial", &BackwardForwardSweepSolver::is_radial)  // whether the grid of the last powerflow was radial
+        .def("used_nr", &BackwardForwardSweepSolver::used_nr)  // whether the newton raphson has been used instead of the sweeps
+        .def("compute_pf", &BackwardForwardSweepSolver::compute_pf, py::call_guard<py::gil_scoped_release>())  // compute the powerflow
+        .def("get_timers", &BackwardForwardSweepSolver::get_timers)  // returns the timers corresponding to times the solver spent in different part
+        .def("solve", &BackwardForwardSweepSolver::compute_pf, py::call_guard<py::gil_scoped_release>() );  // compute the powerflow
+
     py::class_<DCSolver>(m, "DCSolver")
         .def(py::init<>())
         .def("get_Va", &DCSolver::get_Va)  // get the voltage angle vector (vector of double)
@@ -114,6 +194,8 @@ PYBIND11_MODULE(lightsim2grid_cpp, m)
                             gm.set_state(state);
                             return gm;
         }))
+        // text file (can be read by the c++ library, see LightSimGrid.h)
+        .def("save", &save_grid)
 
         // general parameters
         // solver control
@@ -121,6 +203,26 @@ PYBIND11_MODULE(lightsim2grid_cpp, m)
         .def("available_solvers", &GridModel::available_solvers)  // retrieve the solver available for your installation
         .def("get_computation_time", &GridModel::get_computation_time)  // get the computation time spent in the solver
         .def("get_solver_type", &GridModel::get_solver_type)  // get the type of solver used
+        .def("get_solver_type_used", &GridModel::get_solver_type_used)  // get the type of solver used for the last powerflow (relevant for "Auto")
+        .def("get_auto_solver_log", &GridModel::get_auto_solver_log)  // decisions taken by the "Auto" solver
+        .def("set_recovery_stages", &GridModel::set_recovery_stages)  // what is tried, in the ac powerflow, in case of divergence
+        .def("get_recovery_stages", &GridModel::get_recovery_stages)
+        .def("get_last_recovery_stage", &GridModel::get_last_recovery_stage)  // which recovery stage made the last ac powerflow converge
+        .def("set_step_control", &GridModel::set_step_control)  // full newton step (default), Iwamoto multiplier or line search
+        .def("get_step_control", &GridModel::get_step_control)
+        .def("set_sparse_kernel", &GridModel::set_sparse_kernel)  // Eigen (default) or split real / imaginary parts with simd kernels
+        .def("get_sparse_kernel", &GridModel::get_sparse_kernel)
+        .def("set_precision", &GridModel::set_precision)  // double (default) or mixed precision for the linear systems
+        .def("get_precision", &GridModel::get_precision)
+        .def("set_parallel_ybus", &GridModel::set_parallel_ybus)  // fill Ybus with 3 threads on large grids (off by default)
+        .def("get_parallel_ybus", &GridModel::get_parallel_ybus)
+        .def("set_klu_parameters", &GridModel::set_klu_parameters)  // parameters of the factorizations made by KLU (saved with the grid)
+        .def("get_klu_parameters", &GridModel::get_klu_parameters)
+        .def("tune_klu", &GridModel::tune_klu, py::arg("candidates") = std::vector<KLUParameters>(), py::arg("nb_repeat") = 3)  // benchmark the parameters of KLU on the last jacobian, keep the best
+        .def("set_gen_slack_weights", &GridModel::set_gen_slack_weights)  // distributed slack: one participation factor per generator (empty: single slack)
+        .def("get_gen_slack_weights", &GridModel::get_gen_slack_weights)
+        .def("get_distributed_slack_p", &GridModel::get_distributed_slack_p)  // active power (MW) shared by the generators during the last powerflow
+        .def("get_step_lengths", &GridModel::get_step_lengths)  // step length applied at each iteration of the last powerflow
 
         // init the grid
         .def("init_bus", &GridModel::init_bus)
@@ -149,6 +251,10 @@ PYBIND11_MODULE(lightsim2grid_cpp, m)
         .def("change_bus_trafo_lv", &GridModel::change_bus_trafo_lv)
         .def("get_bus_trafo_hv", &GridModel::get_bus_trafo_hv)
         .def("get_bus_trafo_lv", &GridModel::get_bus_trafo_lv)
+        .def("change_ratio_trafo", &GridModel::change_ratio_trafo)
+        .def("change_tap_trafo", &GridModel::change_tap_trafo)
+        .def("get_trafo_ratio", &GridModel::get_trafo_ratio)
+        .def("get_trafo_tap_pos", &GridModel::get_trafo_tap_pos)
 
         .def("deactivate_load", &GridModel::deactivate_load)
         .def("reactivate_load", &GridModel::reactivate_load)
@@ -172,8 +278,10 @@ PYBIND11_MODULE(lightsim2grid_cpp, m)
         .def("change_q_shunt", &GridModel::change_q_shunt)
 
         // get back the results
+        .def("get_V", &GridModel::get_V)  // complex voltages of the solver (solver bus ids)
         .def("get_Va", &GridModel::get_Va)
         .def("get_Vm", &GridModel::get_Vm)
+        .def("get_J", &GridModel::get_J)  // jacobian matrix of the last newton raphson (sparse csc matrix)
 
         // TODO optimize that for speed, results are copied apparently
         .def("get_loads_res", &GridModel::get_loads_res)
@@ -189,6 +297,17 @@ PYBIND11_MODULE(lightsim2grid_cpp, m)
         .def("get_trafolv_res", &GridModel::get_trafolv_res)
         .def("get_trafo_status", &GridModel::get_trafo_status)
 
+        // graph of the grid, the getters return read only views (no copy) valid as long as the grid exists
+        // (and is not initialized again), see GridModel::update_graph
+        .def("update_graph", &GridModel::update_graph)
+        .def("get_graph_edge_or", &GridModel::get_graph_edge_or, py::return_value_policy::reference_internal)
+        .def("get_graph_edge_ex", &GridModel::get_graph_edge_ex, py::return_value_policy::reference_internal)
+        .def("get_graph_csr_indptr", &GridModel::get_graph_csr_indptr, py::return_value_policy::reference_internal)
+        .def("get_graph_csr_indices", &GridModel::get_graph_csr_indices, py::return_value_policy::reference_internal)
+        .def("get_graph_csr_edges", &GridModel::get_graph_csr_edges, py::return_value_policy::reference_internal)
+        .def("get_graph_csr_nnz", &GridModel::get_graph_csr_nnz)
+        .def("get_graph_edge_features", &GridModel::get_graph_edge_features, py::return_value_policy::reference_internal)
+
         // do something with the grid
         // .def("init_Ybus", &DataModel::init_Ybus) // temporary
         .def("get_Ybus", &GridModel::get_Ybus)
@@ -201,7 +320,40 @@ PYBIND11_MODULE(lightsim2grid_cpp, m)
         .def("dc_pf", &GridModel::dc_pf)
         .def("dc_pf_old", &GridModel::dc_pf_old)
         .def("ac_pf", &GridModel::ac_pf)
+        .def("ac_pf_dc_init", &GridModel::ac_pf_dc_init)
+        .def("ac_pf_injections", &GridModel::ac_pf_injections)  // re uses Ybus and the factorization of the last ac powerflow (same topology)
+        // voltage control by the tap changers of the transformers
+        .def("add_oltc", &GridModel::add_oltc)
+        .def("clear_oltc", &GridModel::clear_oltc)
+        .def("ac_pf_oltc", &GridModel::ac_pf_oltc, py::arg("Vinit"), py::arg("max_iter"), py::arg("tol"), py::arg("max_tap_iter") = 10)
+        .def("get_oltc_nb_iter", &GridModel::get_oltc_nb_iter)
+        // redispatching with a dc optimal powerflow
+        .def("redispatch_dc", &GridModel::redispatch_dc)
+        .def("get_redispatch_line_p", &GridModel::get_redispatch_line_p)
+        .def("get_redispatch_trafo_p", &GridModel::get_redispatch_trafo_p)
+        .def("get_redispatch_nb_iter", &GridModel::get_redispatch_nb_iter)
         .def("compute_newton", &GridModel::ac_pf)
+        .def("predict", &GridModel::predict)
+        .def("continuation_pf", &GridModel::continuation_pf,
+             py::arg("load_p_dir") = Eigen::VectorXd(), py::arg("load_q_dir") = Eigen::VectorXd(),
+             py::arg("gen_p_dir") = Eigen::VectorXd(), py::arg("step") = 0.1, py::arg("min_step") = 1e-3,
+             py::arg("max_step") = 1.0, py::arg("max_nb_point") = 200, py::arg("stop_at_nose") = false,
+             py::arg("max_iter") = 10, py::arg("tol") = 1e-8)  // PV curve and maximum loadability from the last ac powerflow
+        .def("reduce", &GridModel::reduce, py::arg("keep_buses"), py::arg("V"), py::arg("drop_tol") = 1e-8)  // equivalent model (kron reduction and ward injections) keeping only some buses
+
+        // checkpoints, to compute "what if" without copying the grid
+        .def("begin", &GridModel::begin)
+        .def("rollback", &GridModel::rollback)
+        .def("commit", &GridModel::commit)
+        .def("get_nb_checkpoints", &GridModel::get_nb_checkpoints)
+
+        // memoization of the ac powerflows
+        .def("set_memo_size", &GridModel::set_memo_size)
+        .def("get_memo_size", &GridModel::get_memo_size)
+        .def("clear_memo", &GridModel::clear_memo)
+        .def("get_memo_nb_entries", &GridModel::get_memo_nb_entries)
+        .def("get_memo_nb_hit", &GridModel::get_memo_nb_hit)
+        .def("get_memo_nb_miss", &GridModel::get_memo_nb_miss)
 
          // apply action faster (optimized for grid2op representation)
          // it is not recommended to use it outside of grid2Op.
@@ -227,4 +379,119 @@ PYBIND11_MODULE(lightsim2grid_cpp, m)
         .def("set_trafo_lv_to_subid", &GridModel::set_trafo_lv_to_subid)
         ;
 
-}
\ No newline at end of file
+    m.def("load_grid", [](const std::string & path) {
+        GridModel gm;
+        load_grid(gm, path);
+        return gm;
+    });  // read a grid saved with "GridModel.save"
+
+    py::class_<MonteCarlo>(m, "MonteCarlo")
+        .def(py::init<const GridModel &>())  // the grid is copied
+        .def("set_max_iter", &MonteCarlo::set_max_iter)
+        .def("set_tol", &MonteCarlo::set_tol)
+        .def("set_nb_threads", &MonteCarlo::set_nb_threads)  // 0 = as many as openmp would use
+        .def("get_nb_threads", &MonteCarlo::get_nb_threads)
+        .def("set_quantiles", &MonteCarlo::set_quantiles)  // quantiles of the voltage magnitudes (resets the statistics)
+        .def("get_quantiles", &MonteCarlo::get_quantiles)
+        .def("set_thermal_limits", &MonteCarlo::set_thermal_limits)  // one per powerline then per trafo, in kA (resets the statistics)
+        .def("reset_stats", &MonteCarlo::reset_stats)
+
+        // compute the scenarios (statistics are accumulated)
+        .def("run_samples", &MonteCarlo::run_samples, py::call_guard<py::gil_scoped_release>())  // one scenario per row of the matrices
+        .def("run_normal", &MonteCarlo::run_normal, py::call_guard<py::gil_scoped_release>())  // scenarios drawn from normal distributions
+
+        // get back the statistics
+        .def("get_nb_scenario", &MonteCarlo::get_nb_scenario)  // number of scenarios taken into account
+        .def("get_nb_diverged", &MonteCarlo::get_nb_diverged)
+        .def("get_loading_mean", &MonteCarlo::get_loading_mean)
+        .def("get_loading_var", &MonteCarlo::get_loading_var)
+        .def("get_loading_max", &MonteCarlo::get_loading_max)
+        .def("get_overload_proba", &MonteCarlo::get_overload_proba)
+        .def("get_vm_mean", &MonteCarlo::get_vm_mean)
+        .def("get_vm_var", &MonteCarlo::get_vm_var)
+        .def("get_vm_quantiles", &MonteCarlo::get_vm_quantiles);  // one row per bus, one column per quantile
+
+    // quasi static time series with discrete controls
+    py::enum_<ControlType>(m, "ControlType")
+        .value("OLTC", ControlType::OLTC)
+        .value("SwitchedShunt", ControlType::SwitchedShunt);
+
+    py::class_<TimeSeries>(m, "TimeSeries")
+        .def(py::init<const GridModel &>())  // the grid is copied
+        .def("set_max_iter", &TimeSeries::set_max_iter)
+        .def("set_tol", &TimeSeries::set_tol)
+        .def("set_max_control_iter", &TimeSeries::set_max_control_iter)  // powerflows solved again after the controls moved, per time step
+        .def("add_oltc", &TimeSeries::add_oltc, py::arg("trafo_id"), py::arg("controlled_bus"), py::arg("v_target_pu"),
+             py::arg("deadband_pu"), py::arg("tap_min"), py::arg("tap_max"), py::arg("delay") = 0, py::arg("max_step") = 1)
+        .def("add_switched_shunt", &TimeSeries::add_switched_shunt, py::arg("shunt_id"), py::arg("controlled_bus"),
+             py::arg("v_target_pu"), py::arg("deadband_pu"), py::arg("q_step_mvar"), py::arg("step_min"), py::arg("step_max"),
+             py::arg("delay") = 0, py::arg("max_step") = 1)
+        .def("clear_controls", &TimeSeries::clear_controls)
+        .def("get_nb_oltc", &TimeSeries::get_nb_oltc)
+        .def("get_nb_switched_shunt", &TimeSeries::get_nb_switched_shunt)
+
+        // one time step per row of the matrices (empty matrices: values of the grid)
+        .def("run", &TimeSeries::run,
+             py::arg("load_p") = Eigen::MatrixXd(), py::arg("load_q") = Eigen::MatrixXd(),
+             py::arg("gen_p") = Eigen::MatrixXd(), py::arg("gen_v") = Eigen::MatrixXd(),
+             py::arg("Vinit") = Eigen::VectorXcd(), py::call_guard<py::gil_scoped_release>())
+
+        // results of the last run, one row per time step
+        .def("get_vm", &TimeSeries::get_vm)
+        .def("get_va", &TimeSeries::get_va)
+        .def("get_converged", &TimeSeries::get_converged)
+        .def("get_nb_solve", &TimeSeries::get_nb_solve)
+        .def("get_tap_pos", &TimeSeries::get_tap_pos)
+        .def("get_shunt_step", &TimeSeries::get_shunt_step)
+        .def("get_actions", &TimeSeries::get_actions);  // (time step, ControlType, control id, position before, position after)
+
+    py::class_<ResultWriter>(m, "ResultWriter")
+        .def(py::init<const std::string &, bool, int>(), py::arg("directory"), py::arg("use_float32") = false, py::arg("chunk_size") = 256)
+        .def("append", &ResultWriter::append)  // add the results of the last powerflow of a grid
+        .def("run", &ResultWriter::run, py::call_guard<py::gil_scoped_release>())  // one powerflow per row of the matrices, results are written
+        .def("flush", &ResultWriter::flush)  // write the steps kept in memory (the files can then be read)
+        .def("close", &ResultWriter::close)
+        .def("get_nb_step", &ResultWriter::get_nb_step)
+        .def("get_directory", &ResultWriter::get_directory)
+        .def("get_quantities", &ResultWriter::get_quantities);  // "directory/quantity.npy" for each quantity
+
+    py::class_<PowerflowDaemon>(m, "PowerflowDaemon")
+        .def(py::init<const GridModel &, const std::string &, int, int>(), py::arg("grid"), py::arg("name"), py::arg("nb_slot") = 64, py::arg("nb_worker") = 1)
+        .def("set_max_iter", &PowerflowDaemon::set_max_iter)
+        .def("set_tol", &PowerflowDaemon::set_tol)
+        .def("start", &PowerflowDaemon::start)  // start the worker threads
+        .def("stop", &PowerflowDaemon::stop, py::call_guard<py::gil_scoped_release>())  // wait for the worker threads to finish
+        .def("is_running", &PowerflowDaemon::is_running)
+        .def("get_name", &PowerflowDaemon::get_name)
+        .def("get_nb_slot", &PowerflowDaemon::get_nb_slot)
+        .def("get_nb_worker", &PowerflowDaemon::get_nb_worker)
+        .def("get_nb_processed", &PowerflowDaemon::get_nb_processed);  // number of requests computed
+
+    py::class_<PowerflowClient>(m, "PowerflowClient")
+        .def(py::init<const std::string &>())  // open the shared memory of a PowerflowDaemon
+        .def("nb_bus", &PowerflowClient::nb_bus)
+        .def("nb_load", &PowerflowClient::nb_load)
+        .def("nb_gen", &PowerflowClient::nb_gen)
+        .def("nb_line", &PowerflowClient::nb_line)
+        .def("nb_trafo", &PowerflowClient::nb_trafo)
+        // empty vectors (the default) mean "value of the grid of the daemon"
+        .def("submit", &PowerflowClient::submit,
+             py::arg("load_p") = Eigen::VectorXd(), py::arg("load_q") = Eigen::VectorXd(),
+             py::arg("gen_p") = Eigen::VectorXd(), py::arg("gen_v") = Eigen::VectorXd(),
+             py::arg("line_status") = std::vector<bool>(), py::arg("trafo_status") = std::vector<bool>())  // returns the id of the slot
+        .def("retrieve", &PowerflowClient::retrieve, py::arg("slot_id"), py::arg("timeout_s") = 10.,
+             py::call_guard<py::gil_scoped_release>())  // wait for the results of a request
+        .def("solve", &PowerflowClient::solve,
+             py::arg("load_p") = Eigen::VectorXd(), py::arg("load_q") = Eigen::VectorXd(),
+             py::arg("gen_p") = Eigen::VectorXd(), py::arg("gen_v") = Eigen::VectorXd(),
+             py::arg("line_status") = std::vector<bool>(), py::arg("trafo_status") = std::vector<bool>(),
+             py::arg("timeout_s") = 10., py::call_guard<py::gil_scoped_release>())  // submit then retrieve
+        // results of the last "retrieve" / "solve"
+        .def("get_Vm", &PowerflowClient::get_Vm)
+        .def("get_Va", &PowerflowClient::get_Va)
+        .def("get_lineor_res", &PowerflowClient::get_lineor_res)
+        .def("get_lineex_res", &PowerflowClient::get_lineex_res)
+        .def("get_trafohv_res", &PowerflowClient::get_trafohv_res)
+        .def("get_trafolv_res", &PowerflowClient::get_trafolv_res)
+        .def("get_gen_res", &PowerflowClient::get_gen_res);
+}